@@ -0,0 +1,487 @@
+/**
+ * \file
+ *
+ * \brief Measure the per-file overhead of processing albums of track files.
+ *
+ * Each input directory is searched for cue sheets. Each cue sheet describes an
+ * album whose tracks are the audio files in the same directory, in order of
+ * their names. An album is processed in the same phases as in a batch run:
+ *
+ * <ol>
+ *   <li>parse: the cue sheet is parsed by ToCParser,</li>
+ *   <li>select: type and reader of each audio file are determined,</li>
+ *   <li>size: the size of each audio file is read by AudioInfo,</li>
+ *   <li>calculate: the checksums of the album are calculated by
+ *       ARCSCalculator.</li>
+ * </ol>
+ *
+ * The time of the calculation phase is attributed to each file by the time
+ * between the completion of its track and the completion of the previous
+ * track. The latency of a file is the sum of its select, size and calculate
+ * times.
+ *
+ * The result is printed as CSV with a header line and a line for each phase
+ * and for the files in total. Column per_s is the number of items processed
+ * per second of the phase, for the line "file" it is the number of files
+ * processed per second of the entire run.
+ *
+ * Usage: batch_benchmark [--output <file>] <directory>...
+ */
+
+#ifndef __LIBARCSDEC_CALCULATORS_HPP__
+#include "calculators.hpp"  // for ARCSCalculator, AudioInfo, ToCParser
+#endif
+#ifndef __LIBARCSDEC_METAPARSER_HPP__
+#include "metaparser.hpp"   // for MetadataParser
+#endif
+#ifndef __LIBARCSDEC_SELECTION_HPP__
+#include "selection.hpp"    // for FileReaderRegistry, file_type
+#endif
+
+#ifndef __LIBARCSTK_METADATA_HPP__
+#include <arcstk/metadata.hpp> // for AudioSize, ToC, UNIT
+#endif
+
+#include <algorithm>  // for sort
+#include <chrono>     // for steady_clock, duration
+#include <cmath>      // for ceil
+#include <cstdint>    // for int32_t, int64_t
+#include <cstdlib>    // for EXIT_SUCCESS, EXIT_FAILURE
+#include <filesystem> // for path, recursive_directory_iterator
+#include <fstream>    // for ofstream
+#include <iomanip>    // for setprecision
+#include <iostream>   // for cout, cerr, ostream
+#include <stdexcept>  // for invalid_argument, runtime_error
+#include <string>     // for string
+#include <vector>     // for vector
+
+
+namespace
+{
+
+using arcsdec::ARCSCalculator;
+using arcsdec::AudioInfo;
+using arcsdec::FileReaderRegistry;
+using arcsdec::ToCParser;
+
+using arcstk::AudioSize;
+using arcstk::UNIT;
+
+using clock = std::chrono::steady_clock;
+
+
+/**
+ * \brief Options of the benchmark.
+ */
+struct Options final
+{
+	/**
+	 * \brief Name of the output file, empty for standard output.
+	 */
+	std::string output;
+
+	/**
+	 * \brief Directories to search for albums.
+	 */
+	std::vector<std::string> directories;
+};
+
+
+/**
+ * \brief An album to process.
+ */
+struct Album final
+{
+	/**
+	 * \brief Name of the cue sheet.
+	 */
+	std::string cuesheet;
+
+	/**
+	 * \brief Names of the audio files, one per track.
+	 */
+	std::vector<std::string> tracks;
+};
+
+
+/**
+ * \brief Durations of a single phase.
+ */
+class Phase final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] name Name of the phase
+	 */
+	explicit Phase(const std::string& name)
+		: name_    { name }
+		, seconds_ { /* empty */ }
+	{
+		// empty
+	}
+
+	/**
+	 * \brief Name of the phase.
+	 *
+	 * \return Name of the phase
+	 */
+	const std::string& name() const
+	{
+		return name_;
+	}
+
+	/**
+	 * \brief Add a duration.
+	 *
+	 * \param[in] seconds Duration in seconds
+	 */
+	void add(const double seconds)
+	{
+		seconds_.push_back(seconds);
+	}
+
+	/**
+	 * \brief Duration with the specified index.
+	 *
+	 * \param[in] i Index of the duration
+	 *
+	 * \return Duration in seconds
+	 */
+	double at(const std::size_t i) const
+	{
+		return seconds_.at(i);
+	}
+
+	/**
+	 * \brief Number of durations.
+	 *
+	 * \return Number of durations
+	 */
+	std::size_t count() const
+	{
+		return seconds_.size();
+	}
+
+	/**
+	 * \brief Sum of all durations.
+	 *
+	 * \return Sum of all durations in seconds
+	 */
+	double total() const
+	{
+		auto sum = double { 0 };
+
+		for (const auto& s : seconds_)
+		{
+			sum += s;
+		}
+
+		return sum;
+	}
+
+	/**
+	 * \brief Percentile of the durations by nearest rank.
+	 *
+	 * \param[in] p Percentile as fraction in (0, 1]
+	 *
+	 * \return Percentile in seconds or 0 if there are no durations
+	 */
+	double percentile(const double p) const
+	{
+		if (seconds_.empty())
+		{
+			return 0;
+		}
+
+		auto sorted { seconds_ };
+		std::sort(sorted.begin(), sorted.end());
+
+		const auto rank {
+			static_cast<std::size_t>(std::ceil(p * sorted.size())) };
+
+		return sorted[rank > 0 ? rank - 1 : 0];
+	}
+
+private:
+
+	/**
+	 * \brief Name of the phase.
+	 */
+	std::string name_;
+
+	/**
+	 * \brief Durations in seconds.
+	 */
+	std::vector<double> seconds_;
+};
+
+
+/**
+ * \brief Seconds elapsed since \c start.
+ *
+ * \param[in] start Start time
+ *
+ * \return Seconds elapsed
+ */
+double seconds_since(const clock::time_point& start)
+{
+	return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+
+/**
+ * \brief Parse the command line.
+ *
+ * \param[in] argc Number of arguments
+ * \param[in] argv Arguments
+ *
+ * \return Options parsed
+ *
+ * \throw std::invalid_argument If the arguments are not valid
+ */
+Options parse_options(const int argc, char* argv[])
+{
+	auto options = Options {};
+
+	for (auto i { 1 }; i < argc; ++i)
+	{
+		const auto arg { std::string { argv[i] } };
+
+		if (arg == "--output" && i + 1 < argc)
+		{
+			options.output = argv[++i];
+		} else if (arg.front() != '-')
+		{
+			options.directories.push_back(arg);
+		} else
+		{
+			throw std::invalid_argument("Unknown argument: " + arg);
+		}
+	}
+
+	if (options.directories.empty())
+	{
+		throw std::invalid_argument("No input directories specified");
+	}
+
+	return options;
+}
+
+
+/**
+ * \brief Find all albums in the specified directories.
+ *
+ * \param[in] directories Directories to search
+ *
+ * \return Albums found, in order of the names of their cue sheets
+ */
+std::vector<Album> find_albums(const std::vector<std::string>& directories)
+{
+	namespace fs = std::filesystem;
+
+	auto albums = std::vector<Album> {};
+
+	for (const auto& directory : directories)
+	{
+		for (const auto& entry : fs::recursive_directory_iterator(directory))
+		{
+			if (!entry.is_regular_file() || entry.path().extension() != ".cue")
+			{
+				continue;
+			}
+
+			auto album = Album {};
+			album.cuesheet = entry.path().string();
+
+			for (const auto& file
+					: fs::directory_iterator(entry.path().parent_path()))
+			{
+				if (file.is_regular_file() && file.path() != entry.path())
+				{
+					album.tracks.push_back(file.path().string());
+				}
+			}
+
+			std::sort(album.tracks.begin(), album.tracks.end());
+			albums.push_back(album);
+		}
+	}
+
+	std::sort(albums.begin(), albums.end(),
+		[](const Album& lhs, const Album& rhs)
+		{
+			return lhs.cuesheet < rhs.cuesheet;
+		});
+
+	return albums;
+}
+
+
+/**
+ * \brief Print a line of the result.
+ *
+ * \param[in] out      Stream to print to
+ * \param[in] phase    Phase to print
+ * \param[in] duration Duration of the entire benchmark in seconds
+ * \param[in] wall     Seconds to refer the throughput to
+ */
+void print(std::ostream& out, const Phase& phase, const double duration,
+		const double wall)
+{
+	out << phase.name()
+		<< ',' << phase.count()
+		<< ',' << phase.total()
+		<< ',' << phase.total() / duration * 100
+		<< ',' << phase.percentile(0.50) * 1000
+		<< ',' << phase.percentile(0.99) * 1000
+		<< ',' << phase.count() / wall
+		<< '\n';
+}
+
+
+/**
+ * \brief Process all albums and print the timings.
+ *
+ * \param[in] options Options of the benchmark
+ * \param[in] out     Stream to print the result to
+ *
+ * \throw std::runtime_error If an album could not be processed
+ */
+void run(const Options& options, std::ostream& out)
+{
+	const auto albums { find_albums(options.directories) };
+
+	if (albums.empty())
+	{
+		throw std::runtime_error("No cue sheets found");
+	}
+
+	auto parse     = Phase { "parse" };
+	auto select    = Phase { "select" };
+	auto size      = Phase { "size" };
+	auto calculate = Phase { "calculate" };
+
+	const auto parser     = ToCParser {};
+	const auto info       = AudioInfo {};
+	auto       calculator = ARCSCalculator {};
+
+	const auto formats   { FileReaderRegistry::formats() };
+	const auto readers   { FileReaderRegistry::readers() };
+	const auto selection { FileReaderRegistry::default_audio_selection() };
+
+	const auto start { clock::now() };
+
+	for (const auto& album : albums)
+	{
+		auto begin { clock::now() };
+
+		auto toc { parser.parse(album.cuesheet) };
+
+		parse.add(seconds_since(begin));
+
+		if (static_cast<std::size_t>(toc->total_tracks())
+				!= album.tracks.size())
+		{
+			throw std::runtime_error(album.cuesheet + " has "
+				+ std::to_string(toc->total_tracks()) + " tracks but "
+				+ std::to_string(album.tracks.size()) + " audio files");
+		}
+
+		auto total_samples = int64_t { 0 };
+
+		for (const auto& track : album.tracks)
+		{
+			begin = clock::now();
+
+			const auto [ format, codec ] {
+				arcsdec::details::file_type(track, *formats) };
+
+			if (!selection->get(format, codec, *readers))
+			{
+				throw std::runtime_error("No reader for " + track);
+			}
+
+			select.add(seconds_since(begin));
+
+			begin = clock::now();
+
+			total_samples += info.size(track)->samples();
+
+			size.add(seconds_since(begin));
+		}
+
+		toc->set_leadout(AudioSize {
+				static_cast<int32_t>(total_samples), UNIT::SAMPLES });
+
+		// Each track is a file, so the time until a track is complete is the
+		// time it took to process the file
+
+		begin = clock::now();
+
+		calculator.set_track_callback(
+			[&calculate, &begin](const int, const arcstk::ChecksumSet&)
+			{
+				calculate.add(seconds_since(begin));
+				begin = clock::now();
+			});
+
+		calculator.calculate(album.tracks, *toc);
+	}
+
+	const auto duration { seconds_since(start) };
+
+	auto file = Phase { "file" };
+
+	for (auto i = std::size_t { 0 }; i < select.count(); ++i)
+	{
+		file.add(select.at(i) + size.at(i)
+				+ (i < calculate.count() ? calculate.at(i) : 0));
+	}
+
+	out << "phase,count,seconds,percent,p50_ms,p99_ms,per_s" << '\n';
+
+	out << std::fixed << std::setprecision(6);
+
+	for (const auto& phase : { parse, select, size, calculate })
+	{
+		print(out, phase, duration, phase.total());
+	}
+
+	print(out, file, duration, duration);
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		const auto options { parse_options(argc, argv) };
+
+		if (options.output.empty())
+		{
+			run(options, std::cout);
+		} else
+		{
+			auto out = std::ofstream { options.output };
+			run(options, out);
+		}
+
+	} catch (const std::invalid_argument& e)
+	{
+		std::cerr << e.what() << '\n' << "Usage: batch_benchmark"
+			" [--output <file>] <directory>..." << '\n';
+		return EXIT_FAILURE;
+
+	} catch (const std::exception& e)
+	{
+		std::cerr << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,597 @@
+/**
+ * \file
+ *
+ * \brief Generate synthetic CDDA audio for benchmarking.
+ *
+ * Writes a RIFF/WAV file with 16 bit stereo PCM samples at 44.100 Hz. The
+ * audio is a mix of triangle oscillators and filtered noise whose parameters
+ * change with each track. It is computed by integer arithmetic only, thus the
+ * output is identical on every platform for the same arguments. Unlike silence
+ * or white noise, it is neither trivial to compress nor incompressible, which
+ * lets lossless encoders work as on real music.
+ *
+ * With option --split, the output is a directory. For each album, a
+ * subdirectory contains each track as a WAV file and a cue sheet with the
+ * offsets of the tracks. Each album has its own seed.
+ *
+ * Usage: cdda_corpus [--seconds <n>] [--track-seconds <n>] [--seed <n>]
+ *                    [--split [--albums <n>]] <file or directory>
+ */
+
+#include <algorithm>  // for min
+#include <array>      // for array
+#include <cstdint>    // for int16_t, int32_t, int64_t, uint32_t
+#include <cstdlib>    // for EXIT_SUCCESS, EXIT_FAILURE
+#include <filesystem> // for create_directories, path
+#include <fstream>    // for ofstream
+#include <iomanip>    // for setw, setfill
+#include <iostream>   // for cerr
+#include <sstream>    // for ostringstream
+#include <stdexcept>  // for invalid_argument, runtime_error
+#include <string>     // for string, stol
+#include <vector>     // for vector
+
+
+namespace
+{
+
+/**
+ * \brief Samples per second of CDDA.
+ */
+constexpr int64_t SAMPLES_PER_SECOND = 44100;
+
+/**
+ * \brief Samples per CDDA frame, the size is rounded to full frames.
+ */
+constexpr int64_t SAMPLES_PER_FRAME = 588;
+
+/**
+ * \brief CDDA frames per second.
+ */
+constexpr int64_t FRAMES_PER_SECOND = 75;
+
+/**
+ * \brief Number of stereo samples generated per write operation.
+ */
+constexpr std::size_t SAMPLES_PER_WRITE = 65536;
+
+
+/**
+ * \brief Options of the generator.
+ */
+struct Options final
+{
+	/**
+	 * \brief Total length of the audio in seconds.
+	 */
+	int64_t seconds = 2700;
+
+	/**
+	 * \brief Length of each track in seconds.
+	 */
+	int64_t track_seconds = 270;
+
+	/**
+	 * \brief Seed for the noise and the oscillator parameters.
+	 */
+	uint32_t seed = 1;
+
+	/**
+	 * \brief Iff TRUE, write each track to a file of its own.
+	 */
+	bool split = false;
+
+	/**
+	 * \brief Number of albums to write if tracks are split.
+	 */
+	int albums = 1;
+
+	/**
+	 * \brief Name of the output file or directory.
+	 */
+	std::string filename;
+};
+
+
+/**
+ * \brief Parse the command line.
+ *
+ * \param[in] argc Number of arguments
+ * \param[in] argv Arguments
+ *
+ * \return Options parsed
+ *
+ * \throw std::invalid_argument If the arguments are not valid
+ */
+Options parse_options(const int argc, char* argv[])
+{
+	auto options = Options {};
+
+	for (auto i { 1 }; i < argc; ++i)
+	{
+		const auto arg { std::string { argv[i] } };
+
+		if (arg == "--seconds" && i + 1 < argc)
+		{
+			options.seconds = std::stol(argv[++i]);
+		} else if (arg == "--track-seconds" && i + 1 < argc)
+		{
+			options.track_seconds = std::stol(argv[++i]);
+		} else if (arg == "--seed" && i + 1 < argc)
+		{
+			options.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+		} else if (arg == "--split")
+		{
+			options.split = true;
+		} else if (arg == "--albums" && i + 1 < argc)
+		{
+			options.albums = std::stoi(argv[++i]);
+		} else if (options.filename.empty() && arg.front() != '-')
+		{
+			options.filename = arg;
+		} else
+		{
+			throw std::invalid_argument("Unknown argument: " + arg);
+		}
+	}
+
+	if (options.filename.empty())
+	{
+		throw std::invalid_argument("No output file specified");
+	}
+
+	if (options.seconds < 1 || options.track_seconds < 1)
+	{
+		throw std::invalid_argument("Length must be at least one second");
+	}
+
+	if (options.albums < 1 || (options.albums > 1 && !options.split))
+	{
+		throw std::invalid_argument("Multiple albums require --split");
+	}
+
+	return options;
+}
+
+
+/**
+ * \brief Deterministic pseudo random numbers (xorshift32).
+ */
+class Random final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] seed Seed, 0 is replaced by 1
+	 */
+	explicit Random(const uint32_t seed)
+		: state_ { seed ? seed : 1 }
+	{
+		// empty
+	}
+
+	/**
+	 * \brief Next pseudo random number.
+	 *
+	 * \return Next pseudo random number
+	 */
+	uint32_t next()
+	{
+		state_ ^= state_ << 13;
+		state_ ^= state_ >> 17;
+		state_ ^= state_ << 5;
+
+		return state_;
+	}
+
+private:
+
+	/**
+	 * \brief Internal state.
+	 */
+	uint32_t state_;
+};
+
+
+/**
+ * \brief Synthetic signal for a single channel.
+ *
+ * Mixes three triangle oscillators with lowpass filtered noise.
+ */
+class Channel final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] seed Seed for the noise
+	 */
+	explicit Channel(const uint32_t seed)
+		: phases_     {}
+		, increments_ {}
+		, noise_      { seed }
+		, lowpass_    { 0 }
+	{
+		// empty
+	}
+
+	/**
+	 * \brief Start a new track with new oscillator frequencies.
+	 *
+	 * \param[in] random Source for the frequencies
+	 */
+	void start_track(Random& random)
+	{
+		for (auto& increment : increments_)
+		{
+			// Roughly 55 Hz to 1.8 kHz
+
+			increment = 5000000u + random.next() % 170000000u;
+		}
+	}
+
+	/**
+	 * \brief Next sample of this channel.
+	 *
+	 * \return Next sample
+	 */
+	int16_t next()
+	{
+		auto value = int32_t { 0 };
+
+		for (auto i = std::size_t { 0 }; i < phases_.size(); ++i)
+		{
+			phases_[i] += increments_[i];
+			value += triangle(phases_[i]) / 6;
+		}
+
+		const auto white { static_cast<int32_t>(noise_.next() >> 16) - 32768 };
+		lowpass_ += (white - lowpass_) / 8;
+
+		value += lowpass_ / 8;
+
+		return static_cast<int16_t>(std::max(-32768, std::min(32767, value)));
+	}
+
+private:
+
+	/**
+	 * \brief Triangle wave of a phase.
+	 *
+	 * \param[in] phase Phase in units of 1/2^32 of a period
+	 *
+	 * \return Value in the range of 16 bit samples
+	 */
+	static int32_t triangle(const uint32_t phase)
+	{
+		const auto ramp { static_cast<int32_t>(phase >> 15) }; // 0 .. 131071
+
+		return ramp < 65536 ? ramp - 32768 : 98303 - ramp;
+	}
+
+	/**
+	 * \brief Phases of the oscillators.
+	 */
+	std::array<uint32_t, 3> phases_;
+
+	/**
+	 * \brief Phase increments of the oscillators.
+	 */
+	std::array<uint32_t, 3> increments_;
+
+	/**
+	 * \brief Noise source.
+	 */
+	Random noise_;
+
+	/**
+	 * \brief State of the lowpass filter.
+	 */
+	int32_t lowpass_;
+};
+
+
+/**
+ * \brief Append \c value to \c bytes as little endian.
+ *
+ * \param[in,out] bytes Bytes to append to
+ * \param[in]     value Value to append
+ * \param[in]     size  Number of bytes to append
+ */
+void append_le(std::vector<char>& bytes, const uint32_t value,
+		const int size)
+{
+	for (auto i { 0 }; i < size; ++i)
+	{
+		bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+	}
+}
+
+
+/**
+ * \brief Canonical RIFF/WAV header for 16 bit stereo PCM at 44.100 Hz.
+ *
+ * \param[in] samples Number of stereo samples
+ *
+ * \return Header bytes
+ */
+std::vector<char> wav_header(const int64_t samples)
+{
+	const auto data_bytes { static_cast<uint32_t>(samples * 4) };
+
+	auto header = std::vector<char> {};
+
+	header.insert(header.end(), { 'R', 'I', 'F', 'F' });
+	append_le(header, 36 + data_bytes, 4);
+	header.insert(header.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+	append_le(header, 16, 4);                     // size of format chunk
+	append_le(header, 1, 2);                      // PCM
+	append_le(header, 2, 2);                      // channels
+	append_le(header, SAMPLES_PER_SECOND, 4);     // samples per second
+	append_le(header, SAMPLES_PER_SECOND * 4, 4); // bytes per second
+	append_le(header, 4, 2);                      // block align
+	append_le(header, 16, 2);                     // bits per sample
+	header.insert(header.end(), { 'd', 'a', 't', 'a' });
+	append_le(header, data_bytes, 4);
+
+	return header;
+}
+
+
+/**
+ * \brief Synthetic stereo signal of an album.
+ *
+ * The oscillators of both channels change after each track.
+ */
+class Signal final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] seed          Seed of the album
+	 * \param[in] track_samples Number of samples per track
+	 */
+	Signal(const uint32_t seed, const int64_t track_samples)
+		: random_        { seed }
+		, left_          { random_.next() }
+		, right_         { random_.next() }
+		, track_samples_ { track_samples }
+		, position_      { 0 }
+	{
+		// empty
+	}
+
+	/**
+	 * \brief Fill \c buffer with the next \c samples samples.
+	 *
+	 * \param[in,out] buffer  Buffer for 16 bit stereo samples in little endian
+	 * \param[in]     samples Number of samples to fill
+	 */
+	void fill(std::vector<char>& buffer, const int64_t samples)
+	{
+		for (auto i = int64_t { 0 }; i < samples; ++i, ++position_)
+		{
+			if (position_ % track_samples_ == 0)
+			{
+				left_.start_track(random_);
+				right_.start_track(random_);
+			}
+
+			const auto l { static_cast<uint16_t>(left_.next()) };
+			const auto r { static_cast<uint16_t>(right_.next()) };
+
+			const auto pos { static_cast<std::size_t>(i) * 4 };
+
+			buffer[pos    ] = static_cast<char>(l & 0xFF);
+			buffer[pos + 1] = static_cast<char>(l >> 8);
+			buffer[pos + 2] = static_cast<char>(r & 0xFF);
+			buffer[pos + 3] = static_cast<char>(r >> 8);
+		}
+	}
+
+private:
+
+	/**
+	 * \brief Source for the oscillator parameters.
+	 */
+	Random random_;
+
+	/**
+	 * \brief Left channel.
+	 */
+	Channel left_;
+
+	/**
+	 * \brief Right channel.
+	 */
+	Channel right_;
+
+	/**
+	 * \brief Number of samples per track.
+	 */
+	int64_t track_samples_;
+
+	/**
+	 * \brief Number of samples generated so far.
+	 */
+	int64_t position_;
+};
+
+
+/**
+ * \brief Write the next \c samples samples of \c signal as WAV file.
+ *
+ * \param[in]     filename Name of the file to write
+ * \param[in,out] signal   Signal to write
+ * \param[in]     samples  Number of samples to write
+ *
+ * \throw std::runtime_error If the file could not be written
+ */
+void write_wav(const std::string& filename, Signal& signal,
+		const int64_t samples)
+{
+	auto out = std::ofstream { filename, std::ios::binary };
+
+	if (!out)
+	{
+		throw std::runtime_error("Could not open " + filename);
+	}
+
+	const auto header { wav_header(samples) };
+	out.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+	auto buffer = std::vector<char>(SAMPLES_PER_WRITE * 4);
+
+	for (auto done = int64_t { 0 }; done < samples; )
+	{
+		const auto todo { std::min(static_cast<int64_t>(SAMPLES_PER_WRITE),
+				samples - done) };
+
+		signal.fill(buffer, todo);
+		out.write(buffer.data(), todo * 4);
+
+		done += todo;
+	}
+
+	if (!out)
+	{
+		throw std::runtime_error("Could not write " + filename);
+	}
+}
+
+
+/**
+ * \brief Format a number with leading zeros.
+ *
+ * \param[in] value Value to format
+ * \param[in] width Minimal number of digits
+ *
+ * \return Formatted number
+ */
+std::string zero_padded(const int64_t value, const int width)
+{
+	auto stream = std::ostringstream {};
+	stream << std::setw(width) << std::setfill('0') << value;
+
+	return stream.str();
+}
+
+
+/**
+ * \brief Write a cue sheet for an album with the specified track offsets.
+ *
+ * The cue sheet describes the album as a single stream, hence it contains no
+ * FILE statement and the offsets are not relative to the track files.
+ *
+ * \param[in] filename Name of the cue sheet
+ * \param[in] title    Title of the album
+ * \param[in] offsets  Offset of each track in samples
+ *
+ * \throw std::runtime_error If the file could not be written
+ */
+void write_cue(const std::string& filename, const std::string& title,
+		const std::vector<int64_t>& offsets)
+{
+	auto out = std::ofstream { filename };
+
+	out << "TITLE \"" << title << "\"" << '\n';
+
+	for (auto t = std::size_t { 0 }; t < offsets.size(); ++t)
+	{
+		const auto frames { offsets[t] / SAMPLES_PER_FRAME };
+
+		out << "  TRACK " << zero_padded(static_cast<int64_t>(t + 1), 2)
+			<< " AUDIO" << '\n'
+			<< "    INDEX 01 "
+			<< zero_padded(frames / FRAMES_PER_SECOND / 60, 2) << ':'
+			<< zero_padded(frames / FRAMES_PER_SECOND % 60, 2) << ':'
+			<< zero_padded(frames % FRAMES_PER_SECOND, 2) << '\n';
+	}
+
+	if (!out)
+	{
+		throw std::runtime_error("Could not write " + filename);
+	}
+}
+
+
+/**
+ * \brief Write the synthetic audio as specified by \c options.
+ *
+ * \param[in] options Options of the generator
+ *
+ * \throw std::runtime_error If a file could not be written
+ */
+void generate(const Options& options)
+{
+	// Entire frames only
+
+	const auto total { options.seconds * SAMPLES_PER_SECOND };
+	const auto samples { total - total % SAMPLES_PER_FRAME };
+	const auto track_samples { options.track_seconds * SAMPLES_PER_SECOND };
+
+	if (!options.split)
+	{
+		auto signal = Signal { options.seed, track_samples };
+		write_wav(options.filename, signal, samples);
+
+		return;
+	}
+
+	for (auto a { 1 }; a <= options.albums; ++a)
+	{
+		const auto album { "album" + zero_padded(a, 4) };
+		const auto dir { std::filesystem::path { options.filename } / album };
+
+		std::filesystem::create_directories(dir);
+
+		auto signal = Signal {
+			options.seed + static_cast<uint32_t>(a - 1), track_samples };
+		auto offsets = std::vector<int64_t> {};
+
+		for (auto offset = int64_t { 0 }; offset < samples;
+				offset += track_samples)
+		{
+			const auto track { "track"
+				+ zero_padded(static_cast<int64_t>(offsets.size() + 1), 2)
+				+ ".wav" };
+
+			write_wav((dir / track).string(), signal,
+					std::min(track_samples, samples - offset));
+
+			offsets.push_back(offset);
+		}
+
+		write_cue((dir / "album.cue").string(), album, offsets);
+	}
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		generate(parse_options(argc, argv));
+
+	} catch (const std::invalid_argument& e)
+	{
+		std::cerr << e.what() << '\n' << "Usage: cdda_corpus [--seconds <n>]"
+			" [--track-seconds <n>] [--seed <n>] [--split [--albums <n>]]"
+			" <file or directory>" << '\n';
+		return EXIT_FAILURE;
+
+	} catch (const std::exception& e)
+	{
+		std::cerr << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
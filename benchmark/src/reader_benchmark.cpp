@@ -0,0 +1,372 @@
+/**
+ * \file
+ *
+ * \brief Measure the throughput of the AudioReaders.
+ *
+ * Each input file is read by each available reader that accepts its format and
+ * codec. Each reader is run with each block size and each combination of
+ * checksum types through ARCSCalculator. Every combination is run several
+ * times and the fastest run is reported.
+ *
+ * The result is printed as CSV with a header line. Throughput is given in
+ * megabytes of the input file per second and in samples per second.
+ *
+ * Usage: reader_benchmark [--repeat <n>] [--output <file>] <file>...
+ */
+
+#ifndef __LIBARCSDEC_CALCULATORS_HPP__
+#include "calculators.hpp"  // for ARCSCalculator, ReaderStatistics
+#endif
+#ifndef __LIBARCSDEC_DESCRIPTOR_HPP__
+#include "descriptor.hpp"   // for Format, Codec, name
+#endif
+#ifndef __LIBARCSDEC_SAMPLEPROC_HPP__
+#include "sampleproc.hpp"   // for BLOCKSIZE
+#endif
+#ifndef __LIBARCSDEC_SELECTION_HPP__
+#include "selection.hpp"    // for FileReaderRegistry, IdSelector, ...
+#endif
+
+#ifndef __LIBARCSTK_CALCULATE_HPP__
+#include <arcstk/calculate.hpp> // for checksum, ChecksumtypeSet
+#endif
+
+#include <algorithm>  // for sort
+#include <chrono>     // for steady_clock, duration
+#include <cstdint>    // for int64_t
+#include <cstdlib>    // for EXIT_SUCCESS, EXIT_FAILURE
+#include <filesystem> // for file_size
+#include <fstream>    // for ofstream
+#include <iomanip>    // for setprecision
+#include <iostream>   // for cout, cerr, ostream
+#include <limits>     // for numeric_limits
+#include <stdexcept>  // for invalid_argument
+#include <string>     // for string, stoi
+#include <utility>    // for pair
+#include <vector>     // for vector
+
+
+namespace
+{
+
+using arcsdec::ARCSCalculator;
+using arcsdec::BLOCKSIZE;
+using arcsdec::ChecksumtypeSet;
+using arcsdec::DefaultPreference;
+using arcsdec::DescriptorPreference;
+using arcsdec::FileReaderPreferenceSelection;
+using arcsdec::FileReaderRegistry;
+using arcsdec::IdSelector;
+
+using arcstk::checksum::type;
+
+
+/**
+ * \brief Options of the benchmark.
+ */
+struct Options final
+{
+	/**
+	 * \brief Number of runs per combination.
+	 */
+	int repeat = 3;
+
+	/**
+	 * \brief Name of the output file, empty for standard output.
+	 */
+	std::string output;
+
+	/**
+	 * \brief Names of the input files.
+	 */
+	std::vector<std::string> files;
+};
+
+
+/**
+ * \brief Result of the fastest run of a combination.
+ */
+struct Measurement final
+{
+	/**
+	 * \brief Number of samples read.
+	 */
+	int64_t samples = 0;
+
+	/**
+	 * \brief Wall clock time of the calculation in seconds.
+	 */
+	double seconds = 0;
+};
+
+
+/**
+ * \brief Block sizes to benchmark, in samples.
+ */
+const std::vector<int64_t> block_sizes {
+	BLOCKSIZE::MIN,
+	BLOCKSIZE::DEFAULT / 16,
+	BLOCKSIZE::DEFAULT
+};
+
+
+/**
+ * \brief Combinations of checksum types to benchmark.
+ */
+const std::vector<ChecksumtypeSet> checksum_types {
+	{ type::ARCS1 },
+	{ type::ARCS2 },
+	{ type::ARCS1, type::ARCS2 }
+};
+
+
+/**
+ * \brief Parse the command line.
+ *
+ * \param[in] argc Number of arguments
+ * \param[in] argv Arguments
+ *
+ * \return Options parsed
+ *
+ * \throw std::invalid_argument If the arguments are not valid
+ */
+Options parse_options(const int argc, char* argv[])
+{
+	auto options = Options {};
+
+	for (auto i { 1 }; i < argc; ++i)
+	{
+		const auto arg { std::string { argv[i] } };
+
+		if (arg == "--repeat" && i + 1 < argc)
+		{
+			options.repeat = std::stoi(argv[++i]);
+		} else if (arg == "--output" && i + 1 < argc)
+		{
+			options.output = argv[++i];
+		} else if (arg.front() != '-')
+		{
+			options.files.push_back(arg);
+		} else
+		{
+			throw std::invalid_argument("Unknown argument: " + arg);
+		}
+	}
+
+	if (options.files.empty())
+	{
+		throw std::invalid_argument("No input files specified");
+	}
+
+	if (options.repeat < 1)
+	{
+		throw std::invalid_argument("Repeat must be at least 1");
+	}
+
+	return options;
+}
+
+
+/**
+ * \brief Ids of all readers that accept the type of \c filename.
+ *
+ * \param[in] format Format of the input file
+ * \param[in] codec  Codec of the input file
+ *
+ * \return Ids of the readers to benchmark
+ */
+std::vector<std::string> candidate_readers(const arcsdec::Format format,
+		const arcsdec::Codec codec)
+{
+	const auto preference = DefaultPreference {};
+
+	auto ids = std::vector<std::string> {};
+
+	for (const auto& entry : *FileReaderRegistry::readers())
+	{
+		if (preference.preference(format, codec, *entry.second)
+				> DescriptorPreference::MIN_PREFERENCE)
+		{
+			ids.push_back(entry.first);
+		}
+	}
+
+	std::sort(ids.begin(), ids.end());
+
+	return ids;
+}
+
+
+/**
+ * \brief Name for a combination of checksum types.
+ *
+ * \param[in] types Checksum types
+ *
+ * \return Names of the types, separated by '+'
+ */
+std::string types_name(const ChecksumtypeSet& types)
+{
+	auto name = std::string {};
+
+	for (const auto& t : { type::ARCS1, type::ARCS2 })
+	{
+		if (types.find(t) != types.end())
+		{
+			name += (name.empty() ? "" : "+") + arcstk::checksum::type_name(t);
+		}
+	}
+
+	return name;
+}
+
+
+/**
+ * \brief Run a combination and measure its fastest run.
+ *
+ * \param[in] filename   Name of the input file
+ * \param[in] reader_id  Id of the reader to use
+ * \param[in] block_size Number of samples per read
+ * \param[in] types      Checksum types to calculate
+ * \param[in] repeat     Number of runs
+ *
+ * \return Fastest run
+ */
+Measurement measure(const std::string& filename, const std::string& reader_id,
+		const int64_t block_size, const ChecksumtypeSet& types,
+		const int repeat)
+{
+	using clock = std::chrono::steady_clock;
+
+	auto selection =
+		FileReaderPreferenceSelection<DefaultPreference, IdSelector> {
+			reader_id };
+
+	auto calculator = ARCSCalculator { types };
+	calculator.set_selection(&selection);
+	calculator.set_read_buffer_size(block_size);
+
+	auto best = Measurement {};
+	best.seconds = std::numeric_limits<double>::max();
+
+	for (auto run { 0 }; run < repeat; ++run)
+	{
+		const auto start { clock::now() };
+
+		calculator.calculate(filename, true, true);
+
+		const auto seconds {
+			std::chrono::duration<double>(clock::now() - start).count() };
+
+		if (seconds < best.seconds)
+		{
+			best.seconds = seconds;
+
+			best.samples = calculator.statistics().empty()
+				? 0
+				: calculator.statistics().front().samples;
+		}
+	}
+
+	return best;
+}
+
+
+/**
+ * \brief Benchmark every combination for every input file.
+ *
+ * \param[in] options Options of the benchmark
+ * \param[in] out     Stream to print the result to
+ *
+ * \return TRUE iff every combination succeeded
+ */
+bool run(const Options& options, std::ostream& out)
+{
+	out << "file,format,codec,reader,block_size,checksums,samples,file_bytes,"
+		"seconds,mb_per_s,samples_per_s" << '\n';
+
+	out << std::fixed << std::setprecision(6);
+
+	auto success { true };
+
+	for (const auto& filename : options.files)
+	{
+		const auto [ format, codec ] { arcsdec::details::file_type(filename,
+				*FileReaderRegistry::formats()) };
+		const auto bytes { std::filesystem::file_size(filename) };
+
+		const auto readers { candidate_readers(format, codec) };
+
+		if (readers.empty())
+		{
+			std::cerr << "No reader available for " << filename << '\n';
+			success = false;
+		}
+
+		for (const auto& reader_id : readers)
+		{
+			for (const auto& block_size : block_sizes)
+			{
+				for (const auto& types : checksum_types)
+				{
+					try
+					{
+						const auto m { measure(filename, reader_id, block_size,
+								types, options.repeat) };
+
+						out << filename
+							<< ',' << arcsdec::name(format)
+							<< ',' << arcsdec::name(codec)
+							<< ',' << reader_id
+							<< ',' << block_size
+							<< ',' << types_name(types)
+							<< ',' << m.samples
+							<< ',' << bytes
+							<< ',' << m.seconds
+							<< ',' << bytes / m.seconds / 1000000.0
+							<< ',' << m.samples / m.seconds
+							<< '\n';
+
+					} catch (const std::exception& e)
+					{
+						std::cerr << filename << " with " << reader_id
+							<< " failed: " << e.what() << '\n';
+						success = false;
+					}
+				}
+			}
+		}
+	}
+
+	return success;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		const auto options { parse_options(argc, argv) };
+
+		if (options.output.empty())
+		{
+			return run(options, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		auto out = std::ofstream { options.output };
+
+		return run(options, out) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+	} catch (const std::invalid_argument& e)
+	{
+		std::cerr << e.what() << '\n' << "Usage: reader_benchmark"
+			" [--repeat <n>] [--output <file>] <file>..." << '\n';
+
+	} catch (const std::exception& e)
+	{
+		std::cerr << e.what() << '\n';
+	}
+
+	return EXIT_FAILURE;
+}
@@ -21,6 +21,7 @@
 #include <arcstk/calculate.hpp>  // for SampleInputIterator
 #endif
 
+#include <chrono>     // for steady_clock
 #include <cstddef>    // for size_t
 #include <cstdint>    // for uint16_t, uint32_t, int16_t, int32_t
 #include <memory>     // for unique_ptr
@@ -50,7 +51,15 @@ using arcstk::UNIT;
  * either analyze the file via \c acquire_size() or actually process the file
  * via \c process_file(), which yields the actual calculation results. An
  * AudioReader is a SampleProvider and hence a SampleProcessor can be
- * attached to it.
+ * attached to it. Via \c process_range() only a range of samples in the file
+ * is processed, which lets readers that can seek skip the samples outside
+ * of the range.
+ *
+ * Alternatively to pushing the samples to a SampleProcessor, the caller can
+ * pull the samples: after \c open(), each call of \c next_block() returns the
+ * next SampleBlock until an empty block signals the end of the input. This
+ * lets the caller decide when to read the next block, e.g. for reading many
+ * files by a fixed number of threads.
  *
  * An AudioReader internally holds a concrete instance of AudioReaderImpl.
  * AudioReaderImpl can be subclassed to implement the capabilities of an
@@ -74,6 +83,8 @@ using arcstk::UNIT;
  * BigEndianBytes and LittleEndianBytes decode short sequences of single chars
  * to integers.
  *
+ * ReaderStatistics report where the time was spent while reading an input.
+ *
  * @{
  */
 
@@ -91,6 +102,159 @@ extern const int32_t MAX_SAMPLES_TO_READ;
 // FIXME But we have to expect more samples than redbook allows!
 
 
+/**
+ * \brief Statistics about reading an audio input.
+ *
+ * All times are wall clock seconds. Opening covers opening the file and
+ * reading its metadata until the size of the input is known or the first
+ * samples are passed. Processing covers the time spent in the
+ * SampleProcessor, i.e. updating the Calculations. Since the samples are
+ * converted to PCM 32 bit samples while the SampleProcessor iterates them,
+ * processing includes the conversion. Decoding covers the remaining time,
+ * i.e. reading and decoding the audio data.
+ *
+ * The numbers of blocks and samples are always counted. The times, the bytes
+ * read and the reader id are only measured if the reader has statistics
+ * enabled, since they require to read the clock for each block.
+ */
+struct ReaderStatistics final
+{
+	/**
+	 * \brief Id of the descriptor of the reader.
+	 */
+	std::string reader_id;
+
+	/**
+	 * \brief Process-wide id of the input, unique for each input read.
+	 *
+	 * The id identifies the input in the static tracepoints, if present.
+	 */
+	uint64_t file_id = 0;
+
+	/**
+	 * \brief Number of bytes read from the input, 0 if unknown.
+	 */
+	int64_t bytes_read = 0;
+
+	/**
+	 * \brief Number of sequences of samples passed.
+	 */
+	int64_t blocks = 0;
+
+	/**
+	 * \brief Number of PCM 32 bit samples passed.
+	 */
+	int64_t samples = 0;
+
+	/**
+	 * \brief Size of the largest sequence of samples passed in bytes.
+	 *
+	 * This is the size of the PCM 32 bit samples of the largest block, not
+	 * the peak memory of the reader. The buffers of the decoder and of the
+	 * reader in their own sample format are not covered.
+	 */
+	std::size_t peak_block_bytes = 0;
+
+	/**
+	 * \brief Seconds spent opening the input.
+	 */
+	double open_seconds = 0.0;
+
+	/**
+	 * \brief Seconds spent reading and decoding the audio data.
+	 */
+	double decode_seconds = 0.0;
+
+	/**
+	 * \brief Seconds spent in the SampleProcessor.
+	 */
+	double processing_seconds = 0.0;
+};
+
+
+/**
+ * \brief A block of samples borrowed from an AudioReader.
+ *
+ * The block is a contiguous sequence of PCM 32 bit samples. The samples are
+ * owned by the AudioReader and remain valid until the next call of
+ * \c next_block() or \c close() on the AudioReader.
+ *
+ * An empty block signals the end of the input.
+ */
+class SampleBlock final
+{
+public:
+
+	/**
+	 * \brief Constructor for an empty block.
+	 */
+	SampleBlock();
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] data Pointer to the first sample
+	 * \param[in] size Number of samples
+	 */
+	SampleBlock(const arcstk::sample_t* data, const std::size_t size);
+
+	/**
+	 * \brief Pointer to the first sample.
+	 *
+	 * \return Pointer to the first sample
+	 */
+	const arcstk::sample_t* data() const noexcept;
+
+	/**
+	 * \brief Number of PCM 32 bit samples in the block.
+	 *
+	 * \return Number of samples
+	 */
+	std::size_t size() const noexcept;
+
+	/**
+	 * \brief TRUE iff the block contains no samples.
+	 *
+	 * \return TRUE iff the block is empty
+	 */
+	bool empty() const noexcept;
+
+	/**
+	 * \brief Start of the samples.
+	 *
+	 * \return Pointer to the first sample
+	 */
+	const arcstk::sample_t* begin() const noexcept;
+
+	/**
+	 * \brief End of the samples.
+	 *
+	 * \return Pointer behind the last sample
+	 */
+	const arcstk::sample_t* end() const noexcept;
+
+private:
+
+	/**
+	 * \brief Pointer to the first sample.
+	 */
+	const arcstk::sample_t* data_;
+
+	/**
+	 * \brief Number of samples.
+	 */
+	std::size_t size_;
+};
+
+
+namespace details
+{
+
+class SampleBlockQueue;
+
+} // namespace details
+
+
 /**
  * \brief Abstract base class for AudioReader implementations.
  *
@@ -109,6 +273,11 @@ public:
 	 */
 	AudioReaderImpl();
 
+	/**
+	 * \brief Virtual default destructor.
+	 */
+	~AudioReaderImpl() noexcept override;
+
 	/**
 	 * \brief Provides implementation for acquire_size() of a AudioReader.
 	 *
@@ -129,6 +298,50 @@ public:
 	 */
 	void process_file(const std::string& filename);
 
+	/**
+	 * \brief Provides implementation for process_range() of some AudioReader.
+	 *
+	 * \param[in] filename The filename of the file to process
+	 * \param[in] first    Index of the first PCM 32 bit sample to process
+	 * \param[in] total    Total number of PCM 32 bit samples to process
+	 *
+	 * \throw FileReadException If the file could not be read
+	 */
+	void process_range(const std::string& filename, const int64_t first,
+			const int64_t total);
+
+	/**
+	 * \brief Provides implementation for open() of some AudioReader.
+	 *
+	 * \param[in] filename The filename of the file to read
+	 *
+	 * \throw FileReadException If the file could not be read
+	 * \throw std::logic_error  If an input is already open
+	 */
+	void open(const std::string& filename);
+
+	/**
+	 * \brief Provides implementation for next_block() of some AudioReader.
+	 *
+	 * \return The next block of samples, empty at the end of the input
+	 *
+	 * \throw FileReadException If the file could not be read
+	 * \throw std::logic_error  If no input is open
+	 */
+	SampleBlock next_block();
+
+	/**
+	 * \brief Provides implementation for input_size() of some AudioReader.
+	 *
+	 * \return Size of the open input, zero() if not known
+	 */
+	AudioSize input_size() const;
+
+	/**
+	 * \brief Provides implementation for close() of some AudioReader.
+	 */
+	void close();
+
 	/**
 	 * \brief Set the number of samples to read in one read operation.
 	 *
@@ -145,6 +358,30 @@ public:
 	 */
 	int64_t samples_per_read() const;
 
+	/**
+	 * \brief Provides implementation for statistics() of some AudioReader.
+	 *
+	 * \return Statistics of the last call of process_file() or
+	 * process_range()
+	 */
+	const ReaderStatistics& statistics() const;
+
+	/**
+	 * \brief Provides implementation for set_statistics_enabled() of some
+	 * AudioReader.
+	 *
+	 * \param[in] enabled TRUE iff times and bytes read are to be measured
+	 */
+	void set_statistics_enabled(const bool enabled);
+
+	/**
+	 * \brief Provides implementation for statistics_enabled() of some
+	 * AudioReader.
+	 *
+	 * \return TRUE iff times and bytes read are measured
+	 */
+	bool statistics_enabled() const;
+
 	/**
 	 * \brief Create a descriptor for this AudioReader implementation.
 	 *
@@ -152,6 +389,17 @@ public:
 	 */
 	std::unique_ptr<FileReaderDescriptor> descriptor() const;
 
+	/**
+	 * \brief Provides implementation for reset() of some AudioReader.
+	 *
+	 * Closes the open input, detaches the SampleProcessor, restores the
+	 * default samples_per_read(), clears and disables the statistics. Then the
+	 * implementation resets its own state by do_reset().
+	 *
+	 * \return TRUE iff the instance can be used for another input
+	 */
+	bool reset();
+
 protected:
 
 	// Avoid -Weffc++ firing
@@ -175,6 +423,29 @@ protected:
 	 */
 	SampleProcessor* use_processor();
 
+	/**
+	 * \brief Signal appendsamples for the samples in a buffer of the reader.
+	 *
+	 * If an input is open for pulling, the buffer is handed over to the queue
+	 * of blocks instead of being copied and \c samples receives a recycled
+	 * buffer of a block that was already consumed. The caller must not
+	 * assume anything about the size or content of \c samples afterwards.
+	 *
+	 * Otherwise, this is equivalent to signal_appendsamples().
+	 *
+	 * \param[in,out] samples Samples to pass, replaced by a recycled buffer
+	 */
+	void signal_appendbuffer(std::vector<arcstk::sample_t>& samples);
+
+	/**
+	 * \brief Stop the thread that reads the open input, if any.
+	 *
+	 * The thread started by the default implementation of do_open() calls
+	 * do_process_file(). Subclasses that do not override do_open() must thus
+	 * call this in their destructor.
+	 */
+	void stop_producer() noexcept;
+
 	/**
 	 * \brief Service: convert 64 bit wide number of total samples to AudioSize.
 	 *
@@ -227,9 +498,91 @@ private:
 	virtual void do_process_file(const std::string& filename)
 	= 0;
 
+	/**
+	 * \brief Provides implementation for process_range() of some AudioReader.
+	 *
+	 * The default implementation processes the entire file and passes only
+	 * the samples within the range to the SampleProcessor. Readers that can
+	 * seek in their input are supposed to override it.
+	 *
+	 * An implementation reports the size of the range, not the size of the
+	 * file, as AudioSize. If the file ends before the range, the range is
+	 * truncated to the file.
+	 *
+	 * \param[in] filename The filename of the file to process
+	 * \param[in] first    Index of the first PCM 32 bit sample to process
+	 * \param[in] total    Total number of PCM 32 bit samples to process
+	 *
+	 * \throw FileReadException If the file could not be read
+	 */
+	virtual void do_process_range(const std::string& filename,
+			const int64_t first, const int64_t total);
+
+	/**
+	 * \brief Provides implementation for open() of some AudioReader.
+	 *
+	 * When called, the signals of this instance are received by an internal
+	 * queue of sample blocks. An implementation opens the file and signals
+	 * the start of the input and, if known, the size of the input.
+	 *
+	 * The default implementation processes the file by do_process_file() on
+	 * a separate thread that is paused as long as the queue is full. Readers
+	 * that can decode their input step by step are supposed to override
+	 * do_open(), do_read_block() and do_close() together.
+	 *
+	 * \param[in] filename The filename of the file to read
+	 *
+	 * \throw FileReadException If the file could not be read
+	 */
+	virtual void do_open(const std::string& filename);
+
+	/**
+	 * \brief Provides the next samples for next_block() of some AudioReader.
+	 *
+	 * An implementation passes at least the next decoded samples by signal
+	 * appendsamples. It is called repeatedly until the queue is not empty.
+	 *
+	 * The default implementation waits for the thread started by do_open().
+	 *
+	 * \return FALSE iff there are no more samples to read
+	 *
+	 * \throw FileReadException If the file could not be read
+	 */
+	virtual bool do_read_block();
+
+	/**
+	 * \brief Provides implementation for close() of some AudioReader.
+	 *
+	 * An implementation releases the open file. The default implementation
+	 * does nothing, the thread is stopped by close().
+	 */
+	virtual void do_close();
+
 	virtual std::unique_ptr<FileReaderDescriptor> do_descriptor() const
 	= 0;
 
+	/**
+	 * \brief Provides implementation for reset() of some AudioReader.
+	 *
+	 * An implementation restores the state it had after construction. The
+	 * default implementation returns FALSE, i.e. the instance is not reused.
+	 *
+	 * \return TRUE iff the instance can be used for another input
+	 */
+	virtual bool do_reset();
+
+	/**
+	 * \brief Start collecting statistics for the next input.
+	 */
+	void start_statistics();
+
+	/**
+	 * \brief Complete the statistics after \c filename was read.
+	 *
+	 * \param[in] filename The file that was read
+	 */
+	void finish_statistics(const std::string& filename);
+
 	/**
 	 * \brief Internal pointer to the SampleProcessor.
 	 */
@@ -239,6 +592,36 @@ private:
 	 * \brief Buffer size as total number of PCM 32 bit samples.
 	 */
 	int64_t samples_per_read_;
+
+	/**
+	 * \brief Queue of sample blocks while an input is open for pulling.
+	 */
+	std::unique_ptr<details::SampleBlockQueue> blocks_;
+
+	/**
+	 * \brief Statistics of the last input processed.
+	 */
+	ReaderStatistics statistics_;
+
+	/**
+	 * \brief TRUE iff times and bytes read are measured.
+	 */
+	bool statistics_enabled_;
+
+	/**
+	 * \brief Start of processing the current input, empty if not measuring.
+	 */
+	std::chrono::steady_clock::time_point started_;
+
+	/**
+	 * \brief End of opening the current input, empty if not yet opened.
+	 */
+	std::chrono::steady_clock::time_point opened_;
+
+	/**
+	 * \brief Bytes read by the current thread before processing the input.
+	 */
+	int64_t bytes_before_;
 };
 
 
@@ -322,6 +705,93 @@ public:
 	 */
 	void process_file(const std::string& filename);
 
+	/**
+	 * \brief Process a range of samples of the file.
+	 *
+	 * The attached SampleProcessor receives the samples from index \c first
+	 * to index <tt>first + total - 1</tt> and the size of this range as
+	 * AudioSize. Readers that can seek do not decode the samples before
+	 * the range.
+	 *
+	 * \param[in] filename The filename of the file to process
+	 * \param[in] first    Index of the first PCM 32 bit sample to process
+	 * \param[in] total    Total number of PCM 32 bit samples to process
+	 *
+	 * \throw FileReadException If the file could not be read
+	 */
+	void process_range(const std::string& filename, const int64_t first,
+			const int64_t total);
+
+	/**
+	 * \brief Open a file for pulling its samples by next_block().
+	 *
+	 * While the file is open, the attached SampleProcessor does not receive
+	 * any samples.
+	 *
+	 * \param[in] filename The filename of the file to read
+	 *
+	 * \throw FileReadException If the file could not be read
+	 * \throw std::logic_error  If a file is already open
+	 */
+	void open(const std::string& filename);
+
+	/**
+	 * \brief Read the next block of samples from the open file.
+	 *
+	 * The samples of the returned block remain valid until the next call of
+	 * next_block() or close(). An empty block signals the end of the file.
+	 *
+	 * \return The next block of samples, empty at the end of the file
+	 *
+	 * \throw FileReadException If the file could not be read
+	 * \throw std::logic_error  If no file is open
+	 */
+	SampleBlock next_block();
+
+	/**
+	 * \brief Size of the open file as reported by the reader.
+	 *
+	 * Readers report the size before the first block, but some readers can
+	 * only report it after the last block was decoded.
+	 *
+	 * \return Size of the open file, zero() if not known
+	 */
+	AudioSize input_size() const;
+
+	/**
+	 * \brief Close the file opened by open().
+	 *
+	 * The file may be closed before its end is reached. Closing an instance
+	 * without an open file has no effect.
+	 */
+	void close();
+
+	/**
+	 * \brief Statistics about the last call of process_file() or
+	 * process_range().
+	 *
+	 * \return Statistics about the last input processed
+	 */
+	const ReaderStatistics& statistics() const;
+
+	/**
+	 * \brief Enable or disable measuring the times and bytes read.
+	 *
+	 * Measuring requires to read the clock for each block and the I/O
+	 * counters of the thread for each input, thus it is disabled by default.
+	 * If disabled, the statistics() only count blocks and samples.
+	 *
+	 * \param[in] enabled TRUE iff times and bytes read are to be measured
+	 */
+	void set_statistics_enabled(const bool enabled);
+
+	/**
+	 * \brief TRUE iff the times and bytes read are measured.
+	 *
+	 * \return TRUE iff times and bytes read are measured
+	 */
+	bool statistics_enabled() const;
+
 private:
 
 	class Impl;
@@ -332,6 +802,8 @@ private:
 	std::unique_ptr<AudioReader::Impl> impl_;
 
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
+
+	bool do_reset() final;
 };
 
 
@@ -483,6 +955,11 @@ public:
 	 */
 	void error(const std::string& msg);
 
+	/**
+	 * \brief Clear the internal error list.
+	 */
+	void clear_errors();
+
 	/**
 	 * \brief Returns the last error that occurred.
 	 *
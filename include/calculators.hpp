@@ -7,9 +7,13 @@
  * \brief Calculate AccurateRip Checksums and IDs.
  */
 
+#ifndef __LIBARCSDEC_AUDIOREADER_HPP__
+#include "audioreader.hpp"         // for ReaderStatistics
+#endif
 #ifndef __LIBARCSDEC_SELECTION_HPP__
 #include "selection.hpp"           // for CreateReader, FileReaders, FormatList,
-#endif                             // FileReaderSelector
+#endif                             // FileReaderSelector,
+                                   // ReaderThroughput, ReaderPool
 
 #ifndef __LIBARCSTK_CALCULATE_HPP__
 #include <arcstk/calculate.hpp>    // for Checksums, ChecksumSet,...
@@ -21,9 +25,17 @@
 #include <arcstk/metadata.hpp>     // for ToC
 #endif
 
-#include <memory>   // for unique_ptr
+#include <atomic>   // for atomic
+#include <cstddef>  // for size_t
+#include <cstdint>  // for int64_t, uint64_t
+#include <functional> // for function
+#include <future>   // for future
+#include <iosfwd>   // for istream, ostream
+#include <memory>   // for unique_ptr, shared_ptr, make_unique
+#include <stdexcept> // for runtime_error
 #include <string>   // for string
-#include <utility>  // for pair
+#include <tuple>    // for tuple
+#include <utility>  // for pair, swap
 #include <vector>   // for vector
 
 
@@ -102,9 +114,9 @@ const FileReaderSelection* default_selection();
 
 // Deactivate -Weffc++ for the following two classes
 //
-// -Weffc++ will warn about ReaderAndFormatHolder and SelectionPerformer
-// not having declared copy constructor and copy assignment operator although
-// they have pointer type members. But this is intended + exactly what we want.
+// -Weffc++ will warn about ReaderAndFormatHolder not having declared copy
+// constructor and copy assignment operator although it has pointer type
+// members. But this is intended + exactly what we want.
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Weffc++"
 
@@ -159,6 +171,16 @@ public:
 	 */
 	const FileReaders* readers() const;
 
+	/**
+	 * \brief Identifier of the current formats and readers.
+	 *
+	 * The identifier changes whenever set_formats() or set_readers() is
+	 * called.
+	 *
+	 * \return Identifier of the current formats and readers
+	 */
+	uint64_t configuration_id() const;
+
 private:
 
 	/**
@@ -171,6 +193,11 @@ private:
 	 * \link FileReaderDescriptor FileReaderDescriptors\endlink
 	 */
 	const FileReaders* descriptors_;
+
+	/**
+	 * \brief Identifier of formats_ and descriptors_.
+	 */
+	uint64_t configuration_id_;
 };
 
 
@@ -191,8 +218,11 @@ public:
 	 * \param[in] selection The selection to use
 	 */
 	explicit SelectionPerformer(const FileReaderSelection* selection)
-		: selection_ { selection }
-		, create_    { /* default */ }
+		: selection_    { selection }
+		, selection_id_ { details::next_configuration_id() }
+		, create_       { /* default */ }
+		, cache_        { std::make_unique<details::SelectionCache>() }
+		, pool_         { std::make_unique<details::ReaderPool<ReaderType>>() }
 	{
 		/* empty */
 	}
@@ -208,6 +238,91 @@ public:
 		/* empty */
 	}
 
+	/**
+	 * \brief Copy constructor.
+	 *
+	 * The copy uses the same selection but has its own selection decisions
+	 * and its own idle readers.
+	 *
+	 * \param[in] rhs Instance to copy
+	 */
+	SelectionPerformer(const SelectionPerformer& rhs)
+		: selection_    { rhs.selection_ }
+		, selection_id_ { rhs.selection_id_ }
+		, create_       { rhs.create_ }
+		, cache_        { std::make_unique<details::SelectionCache>() }
+		, pool_         { std::make_unique<details::ReaderPool<ReaderType>>() }
+	{
+		/* empty */
+	}
+
+	/**
+	 * \brief Copy assignment.
+	 *
+	 * Forgets all selection decisions and idle readers of this instance.
+	 *
+	 * \param[in] rhs Instance to copy
+	 *
+	 * \return This instance
+	 */
+	SelectionPerformer& operator=(const SelectionPerformer& rhs)
+	{
+		if (this != &rhs)
+		{
+			selection_    = rhs.selection_;
+			selection_id_ = rhs.selection_id_;
+			create_       = rhs.create_;
+			cache_ = std::make_unique<details::SelectionCache>();
+			pool_  = std::make_unique<details::ReaderPool<ReaderType>>();
+		}
+
+		return *this;
+	}
+
+	/**
+	 * \brief Move constructor.
+	 *
+	 * The instance takes the selection decisions and idle readers of
+	 * \c rhs. The moved-from instance gets empty ones and remains usable.
+	 *
+	 * \param[in] rhs Instance to move
+	 */
+	SelectionPerformer(SelectionPerformer&& rhs)
+		: selection_    { rhs.selection_ }
+		, selection_id_ { rhs.selection_id_ }
+		, create_       { rhs.create_ }
+		, cache_        { std::make_unique<details::SelectionCache>() }
+		, pool_         { std::make_unique<details::ReaderPool<ReaderType>>() }
+	{
+		using std::swap;
+
+		swap(cache_, rhs.cache_);
+		swap(pool_,  rhs.pool_);
+	}
+
+	/**
+	 * \brief Move assignment.
+	 *
+	 * Exchanges the selection decisions and idle readers with \c rhs, thus
+	 * the moved-from instance remains usable.
+	 *
+	 * \param[in] rhs Instance to move
+	 *
+	 * \return This instance
+	 */
+	SelectionPerformer& operator=(SelectionPerformer&& rhs) noexcept
+	{
+		using std::swap;
+
+		swap(selection_,    rhs.selection_);
+		swap(selection_id_, rhs.selection_id_);
+		swap(create_,       rhs.create_);
+		swap(cache_,        rhs.cache_);
+		swap(pool_,         rhs.pool_);
+
+		return *this;
+	}
+
 	/**
 	 * \brief Virtual default destructor.
 	 */
@@ -216,11 +331,37 @@ public:
 	/**
 	 * \brief Set the selection to be used for selecting AudioReaders.
 	 *
+	 * All selection decisions made with the previous selection are
+	 * forgotten and all idle readers are destroyed.
+	 *
 	 * \param[in] selection Selection for AudioReaders
 	 */
 	void set_selection(const FileReaderSelection* selection)
 	{
-		selection_ = selection;
+		selection_    = selection;
+		selection_id_ = details::next_configuration_id();
+		cache_->clear();
+		pool_->clear();
+	}
+
+	/**
+	 * \brief Forget all remembered selection decisions.
+	 *
+	 * Selection decisions are remembered per pair of Format and Codec. If the
+	 * selection in use is modified, this must be called to let the
+	 * modification take effect.
+	 */
+	void clear_selection_cache()
+	{
+		cache_->clear();
+	}
+
+	/**
+	 * \brief Destroy all idle readers kept for reuse.
+	 */
+	void clear_reader_pool()
+	{
+		pool_->clear();
 	}
 
 	/**
@@ -244,8 +385,28 @@ public:
 	std::unique_ptr<ReaderType> file_reader(const std::string& filename,
 			const ReaderAndFormatHolder* f) const
 	{
+		if (cache_->configure(details::SelectionConfiguration { selection_id_,
+				f->configuration_id(), selection()->revision() }))
+		{
+			pool_->clear();
+		}
+
 		return this->create_(filename, *this->selection(), *f->formats(),
-				*f->readers());
+				*f->readers(), *cache_, *pool_);
+	}
+
+	/**
+	 * \brief Keep a FileReader that completed its file for reuse.
+	 *
+	 * The reader may be returned by a subsequent call of file_reader() for a
+	 * file with the same Format and Codec. Readers that threw while reading
+	 * must not be passed.
+	 *
+	 * \param[in] reader The reader to keep for reuse
+	 */
+	void recycle_reader(std::unique_ptr<ReaderType> reader) const
+	{
+		pool_->put(std::move(reader));
 	}
 
 private:
@@ -255,10 +416,25 @@ private:
 	 */
 	const FileReaderSelection* selection_;
 
+	/**
+	 * \brief Identifier of selection_.
+	 */
+	uint64_t selection_id_;
+
 	/**
 	 * \brief Internal FileReader creator.
 	 */
 	details::CreateReader<ReaderType> create_;
+
+	/**
+	 * \brief Remembered selection decisions.
+	 */
+	std::unique_ptr<details::SelectionCache> cache_;
+
+	/**
+	 * \brief Idle readers for reuse.
+	 */
+	std::unique_ptr<details::ReaderPool<ReaderType>> pool_;
 };
 
 
@@ -289,6 +465,16 @@ protected:
 	{
 		return this->file_reader(filename, this);
 	}
+
+	/**
+	 * \brief Keep a FileReader created by create() for reuse.
+	 *
+	 * \param[in] reader A reader that completed its file without error
+	 */
+	void recycle(std::unique_ptr<ReaderType> reader) const
+	{
+		this->recycle_reader(std::move(reader));
+	}
 };
 
 
@@ -312,216 +498,1020 @@ public:
 
 
 /**
- * \brief Format-independent parser for CD ToC metadata files.
+ * \brief Measures the throughput of all applicable AudioReaders.
+ *
+ * Every available AudioReader that can read the input file reads it
+ * completely once. The ReaderStatistics of each run are recorded in a
+ * ReaderThroughput and can thereby be used by a ThroughputPreference.
+ *
+ * The statistics of other runs, e.g. ARCSCalculator::statistics(), can be
+ * recorded in the same ReaderThroughput by ReaderThroughput::record().
  */
-class ToCParser final : public FileReaderProvider<MetadataParser>
+class ThroughputCalibration final : public ReaderAndFormatHolder
 {
 public:
 
 	/**
-	 * \brief Parse the metadata file to a ToC object.
+	 * \brief Measure the throughput of each applicable reader on a file.
 	 *
-	 * \param[in] metafilename Name of the metadatafile
+	 * Readers that fail to read the file are skipped.
 	 *
-	 * \return The parsed ToC
+	 * \param[in] filename   The audio file to read
+	 * \param[in] throughput The ReaderThroughput to record measurements in
+	 *
+	 * \throw FileReadException If the type of the file could not be determined
 	 */
-	std::unique_ptr<ToC> parse(const std::string& metafilename) const;
+	void calibrate(const std::string& filename, ReaderThroughput& throughput)
+		const;
 };
 
 
 /**
- * \brief Calculate ARCSs for input audio files.
- *
- * Note that ARCSCalculator does not perform any lookups in the filesystem. This
- * part is completely delegated to the \link FileReader FileReaders\endlink.
+ * \brief Format-independent parser for CD ToC metadata files.
  */
-class ARCSCalculator final : public FileReaderProvider<AudioReader>
+class ToCParser final : public FileReaderProvider<MetadataParser>
 {
 public:
 
 	/**
-	 * \brief Constructor
+	 * \brief Parse the metadata file to a ToC object.
 	 *
-	 * \param[in] type The Checksum type to calculate.
-	 */
-	explicit ARCSCalculator(const ChecksumtypeSet& type);
-
-	/**
-	 * \brief Constructor.
+	 * \param[in] metafilename Name of the metadatafile
 	 *
-	 * Uses ARCS1 and ARCS2 as default checksum types.
+	 * \return The parsed ToC
 	 */
-	ARCSCalculator();
+	std::unique_ptr<ToC> parse(const std::string& metafilename) const;
 
 	/**
-	 * \brief Calculate ARCS values for an audio file, using the given ToC.
-	 *
-	 * The ToC is supposed to contain the offsets of all tracks represented
-	 * in the audio file. It is not required to be <tt>complete()</tt>.
+	 * \brief Parse metadata in memory to a ToC object.
 	 *
-	 * Any audio file names in the ToC are ignored in favor of \c audiofilename.
+	 * Since there is no filename, the format of the metadata must be
+	 * specified. The memory is not copied and must remain valid until
+	 * parsing is completed.
 	 *
-	 * The result will contain ARCS v1 and v2 for all tracks specified in the
-	 * ToC. A version of the ToC is returned that is ensured to be complete.
+	 * \param[in] data   Start of the metadata
+	 * \param[in] size   Size of the metadata in bytes
+	 * \param[in] format Format of the metadata, e.g. Format::CUE
 	 *
-	 * \param[in] audiofilename Name of the audiofile
-	 * \param[in] toc           Offsets for the audiofile
+	 * \return The parsed ToC
 	 *
-	 * \return AccurateRip checksums of all tracks in the Toc and completed ToC
+	 * \throw InputFormatException If no parser for \c format is available
 	 */
-	std::pair<Checksums, ToC> calculate(const std::string& audiofilename,
-			const ToC& toc);
+	std::unique_ptr<ToC> parse(const char* data, const std::size_t size,
+			const Format format) const;
 
 	/**
-	 * \brief Calculate ARCSs for audio files.
-	 *
-	 * It can be specified that the sequence of audiofiles forms an album by
-	 * passing <tt>TRUE</tt> for both boolean parameters.
+	 * \brief Parse many metadata files in parallel.
 	 *
-	 * The ARCSs in the result will have the same order as the input files,
-	 * so for any index <tt>i: 0 <= i < audiofilenames.size()</tt>,
-	 * \c result[i] will be the result for <tt>audiofilenames[i]</tt>. The
-	 * result will have the same size as audiofilenames.
+	 * The files are distributed over \c threads threads. Each thread reuses
+	 * its parsers for subsequent files, which avoids to set up a new parser for
+	 * each file.
 	 *
-	 * Note that in this use case, it is not offered to compute the ARId of the
-	 * album since the exact offsets are missing.
+	 * A file that could not be parsed is logged and yields a nullptr. This
+	 * lets a single broken file not abort a large batch.
 	 *
-	 * \param[in] audiofilenames            Names of the audiofiles
-	 * \param[in] first_file_is_first_track Process first file as first track
-	 * \param[in] last_file_is_last_track   Process last file as last track
+	 * \param[in] metafilenames Names of the metadata files
+	 * \param[in] threads       Number of threads, 0 for hardware concurrency
 	 *
-	 * \return AccurateRip checksums of the input files
+	 * \return The parsed ToCs in the order of \c metafilenames
 	 */
-	Checksums calculate(const std::vector<std::string>& audiofilenames,
-			const bool first_file_is_first_track,
-			const bool last_file_is_last_track);
+	std::vector<std::unique_ptr<ToC>> parse_all(
+			const std::vector<std::string>& metafilenames,
+			const unsigned threads = 0) const;
+};
 
-	/**
-	 * \brief Calculate a single ARCS for an audio file.
-	 *
-	 * The flags \c is_first_track and \c is_last_track control whether the
-	 * track is processed as first or last track of an album. Since the
-	 * AccurateRip algorithms process the first and last file in a special way,
-	 * it is required to flag them accordingly.
-	 *
-	 * \param[in] audiofilename     Name of the audiofile
-	 * \param[in] is_first_track    Iff TRUE, file is treated as first track
-	 * \param[in] is_last_track     Iff TRUE, file is treated as last track
-	 *
-	 * \return The AccurateRip checksum of this track
-	 */
-	ChecksumSet calculate(const std::string& audiofilename,
-		const bool is_first_track, const bool is_last_track);
-	// NOTE This is not really useful except for testing
 
-	/**
-	 * \brief Calculate Checksums of a single audiofile.
-	 *
-	 * If \c leadout is zero() the leadout will be updated from reading it from
-	 * the audiofile, otherwise the returned leadout will just be identical to
-	 * the leadout passed.
-	 *
-	 * \param[in] audiofilename Name of audio file to process
-	 * \param[in] settings      Settings for calculations
-	 * \param[in] types         Requested checksum types
-	 * \param[in] leadout       Leadout
-	 * \param[in] offsets       Offsets
-	 *
-	 * \return Calculated checksums and updated Leadout
-	 */
-	std::pair<Checksums, AudioSize> calculate(const std::string& audiofilename,
-			const Settings& settings, const ChecksumtypeSet& types,
-			const AudioSize& leadout, const Points& offsets);
+/**
+ * \brief Function to call with the checksums of a completed track.
+ *
+ * The first parameter is the number of the track, starting with 1. The
+ * second parameter holds the checksums of this track.
+ */
+using TrackCallback = std::function<void(const int track,
+		const ChecksumSet& checksums)>;
+
+
+/**
+ * \brief Function to call with the progress of a calculation.
+ *
+ * The first parameter is the number of samples processed so far. The second
+ * parameter is the size of the input currently read, which is zero() as long
+ * as it is not known.
+ */
+using ProgressCallback = std::function<void(const int64_t samples_processed,
+		const AudioSize& total)>;
+
+
+/**
+ * \brief Function to call with the statistics of each audio input read.
+ */
+using StatisticsCallback = std::function<void(
+		const ReaderStatistics& statistics)>;
 
-	/**
-	 * \brief Return checksum::types calculated by this instance.
-	 *
-	 * \return The set of checksum::types to calculate
-	 */
-	ChecksumtypeSet types() const;
+
+/**
+ * \brief Token for cancelling a calculation from another thread.
+ *
+ * Copies of a Cancellation share their state. The caller keeps a copy and
+ * passes another one to the calculation. After cancel() is called on any copy,
+ * the calculation stops before the next block of samples is processed and
+ * throws CalculationCancelled.
+ */
+class Cancellation final
+{
+public:
 
 	/**
-	 * \brief Set checksum::type for the instance to calculate.
+	 * \brief Constructor.
 	 *
-	 * \param[in] type The checksum::type to calculate
+	 * Creates a token that is not cancelled.
 	 */
-	void set_types(const ChecksumtypeSet& type);
+	Cancellation();
 
 	/**
-	 * \brief Size of the read buffer.
-	 *
-	 * \return Preferred size of the read buffer
+	 * \brief Request the cancellation of all calculations using this token.
 	 */
-	int64_t read_buffer_size() const;
+	void cancel();
 
 	/**
-	 * \brief Set the preferred size of the read buffer.
-	 *
-	 * This determines the number of samples to read in one read operation.
-	 *
-	 * The Audioreader is not forced to respect it, but it is a strong hint.
+	 * \brief TRUE iff cancel() was called on this token or any copy of it.
 	 *
-	 * \param[in] total_samples Number of PCM 32 bit samples to read at once
+	 * \return TRUE iff the cancellation was requested
 	 */
-	void set_read_buffer_size(const int64_t total_samples); // TODO AudioSize?
+	bool cancelled() const;
 
 private:
 
 	/**
-	 * \brief Convert the flags for first and last track to a Context.
-	 *
-	 * \param[in] first_file_is_first_track Treat first file as track 1
-	 * \param[in] last_file_is_last_track   Treat last file as last track
-	 *
-	 * \return Context equivalent to the input flags
+	 * \brief Flag shared by all copies.
 	 */
-	arcstk::Context to_context(
-		const bool first_file_is_first_track,
-		const bool last_file_is_last_track) const;
+	std::shared_ptr<std::atomic<bool>> cancelled_;
+};
 
-	/**
-	 * \brief Internal checksum type.
-	 */
-	ChecksumtypeSet types_;
+
+/**
+ * \brief Reports that a calculation was cancelled.
+ */
+class CalculationCancelled final : public std::runtime_error
+{
+public:
 
 	/**
-	 * \brief Size of the read buffer (in number of samples).
+	 * \brief Constructor.
+	 *
+	 * \param[in] what_arg What argument
 	 */
-	int64_t read_buffer_size_;
+	explicit CalculationCancelled(const std::string& what_arg);
 };
 
 
 /**
- * \brief Calculate AccurateRip ID of an album.
+ * \brief Per-sector aggregates of the samples of an audio input.
  *
- * When instantiated, the default_selection() for AudioReaders is active. To
- * modify this behaviour, replace the default AudioInfo by a custom one.
+ * ARCSv1 of a track is the sum of its samples, each weighted by its 1-based
+ * position in the track. Since the weights are linear in the position, the
+ * sum for any track can be computed from prefix sums of the samples and of
+ * the samples weighted by their position in the input. A SectorIndex keeps
+ * both prefix sums for the end of each sector of 588 samples. Additionally,
+ * it keeps the last sample of each sector since the first track starts to
+ * be summed one sample before a sector boundary.
+ *
+ * With a SectorIndex of an input, ARCSv1 for any ToC whose offsets are at
+ * sector boundaries can be computed in O(tracks) without reading the input
+ * again, e.g. for a corrected cue sheet. ARCSv2 sums the upper and lower
+ * half of each 64 bit product separately and cannot be decomposed this way.
+ *
+ * The index requires 12 bytes per sector, i.e. about 4 MiB for 80 minutes of
+ * audio. It can be stored by write() and restored by the constructor that
+ * reads from a stream.
  */
-class ARIdCalculator final : public FileReaderProvider<MetadataParser>
+class SectorIndex final
 {
 public:
 
 	/**
 	 * \brief Constructor.
+	 *
+	 * Creates an empty index.
 	 */
-	ARIdCalculator();
+	SectorIndex();
 
 	/**
-	 * \brief Calculate ARId using the specified metadata and audio file.
+	 * \brief Constructor.
 	 *
-	 * \param[in] metafilename  Name of the metadata file
-	 * \param[in] audiofilename Name of the audiofile
+	 * Reads an index that was written by write().
 	 *
-	 * \return The AccurateRip id for this medium
+	 * \param[in] in Stream to read the index from
+	 *
+	 * \throw std::runtime_error If \c in does not contain a valid index
 	 */
-	std::unique_ptr<ARId> calculate(const std::string& metafilename,
-			const std::string& audiofilename) const;
+	explicit SectorIndex(std::istream& in);
 
 	/**
-	 * \brief Calculate ARId from ToC while taking leadout from audio file.
-	 *
-	 * Iff the ToC is complete(), the audiofilename parameter is completely
-	 * ignored.
+	 * \brief Add samples to the index.
+	 *
+	 * \param[in] begin Iterator pointing to the first sample
+	 * \param[in] end   Iterator pointing behind the last sample
+	 */
+	void append(SampleInputIterator begin, SampleInputIterator end);
+
+	/**
+	 * \brief Remove all samples from the index.
+	 */
+	void clear();
+
+	/**
+	 * \brief Number of PCM 32 bit samples in the index.
+	 *
+	 * \return Number of samples added
+	 */
+	int64_t total_samples() const noexcept;
+
+	/**
+	 * \brief TRUE iff ARCSv1 for \c toc can be computed from this index.
+	 *
+	 * This requires the offsets to be at sector boundaries and the tracks to
+	 * be within the samples of the index. If \c toc has no leadout, the end
+	 * of the index is used as leadout.
+	 *
+	 * \param[in] toc ToC to check
+	 *
+	 * \return TRUE iff arcs1() accepts \c toc
+	 */
+	bool covers(const ToC& toc) const;
+
+	/**
+	 * \brief Compute ARCSv1 of each track in \c toc.
+	 *
+	 * The first and the last track are processed as first and last track of
+	 * an album.
+	 *
+	 * \param[in] toc ToC to compute the checksums for
+	 *
+	 * \return ARCSv1 of each track in \c toc
+	 *
+	 * \throw std::invalid_argument If the index does not cover \c toc
+	 */
+	Checksums arcs1(const ToC& toc) const;
+
+	/**
+	 * \brief Write the index to a stream in a binary format.
+	 *
+	 * \param[in] out Stream to write the index to
+	 */
+	void write(std::ostream& out) const;
+
+private:
+
+	/**
+	 * \brief Prefix sums of the samples before \c sample.
+	 *
+	 * \param[in] sample Index of a sample at a sector boundary, one before a
+	 *                   sector boundary or at the end of the index
+	 *
+	 * \return Sum of the samples and sum of the weighted samples
+	 *
+	 * \throw std::invalid_argument If \c sample is not supported
+	 */
+	std::pair<uint32_t, uint32_t> prefix(const int64_t sample) const;
+
+	/**
+	 * \brief TRUE iff prefix() accepts \c sample.
+	 *
+	 * \param[in] sample Index of a sample
+	 *
+	 * \return TRUE iff prefix() accepts \c sample
+	 */
+	bool supported(const int64_t sample) const noexcept;
+
+	/**
+	 * \brief Prefix sums and last sample of each complete sector.
+	 */
+	std::vector<uint32_t> sectors_;
+
+	/**
+	 * \brief Sum of all samples.
+	 */
+	uint32_t sum_;
+
+	/**
+	 * \brief Sum of all samples, weighted by their 1-based position.
+	 */
+	uint32_t weighted_sum_;
+
+	/**
+	 * \brief Number of samples.
+	 */
+	int64_t total_samples_;
+};
+
+
+/**
+ * \brief Checksums of audio files, recognized by their content.
+ *
+ * Libraries often contain several copies of the same audio data, e.g. hard
+ * links to the same file or FLAC files that only differ in their tags. A
+ * ChecksumCache remembers the checksums calculated for an audio file and
+ * returns them for any file that is known to have the same audio content
+ * without decoding it.
+ *
+ * A file is recognized
+ * <ul>
+ *   <li>by device and inode, together with size and modification time, which
+ *       identifies hard links to the same file, and</li>
+ *   <li>if it is a FLAC file, by the MD5 of the decoded samples and the
+ *       total number of samples in its STREAMINFO block, together with the
+ *       sample format.</li>
+ * </ul>
+ *
+ * Checksums are only returned for the same Context, the same checksum types
+ * and the same offsets they were calculated for. A leadout is only required
+ * to match if it is passed.
+ *
+ * FLAC files without an MD5 in STREAMINFO are only recognized by inode.
+ *
+ * The instance is safe to be used from concurrent threads.
+ */
+class ChecksumCache final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	ChecksumCache();
+
+	/**
+	 * \brief Destructor.
+	 */
+	~ChecksumCache() noexcept;
+
+	ChecksumCache(const ChecksumCache&) = delete;
+	ChecksumCache& operator=(const ChecksumCache&) = delete;
+
+	/**
+	 * \brief Find the checksums of an audio file with the same content.
+	 *
+	 * \param[in] audiofilename Name of the audio file
+	 * \param[in] context       Context of the calculation
+	 * \param[in] types         Checksum types to calculate
+	 * \param[in] leadout       Leadout of the input, may be zero
+	 * \param[in] offsets       Offsets of the input, may be empty
+	 *
+	 * \return Checksums and leadout or nullptr if the content is unknown
+	 */
+	std::unique_ptr<std::pair<Checksums, AudioSize>> find(
+			const std::string& audiofilename,
+			const arcstk::Context context, const ChecksumtypeSet& types,
+			const AudioSize& leadout, const Points& offsets) const;
+
+	/**
+	 * \brief Remember the checksums calculated for an audio file.
+	 *
+	 * \param[in] audiofilename Name of the audio file
+	 * \param[in] context       Context of the calculation
+	 * \param[in] types         Checksum types calculated
+	 * \param[in] offsets       Offsets of the input, may be empty
+	 * \param[in] result        Checksums and leadout calculated
+	 */
+	void insert(const std::string& audiofilename,
+			const arcstk::Context context, const ChecksumtypeSet& types,
+			const Points& offsets,
+			const std::pair<Checksums, AudioSize>& result);
+
+	/**
+	 * \brief Number of calculations returned by find().
+	 *
+	 * \return Number of successful lookups
+	 */
+	int64_t hits() const;
+
+	/**
+	 * \brief Number of calculations remembered.
+	 *
+	 * \return Number of calculations remembered
+	 */
+	std::size_t size() const;
+
+	/**
+	 * \brief Forget all calculations.
+	 */
+	void clear();
+
+private:
+
+	class Impl;
+
+	/**
+	 * \brief Private implementation.
+	 */
+	std::unique_ptr<Impl> impl_;
+};
+
+
+// Deactivate -Weffc++ for the following class
+//
+// -Weffc++ will warn about ARCSCalculator not having declared copy constructor
+// and copy assignment operator although it has pointer type members. But this
+// is intended: a copy records to the same SectorIndex and uses the same
+// ChecksumCache as the original.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+
+/**
+ * \brief Calculate ARCSs for input audio files.
+ *
+ * Note that ARCSCalculator does not perform any lookups in the filesystem. This
+ * part is completely delegated to the \link FileReader FileReaders\endlink.
+ */
+class ARCSCalculator final : public FileReaderProvider<AudioReader>
+{
+public:
+
+	/**
+	 * \brief Constructor
+	 *
+	 * \param[in] type The Checksum type to calculate.
+	 */
+	explicit ARCSCalculator(const ChecksumtypeSet& type);
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * Uses ARCS1 and ARCS2 as default checksum types.
+	 */
+	ARCSCalculator();
+
+	/**
+	 * \brief Calculate ARCS values for an audio file, using the given ToC.
+	 *
+	 * The ToC is supposed to contain the offsets of all tracks represented
+	 * in the audio file. It is not required to be <tt>complete()</tt>.
+	 *
+	 * Any audio file names in the ToC are ignored in favor of \c audiofilename.
+	 *
+	 * The result will contain ARCS v1 and v2 for all tracks specified in the
+	 * ToC. A version of the ToC is returned that is ensured to be complete.
+	 *
+	 * The audio file is opened only once. If the ToC has no leadout, the
+	 * leadout is taken from the size the AudioReader reports while reading.
+	 *
+	 * \param[in] audiofilename Name of the audiofile
+	 * \param[in] toc           Offsets for the audiofile
+	 *
+	 * \return AccurateRip checksums of all tracks in the Toc and completed ToC
+	 *
+	 * \throw std::runtime_error If the AudioReader did not report a size
+	 */
+	std::pair<Checksums, ToC> calculate(const std::string& audiofilename,
+			const ToC& toc);
+
+	/**
+	 * \brief Calculate ARCS values for an audio file by its SectorIndex.
+	 *
+	 * If only ARCS1 is requested and \c index covers() the ToC, the checksums
+	 * are computed from \c index without reading the audio file. Otherwise,
+	 * this is equivalent to calculate(const std::string&, const ToC&).
+	 *
+	 * This makes recalculating ARCSv1 for a corrected ToC cheap if the index
+	 * was recorded while the audio file was read before, see
+	 * set_sector_index().
+	 *
+	 * \param[in] audiofilename Name of the audiofile, read if required
+	 * \param[in] toc           Offsets for the audiofile
+	 * \param[in] index         SectorIndex of the audiofile
+	 *
+	 * \return AccurateRip checksums of all tracks in the Toc and completed ToC
+	 *
+	 * \throw std::runtime_error If the AudioReader did not report a size
+	 */
+	std::pair<Checksums, ToC> calculate(const std::string& audiofilename,
+			const ToC& toc, const SectorIndex& index);
+
+	/**
+	 * \brief Calculate ARCS values for a ToC that spans several audio files.
+	 *
+	 * The audio files are read one after another and form a single gapless
+	 * stream of samples. The offsets of the ToC refer to this stream, thus
+	 * the track boundaries are not required to coincide with the file
+	 * boundaries. While a file is read, the next file is prefetched.
+	 *
+	 * The offsets are not adjusted by the lengths of the files. A ToC whose
+	 * offsets are relative to each file, as in a cue sheet with a FILE
+	 * statement per track, must be converted by the caller by adding the
+	 * lengths of all preceding files. Note that the CueSheet parser does
+	 * not accept a FILE statement after the first TRACK statement.
+	 *
+	 * If the ToC is not <tt>complete()</tt>, the size of each audio file is
+	 * acquired in advance. A version of the ToC is returned that is ensured
+	 * to be complete.
+	 *
+	 * \param[in] audiofilenames Names of the audiofiles in stream order
+	 * \param[in] toc            Offsets for the concatenated audiofiles
+	 *
+	 * \return AccurateRip checksums of all tracks in the Toc and completed ToC
+	 *
+	 * \throw std::invalid_argument If \c audiofilenames is empty
+	 */
+	std::pair<Checksums, ToC> calculate(
+			const std::vector<std::string>& audiofilenames, const ToC& toc);
+
+	/**
+	 * \brief Calculate ARCS values for selected tracks of an audio file.
+	 *
+	 * Only the samples of the selected tracks are read. AudioReaders that can
+	 * seek skip the samples of all other tracks, which makes the cost of
+	 * the calculation depend on the selected tracks instead of the entire
+	 * file. Consecutive selected tracks are read in a single pass.
+	 *
+	 * The ToC is supposed to contain the offsets of all tracks represented
+	 * in the audio file. If the last track is selected and the ToC is not
+	 * <tt>complete()</tt>, the leadout is acquired from the audio file.
+	 *
+	 * The result contains a ChecksumSet for each track in \c tracks in the
+	 * order of \c tracks.
+	 *
+	 * \param[in] audiofilename Name of the audiofile
+	 * \param[in] toc           Offsets for the audiofile
+	 * \param[in] tracks        Numbers of the tracks to calculate, 1-based
+	 *
+	 * \return AccurateRip checksums of the selected tracks
+	 *
+	 * \throw std::invalid_argument If a track number is not in the ToC
+	 */
+	Checksums calculate(const std::string& audiofilename, const ToC& toc,
+			const std::vector<int>& tracks);
+
+	/**
+	 * \brief Calculate ARCSs for audio files.
+	 *
+	 * It can be specified that the sequence of audiofiles forms an album by
+	 * passing <tt>TRUE</tt> for both boolean parameters.
+	 *
+	 * The ARCSs in the result will have the same order as the input files,
+	 * so for any index <tt>i: 0 <= i < audiofilenames.size()</tt>,
+	 * \c result[i] will be the result for <tt>audiofilenames[i]</tt>. The
+	 * result will have the same size as audiofilenames.
+	 *
+	 * Note that in this use case, it is not offered to compute the ARId of the
+	 * album since the exact offsets are missing.
+	 *
+	 * While a file is processed, the reader for the next file is already
+	 * selected and the next file is prefetched in the background.
+	 *
+	 * \param[in] audiofilenames            Names of the audiofiles
+	 * \param[in] first_file_is_first_track Process first file as first track
+	 * \param[in] last_file_is_last_track   Process last file as last track
+	 *
+	 * \return AccurateRip checksums of the input files
+	 */
+	Checksums calculate(const std::vector<std::string>& audiofilenames,
+			const bool first_file_is_first_track,
+			const bool last_file_is_last_track);
+
+	/**
+	 * \brief Calculate a single ARCS for an audio file.
+	 *
+	 * The flags \c is_first_track and \c is_last_track control whether the
+	 * track is processed as first or last track of an album. Since the
+	 * AccurateRip algorithms process the first and last file in a special way,
+	 * it is required to flag them accordingly.
+	 *
+	 * \param[in] audiofilename     Name of the audiofile
+	 * \param[in] is_first_track    Iff TRUE, file is treated as first track
+	 * \param[in] is_last_track     Iff TRUE, file is treated as last track
+	 *
+	 * \return The AccurateRip checksum of this track
+	 */
+	ChecksumSet calculate(const std::string& audiofilename,
+		const bool is_first_track, const bool is_last_track);
+	// NOTE This is not really useful except for testing
+
+	/**
+	 * \brief Calculate Checksums of a single audiofile.
+	 *
+	 * If \c leadout is zero() the leadout will be updated from reading it from
+	 * the audiofile, otherwise the returned leadout will just be identical to
+	 * the leadout passed.
+	 *
+	 * \param[in] audiofilename Name of audio file to process
+	 * \param[in] settings      Settings for calculations
+	 * \param[in] types         Requested checksum types
+	 * \param[in] leadout       Leadout
+	 * \param[in] offsets       Offsets
+	 *
+	 * \return Calculated checksums and updated Leadout
+	 */
+	std::pair<Checksums, AudioSize> calculate(const std::string& audiofilename,
+			const Settings& settings, const ChecksumtypeSet& types,
+			const AudioSize& leadout, const Points& offsets);
+
+	/**
+	 * \brief Calculate ARCS values for an audio file in the background.
+	 *
+	 * Performs calculate(const std::string&, const ToC&) on a copy of this
+	 * instance in a separate thread. Callbacks are called on this thread.
+	 *
+	 * If \c cancellation is cancelled, the future will throw
+	 * CalculationCancelled.
+	 *
+	 * \note
+	 * As any future returned by std::async, the returned future waits in its
+	 * destructor until the calculation is finished. To abandon a calculation
+	 * without waiting for its end, cancel it before the future is destroyed.
+	 *
+	 * \param[in] audiofilename Name of the audiofile
+	 * \param[in] toc           Offsets for the audiofile
+	 * \param[in] cancellation  Token for cancelling the calculation
+	 *
+	 * \return Future for the checksums and the completed ToC
+	 */
+	std::future<std::pair<Checksums, ToC>> calculate_async(
+			const std::string& audiofilename, const ToC& toc,
+			const Cancellation& cancellation = Cancellation {}) const;
+
+	/**
+	 * \brief Calculate ARCS values for a ToC that spans several audio files in
+	 * the background.
+	 *
+	 * Performs calculate(const std::vector<std::string>&, const ToC&) on a
+	 * copy of this instance in a separate thread. Callbacks are called on
+	 * this thread. The returned future waits for the calculation when it is
+	 * destroyed, as described for calculate_async(const std::string&,
+	 * const ToC&, const Cancellation&) const.
+	 *
+	 * \param[in] audiofilenames Names of the audiofiles in stream order
+	 * \param[in] toc            Offsets for the concatenated audiofiles
+	 * \param[in] cancellation   Token for cancelling the calculation
+	 *
+	 * \return Future for the checksums and the completed ToC
+	 */
+	std::future<std::pair<Checksums, ToC>> calculate_async(
+			const std::vector<std::string>& audiofilenames, const ToC& toc,
+			const Cancellation& cancellation = Cancellation {}) const;
+
+	/**
+	 * \brief Calculate ARCSs for audio files in the background.
+	 *
+	 * Performs calculate(const std::vector<std::string>&, const bool,
+	 * const bool) on a copy of this instance in a separate thread. Callbacks
+	 * are called on this thread. The returned future waits for the
+	 * calculation when it is destroyed, as described for
+	 * calculate_async(const std::string&, const ToC&, const Cancellation&)
+	 * const.
+	 *
+	 * \param[in] audiofilenames            Names of the audiofiles
+	 * \param[in] first_file_is_first_track Process first file as first track
+	 * \param[in] last_file_is_last_track   Process last file as last track
+	 * \param[in] cancellation              Token for cancelling
+	 *
+	 * \return Future for the checksums of the input files
+	 */
+	std::future<Checksums> calculate_async(
+			const std::vector<std::string>& audiofilenames,
+			const bool first_file_is_first_track,
+			const bool last_file_is_last_track,
+			const Cancellation& cancellation = Cancellation {}) const;
+
+	/**
+	 * \brief Return checksum::types calculated by this instance.
+	 *
+	 * \return The set of checksum::types to calculate
+	 */
+	ChecksumtypeSet types() const;
+
+	/**
+	 * \brief Set checksum::type for the instance to calculate.
+	 *
+	 * \param[in] type The checksum::type to calculate
+	 */
+	void set_types(const ChecksumtypeSet& type);
+
+	/**
+	 * \brief Size of the read buffer.
+	 *
+	 * \return Preferred size of the read buffer
+	 */
+	int64_t read_buffer_size() const;
+
+	/**
+	 * \brief Set the preferred size of the read buffer.
+	 *
+	 * This determines the number of samples to read in one read operation.
+	 *
+	 * The Audioreader is not forced to respect it, but it is a strong hint.
+	 *
+	 * \param[in] total_samples Number of PCM 32 bit samples to read at once
+	 */
+	void set_read_buffer_size(const int64_t total_samples); // TODO AudioSize?
+
+	/**
+	 * \brief Function called with each track as soon as it is complete.
+	 *
+	 * \return The function to call with each completed track
+	 */
+	const TrackCallback& track_callback() const;
+
+	/**
+	 * \brief Set a function to call with each track as soon as it is complete.
+	 *
+	 * While the input is still read, the function is called with the
+	 * checksums of each track whose last sample has been processed. This lets
+	 * the caller present or match the checksums of a track without waiting
+	 * for the remaining tracks. The function is called in the order of the
+	 * tracks and on the thread that calls calculate().
+	 *
+	 * An empty function disables the callback, which is the default.
+	 *
+	 * \param[in] callback The function to call with each completed track
+	 */
+	void set_track_callback(const TrackCallback& callback);
+
+	/**
+	 * \brief Function called with the progress of the calculation.
+	 *
+	 * \return The function to call with the progress
+	 */
+	const ProgressCallback& progress_callback() const;
+
+	/**
+	 * \brief Set a function to call with the progress of the calculation.
+	 *
+	 * The function is called after each block of samples with the number of
+	 * samples processed and the size of the input. If a ToC spans several
+	 * audio files, the input is the entire stream, otherwise it is the audio
+	 * file currently read. The function is called on the thread that
+	 * calculates.
+	 *
+	 * An empty function disables the callback, which is the default.
+	 *
+	 * \param[in] callback The function to call with the progress
+	 */
+	void set_progress_callback(const ProgressCallback& callback);
+
+	/**
+	 * \brief Token for cancelling the calculations of this instance.
+	 *
+	 * \return Token for cancelling the calculations
+	 */
+	const Cancellation& cancellation() const;
+
+	/**
+	 * \brief Set the token for cancelling the calculations of this instance.
+	 *
+	 * The token is checked before each block of samples. If it is cancelled,
+	 * the calculation throws CalculationCancelled. Since a block is the unit
+	 * of reading, a cancellation takes effect as soon as the pending read
+	 * operation returns.
+	 *
+	 * \param[in] cancellation Token for cancelling the calculations
+	 */
+	void set_cancellation(const Cancellation& cancellation);
+
+	/**
+	 * \brief SectorIndex to record the input of a calculation in.
+	 *
+	 * \return SectorIndex to record the input in or nullptr
+	 */
+	SectorIndex* sector_index() const;
+
+	/**
+	 * \brief Set a SectorIndex to record the input of a calculation in.
+	 *
+	 * If set, each calculation for a ToC clears \c index and records its
+	 * entire input in it. The index is owned by the caller and must outlive
+	 * the calculations.
+	 *
+	 * Passing nullptr disables recording, which is the default.
+	 *
+	 * \param[in] index SectorIndex to record the input in or nullptr
+	 */
+	void set_sector_index(SectorIndex* index);
+
+	/**
+	 * \brief ChecksumCache to reuse the checksums of identical audio files.
+	 *
+	 * \return ChecksumCache to use or nullptr
+	 */
+	ChecksumCache* checksum_cache() const;
+
+	/**
+	 * \brief Set a ChecksumCache to reuse the checksums of identical audio
+	 * files.
+	 *
+	 * If set, calculations of entire audio files look up each file in
+	 * \c cache before reading it and add the result to \c cache afterwards.
+	 * Files found in \c cache are not read and have no statistics().
+	 * Calculations that record a SectorIndex, that calculate selected tracks
+	 * or a ToC over several files always read the files. The cache is owned
+	 * by the caller and must outlive the calculations.
+	 *
+	 * Passing nullptr disables the lookups, which is the default.
+	 *
+	 * \param[in] cache ChecksumCache to use or nullptr
+	 */
+	void set_checksum_cache(ChecksumCache* cache);
+
+	/**
+	 * \brief Statistics about the audio inputs read by the last calculation.
+	 *
+	 * Contains an entry for each read operation in the order of reading,
+	 * i.e. an entry for each audio file or, if selected tracks were
+	 * calculated, for each run of consecutive selected tracks. The times and
+	 * bytes read are only measured if statistics_enabled().
+	 *
+	 * The statistics of calculate_async() are kept by the copy that performs
+	 * the calculation. Use set_statistics_callback() to receive them.
+	 *
+	 * \return Statistics of each audio input read
+	 */
+	const std::vector<ReaderStatistics>& statistics() const;
+
+	/**
+	 * \brief Enable or disable measuring the times and bytes read.
+	 *
+	 * Disabled by default. The AudioReader of each input is configured
+	 * accordingly, see AudioReader::set_statistics_enabled().
+	 *
+	 * \param[in] enabled TRUE iff times and bytes read are to be measured
+	 */
+	void set_statistics_enabled(const bool enabled);
+
+	/**
+	 * \brief TRUE iff the times and bytes read are measured.
+	 *
+	 * \return TRUE iff times and bytes read are measured
+	 */
+	bool statistics_enabled() const;
+
+	/**
+	 * \brief Function called with the statistics of each audio input read.
+	 *
+	 * \return The function to call with the statistics
+	 */
+	const StatisticsCallback& statistics_callback() const;
+
+	/**
+	 * \brief Set a function to call with the statistics of each audio input
+	 * read.
+	 *
+	 * The function is called with each entry added to statistics(), on the
+	 * thread that calculates. Thereby, it also reports the statistics of
+	 * calculate_async().
+	 *
+	 * An empty function disables the callback, which is the default.
+	 *
+	 * \param[in] callback The function to call with the statistics
+	 */
+	void set_statistics_callback(const StatisticsCallback& callback);
+
+private:
+
+	/**
+	 * \brief Worker: calculate Checksums of an audiofile by a given reader.
+	 *
+	 * If \c leadout is zero(), the returned leadout is the size reported by
+	 * \c reader while reading, otherwise it is identical to \c leadout.
+	 *
+	 * \param[in] reader        AudioReader to read the audiofile
+	 * \param[in] audiofilename Name of audio file to process
+	 * \param[in] settings      Settings for calculations
+	 * \param[in] types         Requested checksum types
+	 * \param[in] leadout       Leadout, may be zero()
+	 * \param[in] offsets       Offsets
+	 * \param[in] first_track   Number of the track at the first offset
+	 * \param[in] first         Index of the first sample to process
+	 * \param[in] total         Samples to process, negative for entire file
+	 * \param[in] index         SectorIndex to record the input in or nullptr
+	 *
+	 * \return Calculated checksums and updated Leadout
+	 */
+	std::pair<Checksums, AudioSize> process(AudioReader& reader,
+			const std::string& audiofilename,
+			const Settings& settings, const ChecksumtypeSet& types,
+			const AudioSize& leadout, const Points& offsets,
+			const int first_track, const int64_t first, const int64_t total,
+			SectorIndex* index) const;
+
+	/**
+	 * \brief Prepare reading an audiofile in the background.
+	 *
+	 * Selects and creates the AudioReader for \c audiofilename while the
+	 * caller is still busy with the previous file. The operating system is
+	 * asked to read the file into its cache in advance.
+	 *
+	 * \param[in] audiofilename Name of the audiofile to prepare
+	 *
+	 * \return AudioReader for \c audiofilename when ready
+	 */
+	std::future<std::unique_ptr<AudioReader>> prefetch(
+			const std::string& audiofilename) const;
+
+	/**
+	 * \brief Add the statistics of the last input read by \c reader.
+	 *
+	 * \param[in] reader AudioReader that has read an input
+	 */
+	void record(const AudioReader& reader);
+
+	/**
+	 * \brief Convert the flags for first and last track to a Context.
+	 *
+	 * \param[in] first_file_is_first_track Treat first file as track 1
+	 * \param[in] last_file_is_last_track   Treat last file as last track
+	 *
+	 * \return Context equivalent to the input flags
+	 */
+	arcstk::Context to_context(
+		const bool first_file_is_first_track,
+		const bool last_file_is_last_track) const;
+
+	/**
+	 * \brief Internal checksum type.
+	 */
+	ChecksumtypeSet types_;
+
+	/**
+	 * \brief Size of the read buffer (in number of samples).
+	 */
+	int64_t read_buffer_size_;
+
+	/**
+	 * \brief Function to call with each completed track.
+	 */
+	TrackCallback track_callback_;
+
+	/**
+	 * \brief Function to call with the progress.
+	 */
+	ProgressCallback progress_callback_;
+
+	/**
+	 * \brief Token for cancelling the calculations.
+	 */
+	Cancellation cancellation_;
+
+	/**
+	 * \brief Statistics of the last calculation.
+	 */
+	std::vector<ReaderStatistics> statistics_;
+
+	/**
+	 * \brief TRUE iff times and bytes read are measured.
+	 */
+	bool statistics_enabled_;
+
+	/**
+	 * \brief Function to call with the statistics of each input.
+	 */
+	StatisticsCallback statistics_callback_;
+
+	/**
+	 * \brief SectorIndex to record the input in.
+	 */
+	SectorIndex* sector_index_;
+
+	/**
+	 * \brief ChecksumCache to use.
+	 */
+	ChecksumCache* checksum_cache_;
+};
+
+// Re-activate -Weffc++ for all what follows
+#pragma GCC diagnostic pop
+
+
+/**
+ * \brief Calculate AccurateRip ID of an album.
+ *
+ * When instantiated, the default_selection() for AudioReaders is active. To
+ * modify this behaviour, replace the default AudioInfo by a custom one.
+ */
+class ARIdCalculator final : public FileReaderProvider<MetadataParser>
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	ARIdCalculator();
+
+	/**
+	 * \brief Calculate ARId using the specified metadata and audio file.
+	 *
+	 * \param[in] metafilename  Name of the metadata file
+	 * \param[in] audiofilename Name of the audiofile
+	 *
+	 * \return The AccurateRip id for this medium
+	 */
+	std::unique_ptr<ARId> calculate(const std::string& metafilename,
+			const std::string& audiofilename) const;
+
+	/**
+	 * \brief Calculate ARId from ToC while taking leadout from audio file.
+	 *
+	 * Iff the ToC is complete(), the audiofilename parameter is completely
+	 * ignored.
 	 *
 	 * \param[in] toc           ToC of the audio data
 	 * \param[in] audiofilename Name of the audiofile
@@ -553,6 +1543,88 @@ private:
 	AudioInfo audio_;
 };
 
+
+/**
+ * \brief Calculate ARId, ToC and ARCSs of an album in a single pass.
+ *
+ * Parses the metadata file and reads the audio file exactly once. The leadout
+ * missing in the metadata is taken from the audio reader while it reads the
+ * samples, thus the audio file is neither probed nor opened a second time.
+ *
+ * The ToCParser and the ARCSCalculator used can be replaced to modify
+ * selection and calculation settings.
+ */
+class AlbumCalculator final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] types The checksum types to calculate
+	 */
+	explicit AlbumCalculator(const ChecksumtypeSet& types);
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * Uses ARCS1 and ARCS2 as default checksum types.
+	 */
+	AlbumCalculator();
+
+	/**
+	 * \brief Calculate ARId, ToC and ARCSs of an album.
+	 *
+	 * \param[in] metafilename  Name of the metadata file
+	 * \param[in] audiofilename Name of the audiofile
+	 *
+	 * \return AccurateRip id, completed ToC and checksums of all tracks
+	 */
+	std::tuple<std::unique_ptr<ARId>, ToC, Checksums> calculate(
+			const std::string& metafilename,
+			const std::string& audiofilename);
+
+	/**
+	 * \brief ToCParser used by this instance.
+	 *
+	 * \return ToCParser used by this instance
+	 */
+	const ToCParser* toc_parser() const;
+
+	/**
+	 * \brief Set the ToCParser used by this instance.
+	 *
+	 * \param[in] parser ToCParser to be used by this instance
+	 */
+	void set_toc_parser(const ToCParser& parser);
+
+	/**
+	 * \brief ARCSCalculator used by this instance.
+	 *
+	 * \return ARCSCalculator used by this instance
+	 */
+	const ARCSCalculator* arcs_calculator() const;
+
+	/**
+	 * \brief Set the ARCSCalculator used by this instance.
+	 *
+	 * \param[in] calculator ARCSCalculator to be used by this instance
+	 */
+	void set_arcs_calculator(const ARCSCalculator& calculator);
+
+private:
+
+	/**
+	 * \brief Internal parser for the metadata file.
+	 */
+	ToCParser parser_;
+
+	/**
+	 * \brief Internal calculator for the audio file.
+	 */
+	ARCSCalculator calculator_;
+};
+
 /// @}
 
 } // namespace v_1_0_0
@@ -0,0 +1,426 @@
+#ifndef __LIBARCSDEC_DBARINDEX_HPP__
+#define __LIBARCSDEC_DBARINDEX_HPP__
+
+/**
+ * \file
+ *
+ * \brief Local index of AccurateRip responses and matching against it.
+ */
+
+#ifndef __LIBARCSTK_CALCULATE_HPP__
+#include <arcstk/calculate.hpp>    // for Checksums, checksum::type
+#endif
+#ifndef __LIBARCSTK_IDENTIFIER_HPP__
+#include <arcstk/identifier.hpp>   // for ARId
+#endif
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint32_t
+#include <memory>   // for unique_ptr
+#include <string>   // for string
+#include <vector>   // for vector
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+using arcstk::ARId;
+using arcstk::Checksums;
+
+/**
+ * \defgroup dbarindex Local AccurateRip index
+ *
+ * \brief Match checksums against a local mirror of AccurateRip responses.
+ *
+ * AccurateRip responds to a query for an ARId with a dBAR file. A dBAR file
+ * contains a block for each pressing of the disc. Each block contains the
+ * ARId and, for each track, the confidence and the reference checksum. The
+ * reference checksum may be an ARCSv1 or an ARCSv2.
+ *
+ * A DBARIndex merges the blocks of many dBAR files in a single file that is
+ * memory mapped and sorted by ARId. An ARMatcher compares Checksums against
+ * the pressings in a DBARIndex without parsing any dBAR file again.
+ *
+ * @{
+ */
+
+/**
+ * \brief Reference checksums of all pressings of a disc in a DBARIndex.
+ *
+ * The values are stored column-wise, i.e. the values of all pressings for the
+ * same track are contiguous. A DBARResponse is a view on the memory of its
+ * DBARIndex and must not outlive it.
+ */
+class DBARResponse final
+{
+public:
+
+	/**
+	 * \brief Constructor for an empty response.
+	 */
+	DBARResponse();
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] tracks    Number of tracks
+	 * \param[in] pressings Number of pressings
+	 * \param[in] data      Checksums, confidences and frame 450 checksums
+	 */
+	DBARResponse(const int tracks, const int pressings, const uint32_t* data);
+
+	/**
+	 * \brief Number of tracks of the disc.
+	 *
+	 * \return Number of tracks
+	 */
+	int tracks() const noexcept;
+
+	/**
+	 * \brief Number of pressings of the disc.
+	 *
+	 * \return Number of pressings
+	 */
+	int pressings() const noexcept;
+
+	/**
+	 * \brief TRUE iff the response has no pressings.
+	 *
+	 * \return TRUE iff the disc is not in the index
+	 */
+	bool empty() const noexcept;
+
+	/**
+	 * \brief Reference checksums of all pressings for a track.
+	 *
+	 * \param[in] track 0-based index of the track
+	 *
+	 * \return Pointer to pressings() reference checksums
+	 */
+	const uint32_t* checksums(const int track) const noexcept;
+
+	/**
+	 * \brief Confidences of all pressings for a track.
+	 *
+	 * \param[in] track 0-based index of the track
+	 *
+	 * \return Pointer to pressings() confidences
+	 */
+	const uint32_t* confidences(const int track) const noexcept;
+
+	/**
+	 * \brief Checksums of frame 450 of all pressings for a track.
+	 *
+	 * \param[in] track 0-based index of the track
+	 *
+	 * \return Pointer to pressings() checksums of frame 450
+	 */
+	const uint32_t* frame450_checksums(const int track) const noexcept;
+
+private:
+
+	/**
+	 * \brief Number of tracks.
+	 */
+	int tracks_;
+
+	/**
+	 * \brief Number of pressings.
+	 */
+	int pressings_;
+
+	/**
+	 * \brief Values of the response.
+	 */
+	const uint32_t* data_;
+};
+
+
+/**
+ * \brief Memory mapped index of AccurateRip responses.
+ *
+ * The index file is created from a set of dBAR files by build(). It is
+ * written in the byte order of the host and must be rebuilt on a host with a
+ * different byte order.
+ *
+ * Since the index is read only, the instance is safe to be used from
+ * concurrent threads.
+ */
+class DBARIndex final
+{
+public:
+
+	/**
+	 * \brief Create an index file from dBAR files.
+	 *
+	 * Blocks for the same ARId in different dBAR files are merged. Identical
+	 * blocks, e.g. of a dBAR file passed twice, are stored only once.
+	 *
+	 * \param[in] dbar_files Names of the dBAR files
+	 * \param[in] filename   Name of the index file to write
+	 *
+	 * \throw std::runtime_error If a dBAR file cannot be read or is invalid
+	 */
+	static void build(const std::vector<std::string>& dbar_files,
+			const std::string& filename);
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * Maps the index file into memory.
+	 *
+	 * \param[in] filename Name of the index file
+	 *
+	 * \throw std::runtime_error If the file cannot be mapped or is invalid
+	 */
+	explicit DBARIndex(const std::string& filename);
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Unmaps the index file.
+	 */
+	~DBARIndex() noexcept;
+
+	DBARIndex(const DBARIndex&) = delete;
+	DBARIndex& operator=(const DBARIndex&) = delete;
+
+	/**
+	 * \brief Find the response for an ARId.
+	 *
+	 * \param[in] id ARId of the disc
+	 *
+	 * \return Response for \c id, empty if \c id is not in the index
+	 */
+	DBARResponse find(const ARId& id) const;
+
+	/**
+	 * \brief Number of discs in the index.
+	 *
+	 * \return Number of discs
+	 */
+	std::size_t size() const noexcept;
+
+private:
+
+	class Impl;
+
+	/**
+	 * \brief Private implementation.
+	 */
+	std::unique_ptr<Impl> impl_;
+};
+
+
+/**
+ * \brief Result of matching a track against the pressings of a disc.
+ */
+class ARTrackMatch final
+{
+public:
+
+	/**
+	 * \brief Constructor for a track without match.
+	 */
+	ARTrackMatch();
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] pressing   0-based index of the matching pressing
+	 * \param[in] type       Checksum type that matched
+	 * \param[in] confidence Confidence of the matching pressing
+	 */
+	ARTrackMatch(const int pressing, const arcstk::checksum::type type,
+			const uint32_t confidence);
+
+	/**
+	 * \brief TRUE iff a pressing matches the track.
+	 *
+	 * \return TRUE iff the track matches
+	 */
+	bool matches() const noexcept;
+
+	/**
+	 * \brief Matching pressing with the highest confidence.
+	 *
+	 * \return 0-based index of the pressing or -1 if none matches
+	 */
+	int pressing() const noexcept;
+
+	/**
+	 * \brief Checksum type that matched.
+	 *
+	 * \return Checksum type that matched, undefined if none matches
+	 */
+	arcstk::checksum::type type() const noexcept;
+
+	/**
+	 * \brief Confidence of the matching pressing.
+	 *
+	 * \return Confidence or 0 if none matches
+	 */
+	uint32_t confidence() const noexcept;
+
+private:
+
+	/**
+	 * \brief Index of the matching pressing.
+	 */
+	int pressing_;
+
+	/**
+	 * \brief Checksum type that matched.
+	 */
+	arcstk::checksum::type type_;
+
+	/**
+	 * \brief Confidence of the matching pressing.
+	 */
+	uint32_t confidence_;
+};
+
+
+/**
+ * \brief Result of matching a disc against its pressings.
+ */
+class ARMatch final
+{
+public:
+
+	/**
+	 * \brief Constructor for a disc that is not in the index.
+	 */
+	ARMatch();
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] candidate Index of the matching candidate
+	 * \param[in] tracks    Match of each track of this candidate
+	 */
+	ARMatch(const int candidate, const std::vector<ARTrackMatch>& tracks);
+
+	/**
+	 * \brief TRUE iff the disc was found in the index.
+	 *
+	 * \return TRUE iff the disc was found
+	 */
+	bool found() const noexcept;
+
+	/**
+	 * \brief TRUE iff every track matches.
+	 *
+	 * \return TRUE iff every track matches
+	 */
+	bool matches() const noexcept;
+
+	/**
+	 * \brief Number of tracks that match.
+	 *
+	 * \return Number of matching tracks
+	 */
+	int matching_tracks() const noexcept;
+
+	/**
+	 * \brief Candidate with the most matching tracks.
+	 *
+	 * If several candidates match the same number of tracks, the one with the
+	 * highest total confidence is chosen and then the first one.
+	 *
+	 * \return 0-based index of the candidate or -1 if the disc was not found
+	 */
+	int candidate() const noexcept;
+
+	/**
+	 * \brief Matches of the tracks of candidate().
+	 *
+	 * \return Match of each track
+	 */
+	const std::vector<ARTrackMatch>& tracks() const noexcept;
+
+private:
+
+	/**
+	 * \brief Index of the matching candidate.
+	 */
+	int candidate_;
+
+	/**
+	 * \brief Match of each track.
+	 */
+	std::vector<ARTrackMatch> tracks_;
+};
+
+
+/**
+ * \brief Match Checksums against the pressings in a DBARIndex.
+ *
+ * Each track is compared with the reference checksums of all pressings at
+ * once. The reference checksums of a track are contiguous in the index, thus
+ * the comparison is a branch-free loop that compilers vectorize.
+ *
+ * A disc may be matched with several candidate Checksums, e.g. calculated
+ * with different sample offsets. The candidate with the most matching tracks
+ * is reported.
+ */
+class ARMatcher final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] index Index to match against, must outlive the matcher
+	 */
+	explicit ARMatcher(const DBARIndex& index);
+
+	/**
+	 * \brief Match the Checksums of a disc.
+	 *
+	 * \param[in] id        ARId of the disc
+	 * \param[in] checksums Checksums of the tracks of the disc
+	 *
+	 * \return Result of the match
+	 */
+	ARMatch match(const ARId& id, const Checksums& checksums) const;
+
+	/**
+	 * \brief Match several candidate Checksums of a disc.
+	 *
+	 * \param[in] id         ARId of the disc
+	 * \param[in] candidates Candidate Checksums of the tracks of the disc
+	 *
+	 * \return Result of the match for the best candidate
+	 */
+	ARMatch match(const ARId& id, const std::vector<Checksums>& candidates)
+		const;
+
+	/**
+	 * \brief Match the candidate Checksums of several discs.
+	 *
+	 * \param[in] ids        ARIds of the discs
+	 * \param[in] candidates Candidate Checksums for each disc in \c ids
+	 *
+	 * \return Result of the match for each disc in \c ids
+	 *
+	 * \throw std::invalid_argument If the sizes of the inputs differ
+	 */
+	std::vector<ARMatch> match(const std::vector<ARId>& ids,
+			const std::vector<std::vector<Checksums>>& candidates) const;
+
+private:
+
+	/**
+	 * \brief Index to match against.
+	 */
+	const DBARIndex* index_;
+};
+
+/** @} */
+
+} // namespace v_1_0_0
+} // namespace arcsdec
+
+#endif
@@ -161,10 +161,18 @@ enum class Format : unsigned
 	OGG,
 	WV,
 	AIFF
-	// ... add more audio formats here
+	// ... add more audio formats here, then update FORMAT_COUNT
 };
 
 
+/**
+ * \brief Number of declared \link Format Formats\endlink.
+ *
+ * Each Format has a value in the range <tt>[0, FORMAT_COUNT)</tt>.
+ */
+constexpr unsigned FORMAT_COUNT { static_cast<unsigned>(Format::AIFF) + 1 };
+
+
 /**
  * \brief Name of the \c format.
  *
@@ -209,6 +217,14 @@ enum class Codec : unsigned
 };
 
 
+/**
+ * \brief Number of declared \link Codec Codecs\endlink.
+ *
+ * Each Codec has a value in the range <tt>[0, CODEC_COUNT)</tt>.
+ */
+constexpr unsigned CODEC_COUNT { static_cast<unsigned>(Codec::NONE) + 1 };
+
+
 /**
  * \brief Name of the \c codec.
  *
@@ -479,6 +495,17 @@ public:
 	 */
 	ByteSequence::const_reference operator[](ByteSequence::size_type i) const;
 
+	/**
+	 * \brief TRUE if the byte on position \c i is a wildcard.
+	 *
+	 * The value of a wildcard position is not meaningful.
+	 *
+	 * \param[in] i Index position
+	 *
+	 * \return TRUE if the byte on position \c i is a wildcard
+	 */
+	bool is_wildcard(ByteSequence::size_type i) const;
+
 	/**
 	 * \brief Swap this instance with another.
 	 *
@@ -899,6 +926,17 @@ public:
 	 */
 	std::unique_ptr<FileReaderDescriptor> descriptor() const;
 
+	/**
+	 * \brief Prepare this FileReader for reading another input.
+	 *
+	 * Releases the previous input and restores the state of a newly created
+	 * instance. A FileReader that cannot restore its state returns FALSE and
+	 * must not be used for another input.
+	 *
+	 * \return TRUE iff the instance can be used for another input
+	 */
+	bool reset();
+
 private:
 
 	/**
@@ -908,6 +946,15 @@ private:
 	 */
 	virtual std::unique_ptr<FileReaderDescriptor> do_descriptor() const
 	= 0;
+
+	/**
+	 * \brief Implements FileReader::reset().
+	 *
+	 * The default implementation returns FALSE.
+	 *
+	 * \return TRUE iff the instance can be used for another input
+	 */
+	virtual bool do_reset();
 };
 
 
@@ -0,0 +1,126 @@
+#ifndef __LIBARCSDEC_LOGSINK_HPP__
+#define __LIBARCSDEC_LOGSINK_HPP__
+
+/**
+ * \file
+ *
+ * \brief Non-blocking sink for log messages.
+ */
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint64_t
+#include <cstdio>   // for FILE
+#include <memory>   // for unique_ptr
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+/**
+ * \defgroup logsink Log sink
+ *
+ * \brief Decouple logging from writing the log.
+ *
+ * @{
+ */
+
+/**
+ * \brief Stream for log messages that is written by a background thread.
+ *
+ * An arcstk::Appender writes each message to its stream while holding the
+ * lock of the stream. If the stream is a file or a terminal, every thread
+ * that logs waits for the write to complete. When several threads read audio
+ * files, this serializes them.
+ *
+ * AsyncLogSink provides a stream() that only copies the messages to a buffer
+ * of fixed capacity. A background thread writes the buffer to the target
+ * stream. Logging never waits for the target. If the buffer is full, the
+ * message is dropped and counted.
+ *
+ * Use stream() to create an Appender:
+ *
+ * \code{.cpp}
+ * auto sink = arcsdec::AsyncLogSink { stdout };
+ * arcstk::Logging::instance().add_appender(
+ *     std::make_unique<arcstk::Appender>("async", sink.stream()));
+ * \endcode
+ *
+ * The sink must outlive every use of its stream, i.e. it should be created
+ * before the Appender and be destroyed after logging ended. On destruction,
+ * all buffered messages are written and stream() is closed.
+ *
+ * If the C library does not support custom streams (as glibc and BSD libc
+ * do), stream() is the target stream itself and logging is synchronous.
+ */
+class AsyncLogSink final
+{
+public:
+
+	/**
+	 * \brief Default capacity of the buffer in bytes.
+	 */
+	static constexpr std::size_t DEFAULT_CAPACITY = 1048576; // 1 MiB
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] target Stream to write the messages to
+	 */
+	explicit AsyncLogSink(std::FILE* target);
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] target   Stream to write the messages to
+	 * \param[in] capacity Maximal number of bytes buffered
+	 */
+	AsyncLogSink(std::FILE* target, const std::size_t capacity);
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Writes all buffered messages and closes stream().
+	 */
+	~AsyncLogSink() noexcept;
+
+	AsyncLogSink(const AsyncLogSink&) = delete;
+	AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+	/**
+	 * \brief Stream to pass to an arcstk::Appender.
+	 *
+	 * The stream is line buffered.
+	 *
+	 * \return Stream of this sink
+	 */
+	std::FILE* stream() const noexcept;
+
+	/**
+	 * \brief Wait until all messages written so far are written to the target.
+	 */
+	void flush();
+
+	/**
+	 * \brief Number of messages dropped since the buffer was full.
+	 *
+	 * \return Number of messages dropped
+	 */
+	uint64_t dropped() const noexcept;
+
+private:
+
+	class Impl;
+
+	/**
+	 * \brief Private implementation.
+	 */
+	std::unique_ptr<Impl> impl_;
+};
+
+/** @} */
+
+} // namespace v_1_0_0
+} // namespace arcsdec
+
+#endif
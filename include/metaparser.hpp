@@ -15,6 +15,7 @@
 #include <arcstk/metadata.hpp>    // for ToC
 #endif
 
+#include <cstddef>      // for size_t
 #include <limits>       // for numeric_limits
 #include <memory>       // for unique_ptr
 #include <ostream>      // for ostringstream
@@ -87,6 +88,21 @@ public:
 	 */
 	std::unique_ptr<ToC> parse(const std::string& filename);
 
+	/**
+	 * \brief Parses metadata from a region of memory.
+	 *
+	 * The memory is not copied. It must remain valid until parsing is
+	 * completed.
+	 *
+	 * \param[in] data Start of the metadata
+	 * \param[in] size Size of the metadata in bytes
+	 *
+	 * \return The ToC information represented by the metadata
+	 *
+	 * \throw MetadataParseException If the metadata could not be parsed
+	 */
+	std::unique_ptr<ToC> parse(const char* data, const std::size_t size);
+
 	/**
 	 * \brief Create a descriptor for this MetadataParser implementation.
 	 *
@@ -114,6 +130,20 @@ private:
 	virtual std::unique_ptr<ToC> do_parse(const std::string& filename)
 	= 0;
 
+	/**
+	 * \brief Implements parse() on a region of memory.
+	 *
+	 * \param[in] data Start of the metadata
+	 * \param[in] size Size of the metadata in bytes
+	 *
+	 * \return The ToC information represented by the metadata
+	 *
+	 * \throw MetadataParseException If the metadata could not be parsed
+	 */
+	virtual std::unique_ptr<ToC> do_parse_buffer(const char* data,
+			const std::size_t size)
+	= 0;
+
 	/**
 	 * \brief Provides implementation for \c descriptor() of a MetadataParser.
 	 *
@@ -156,6 +186,22 @@ public:
 	 */
 	std::unique_ptr<ToC> parse(const std::string& filename);
 
+	/**
+	 * \brief Parses metadata from a region of memory.
+	 *
+	 * This avoids writing metadata that is already in memory to a file just
+	 * to parse it. The memory is not copied. It must remain valid until
+	 * parsing is completed.
+	 *
+	 * \param[in] data Start of the metadata
+	 * \param[in] size Size of the metadata in bytes
+	 *
+	 * \return The ToC information represented by the metadata
+	 *
+	 * \throw MetadataParseException If the metadata could not be parsed
+	 */
+	std::unique_ptr<ToC> parse(const char* data, const std::size_t size);
+
 private:
 
 	/**
@@ -164,6 +210,8 @@ private:
 	std::unique_ptr<MetadataParserImpl> impl_;
 
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
+
+	bool do_reset() final;
 };
 
 
@@ -263,6 +311,21 @@ long msf_to_frames(const int m, const int s, const int f);
  */
 void frames_to_msf(long frames, int* m, int* s, int* f);
 
+
+/**
+ * \brief Parse the text of a cue sheet by the preferred cue sheet parser.
+ *
+ * This is intended for MetadataParsers of audio formats that embed a cue sheet
+ * as text, e.g. as a tag.
+ *
+ * \param[in] cuesheet Text of the cue sheet
+ *
+ * \return The ToC information represented by the cue sheet
+ *
+ * \throw MetadataParseException If the text could not be parsed
+ */
+std::unique_ptr<ToC> parse_cuesheet_text(const std::string& cuesheet);
+
 } // namespace details
 
 /// @}
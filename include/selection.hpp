@@ -15,9 +15,15 @@
 #include <arcstk/logging.hpp>   // for ARCS_LOG_WARNING, ARCS_LOG_DEBUG
 #endif
 
-#include <memory>        // for unique_ptr, make_unique
+#include <array>         // for array
+#include <cstddef>       // for size_t
+#include <cstdint>       // for int64_t, uint64_t
+#include <iosfwd>        // for istream, ostream
+#include <memory>        // for unique_ptr, make_unique, shared_ptr
+#include <mutex>         // for mutex, lock_guard
 #include <set>           // for set
 #include <string>        // for string
+#include <tuple>         // for tuple
 #include <type_traits>   // for is_convertible
 #include <unordered_map> // for unordered_map
 #include <utility>       // for pair, move, make_pair, forward
@@ -61,6 +67,9 @@ inline namespace v_1_0_0
  */
 
 
+struct ReaderStatistics;
+
+
 /**
  * \brief Interface for a descriptor preference.
  *
@@ -111,11 +120,24 @@ public:
 	type preference(const Format format, const Codec codec,
 		const FileReaderDescriptor& desc) const;
 
+	/**
+	 * \brief Revision of the data the preferences are computed from.
+	 *
+	 * A preference computed from data that changes over time returns a
+	 * different revision whenever the preference values may have changed.
+	 * Selection decisions made with a previous revision are then outdated.
+	 *
+	 * \return Revision of the preference, 0 if the preference is constant
+	 */
+	uint64_t revision() const;
+
 private:
 
 	virtual type do_preference(const Format format, const Codec codec,
 		const FileReaderDescriptor& desc) const
 	= 0;
+
+	virtual uint64_t do_revision() const;
 };
 
 
@@ -130,13 +152,13 @@ private:
  * This prefers specialized readers (like libFLAC) over general multi-input
  * readers (like ffmpeg).
  *
- * \note
- * DefaultPreference is currently <b>not</b> the actual default preference.
- * DefaultPreference checks for acceptance of the Codec and therefore the
- * concrete descriptor decides whether it respects Codec::UNKNOWN. Since Codec
- * recognition is currently not implemented, the input will mostly be UNKNOWN
- * which currently has to be accepted. Therefore, the current default is
- * \ref FormatPreference.
+ * If the Codec is Codec::UNKNOWN, i.e. it could not be recognized, acceptance
+ * of the Format is sufficient.
+ *
+ * DefaultPreference is the default preference for selecting
+ * \link AudioReader AudioReaders\endlink. Descriptors that do not have
+ * InputType::AUDIO are not accepted. Hence, a MetadataParser that reads the
+ * metadata of an audio format is never selected for reading audio.
  */
 class DefaultPreference final : public DescriptorPreference
 {
@@ -163,9 +185,9 @@ class MinPreference final : public DescriptorPreference
  * \brief Preference for the most specific descriptor accepting the Format.
  *
  * \note
- * The codec is ignored. This preference model is used as the default model
- * while codec recognition is not fully implemented. Once codec is fully
- * supported, DefaultPreference will be the default instead of FormatPreference.
+ * The codec is ignored. This preference model is suitable for selecting
+ * \link MetadataParser MetadataParsers\endlink since metadata formats have
+ * no codec.
  */
 class FormatPreference final : public DescriptorPreference
 {
@@ -174,6 +196,217 @@ class FormatPreference final : public DescriptorPreference
 };
 
 
+/**
+ * \brief FormatPreference restricted to descriptors with InputType::TOC.
+ *
+ * This preference model is the default model for selecting
+ * \link MetadataParser MetadataParsers\endlink. Hence, for an audio format
+ * only a MetadataParser for the metadata embedded in it can be selected.
+ */
+class TocPreference final : public DescriptorPreference
+{
+	type do_preference(const Format format, const Codec codec,
+		const FileReaderDescriptor& desc) const final;
+};
+
+
+/**
+ * \brief Measured decoding throughput of FileReaders.
+ *
+ * Holds the number of samples decoded and the time required to decode them
+ * per reader id, Format and Codec. Multiple measurements for the same
+ * combination are accumulated.
+ *
+ * The measurements can be saved to and loaded from a stream, e.g. to persist
+ * them between runs on the same host. The text format consists of one line per
+ * measurement with reader id, format name, codec name, number of samples and
+ * number of seconds, separated by blanks.
+ *
+ * The revision() changes whenever the fastest reader for a pair of Format and
+ * Codec changes. This lets a SelectionCache forget the decisions made with
+ * the previous measurements.
+ *
+ * The instance is safe to be used from concurrent threads.
+ *
+ * \see ThroughputPreference
+ */
+class ReaderThroughput final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	ReaderThroughput();
+
+	/**
+	 * \brief Destructor.
+	 */
+	~ReaderThroughput() noexcept;
+
+	ReaderThroughput(const ReaderThroughput&) = delete;
+	ReaderThroughput& operator=(const ReaderThroughput&) = delete;
+
+	/**
+	 * \brief Record a measurement.
+	 *
+	 * Measurements without samples or time are ignored.
+	 *
+	 * \param[in] reader_id Id of the reader measured
+	 * \param[in] format    Format of the file decoded
+	 * \param[in] codec     Codec of the file decoded
+	 * \param[in] samples   Number of samples decoded
+	 * \param[in] seconds   Time required to decode \c samples
+	 */
+	void record(const std::string& reader_id, const Format format,
+			const Codec codec, const int64_t samples, const double seconds);
+
+	/**
+	 * \brief Record the statistics of reading an input.
+	 *
+	 * The samples passed are recorded with the time spent opening the input
+	 * and reading and decoding the audio data. The time spent processing
+	 * the samples is not part of the throughput of the reader.
+	 *
+	 * \param[in] statistics Statistics of a reader that has read an input
+	 * \param[in] format     Format of the input
+	 * \param[in] codec      Codec of the input
+	 */
+	void record(const ReaderStatistics& statistics, const Format format,
+			const Codec codec);
+
+	/**
+	 * \brief Throughput of a reader for a pair of Format and Codec.
+	 *
+	 * \param[in] reader_id Id of the reader
+	 * \param[in] format    Format
+	 * \param[in] codec     Codec
+	 *
+	 * \return Samples decoded per second or 0 if nothing was recorded
+	 */
+	double samples_per_second(const std::string& reader_id,
+			const Format format, const Codec codec) const;
+
+	/**
+	 * \brief Best throughput of any reader for a pair of Format and Codec.
+	 *
+	 * \param[in] format Format
+	 * \param[in] codec  Codec
+	 *
+	 * \return Maximal samples per second or 0 if nothing was recorded
+	 */
+	double best(const Format format, const Codec codec) const;
+
+	/**
+	 * \brief Write all measurements to \c out.
+	 *
+	 * \param[in] out Stream to write to
+	 */
+	void save(std::ostream& out) const;
+
+	/**
+	 * \brief Add the measurements read from \c in.
+	 *
+	 * Lines that cannot be parsed are skipped.
+	 *
+	 * \param[in] in Stream to read from
+	 */
+	void load(std::istream& in);
+
+	/**
+	 * \brief Forget all measurements.
+	 */
+	void clear();
+
+	/**
+	 * \brief Number of combinations of reader, Format and Codec measured.
+	 *
+	 * \return Number of measured combinations
+	 */
+	std::size_t size() const;
+
+	/**
+	 * \brief Revision of the measurements.
+	 *
+	 * \return Revision of the measurements
+	 */
+	uint64_t revision() const;
+
+private:
+
+	class Impl;
+
+	/**
+	 * \brief Private implementation.
+	 */
+	std::unique_ptr<Impl> impl_;
+};
+
+
+// Deactivate -Weffc++ for the following class
+//
+// -Weffc++ will warn about ThroughputPreference not having declared copy
+// constructor and copy assignment operator although it has a pointer type
+// member. Copies are intended to share the measurements.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+
+/**
+ * \brief Preference for the fastest descriptor.
+ *
+ * Descriptors are ranked by the throughput measured for the reader on the
+ * given Format and Codec. Any descriptor with a measured throughput is
+ * preferred over any descriptor without a measurement. Among the descriptors
+ * with measured throughput, the preference is proportional to the throughput.
+ * Among descriptors without measurement, the ranking of DefaultPreference
+ * applies.
+ *
+ * A descriptor that is not accepted by DefaultPreference is never preferred.
+ *
+ * \see ReaderThroughput
+ */
+class ThroughputPreference final : public DescriptorPreference
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * Uses the measurements in FileReaderRegistry::throughput().
+	 */
+	ThroughputPreference();
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] throughput Measurements to use
+	 */
+	explicit ThroughputPreference(const ReaderThroughput* throughput);
+
+	/**
+	 * \brief Measurements used by this instance.
+	 *
+	 * \return Measurements used
+	 */
+	const ReaderThroughput* throughput() const;
+
+private:
+
+	type do_preference(const Format format, const Codec codec,
+		const FileReaderDescriptor& desc) const final;
+
+	uint64_t do_revision() const final;
+
+	/**
+	 * \brief Measurements used by this instance.
+	 */
+	const ReaderThroughput* throughput_;
+};
+
+// Re-activate -Weffc++ for all what follows
+#pragma GCC diagnostic pop
+
+
 /**
  * \brief Type for the container of available FileReaderDescriptor instances.
  *
@@ -304,11 +537,22 @@ public:
 	std::unique_ptr<FileReaderDescriptor> get(const Format format,
 			const Codec codec, const FileReaders& descs) const;
 
+	/**
+	 * \brief Revision of the data the selection depends on.
+	 *
+	 * \return Revision of the selection, 0 if the selection is constant
+	 *
+	 * \see DescriptorPreference::revision()
+	 */
+	uint64_t revision() const;
+
 private:
 
 	virtual std::unique_ptr<FileReaderDescriptor> do_get(const Format format,
 			const Codec codec, const FileReaders& descs) const
 	= 0;
+
+	virtual uint64_t do_revision() const;
 };
 
 
@@ -409,6 +653,11 @@ private:
 	{
 		return selector()->select(format, codec, descs, *preference());
 	}
+
+	inline uint64_t do_revision() const final
+	{
+		return preference()->revision();
+	}
 };
 
 
@@ -418,6 +667,114 @@ private:
 using FormatList = std::vector<std::unique_ptr<Matcher>>;
 
 
+namespace details
+{
+
+/**
+ * \brief Compiled reference bytes of a list of Matchers.
+ *
+ * The reference bytes of all Matchers added are compiled into a single table
+ * that contains, for each byte position and each possible byte value, the set
+ * of Matchers accepting this byte value on this position. Wildcards and
+ * positions outside the reference bytes accept any value. The set of Matchers
+ * accepting an input sequence is therefore determined in a single pass over
+ * the input, independent of the number of Matchers.
+ *
+ * Matchers are kept in the order in which they were added. Only the first
+ * MAX_COMPILED Matchers are compiled, any further Matchers are tried one by
+ * one after the compiled ones.
+ *
+ * The table does not own the Matchers.
+ */
+class FormatTable final
+{
+public:
+
+	/**
+	 * \brief Type of the set of Matchers accepting a byte on a position.
+	 */
+	using mask_type = uint64_t;
+
+	/**
+	 * \brief Maximal number of compiled Matchers.
+	 */
+	constexpr static std::size_t MAX_COMPILED = 64;
+
+	/**
+	 * \brief Constructor for an empty table.
+	 */
+	FormatTable();
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * Adds every Matcher in \c formats in order.
+	 *
+	 * \param[in] formats The Matchers to compile
+	 */
+	explicit FormatTable(const FormatList& formats);
+
+	/**
+	 * \brief Add a Matcher to the table.
+	 *
+	 * \param[in] matcher The Matcher to add
+	 */
+	void add(const Matcher* matcher);
+
+	/**
+	 * \brief Match the table against the bytes and the name of a file.
+	 *
+	 * Equivalent to trying Matcher::matches() for \c bytes and then for
+	 * \c filename on each Matcher in order.
+	 *
+	 * \param[in] bytes    Bytes read from the file
+	 * \param[in] filename Name of the file
+	 *
+	 * \return First Matcher that matches \c bytes and \c filename or nullptr
+	 */
+	const Matcher* match(const Bytes& bytes, const std::string& filename)
+		const;
+
+	/**
+	 * \brief Set of compiled Matchers that accept \c bytes.
+	 *
+	 * Bit \c i is set iff the \c i-th Matcher accepts \c bytes.
+	 *
+	 * \param[in] bytes Bytes read from a file
+	 *
+	 * \return Set of accepting compiled Matchers
+	 */
+	mask_type candidates(const Bytes& bytes) const;
+
+	/**
+	 * \brief Number of Matchers in the table.
+	 *
+	 * \return Number of Matchers.
+	 */
+	std::size_t size() const;
+
+private:
+
+	/**
+	 * \brief The Matchers in the order they were added.
+	 */
+	std::vector<const Matcher*> matchers_;
+
+	/**
+	 * \brief Accepting Matchers per byte position and byte value.
+	 */
+	std::vector<std::array<mask_type, ByteSequence::max_byte_value + 1>>
+		positions_;
+
+	/**
+	 * \brief Set of all compiled Matchers.
+	 */
+	mask_type compiled_;
+};
+
+} // namespace details
+
+
 /**
  * \internal
  * \brief Function pointer to function returning std::unique_ptr<T>.
@@ -467,6 +824,16 @@ class FileReaderRegistry
 	 */
 	static std::unique_ptr<FileReaderSelection> default_toc_selection_;
 
+	/**
+	 * \brief Compiled reference bytes of the supported formats.
+	 */
+	static details::FormatTable format_table_;
+
+	/**
+	 * \brief Global throughput measurements.
+	 */
+	static std::unique_ptr<ReaderThroughput> throughput_;
+
 public:
 
 	/**
@@ -495,6 +862,15 @@ public:
 	 */
 	static const FormatList* formats();
 
+	/**
+	 * \brief Compiled reference bytes of the supported formats.
+	 *
+	 * The table is updated whenever a Format is registered.
+	 *
+	 * \return Compiled table for formats()
+	 */
+	static const details::FormatTable* format_table();
+
 	/**
 	 * \brief Set of available \link FileReader FileReaderDescriptors\endlink.
 	 *
@@ -523,6 +899,15 @@ public:
 	 */
 	static const FileReaderSelection* default_toc_selection();
 
+	/**
+	 * \brief Throughput measurements of the available readers.
+	 *
+	 * This is used by ThroughputPreference if not specified otherwise.
+	 *
+	 * \return Global throughput measurements
+	 */
+	static ReaderThroughput* throughput();
+
 protected:
 
 	/**
@@ -665,6 +1050,288 @@ std::unique_ptr<FileReader> select_reader(
 		const FileReaders& readers);
 
 
+/**
+ * \brief Determine Format and Codec of a file.
+ *
+ * \param[in] filename Name of the file to inspect
+ * \param[in] formats  Set of file formats to check \c filename for
+ *
+ * \return Format and Codec of \c filename
+ *
+ * \throw FileReadException If \c filename is empty or could not be read
+ */
+std::pair<Format, Codec> file_type(const std::string& filename,
+		const FormatList& formats);
+
+
+/**
+ * \brief Return a new identifier for a configuration.
+ *
+ * Each call returns a value greater than all values returned before. Owners
+ * of a FileReaderSelection, a FormatList or a set of FileReaders use it to
+ * identify their current configuration for a SelectionCache. Since an
+ * identifier is never reused, a configuration cannot be mistaken for a
+ * previous one, even if its objects reside at the same address.
+ *
+ * \return New configuration identifier, never 0
+ */
+uint64_t next_configuration_id();
+
+
+/**
+ * \brief Identifies the configuration a SelectionCache is filled for.
+ *
+ * Consists of the identifier of the FileReaderSelection in use and the
+ * identifier of the FormatList and FileReaders in use, each obtained by
+ * next_configuration_id(), and the FileReaderSelection::revision() of the
+ * selection in use.
+ */
+using SelectionConfiguration = std::tuple<uint64_t, uint64_t, uint64_t>;
+
+
+/**
+ * \brief Memoized selection of FileReaderDescriptors.
+ *
+ * Remembers the descriptor selected for each detected pair of Format and
+ * Codec. For a known pair, neither the preferences of the available
+ * descriptors are computed again nor is the selected descriptor cloned again.
+ *
+ * Additionally, the Matcher that recognized the Format of a file is remembered
+ * for the filename suffix of this file. For subsequent files with the same
+ * suffix, this Matcher is tried first before the entire FormatList is scanned.
+ *
+ * The descriptors returned are shared and immutable. Their create_reader()
+ * acts as factory for the concrete FileReader.
+ *
+ * An instance remembers decisions for a single configuration of
+ * FileReaderSelection, FormatList and FileReaders. Before the configuration is
+ * used, it is to be passed to configure(), which forgets all decisions if the
+ * configuration differs from the previous one. If a FileReaderSelection, a
+ * FormatList or a set of FileReaders is modified in place after it was used
+ * with an instance, clear() must be called.
+ *
+ * The instance is safe to be used from concurrent threads.
+ */
+class SelectionCache final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	SelectionCache();
+
+	/**
+	 * \brief Destructor.
+	 */
+	~SelectionCache() noexcept;
+
+	SelectionCache(const SelectionCache&) = delete;
+	SelectionCache& operator=(const SelectionCache&) = delete;
+
+	/**
+	 * \brief Select a FileReaderDescriptor.
+	 *
+	 * Equivalent to select_descriptor() except that known decisions are
+	 * reused.
+	 *
+	 * \param[in] filename  Name of the file to read
+	 * \param[in] selection FileReaderSelection to select from
+	 * \param[in] formats   Set of file formats to check \c filename for
+	 * \param[in] readers   Set of available file readers
+	 *
+	 * \return Descriptor that accepts the input file or nullptr
+	 *
+	 * \throw FileReadException If \c filename is empty or could not be read
+	 */
+	std::shared_ptr<const FileReaderDescriptor> descriptor(
+			const std::string& filename,
+			const FileReaderSelection& selection,
+			const FormatList& formats,
+			const FileReaders& readers);
+
+	/**
+	 * \brief Bind the instance to a configuration.
+	 *
+	 * If \c configuration differs from the configuration the instance is
+	 * currently bound to, all decisions are forgotten.
+	 *
+	 * \param[in] configuration Configuration to be used subsequently
+	 *
+	 * \return TRUE iff the configuration changed
+	 */
+	bool configure(const SelectionConfiguration& configuration);
+
+	/**
+	 * \brief Forget all decisions.
+	 */
+	void clear();
+
+	/**
+	 * \brief Number of selection decisions currently known.
+	 *
+	 * \return Number of selection decisions.
+	 */
+	std::size_t size() const;
+
+private:
+
+	class Impl;
+
+	/**
+	 * \brief Private implementation.
+	 */
+	std::unique_ptr<Impl> impl_;
+};
+
+
+/**
+ * \brief Pool of idle FileReaders for reuse.
+ *
+ * Constructing a FileReader may be expensive since it may involve setting up
+ * a decoder instance of a third party library. When many small files are
+ * read, constructing and destructing a FileReader for each file can make up a
+ * significant share of the total runtime. A ReaderPool keeps the readers that
+ * completed their file for reuse on the next file that is selected for the
+ * same FileReaderDescriptor.
+ *
+ * A FileReader must only be put back into the pool after it has completely
+ * processed its file without error. Readers that threw must be discarded.
+ * The pool calls FileReader::reset() on each reader put back and discards
+ * readers that cannot be reset. Hence, a reader taken from the pool is in the
+ * state of a newly created reader.
+ *
+ * The pool keeps at most MAX_IDLE readers per descriptor id. Each reader is
+ * taken by exactly one thread at a time, hence the instance is safe to be
+ * used from concurrent threads.
+ *
+ * 	param ReaderType Concrete type of the pooled FileReader
+ */
+template <class ReaderType>
+class ReaderPool final
+{
+public:
+
+	/**
+	 * \brief Maximal number of idle readers kept per descriptor id.
+	 */
+	static constexpr std::size_t MAX_IDLE = 8;
+
+	/**
+	 * \brief Constructor.
+	 */
+	ReaderPool()
+		: idle_  { /* empty */ }
+		, mutex_ { /* default */ }
+	{
+		// empty
+	}
+
+	ReaderPool(const ReaderPool&) = delete;
+	ReaderPool& operator=(const ReaderPool&) = delete;
+
+	/**
+	 * \brief Take an idle reader for the descriptor with the specified id.
+	 *
+	 * \param[in] id Id of the FileReaderDescriptor
+	 *
+	 * \return An idle reader or nullptr if none is available
+	 */
+	std::unique_ptr<ReaderType> take(const std::string& id)
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto entry { idle_.find(id) };
+
+		if (entry == idle_.end() || entry->second.empty())
+		{
+			return nullptr;
+		}
+
+		auto reader { std::move(entry->second.back()) };
+		entry->second.pop_back();
+
+		ARCS_LOG(DEBUG1) << "Reuse idle reader for descriptor '" << id << "'";
+
+		return reader;
+	}
+
+	/**
+	 * \brief Put a reader that completed its file into the pool.
+	 *
+	 * If \c reader cannot be reset or the pool already holds MAX_IDLE readers
+	 * for the descriptor of \c reader, \c reader is destroyed.
+	 *
+	 * \param[in] reader The reader to put into the pool
+	 */
+	void put(std::unique_ptr<ReaderType> reader)
+	{
+		if (!reader || !reader->reset())
+		{
+			return;
+		}
+
+		const auto desc { reader->descriptor() };
+
+		if (!desc)
+		{
+			return;
+		}
+
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		auto& readers { idle_[desc->id()] };
+
+		if (readers.size() < MAX_IDLE)
+		{
+			readers.push_back(std::move(reader));
+		}
+	}
+
+	/**
+	 * \brief Destroy all idle readers.
+	 */
+	void clear()
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		idle_.clear();
+	}
+
+	/**
+	 * \brief Total number of idle readers.
+	 *
+	 * \return Number of idle readers in the pool
+	 */
+	std::size_t size() const
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		auto total = std::size_t { 0 };
+
+		for (const auto& entry : idle_)
+		{
+			total += entry.second.size();
+		}
+
+		return total;
+	}
+
+private:
+
+	/**
+	 * \brief Idle readers by descriptor id.
+	 */
+	std::unordered_map<std::string, std::vector<std::unique_ptr<ReaderType>>>
+		idle_;
+
+	/**
+	 * \brief Guards idle_.
+	 */
+	mutable std::mutex mutex_;
+};
+
+
 /**
  * \brief Functor to safely create a unique_ptr to a downcasted FileReader.
  *
@@ -707,8 +1374,92 @@ struct CreateReader final
 	{
 		ARCS_LOG_DEBUG << "Input file: " << filename << "";
 
-		auto reader = select_reader(filename, selection, formats, readers);
+		return downcast(filename,
+				select_reader(filename, selection, formats, readers));
+	}
+
+	/**
+	 * \brief Return a unique_ptr to an instance of the specified \c ReaderType.
+	 *
+	 * The descriptor for \c filename is acquired via \c cache.
+	 *
+	 * \param[in] filename  The name of the file to choose a FileReader
+	 * \param[in] selection FileReaderSelection to select from
+	 * \param[in] formats   Set of supported formats
+	 * \param[in] readers   Set of available file readers
+	 * \param[in] cache     Cache for selection decisions
+	 *
+	 * \return Instance of the specified ReaderType
+	 */
+	auto operator()(const std::string& filename,
+			const FileReaderSelection& selection,
+			const FormatList& formats,
+			const FileReaders& readers,
+			SelectionCache& cache) const
+	-> std::unique_ptr<ReaderType>
+	{
+		ARCS_LOG_DEBUG << "Input file: " << filename << "";
+
+		const auto d { cache.descriptor(filename, selection, formats, readers) };
+
+		return downcast(filename, d ? d->create_reader() : nullptr);
+	}
 
+	/**
+	 * \brief Return a unique_ptr to an instance of the specified \c ReaderType.
+	 *
+	 * The descriptor for \c filename is acquired via \c cache. If \c pool
+	 * holds an idle reader for this descriptor, it is returned instead of a
+	 * newly created reader.
+	 *
+	 * \param[in] filename  The name of the file to choose a FileReader
+	 * \param[in] selection FileReaderSelection to select from
+	 * \param[in] formats   Set of supported formats
+	 * \param[in] readers   Set of available file readers
+	 * \param[in] cache     Cache for selection decisions
+	 * \param[in] pool      Pool of idle readers
+	 *
+	 * \return Instance of the specified ReaderType
+	 */
+	auto operator()(const std::string& filename,
+			const FileReaderSelection& selection,
+			const FormatList& formats,
+			const FileReaders& readers,
+			SelectionCache& cache,
+			ReaderPool<ReaderType>& pool) const
+	-> std::unique_ptr<ReaderType>
+	{
+		ARCS_LOG_DEBUG << "Input file: " << filename << "";
+
+		const auto d { cache.descriptor(filename, selection, formats, readers) };
+
+		if (!d)
+		{
+			return downcast(filename, nullptr);
+		}
+
+		auto reader { pool.take(d->id()) };
+
+		return reader ? std::move(reader)
+			: downcast(filename, d->create_reader());
+	}
+
+private:
+
+	/**
+	 * \brief Downcast \c reader to \c ReaderType or throw.
+	 *
+	 * \param[in] filename The name of the file \c reader was created for
+	 * \param[in] reader   The reader to downcast
+	 *
+	 * \return Instance of the specified ReaderType
+	 *
+	 * \throw InputFormatException If \c reader is null or not a ReaderType
+	 */
+	auto downcast(const std::string& filename,
+			std::unique_ptr<FileReader> reader) const
+	-> std::unique_ptr<ReaderType>
+	{
 		if (!reader)
 		{
 			throw InputFormatException("Failed to select a reader for file: '"
@@ -7,6 +7,9 @@
 #ifndef __LIBARCSDEC_AUDIOREADER_HPP__
 #include "audioreader.hpp"
 #endif
+#ifndef __LIBARCSDEC_TRACEPOINTS_HPP__
+#include "tracepoints.hpp"     // for ARCSDEC_TRACE2, _TRACE3, _TRACE4
+#endif
 
 #ifndef __LIBARCSTK_METADATA_HPP__
 #include <arcstk/metadata.hpp> // for CDDA
@@ -15,12 +18,24 @@
 #include <arcstk/logging.hpp>  // for ARCS_LOG, _ERROR, _WARNING, _DEBUG
 #endif
 
+#include <algorithm>     // for max, min
+#include <atomic>        // for atomic
+#include <chrono>        // for steady_clock, duration
+#include <condition_variable> // for condition_variable
 #include <cstdint>       // for uint16_t, uint32_t, int16_t, int32_t
+#include <deque>         // for deque
+#include <exception>     // for exception_ptr, current_exception
+#include <fstream>       // for ifstream
+#include <functional>    // for function
+#include <iterator>      // for distance, next
 #include <memory>        // for unique_ptr, make_unique
+#include <mutex>         // for mutex, lock_guard, unique_lock
 #include <sstream>       // for ostringstream
 #include <stdexcept>     // for logic_error
 #include <string>        // for string, to_string
+#include <thread>        // for thread
 #include <utility>       // for move
+#include <vector>        // for vector
 
 
 namespace arcsdec
@@ -32,6 +47,649 @@ inline namespace v_1_0_0
 using arcstk::CDDA;
 
 
+namespace
+{
+
+/**
+ * \brief Id for the next input opened by any AudioReader.
+ *
+ * \return Process-wide unique id of an input
+ */
+uint64_t next_file_id()
+{
+	static std::atomic<uint64_t> id { 0 };
+
+	return ++id;
+}
+
+
+/**
+ * \brief Id of the descriptor of \c reader.
+ *
+ * \param[in] reader Reader to get the id for
+ *
+ * \return Id of the reader or an empty string
+ */
+std::string reader_id(const AudioReaderImpl& reader)
+{
+	const auto descriptor { reader.descriptor() };
+
+	return descriptor ? descriptor->id() : std::string {};
+}
+
+
+/**
+ * \brief Number of bytes the current thread has read so far.
+ *
+ * Counts the bytes of all read operations of the thread, regardless of
+ * whether they were served from the cache.
+ *
+ * \return Bytes read by the current thread, negative if not known
+ */
+int64_t thread_bytes_read()
+{
+	auto in { std::ifstream { "/proc/thread-self/io" } };
+
+	auto key   = std::string {};
+	auto value = int64_t { 0 };
+
+	while (in >> key >> value)
+	{
+		if (key == "rchar:")
+		{
+			return value;
+		}
+	}
+
+	return -1;
+}
+
+
+/**
+ * \brief Seconds elapsed since \c start.
+ *
+ * \param[in] start Point in time to measure from
+ *
+ * \return Seconds elapsed since \c start
+ */
+double seconds_since(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration<double> {
+		std::chrono::steady_clock::now() - start }.count();
+}
+
+
+/**
+ * \brief SampleProcessor that passes only the samples within a range.
+ *
+ * Used by the default implementation of AudioReaderImpl::process_range() for
+ * readers that cannot seek.
+ */
+class SampleRangeFilter final : public SampleProcessor
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] processor SampleProcessor to pass the range to
+	 * \param[in] first     Index of the first sample to pass
+	 * \param[in] total     Total number of samples to pass
+	 */
+	SampleRangeFilter(SampleProcessor& processor, const int64_t first,
+			const int64_t total);
+
+	SampleRangeFilter(const SampleRangeFilter&) = delete;
+	SampleRangeFilter& operator=(const SampleRangeFilter&) = delete;
+
+private:
+
+	void do_start_input() final;
+
+	void do_append_samples(SampleInputIterator begin, SampleInputIterator end)
+		final;
+
+	void do_update_audiosize(const AudioSize& size) final;
+
+	void do_end_input() final;
+
+	/**
+	 * \brief SampleProcessor to pass the range to.
+	 */
+	SampleProcessor* processor_;
+
+	/**
+	 * \brief Index of the first sample to pass.
+	 */
+	int64_t first_;
+
+	/**
+	 * \brief Total number of samples to pass.
+	 */
+	int64_t total_;
+
+	/**
+	 * \brief Index of the next sample received.
+	 */
+	int64_t position_;
+};
+
+
+SampleRangeFilter::SampleRangeFilter(SampleProcessor& processor,
+		const int64_t first, const int64_t total)
+	: processor_ { &processor }
+	, first_     { first }
+	, total_     { total }
+	, position_  { 0 }
+{
+	// empty
+}
+
+
+void SampleRangeFilter::do_start_input()
+{
+	position_ = 0;
+	processor_->start_input();
+}
+
+
+void SampleRangeFilter::do_append_samples(SampleInputIterator begin,
+		SampleInputIterator end)
+{
+	const auto block_first { position_ };
+	position_ += std::distance(begin, end);
+
+	const auto from { std::max(first_, block_first) };
+	const auto to   { std::min(first_ + total_, position_) };
+
+	if (from >= to)
+	{
+		return;
+	}
+
+	processor_->append_samples(std::next(begin, from - block_first),
+			std::next(begin, to - block_first));
+}
+
+
+void SampleRangeFilter::do_update_audiosize(const AudioSize& size)
+{
+	const auto available { std::max(int64_t { 0 },
+			std::min(total_, size.samples() - first_)) };
+
+	processor_->update_audiosize(
+			{ static_cast<int32_t>(available), UNIT::SAMPLES });
+}
+
+
+void SampleRangeFilter::do_end_input()
+{
+	processor_->end_input();
+}
+
+
+/**
+ * \brief Thrown to a producer thread whose queue was stopped.
+ */
+class ProducerStopped final
+{
+	// empty
+};
+
+} // namespace
+
+
+namespace details
+{
+
+/**
+ * \brief Queue of the sample blocks of an input that is open for pulling.
+ *
+ * Receives the signals of an AudioReaderImpl while an input is open. Each
+ * sequence of samples is copied to a block of the queue, which keeps the
+ * samples valid independently of the buffers of the reader. A reader that
+ * holds its samples in a buffer of its own can push() the buffer instead,
+ * which avoids the copy.
+ *
+ * If the samples are produced on a separate thread, the producer is paused
+ * as long as the queue holds its capacity of blocks.
+ */
+class SampleBlockQueue final : public SampleProcessor
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] processor SampleProcessor to restore when the input is closed
+	 */
+	explicit SampleBlockQueue(SampleProcessor* processor);
+
+	/**
+	 * \brief Destructor.
+	 *
+	 * Stops the producer thread, if any.
+	 */
+	~SampleBlockQueue() noexcept final;
+
+	SampleBlockQueue(const SampleBlockQueue&) = delete;
+	SampleBlockQueue& operator=(const SampleBlockQueue&) = delete;
+
+	/**
+	 * \brief SampleProcessor to restore when the input is closed.
+	 *
+	 * \return The SampleProcessor attached before the input was opened
+	 */
+	SampleProcessor* previous_processor() const;
+
+	/**
+	 * \brief Run a producer of samples on a separate thread.
+	 *
+	 * \param[in] producer Function that passes the samples to this queue
+	 * \param[in] capacity Maximal number of queued blocks
+	 */
+	void start_producer(std::function<void()> producer,
+			const std::size_t capacity);
+
+	/**
+	 * \brief Stop the producer thread and wait for it.
+	 */
+	void stop_producer();
+
+	/**
+	 * \brief Wait until a block is queued or the input ended.
+	 */
+	void wait();
+
+	/**
+	 * \brief Mark the end of the input.
+	 */
+	void finish();
+
+	/**
+	 * \brief TRUE iff no block is queued.
+	 *
+	 * \return TRUE iff no block is queued
+	 */
+	bool empty() const;
+
+	/**
+	 * \brief TRUE iff the input ended.
+	 *
+	 * \return TRUE iff the input ended
+	 */
+	bool ended() const;
+
+	/**
+	 * \brief Take the next block from the queue.
+	 *
+	 * The returned block remains valid until the next call of pop().
+	 *
+	 * \return The next block, empty if no block is queued
+	 *
+	 * \throw Any exception the producer thread has thrown
+	 */
+	SampleBlock pop();
+
+	/**
+	 * \brief Queue a buffer of samples without copying it.
+	 *
+	 * The content of \c block is moved to the queue. In exchange, \c block
+	 * receives the buffer of a block that was already consumed, if any, thus
+	 * the buffers are recycled.
+	 *
+	 * \param[in,out] block Samples to queue, replaced by a recycled buffer
+	 */
+	void push(std::vector<arcstk::sample_t>& block);
+
+	/**
+	 * \brief Size of the input as reported by the reader.
+	 *
+	 * \return Size of the input, zero() if not reported
+	 */
+	AudioSize size() const;
+
+private:
+
+	void do_start_input() final;
+
+	void do_append_samples(SampleInputIterator begin, SampleInputIterator end)
+		final;
+
+	void do_update_audiosize(const AudioSize& size) final;
+
+	void do_end_input() final;
+
+	/**
+	 * \brief Wait until the queue accepts another block.
+	 *
+	 * \return Lock on the queue
+	 *
+	 * \throw ProducerStopped If the producer is requested to stop
+	 */
+	std::unique_lock<std::mutex> wait_for_capacity();
+
+	/**
+	 * \brief SampleProcessor to restore when the input is closed.
+	 */
+	SampleProcessor* previous_;
+
+	/**
+	 * \brief Queued blocks.
+	 */
+	std::deque<std::vector<arcstk::sample_t>> blocks_;
+
+	/**
+	 * \brief The block most recently returned by pop().
+	 */
+	std::vector<arcstk::sample_t> current_;
+
+	/**
+	 * \brief Buffer to reuse for the next block.
+	 */
+	std::vector<arcstk::sample_t> spare_;
+
+	/**
+	 * \brief Size of the input as reported by the reader.
+	 */
+	AudioSize size_;
+
+	/**
+	 * \brief TRUE iff the input ended.
+	 */
+	bool ended_;
+
+	/**
+	 * \brief TRUE iff the producer is requested to stop.
+	 */
+	bool stopped_;
+
+	/**
+	 * \brief Maximal number of queued blocks, 0 for unlimited.
+	 */
+	std::size_t capacity_;
+
+	/**
+	 * \brief Exception thrown by the producer.
+	 */
+	std::exception_ptr error_;
+
+	/**
+	 * \brief Producer thread, if any.
+	 */
+	std::thread producer_;
+
+	/**
+	 * \brief Guards the state shared with the producer thread.
+	 */
+	mutable std::mutex mutex_;
+
+	/**
+	 * \brief Signals any change of the queue.
+	 */
+	std::condition_variable changed_;
+};
+
+
+SampleBlockQueue::SampleBlockQueue(SampleProcessor* processor)
+	: previous_ { processor }
+	, blocks_   { /* empty */ }
+	, current_  { /* empty */ }
+	, spare_    { /* empty */ }
+	, size_     { /* zero */ }
+	, ended_    { false }
+	, stopped_  { false }
+	, capacity_ { 0 }
+	, error_    { /* empty */ }
+	, producer_ { /* empty */ }
+	, mutex_    { /* default */ }
+	, changed_  { /* default */ }
+{
+	// empty
+}
+
+
+SampleBlockQueue::~SampleBlockQueue() noexcept
+{
+	stop_producer();
+}
+
+
+SampleProcessor* SampleBlockQueue::previous_processor() const
+{
+	return previous_;
+}
+
+
+void SampleBlockQueue::start_producer(std::function<void()> producer,
+		const std::size_t capacity)
+{
+	capacity_ = capacity;
+
+	producer_ = std::thread(
+		[this, producer]()
+		{
+			try
+			{
+				producer();
+			}
+			catch (const ProducerStopped&)
+			{
+				// empty, the consumer closed the input
+			}
+			catch (...)
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				error_ = std::current_exception();
+			}
+
+			finish();
+		});
+}
+
+
+void SampleBlockQueue::stop_producer()
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		stopped_ = true;
+	}
+
+	changed_.notify_all();
+
+	if (producer_.joinable())
+	{
+		producer_.join();
+	}
+}
+
+
+void SampleBlockQueue::wait()
+{
+	auto lock = std::unique_lock<std::mutex> { mutex_ };
+
+	changed_.wait(lock, [this]{ return !blocks_.empty() || ended_; });
+}
+
+
+void SampleBlockQueue::finish()
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		ended_ = true;
+	}
+
+	changed_.notify_all();
+}
+
+
+bool SampleBlockQueue::empty() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	return blocks_.empty();
+}
+
+
+bool SampleBlockQueue::ended() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	return ended_;
+}
+
+
+SampleBlock SampleBlockQueue::pop()
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		if (blocks_.empty())
+		{
+			if (error_)
+			{
+				std::rethrow_exception(error_);
+			}
+
+			return SampleBlock {};
+		}
+
+		spare_ = std::move(current_);
+		current_ = std::move(blocks_.front());
+		blocks_.pop_front();
+	}
+
+	changed_.notify_all();
+
+	return SampleBlock { current_.data(), current_.size() };
+}
+
+
+void SampleBlockQueue::push(std::vector<arcstk::sample_t>& block)
+{
+	auto lock { wait_for_capacity() };
+
+	blocks_.push_back(std::move(block));
+
+	block = std::move(spare_);
+	block.clear();
+	spare_.clear();
+
+	lock.unlock();
+	changed_.notify_all();
+}
+
+
+AudioSize SampleBlockQueue::size() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	return size_;
+}
+
+
+void SampleBlockQueue::do_start_input()
+{
+	// empty
+}
+
+
+void SampleBlockQueue::do_append_samples(SampleInputIterator begin,
+		SampleInputIterator end)
+{
+	auto lock { wait_for_capacity() };
+
+	auto block { std::move(spare_) };
+	block.assign(begin, end);
+	spare_.clear();
+
+	blocks_.push_back(std::move(block));
+
+	lock.unlock();
+	changed_.notify_all();
+}
+
+
+void SampleBlockQueue::do_update_audiosize(const AudioSize& size)
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	size_ = size;
+}
+
+
+void SampleBlockQueue::do_end_input()
+{
+	finish();
+}
+
+
+std::unique_lock<std::mutex> SampleBlockQueue::wait_for_capacity()
+{
+	auto lock = std::unique_lock<std::mutex> { mutex_ };
+
+	if (capacity_ > 0)
+	{
+		changed_.wait(lock,
+			[this]{ return blocks_.size() < capacity_ || stopped_; });
+	}
+
+	if (stopped_)
+	{
+		throw ProducerStopped {};
+	}
+
+	return lock;
+}
+
+} // namespace details
+
+
+// SampleBlock
+
+
+SampleBlock::SampleBlock()
+	: data_ { nullptr }
+	, size_ { 0 }
+{
+	// empty
+}
+
+
+SampleBlock::SampleBlock(const arcstk::sample_t* data, const std::size_t size)
+	: data_ { data }
+	, size_ { size }
+{
+	// empty
+}
+
+
+const arcstk::sample_t* SampleBlock::data() const noexcept
+{
+	return data_;
+}
+
+
+std::size_t SampleBlock::size() const noexcept
+{
+	return size_;
+}
+
+
+bool SampleBlock::empty() const noexcept
+{
+	return size_ == 0;
+}
+
+
+const arcstk::sample_t* SampleBlock::begin() const noexcept
+{
+	return data_;
+}
+
+
+const arcstk::sample_t* SampleBlock::end() const noexcept
+{
+	return data_ + size_;
+}
+
+
 // MAX_SAMPLES_TO_READ
 
 
@@ -229,6 +887,12 @@ void AudioValidator::error(const std::string& msg)
 }
 
 
+void AudioValidator::clear_errors()
+{
+	errors_.clear();
+}
+
+
 const std::string& AudioValidator::last_error() const
 {
 	return errors_.back();
@@ -418,44 +1082,208 @@ void DefaultValidator::on_failure()
 // AudioReaderImpl
 
 
-AudioReaderImpl::AudioReaderImpl()
-	: processor_        { /* empty */ }
-	, samples_per_read_ { BLOCKSIZE::DEFAULT }
+AudioReaderImpl::AudioReaderImpl()
+	: processor_          { /* empty */ }
+	, samples_per_read_   { BLOCKSIZE::DEFAULT }
+	, blocks_             { /* empty */ }
+	, statistics_         { /* empty */ }
+	, statistics_enabled_ { false }
+	, started_            { /* empty */ }
+	, opened_             { /* empty */ }
+	, bytes_before_       { 0 }
+{
+	// empty
+}
+
+
+AudioReaderImpl::~AudioReaderImpl() noexcept
+{
+	// The subclass is already destroyed, thus do_close() cannot be called.
+	// Subclasses with a producer thread stop it in their destructor, since
+	// the thread calls the subclass. This is the last resort.
+
+	this->stop_producer();
+}
+
+
+AudioReaderImpl::AudioReaderImpl(AudioReaderImpl&&) noexcept = default;
+
+
+AudioReaderImpl& AudioReaderImpl::operator = (AudioReaderImpl&&) noexcept
+= default;
+
+
+std::unique_ptr<AudioSize> AudioReaderImpl::acquire_size(
+		const std::string& filename)
+{
+	return this->do_acquire_size(filename);
+}
+
+
+void AudioReaderImpl::process_file(const std::string& filename)
+{
+	ARCS_LOG_DEBUG << "Process audio file " << filename;
+
+	this->start_statistics();
+
+	ARCSDEC_TRACE3(file_open, statistics_.file_id, filename.c_str(),
+			statistics_.reader_id.c_str());
+
+	try
+	{
+		this->do_process_file(filename);
+	}
+	catch (const std::exception& e)
+	{
+		ARCSDEC_TRACE3(read_error, statistics_.file_id,
+				statistics_.reader_id.c_str(), e.what());
+		throw;
+	}
+
+	this->finish_statistics(filename);
+}
+
+
+void AudioReaderImpl::process_range(const std::string& filename,
+		const int64_t first, const int64_t total)
+{
+	ARCS_LOG_DEBUG << "Process " << total << " samples from sample " << first
+		<< " of audio file " << filename;
+
+	this->start_statistics();
+
+	ARCSDEC_TRACE3(file_open, statistics_.file_id, filename.c_str(),
+			statistics_.reader_id.c_str());
+
+	try
+	{
+		this->do_process_range(filename, first, total);
+	}
+	catch (const std::exception& e)
+	{
+		ARCSDEC_TRACE3(read_error, statistics_.file_id,
+				statistics_.reader_id.c_str(), e.what());
+		throw;
+	}
+
+	this->finish_statistics(filename);
+}
+
+
+void AudioReaderImpl::open(const std::string& filename)
+{
+	if (blocks_)
+	{
+		throw std::logic_error("Cannot open " + filename
+				+ ", another input is open");
+	}
+
+	ARCS_LOG_DEBUG << "Open audio file " << filename << " to read blocks";
+
+	blocks_ = std::make_unique<details::SampleBlockQueue>(processor_);
+	this->attach_processor_impl(*blocks_);
+
+	statistics_.file_id = next_file_id();
+
+	if (details::tracepoints_enabled)
+	{
+		ARCSDEC_TRACE3(file_open, statistics_.file_id, filename.c_str(),
+				reader_id(*this).c_str());
+	}
+
+	try
+	{
+		this->do_open(filename);
+	}
+	catch (const std::exception& e)
+	{
+		if (details::tracepoints_enabled)
+		{
+			ARCSDEC_TRACE3(read_error, statistics_.file_id,
+					reader_id(*this).c_str(), e.what());
+		}
+
+		this->close();
+		throw;
+	}
+	catch (...)
+	{
+		this->close();
+		throw;
+	}
+}
+
+
+SampleBlock AudioReaderImpl::next_block()
+{
+	if (!blocks_)
+	{
+		throw std::logic_error("Cannot read next block, no input is open");
+	}
+
+	while (blocks_->empty() && !blocks_->ended())
+	{
+		if (!this->do_read_block())
+		{
+			blocks_->finish();
+		}
+	}
+
+	return blocks_->pop();
+}
+
+
+AudioSize AudioReaderImpl::input_size() const
+{
+	return blocks_ ? blocks_->size() : AudioSize {};
+}
+
+
+void AudioReaderImpl::close()
 {
-	// empty
-}
+	if (!blocks_)
+	{
+		return;
+	}
 
+	blocks_->stop_producer();
 
-AudioReaderImpl::AudioReaderImpl(AudioReaderImpl&&) noexcept = default;
+	this->do_close();
 
+	processor_ = blocks_->previous_processor();
+	blocks_.reset();
 
-AudioReaderImpl& AudioReaderImpl::operator = (AudioReaderImpl&&) noexcept
-= default;
+	ARCS_LOG_DEBUG << "Closed audio file";
+}
 
 
-std::unique_ptr<AudioSize> AudioReaderImpl::acquire_size(
-		const std::string& filename)
+void AudioReaderImpl::set_samples_per_read(const int64_t samples_per_read)
 {
-	return this->do_acquire_size(filename);
+	samples_per_read_ = samples_per_read;
 }
 
 
-void AudioReaderImpl::process_file(const std::string& filename)
+int64_t AudioReaderImpl::samples_per_read() const
 {
-	ARCS_LOG_DEBUG << "Process audio file " << filename;
-	this->do_process_file(filename);
+	return samples_per_read_;
 }
 
 
-void AudioReaderImpl::set_samples_per_read(const int64_t samples_per_read)
+const ReaderStatistics& AudioReaderImpl::statistics() const
 {
-	samples_per_read_ = samples_per_read;
+	return statistics_;
 }
 
 
-int64_t AudioReaderImpl::samples_per_read() const
+void AudioReaderImpl::set_statistics_enabled(const bool enabled)
 {
-	return samples_per_read_;
+	statistics_enabled_ = enabled;
+}
+
+
+bool AudioReaderImpl::statistics_enabled() const
+{
+	return statistics_enabled_;
 }
 
 
@@ -492,6 +1320,20 @@ std::unique_ptr<FileReaderDescriptor> AudioReaderImpl::descriptor() const
 }
 
 
+bool AudioReaderImpl::reset()
+{
+	this->close();
+
+	processor_          = nullptr;
+	samples_per_read_   = BLOCKSIZE::DEFAULT;
+	statistics_         = ReaderStatistics {};
+	statistics_enabled_ = false;
+	bytes_before_       = 0;
+
+	return this->do_reset();
+}
+
+
 void AudioReaderImpl::attach_processor_impl(SampleProcessor& processor)
 {
 	processor_ = &processor;
@@ -504,6 +1346,96 @@ SampleProcessor* AudioReaderImpl::use_processor()
 }
 
 
+void AudioReaderImpl::signal_appendbuffer(
+		std::vector<arcstk::sample_t>& samples)
+{
+	if (!blocks_ || use_processor() != blocks_.get())
+	{
+		using std::cbegin;
+		using std::cend;
+
+		this->signal_appendsamples(cbegin(samples), cend(samples));
+		return;
+	}
+
+	ARCSDEC_TRACE2(block, statistics_.file_id, samples.size());
+
+	blocks_->push(samples);
+}
+
+
+void AudioReaderImpl::stop_producer() noexcept
+{
+	if (blocks_)
+	{
+		blocks_->stop_producer();
+	}
+}
+
+
+void AudioReaderImpl::start_statistics()
+{
+	statistics_ = ReaderStatistics {};
+	statistics_.file_id = next_file_id();
+
+	opened_  = std::chrono::steady_clock::time_point {};
+	started_ = std::chrono::steady_clock::time_point {};
+
+	// The id requires a descriptor, thus it is only created if required
+
+	if (statistics_enabled_ || details::tracepoints_enabled)
+	{
+		statistics_.reader_id = reader_id(*this);
+	}
+
+	if (!statistics_enabled_)
+	{
+		return;
+	}
+
+	bytes_before_ = thread_bytes_read();
+	started_      = std::chrono::steady_clock::now();
+}
+
+
+void AudioReaderImpl::finish_statistics(const std::string& filename)
+{
+	ARCSDEC_TRACE3(file_close, statistics_.file_id, statistics_.samples,
+			statistics_.blocks);
+
+	if (started_ == std::chrono::steady_clock::time_point {})
+	{
+		ARCS_LOG(DEBUG1) << "Read " << statistics_.samples << " samples in "
+			<< statistics_.blocks << " blocks from " << filename;
+		return;
+	}
+
+	const auto total_seconds { seconds_since(started_) };
+
+	if (opened_ != std::chrono::steady_clock::time_point {})
+	{
+		statistics_.open_seconds = std::chrono::duration<double> {
+			opened_ - started_ }.count();
+	}
+
+	statistics_.decode_seconds = std::max(0.0, total_seconds
+			- statistics_.open_seconds - statistics_.processing_seconds);
+
+	const auto bytes_after { thread_bytes_read() };
+
+	if (bytes_before_ >= 0 && bytes_after >= bytes_before_)
+	{
+		statistics_.bytes_read = bytes_after - bytes_before_;
+	}
+
+	started_ = std::chrono::steady_clock::time_point {};
+
+	ARCS_LOG(DEBUG1) << "Read " << statistics_.samples << " samples in "
+		<< statistics_.blocks << " blocks from " << filename << " in "
+		<< total_seconds << " seconds";
+}
+
+
 void AudioReaderImpl::do_signal_startinput()
 {
 	use_processor()->start_input();
@@ -513,12 +1445,44 @@ void AudioReaderImpl::do_signal_startinput()
 void AudioReaderImpl::do_signal_appendsamples(
 		SampleInputIterator begin, SampleInputIterator end)
 {
+	const auto samples { std::distance(begin, end) };
+
+	ARCSDEC_TRACE2(block, statistics_.file_id, samples);
+
+	++statistics_.blocks;
+	statistics_.samples += samples;
+	statistics_.peak_block_bytes = std::max(statistics_.peak_block_bytes,
+			static_cast<std::size_t>(samples) * sizeof(arcstk::sample_t));
+
+	// The clock is only read if statistics are enabled
+
+	if (started_ == std::chrono::steady_clock::time_point {})
+	{
+		use_processor()->append_samples(begin, end);
+		return;
+	}
+
+	const auto start { std::chrono::steady_clock::now() };
+
+	if (opened_ == std::chrono::steady_clock::time_point {})
+	{
+		opened_ = start;
+	}
+
 	use_processor()->append_samples(begin, end);
+
+	statistics_.processing_seconds += seconds_since(start);
 }
 
 
 void AudioReaderImpl::do_signal_updateaudiosize(const AudioSize& size)
 {
+	if (started_ != std::chrono::steady_clock::time_point {}
+		&& opened_ == std::chrono::steady_clock::time_point {})
+	{
+		opened_ = std::chrono::steady_clock::now();
+	}
+
 	use_processor()->update_audiosize(size);
 }
 
@@ -541,6 +1505,71 @@ const SampleProcessor* AudioReaderImpl::do_processor() const
 }
 
 
+void AudioReaderImpl::do_process_range(const std::string& filename,
+		const int64_t first, const int64_t total)
+{
+	auto processor { use_processor() };
+
+	if (!processor)
+	{
+		throw std::logic_error("No SampleProcessor attached");
+	}
+
+	ARCS_LOG(DEBUG1) << "Reader cannot seek, process entire file";
+
+	auto filter = SampleRangeFilter { *processor, first, total };
+	this->attach_processor_impl(filter);
+
+	try
+	{
+		this->do_process_file(filename);
+	}
+	catch (...)
+	{
+		this->attach_processor_impl(*processor);
+		throw;
+	}
+
+	this->attach_processor_impl(*processor);
+}
+
+
+void AudioReaderImpl::do_open(const std::string& filename)
+{
+	ARCS_LOG(DEBUG1) << "Reader cannot read single blocks, process file "
+		<< "on separate thread";
+
+	// Two blocks let the producer decode the next block while the caller
+	// processes the current one
+
+	blocks_->start_producer(
+		[this, filename]()
+		{
+			this->do_process_file(filename);
+		}, 2);
+}
+
+
+bool AudioReaderImpl::do_read_block()
+{
+	blocks_->wait();
+
+	return true;
+}
+
+
+void AudioReaderImpl::do_close()
+{
+	// empty
+}
+
+
+bool AudioReaderImpl::do_reset()
+{
+	return false;
+}
+
+
 // Audioreader::Impl
 
 
@@ -567,6 +1596,11 @@ public:
 	 */
 	explicit Impl(std::unique_ptr<AudioReaderImpl> readerimpl);
 
+	/**
+	 * Destructor, closes the open input.
+	 */
+	~Impl() noexcept;
+
 	Impl(const Impl& rhs) = delete;
 	Impl& operator = (const Impl& rhs) = delete;
 
@@ -596,6 +1630,58 @@ public:
 	 */
 	void process_file(const std::string& filename);
 
+	/**
+	 *
+	 * \param[in] filename Audiofile to process
+	 * \param[in] first    Index of the first sample to process
+	 * \param[in] total    Total number of samples to process
+	 */
+	void process_range(const std::string& filename, const int64_t first,
+			const int64_t total);
+
+	/**
+	 *
+	 * \param[in] filename Audiofile to open
+	 */
+	void open(const std::string& filename);
+
+	/**
+	 *
+	 * \return The next block of samples
+	 */
+	SampleBlock next_block();
+
+	/**
+	 *
+	 * \return Size of the open input
+	 */
+	AudioSize input_size() const;
+
+	/**
+	 * Close the open input.
+	 */
+	void close();
+
+	/**
+	 *
+	 * \return Statistics about the last input processed
+	 */
+	const ReaderStatistics& statistics() const;
+
+	/**
+	 * \brief Enable or disable measuring the times and bytes read.
+	 *
+	 * \param[in] enabled TRUE iff times and bytes read are to be measured
+	 */
+	void set_statistics_enabled(const bool enabled);
+
+	/**
+	 * \brief TRUE iff the times and bytes read are measured.
+	 *
+	 * \return TRUE iff times and bytes read are measured
+	 */
+	bool statistics_enabled() const;
+
 	/**
 	 * \brief Create a descriptor for this AudioReader implementation.
 	 *
@@ -603,6 +1689,13 @@ public:
 	 */
 	std::unique_ptr<FileReaderDescriptor> descriptor() const;
 
+	/**
+	 * \brief Prepare the reader for another input.
+	 *
+	 * \return TRUE iff the reader can be used for another input
+	 */
+	bool reset();
+
 	/**
 	 *
 	 * \param[in] processor The SampleProcessor to use
@@ -639,6 +1732,24 @@ AudioReader::Impl::Impl(std::unique_ptr<AudioReaderImpl> readerimpl)
 }
 
 
+AudioReader::Impl::~Impl() noexcept
+{
+	if (!readerimpl_)
+	{
+		return;
+	}
+
+	try
+	{
+		readerimpl_->close();
+	}
+	catch (const std::exception& e)
+	{
+		ARCS_LOG_WARNING << "Closing the audio file failed: " << e.what();
+	}
+}
+
+
 void AudioReader::Impl::set_samples_per_read(const int64_t samples_per_read)
 {
 	readerimpl_->set_samples_per_read(samples_per_read);
@@ -684,12 +1795,73 @@ void AudioReader::Impl::process_file(const std::string& filename)
 }
 
 
+void AudioReader::Impl::process_range(const std::string& filename,
+		const int64_t first, const int64_t total)
+{
+	ARCS_LOG_DEBUG << "Start to process range of audio file '" << filename
+		<< "'";
+
+	readerimpl_->process_range(filename, first, total);
+
+	ARCS_LOG_DEBUG << "Sucessfully processed range of audio file '"
+		<< filename << "'";
+}
+
+
+void AudioReader::Impl::open(const std::string& filename)
+{
+	readerimpl_->open(filename);
+}
+
+
+SampleBlock AudioReader::Impl::next_block()
+{
+	return readerimpl_->next_block();
+}
+
+
+AudioSize AudioReader::Impl::input_size() const
+{
+	return readerimpl_->input_size();
+}
+
+
+void AudioReader::Impl::close()
+{
+	readerimpl_->close();
+}
+
+
+const ReaderStatistics& AudioReader::Impl::statistics() const
+{
+	return readerimpl_->statistics();
+}
+
+
+void AudioReader::Impl::set_statistics_enabled(const bool enabled)
+{
+	readerimpl_->set_statistics_enabled(enabled);
+}
+
+
+bool AudioReader::Impl::statistics_enabled() const
+{
+	return readerimpl_->statistics_enabled();
+}
+
+
 std::unique_ptr<FileReaderDescriptor> AudioReader::Impl::descriptor() const
 {
 	return readerimpl_->descriptor();
 }
 
 
+bool AudioReader::Impl::reset()
+{
+	return readerimpl_->reset();
+}
+
+
 void AudioReader::Impl::set_processor(SampleProcessor& processor)
 {
 	readerimpl_->attach_processor(processor);
@@ -765,6 +1937,55 @@ void AudioReader::process_file(const std::string& filename)
 }
 
 
+void AudioReader::process_range(const std::string& filename,
+		const int64_t first, const int64_t total)
+{
+	impl_->process_range(filename, first, total);
+}
+
+
+void AudioReader::open(const std::string& filename)
+{
+	impl_->open(filename);
+}
+
+
+SampleBlock AudioReader::next_block()
+{
+	return impl_->next_block();
+}
+
+
+AudioSize AudioReader::input_size() const
+{
+	return impl_->input_size();
+}
+
+
+void AudioReader::close()
+{
+	impl_->close();
+}
+
+
+const ReaderStatistics& AudioReader::statistics() const
+{
+	return impl_->statistics();
+}
+
+
+void AudioReader::set_statistics_enabled(const bool enabled)
+{
+	impl_->set_statistics_enabled(enabled);
+}
+
+
+bool AudioReader::statistics_enabled() const
+{
+	return impl_->statistics_enabled();
+}
+
+
 void AudioReader::set_processor(SampleProcessor& processor)
 {
 	impl_->set_processor(processor);
@@ -776,6 +1997,12 @@ std::unique_ptr<FileReaderDescriptor> AudioReader::do_descriptor() const
 	return impl_->descriptor();
 }
 
+
+bool AudioReader::do_reset()
+{
+	return impl_->reset();
+}
+
 } // namespace v_1_0_0
 
 } // namespace arcsdec
@@ -20,12 +20,18 @@
 #ifndef __LIBARCSDEC_AUDIOREADER_HPP__
 #include "audioreader.hpp"      // for AudioReader
 #endif
+#ifndef __LIBARCSDEC_LOGLEVEL_HPP__
+#include "loglevel.hpp"         // for ARCSDEC_LOG
+#endif
 #ifndef __LIBARCSDEC_METAPARSER_HPP__
 #include "metaparser.hpp"       // for MetadataParser
 #endif
 #ifndef __LIBARCSDEC_SAMPLEPROC_HPP__
 #include "sampleproc.hpp"       // for SampleProcessor, BLOCKSIZE
 #endif
+#ifndef __LIBARCSDEC_TRACEPOINTS_HPP__
+#include "tracepoints.hpp"      // for ARCSDEC_TRACE3
+#endif
 
 #ifndef __LIBARCSTK_ALGORITHMS_HPP__
 #include <arcstk/algorithms.hpp>// for AccurateRip::V1andV2...
@@ -43,11 +49,32 @@
 #include <arcstk/logging.hpp>   // for ARCS_LOG, _ERROR, _WARNING, _INFO, _DEBUG
 #endif
 
-#include <cstdint>       // for uint16_t, int64_t
+extern "C"
+{
+#include <fcntl.h>       // for open, posix_fadvise, O_RDONLY
+#include <sys/stat.h>    // for stat
+#include <unistd.h>      // for close
+}
+
+#include <algorithm>     // for find, find_if, for_each, transform
+#include <array>         // for array
+#include <atomic>        // for atomic
+#include <cstddef>       // for size_t
+#include <cstdint>       // for int64_t
 #include <iterator>      // for distance
-#include <memory>        // for unique_ptr, make_unique
-#include <stdexcept>     // for logic_error, runtime_error
+#include <limits>        // for numeric_limits
+#include <memory>        // for unique_ptr, make_unique, make_shared
+#include <exception>     // for exception
+#include <fstream>       // for ifstream
+#include <future>        // for async, future
+#include <istream>       // for istream
+#include <mutex>         // for mutex, lock_guard
+#include <ostream>       // for ostream
+#include <stdexcept>     // for invalid_argument, logic_error, runtime_error
 #include <string>        // for string, to_string
+#include <thread>        // for thread
+#include <tuple>         // for tuple, make_tuple
+#include <unordered_map> // for unordered_map
 #include <unordered_set> // for unordered_set
 #include <utility>       // for pair, move, make_pair
 #include <vector>        // for vector
@@ -60,6 +87,7 @@ inline namespace v_1_0_0
 
 using arcstk::ARId;
 using arcstk::AudioSize;
+using arcstk::CDDA;
 using arcstk::Calculation;
 using arcstk::ChecksumSet;
 using arcstk::Checksums;
@@ -68,6 +96,7 @@ using arcstk::Points;
 using arcstk::SampleInputIterator;
 using arcstk::Settings;
 using arcstk::ToC;
+using arcstk::UNIT;
 using arcstk::make_arid;
 
 
@@ -198,39 +227,135 @@ Checksums merge_results(const std::vector<Calculation>& calculations)
 }
 
 
-// process_audio_file
+// merge_result
 
 
-void process_audio_file(const std::string& audiofilename,
-		std::unique_ptr<AudioReader> reader, const int64_t buffer_size,
+ChecksumSet merge_result(const std::vector<Calculation>& calculations,
+		const std::size_t index)
+{
+	auto track = ChecksumSet { 0 };
+
+	for (const auto& c : calculations)
+	{
+		const auto checksums { c.result() };
+
+		if (index < checksums.size())
+		{
+			track.merge(checksums[index]);
+			track.set_length(checksums[index].length());
+		}
+	}
+
+	return track;
+}
+
+
+// configure_reader
+
+
+void configure_reader(AudioReader& reader, const int64_t buffer_size,
 		SampleProcessor& processor)
 {
 	using std::to_string;
 
-	// Configure AudioReader and process file
-
 	if (BLOCKSIZE::MIN <= buffer_size and buffer_size <= BLOCKSIZE::MAX)
 	{
 		ARCS_LOG(DEBUG1) << "Chunk size for reading samples: "
 			<< to_string(buffer_size) << " bytes";
 
-		reader->set_samples_per_read(buffer_size);
+		reader.set_samples_per_read(buffer_size);
 
 	} else
 	{
-		// Buffer size is illegal.
-		// Do nothing, AudioReaderImpl uses its default.
+		// Buffer size is illegal, use the default. The reader may have been
+		// used before with a different size.
 
 		ARCS_LOG_WARNING << "Specified buffer size of " << buffer_size
 			<< " bytes is not within the legal range of "
 			<< BLOCKSIZE::MIN << " - " << BLOCKSIZE::MAX
 			<< " samples. Fall back to default: "
-			<< reader->samples_per_read()
+			<< BLOCKSIZE::DEFAULT
 			<< " bytes";
+
+		reader.set_samples_per_read(BLOCKSIZE::DEFAULT);
+	}
+
+	reader.set_processor(processor);
+}
+
+
+// process_audio_file
+
+
+void process_audio_file(const std::string& audiofilename,
+		AudioReader& reader, const int64_t buffer_size,
+		SampleProcessor& processor)
+{
+	configure_reader(reader, buffer_size, processor);
+	reader.process_file(audiofilename);
+}
+
+
+// process_audio_range
+
+
+void process_audio_range(const std::string& audiofilename,
+		AudioReader& reader, const int64_t buffer_size,
+		const int64_t first, const int64_t total,
+		SampleProcessor& processor)
+{
+	configure_reader(reader, buffer_size, processor);
+	reader.process_range(audiofilename, first, total);
+}
+
+
+// log_incomplete
+
+
+void log_incomplete(const std::vector<Calculation>& calculations)
+{
+	for (const auto& c : calculations)
+	{
+		if (not c.complete())
+		{
+			ARCS_LOG_ERROR << "Calculation not complete "
+				"after last input sample: "
+				<< "Expected total samples: " << c.samples_expected()
+				<< " "
+				<< "Processed total samples: " << c.samples_processed();
+		}
+
+		if (c.samples_todo() < 0)
+		{
+			ARCS_LOG_WARNING << "More samples than expected. "
+				<< "Expected: " << c.samples_expected()
+				<< " "
+				<< "Processed: " << c.samples_processed();
+		}
+	}
+}
+
+
+// prefetch_file
+
+
+void prefetch_file(const std::string& filename)
+{
+#ifdef POSIX_FADV_WILLNEED
+	const auto fd { ::open(filename.c_str(), O_RDONLY) };
+
+	if (fd < 0)
+	{
+		return;
 	}
 
-	reader->set_processor(processor);
-	reader->process_file(audiofilename);
+	ARCS_LOG(DEBUG1) << "Prefetch file " << filename;
+
+	::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+	::close(fd);
+#else
+	static_cast<void>(filename);
+#endif
 }
 
 
@@ -252,6 +377,118 @@ AudioSize ensure_leadout(const AudioSize& leadout,
 }
 
 
+// write_le
+
+
+void write_le(std::ostream& out, const uint64_t value, const int bytes)
+{
+	for (auto i { 0 }; i < bytes; ++i)
+	{
+		out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+	}
+}
+
+
+// read_le
+
+
+uint64_t read_le(std::istream& in, const int bytes)
+{
+	auto value = uint64_t { 0 };
+
+	for (auto i { 0 }; i < bytes; ++i)
+	{
+		const auto byte { in.get() };
+
+		if (byte == std::istream::traits_type::eof())
+		{
+			throw std::runtime_error("Unexpected end of input");
+		}
+
+		value |= static_cast<uint64_t>(byte & 0xFF) << (8 * i);
+	}
+
+	return value;
+}
+
+
+// file_identity
+
+
+std::string file_identity(const std::string& filename)
+{
+	struct ::stat stat_buf;
+
+	if (::stat(filename.c_str(), &stat_buf) != 0)
+	{
+		return std::string {};
+	}
+
+	// The nanoseconds recognize a file rewritten within the same second
+
+	return "inode:" + std::to_string(stat_buf.st_dev)
+		+ ":" + std::to_string(stat_buf.st_ino)
+		+ ":" + std::to_string(stat_buf.st_size)
+		+ ":" + std::to_string(stat_buf.st_mtim.tv_sec)
+		+ "." + std::to_string(stat_buf.st_mtim.tv_nsec);
+}
+
+
+// flac_content_identity
+
+
+std::string flac_content_identity(const std::string& filename)
+{
+	// Magic number, header of the first metadata block and STREAMINFO
+
+	auto header = std::array<unsigned char, 4 + 4 + 34> {};
+
+	auto in = std::ifstream { filename, std::ios::in | std::ios::binary };
+
+	if (!in.read(reinterpret_cast<char*>(header.data()), header.size()))
+	{
+		return std::string {};
+	}
+
+	// STREAMINFO is mandatory and always the first block
+
+	if (header[0] != 'f' || header[1] != 'L' || header[2] != 'a'
+		|| header[3] != 'C' || (header[4] & 0x7F) != 0
+		|| header[5] != 0 || header[6] != 0 || header[7] != 34)
+	{
+		return std::string {};
+	}
+
+	// Sample rate, channels, bits per sample and total samples start at byte
+	// 10 of STREAMINFO, the MD5 occupies its last 16 bytes
+
+	const auto format { header.begin() + 18 };
+	const auto md5    { header.begin() + 26 };
+
+	const auto has_samples { (format[3] & 0x0F) != 0
+		|| std::any_of(format + 4, md5, [](unsigned char b){ return b; }) };
+	const auto has_md5 {
+		std::any_of(md5, header.end(), [](unsigned char b){ return b; }) };
+
+	if (!has_samples || !has_md5)
+	{
+		return std::string {};
+	}
+
+	static const char hex[] = "0123456789abcdef";
+
+	auto identity = std::string { "flac:" };
+
+	std::for_each(format, header.end(), [&identity](unsigned char b)
+		{
+			identity += hex[b >> 4];
+			identity += hex[b & 0x0F];
+		});
+
+	return identity;
+}
+
+
 // CalculationProcessor
 
 
@@ -292,7 +529,7 @@ void CalculationProcessor::do_start_input()
 void CalculationProcessor::do_append_samples(SampleInputIterator begin,
 		SampleInputIterator end)
 {
-	ARCS_LOG(DEBUG2) << "CalculationProcessor received: APPEND SAMPLES";
+	ARCSDEC_LOG(DEBUG2) << "CalculationProcessor received: APPEND SAMPLES";
 
 	++total_sequences_;
 
@@ -331,6 +568,7 @@ int64_t CalculationProcessor::samples_processed() const
 
 MultiCalculationProcessor::MultiCalculationProcessor()
 	: processors_ { /* default */ }
+	, audiosize_  { /* zero */ }
 {
 	// empty
 }
@@ -342,6 +580,12 @@ void MultiCalculationProcessor::add(Calculation& c)
 }
 
 
+AudioSize MultiCalculationProcessor::audiosize() const
+{
+	return audiosize_;
+}
+
+
 void MultiCalculationProcessor::do_start_input()
 {
 	ARCS_LOG(DEBUG2) << "MultiCalculationProcessor received: START INPUT";
@@ -360,7 +604,7 @@ void MultiCalculationProcessor::do_start_input()
 void MultiCalculationProcessor::do_append_samples(SampleInputIterator start,
 		SampleInputIterator stop)
 {
-	ARCS_LOG(DEBUG2) << "MultiCalculationProcessor received: APPEND SAMPLES";
+	ARCSDEC_LOG(DEBUG2) << "MultiCalculationProcessor received: APPEND SAMPLES";
 
 	using std::begin;
 	using std::end;
@@ -377,6 +621,8 @@ void MultiCalculationProcessor::do_update_audiosize(const AudioSize& size)
 {
 	ARCS_LOG(DEBUG2) << "MultiCalculationProcessor received: UPDATE AUDIOSIZE";
 
+	audiosize_ = size;
+
 	using std::begin;
 	using std::end;
 
@@ -402,214 +648,1732 @@ void MultiCalculationProcessor::do_end_input()
 			});
 }
 
-} // namespace details
-
-
-// calculate.hpp
 
 
-// default_selection()
+// ConcatenationProcessor
 
 
-template <>
-const FileReaderSelection* default_selection<AudioReader>()
+ConcatenationProcessor::ConcatenationProcessor(SampleProcessor& target)
+	: target_        { &target }
+	, started_       { false }
+	, total_samples_ { 0 }
 {
-	return FileReaderRegistry::default_audio_selection();
+	// empty
 }
 
 
-template <>
-const FileReaderSelection* default_selection<MetadataParser>()
+void ConcatenationProcessor::finish()
 {
-	return FileReaderRegistry::default_toc_selection();
+	target_->end_input();
 }
 
 
-// ReaderAndFormatHolder
-
-
-ReaderAndFormatHolder::ReaderAndFormatHolder()
-	: formats_      { FileReaderRegistry::formats() }
-	, descriptors_  { FileReaderRegistry::readers() }
+int64_t ConcatenationProcessor::samples_processed() const
 {
-	/* empty */
+	return total_samples_;
 }
 
 
-ReaderAndFormatHolder::~ReaderAndFormatHolder() noexcept = default;
-
-
-void ReaderAndFormatHolder::set_formats(const FormatList* formats)
+void ConcatenationProcessor::do_start_input()
 {
-	formats_ = formats;
+	if (!started_)
+	{
+		started_ = true;
+		target_->start_input();
+	}
 }
 
 
-const FormatList* ReaderAndFormatHolder::formats() const
+void ConcatenationProcessor::do_append_samples(SampleInputIterator start,
+		SampleInputIterator stop)
 {
-	return formats_;
+	total_samples_ += std::distance(start, stop);
+	target_->append_samples(start, stop);
 }
 
 
-void ReaderAndFormatHolder::set_readers(const FileReaders* descriptors)
+void ConcatenationProcessor::do_update_audiosize(const AudioSize& /* size */)
 {
-	descriptors_ = descriptors;
+	// empty, the target knows the size of the entire stream
 }
 
 
-const FileReaders* ReaderAndFormatHolder::readers() const
+void ConcatenationProcessor::do_end_input()
 {
-	return descriptors_;
+	// empty, the stream ends with finish()
 }
 
 
-// ToCParser
+// TrackCompletionProcessor
 
 
-std::unique_ptr<ToC> ToCParser::parse(const std::string& metafilename) const
+TrackCompletionProcessor::TrackCompletionProcessor(SampleProcessor& target,
+		const std::vector<Calculation>& calculations, const Points& offsets,
+		const int first_track,
+		const std::function<void(const int, const ChecksumSet&)>& callback)
+	: target_           { &target }
+	, calculations_     { &calculations }
+	, boundaries_       {}
+	, first_track_      { first_track }
+	, callback_         { callback }
+	, total_samples_    { 0 }
+	, tracks_completed_ { 0 }
 {
-	if (metafilename.empty())
-	{
-		ARCS_LOG_ERROR <<
-			"ToC info was requested but metadata filename was empty";
+	// Each track ends where the next track starts
 
-		throw FileReadException(
-				"Requested metadata file parser for empty filename.");
+	for (auto i = std::size_t { 1 }; i < offsets.size(); ++i)
+	{
+		boundaries_.push_back(offsets[i].samples());
 	}
-
-	return create(metafilename)->parse(metafilename);
 }
 
 
-// AudioInfo
-
-
-std::unique_ptr<AudioSize> AudioInfo::size(const std::string& filename) const
+void TrackCompletionProcessor::notify_next()
 {
-	return create(filename)->acquire_size(filename);
-}
+	++tracks_completed_;
 
+	// Only the completed track is merged, not all tracks
 
-// ARCSCalculator
+	callback_(first_track_ + tracks_completed_ - 1,
+			merge_result(*calculations_,
+				static_cast<std::size_t>(tracks_completed_ - 1)));
+}
 
 
-ARCSCalculator::ARCSCalculator(const ChecksumtypeSet& typeset)
-	: types_             { typeset }
-	, read_buffer_size_  { BLOCKSIZE::DEFAULT }
+void TrackCompletionProcessor::do_start_input()
 {
-	/* empty */
+	total_samples_    = 0;
+	tracks_completed_ = 0;
+
+	target_->start_input();
 }
 
 
-ARCSCalculator::ARCSCalculator()
-	: ARCSCalculator(
-			{ arcstk::checksum::type::ARCS1, arcstk::checksum::type::ARCS2 })
+void TrackCompletionProcessor::do_append_samples(SampleInputIterator start,
+		SampleInputIterator stop)
 {
-	/* empty */
-}
+	auto remaining { std::distance(start, stop) };
 
+	// Split the sequence at each track boundary it contains
 
-std::pair<Checksums, ToC> ARCSCalculator::calculate(
-		const std::string& audiofilename,
-		const ToC& toc)
-{
-	ARCS_LOG_DEBUG << "Calculate by ToC and single audiofilename";
+	while (static_cast<std::size_t>(tracks_completed_) < boundaries_.size())
+	{
+		const auto to_boundary {
+			boundaries_[static_cast<std::size_t>(tracks_completed_)]
+				- total_samples_ };
 
-	// A Calculation requires two informations about the input audio data:
-	//
-	// 1.) the LBA offset of each track
-	//	=>	which are either known at this point by inspecting the ToC or by
-	//		knowing that the audiofile represents a single track.
-	//
-	// 2.) the size of the audio input, which requires to know at least one of
-	// the following four:
-	//	a) the LBA track offset of the leadout frame
-	//	b) the total number of 16bit samples in <audiofilename>
-	//	c) the total number of bytes in <audiofilename> representing samples
-	//	d) the length of the last track
-	//	=>	which may or may not be represented in the ToC
+		if (to_boundary > remaining)
+		{
+			break;
+		}
 
-	// Not all ToC providing file formats contain sufficient information to
-	// calculate the leadout - simple CueSheets for example do not. Therefore,
-	// ToCs are accepted to be incomplete up to this point. They may contain
-	// only the offstes but not the leadout.
+		if (to_boundary > 0)
+		{
+			const auto boundary { start + to_boundary };
 
-	// However, this means we additionally have to inspect the audio file to get
-	// the missing information.
+			target_->append_samples(start, boundary);
 
-	// The total PCM byte count is exclusively known to the AudioReader in
-	// the process of reading the audio file. (We cannot deduce it from the
-	// mere file size.) However, we do not intend to actually read the audio
-	// samples. Hence, to know the leadout, we actually have to create an
-	// AudioReader, open the file and get the information. Since this is an
-	// expensive operation, we want to keep the reader.
+			start           = boundary;
+			remaining      -= to_boundary;
+			total_samples_ += to_boundary;
+		}
 
-	const auto [ track_checksums, leadout ] {
-		calculate(audiofilename, Context::ALBUM, types(),
-				toc.leadout(), toc.offsets())
-	};
+		notify_next();
+	}
 
-	if (toc.leadout() == leadout)
+	if (remaining > 0)
 	{
-		return std::make_pair(track_checksums, toc);
+		target_->append_samples(start, stop);
+		total_samples_ += remaining;
 	}
+}
 
-	auto updated_toc { toc };
-	updated_toc.set_leadout(leadout);
 
-	return std::make_pair(track_checksums, updated_toc);
+void TrackCompletionProcessor::do_update_audiosize(const AudioSize& size)
+{
+	target_->update_audiosize(size);
 }
 
 
-Checksums ARCSCalculator::calculate(
-	const std::vector<std::string>& audiofilenames,
-	const bool first_file_is_first_track,
-	const bool last_file_is_last_track)
+void TrackCompletionProcessor::do_end_input()
 {
-	ARCS_LOG_DEBUG <<
-		"Calculate by audiofilenames and flags for 1st and last track";
+	target_->end_input();
 
-	if (audiofilenames.empty())
+	// The last track and any tracks not reached are reported at the end
+
+	while (static_cast<std::size_t>(tracks_completed_) <= boundaries_.size())
 	{
-		return Checksums(0);
+		notify_next();
 	}
+}
 
-	const bool single_file { audiofilenames.size() == 1 };
 
-	// Calculate first track
+// ProgressProcessor
 
-	ChecksumSet track {
 
-		// Apply back skipping request on first file only if it's also the last
+ProgressProcessor::ProgressProcessor(SampleProcessor& target,
+		const Cancellation& cancellation,
+		const std::function<void(const int64_t, const AudioSize&)>& callback,
+		const AudioSize& total)
+	: target_        { &target }
+	, cancellation_  { cancellation }
+	, callback_      { callback }
+	, total_         { total }
+	, total_samples_ { 0 }
+{
+	// empty
+}
 
-		calculate(audiofilenames.front(), first_file_is_first_track,
-			(single_file ? last_file_is_last_track : false))
-	};
 
-	auto checksums = Checksums{};
-	checksums.push_back(track);
+int64_t ProgressProcessor::samples_processed() const
+{
+	return total_samples_;
+}
 
-	// Avoid calculating a single track track twice
 
-	if (single_file)
+void ProgressProcessor::check_cancellation() const
+{
+	if (cancellation_.cancelled())
 	{
-		return checksums;
+		throw CalculationCancelled("Calculation was cancelled after "
+				+ std::to_string(total_samples_) + " samples");
 	}
+}
+
+
+void ProgressProcessor::do_start_input()
+{
+	check_cancellation();
+
+	total_samples_ = 0;
+
+	target_->start_input();
+}
+
+
+void ProgressProcessor::do_append_samples(SampleInputIterator start,
+		SampleInputIterator stop)
+{
+	check_cancellation();
+
+	target_->append_samples(start, stop);
+
+	total_samples_ += std::distance(start, stop);
+
+	if (callback_)
+	{
+		callback_(total_samples_, total_);
+	}
+}
+
+
+void ProgressProcessor::do_update_audiosize(const AudioSize& size)
+{
+	total_ = size;
+
+	target_->update_audiosize(size);
+}
+
+
+void ProgressProcessor::do_end_input()
+{
+	target_->end_input();
+}
+
+
+// SectorIndexProcessor
+
+
+SectorIndexProcessor::SectorIndexProcessor(SampleProcessor& target,
+		SectorIndex& index)
+	: target_ { &target }
+	, index_  { &index }
+{
+	// empty
+}
+
+
+void SectorIndexProcessor::do_start_input()
+{
+	index_->clear();
+
+	target_->start_input();
+}
+
+
+void SectorIndexProcessor::do_append_samples(SampleInputIterator start,
+		SampleInputIterator stop)
+{
+	index_->append(start, stop);
+
+	target_->append_samples(start, stop);
+}
+
+
+void SectorIndexProcessor::do_update_audiosize(const AudioSize& size)
+{
+	target_->update_audiosize(size);
+}
+
+
+void SectorIndexProcessor::do_end_input()
+{
+	target_->end_input();
+}
+
+
+// SampleCounter
+
+
+SampleCounter::SampleCounter()
+	: total_samples_ { 0 }
+{
+	// empty
+}
+
+
+int64_t SampleCounter::samples_processed() const
+{
+	return total_samples_;
+}
+
+
+void SampleCounter::do_start_input()
+{
+	total_samples_ = 0;
+}
+
+
+void SampleCounter::do_append_samples(SampleInputIterator start,
+		SampleInputIterator stop)
+{
+	total_samples_ += std::distance(start, stop);
+}
+
+
+void SampleCounter::do_update_audiosize(const AudioSize& /* size */)
+{
+	// empty
+}
+
+
+void SampleCounter::do_end_input()
+{
+	// empty
+}
+
+} // namespace details
+
+
+// calculate.hpp
+
+
+// default_selection()
+
+
+template <>
+const FileReaderSelection* default_selection<AudioReader>()
+{
+	return FileReaderRegistry::default_audio_selection();
+}
+
+
+template <>
+const FileReaderSelection* default_selection<MetadataParser>()
+{
+	return FileReaderRegistry::default_toc_selection();
+}
+
+
+// ReaderAndFormatHolder
+
+
+ReaderAndFormatHolder::ReaderAndFormatHolder()
+	: formats_          { FileReaderRegistry::formats() }
+	, descriptors_      { FileReaderRegistry::readers() }
+	, configuration_id_ { details::next_configuration_id() }
+{
+	/* empty */
+}
+
+
+ReaderAndFormatHolder::~ReaderAndFormatHolder() noexcept = default;
+
+
+void ReaderAndFormatHolder::set_formats(const FormatList* formats)
+{
+	formats_          = formats;
+	configuration_id_ = details::next_configuration_id();
+}
+
+
+const FormatList* ReaderAndFormatHolder::formats() const
+{
+	return formats_;
+}
+
+
+void ReaderAndFormatHolder::set_readers(const FileReaders* descriptors)
+{
+	descriptors_      = descriptors;
+	configuration_id_ = details::next_configuration_id();
+}
+
+
+const FileReaders* ReaderAndFormatHolder::readers() const
+{
+	return descriptors_;
+}
+
+
+uint64_t ReaderAndFormatHolder::configuration_id() const
+{
+	return configuration_id_;
+}
+
+
+// ToCParser
+
+
+std::unique_ptr<ToC> ToCParser::parse(const std::string& metafilename) const
+{
+	if (metafilename.empty())
+	{
+		ARCS_LOG_ERROR <<
+			"ToC info was requested but metadata filename was empty";
+
+		throw FileReadException(
+				"Requested metadata file parser for empty filename.");
+	}
+
+	auto parser { create(metafilename) };
+	auto toc    { parser->parse(metafilename) };
+
+	recycle(std::move(parser));
+
+	return toc;
+}
+
+
+std::unique_ptr<ToC> ToCParser::parse(const char* data, const std::size_t size,
+		const Format format) const
+{
+	const auto desc { selection()->get(format, Codec::NONE, *readers()) };
+
+	if (!desc)
+	{
+		throw InputFormatException("No parser available for format "
+				+ name(format));
+	}
+
+	auto parser { details::cast_reader<MetadataParser>(
+			desc->create_reader()).first };
+
+	if (!parser)
+	{
+		throw InputFormatException("Reader " + desc->id()
+				+ " is not a metadata parser");
+	}
+
+	return parser->parse(data, size);
+}
+
+
+std::vector<std::unique_ptr<ToC>> ToCParser::parse_all(
+		const std::vector<std::string>& metafilenames,
+		const unsigned threads) const
+{
+	auto tocs = std::vector<std::unique_ptr<ToC>>(metafilenames.size());
+
+	if (metafilenames.empty())
+	{
+		return tocs;
+	}
+
+	auto total_threads { threads ? threads
+		: std::thread::hardware_concurrency() };
+
+	if (total_threads < 1)
+	{
+		total_threads = 1;
+	}
+
+	if (total_threads > metafilenames.size())
+	{
+		total_threads = static_cast<unsigned>(metafilenames.size());
+	}
+
+	ARCS_LOG_DEBUG << "Parse " << metafilenames.size() << " files in "
+		<< total_threads << " threads";
+
+	auto next = std::atomic<std::size_t> { 0 };
+
+	const auto parse_next = [&]()
+	{
+		for (auto i { next++ }; i < metafilenames.size(); i = next++)
+		{
+			try
+			{
+				tocs[i] = this->parse(metafilenames[i]);
+
+			} catch (const std::exception& e)
+			{
+				ARCS_LOG_WARNING << "Failed to parse " << metafilenames[i]
+					<< ": " << e.what();
+			}
+		}
+	};
+
+	// The future of std::async waits for its thread when it is destroyed,
+	// thus no worker outlives tocs if starting a further worker throws.
+	auto workers = std::vector<std::future<void>> {};
+	workers.reserve(total_threads - 1);
+
+	for (auto t { 1u }; t < total_threads; ++t)
+	{
+		workers.emplace_back(std::async(std::launch::async, parse_next));
+	}
+
+	parse_next(); // the calling thread is the first worker
+
+	for (auto& worker : workers)
+	{
+		worker.get();
+	}
+
+	return tocs;
+}
+
+
+// AudioInfo
+
+
+std::unique_ptr<AudioSize> AudioInfo::size(const std::string& filename) const
+{
+	auto reader { create(filename) };
+	auto size   { reader->acquire_size(filename) };
+
+	recycle(std::move(reader));
+
+	return size;
+}
+
+
+// ThroughputCalibration
+
+
+void ThroughputCalibration::calibrate(const std::string& filename,
+		ReaderThroughput& throughput) const
+{
+	const auto type { details::file_type(filename, *formats()) };
+
+	const DefaultPreference preference;
+
+	for (const auto& entry : *readers())
+	{
+		const auto& desc { *entry.second };
+
+		if (InputType::AUDIO != desc.input_type()
+			|| DescriptorPreference::MIN_PREFERENCE ==
+				preference.preference(type.first, type.second, desc))
+		{
+			continue;
+		}
+
+		try
+		{
+			auto reader { details::cast_reader<AudioReader>(
+					desc.create_reader()).first };
+
+			if (!reader)
+			{
+				continue;
+			}
+
+			details::SampleCounter counter;
+			reader->set_processor(counter);
+			reader->set_statistics_enabled(true);
+
+			reader->process_file(filename);
+
+			const auto& statistics { reader->statistics() };
+
+			ARCS_LOG_DEBUG << "Reader " << desc.id() << " read "
+				<< statistics.samples << " samples in "
+				<< statistics.open_seconds + statistics.decode_seconds
+				<< " seconds";
+
+			throughput.record(statistics, type.first, type.second);
+
+		} catch (const std::exception& e)
+		{
+			ARCS_LOG_WARNING << "Calibration of reader " << desc.id()
+				<< " failed: " << e.what();
+		}
+	}
+}
+
+
+// Cancellation
+
+
+Cancellation::Cancellation()
+	: cancelled_ { std::make_shared<std::atomic<bool>>(false) }
+{
+	// empty
+}
+
+
+void Cancellation::cancel()
+{
+	cancelled_->store(true);
+}
+
+
+bool Cancellation::cancelled() const
+{
+	return cancelled_->load();
+}
+
+
+// CalculationCancelled
+
+
+CalculationCancelled::CalculationCancelled(const std::string& what_arg)
+	: std::runtime_error { what_arg }
+{
+	// empty
+}
+
+
+// SectorIndex
+
+
+namespace
+{
+
+/**
+ * \brief Identifies a stored SectorIndex.
+ */
+constexpr char SECTOR_INDEX_MAGIC[] = "ARSI";
+
+/**
+ * \brief Version of the format of a stored SectorIndex.
+ */
+constexpr uint32_t SECTOR_INDEX_VERSION = 1;
+
+/**
+ * \brief Number of values stored per sector.
+ *
+ * Sum of the samples, sum of the weighted samples, last sample.
+ */
+constexpr std::size_t SECTOR_INDEX_VALUES = 3;
+
+/**
+ * \brief Number of samples skipped at the start of the first track.
+ */
+constexpr int64_t SKIP_FRONT = 5 * CDDA::SAMPLES_PER_FRAME - 1;
+
+/**
+ * \brief Number of samples skipped at the end of the last track.
+ */
+constexpr int64_t SKIP_BACK = 5 * CDDA::SAMPLES_PER_FRAME;
+
+} // namespace
+
+
+SectorIndex::SectorIndex()
+	: sectors_       { /* empty */ }
+	, sum_           { 0 }
+	, weighted_sum_  { 0 }
+	, total_samples_ { 0 }
+{
+	// empty
+}
+
+
+SectorIndex::SectorIndex(std::istream& in)
+	: SectorIndex {}
+{
+	using details::read_le;
+
+	for (const auto& c : std::string { SECTOR_INDEX_MAGIC })
+	{
+		if (in.get() != c)
+		{
+			throw std::runtime_error("Input is not a sector index");
+		}
+	}
+
+	if (read_le(in, 4) != SECTOR_INDEX_VERSION)
+	{
+		throw std::runtime_error("Unsupported version of sector index");
+	}
+
+	const auto total_samples { static_cast<int64_t>(read_le(in, 8)) };
+
+	if (total_samples < 0
+		|| total_samples > CDDA::MAX_BLOCK_ADDRESS * CDDA::SAMPLES_PER_FRAME)
+	{
+		throw std::runtime_error("Invalid number of samples in sector index: "
+				+ std::to_string(total_samples));
+	}
+
+	sum_          = static_cast<uint32_t>(read_le(in, 4));
+	weighted_sum_ = static_cast<uint32_t>(read_le(in, 4));
+
+	sectors_.resize(static_cast<std::size_t>(
+			total_samples / CDDA::SAMPLES_PER_FRAME) * SECTOR_INDEX_VALUES);
+
+	for (auto& value : sectors_)
+	{
+		value = static_cast<uint32_t>(read_le(in, 4));
+	}
+
+	total_samples_ = total_samples;
+}
+
+
+void SectorIndex::append(SampleInputIterator begin, SampleInputIterator end)
+{
+	for (auto it = begin; it != end; ++it)
+	{
+		const auto sample { static_cast<uint32_t>(*it) };
+
+		++total_samples_;
+
+		sum_          += sample;
+		weighted_sum_ += static_cast<uint32_t>(total_samples_) * sample;
+
+		if (total_samples_ % CDDA::SAMPLES_PER_FRAME == 0)
+		{
+			sectors_.push_back(sum_);
+			sectors_.push_back(weighted_sum_);
+			sectors_.push_back(sample);
+		}
+	}
+}
+
+
+void SectorIndex::clear()
+{
+	sectors_.clear();
+	sum_           = 0;
+	weighted_sum_  = 0;
+	total_samples_ = 0;
+}
+
+
+int64_t SectorIndex::total_samples() const noexcept
+{
+	return total_samples_;
+}
+
+
+bool SectorIndex::covers(const ToC& toc) const
+{
+	const auto offsets { toc.offsets() };
+
+	if (offsets.empty())
+	{
+		return false;
+	}
+
+	const auto leadout { toc.leadout().zero()
+		? total_samples_
+		: static_cast<int64_t>(toc.leadout().samples()) };
+
+	if (leadout > total_samples_)
+	{
+		return false;
+	}
+
+	auto previous = int64_t { 0 };
+
+	for (const auto& offset : offsets)
+	{
+		const auto start { static_cast<int64_t>(offset.samples()) };
+
+		if (start < previous || start % CDDA::SAMPLES_PER_FRAME != 0)
+		{
+			return false;
+		}
+
+		previous = start;
+	}
+
+	// The first track is summed from one sample before a sector boundary
+
+	const auto first { static_cast<int64_t>(offsets.front().samples()) };
+	const auto last  { static_cast<int64_t>(offsets.back().samples()) };
+
+	return leadout - last > SKIP_BACK
+		&& supported(leadout)
+		&& supported(leadout - SKIP_BACK)
+		&& supported(std::min(first + SKIP_FRONT, leadout));
+}
+
+
+Checksums SectorIndex::arcs1(const ToC& toc) const
+{
+	if (!covers(toc))
+	{
+		throw std::invalid_argument("Sector index does not cover the ToC");
+	}
+
+	const auto offsets { toc.offsets() };
+	const auto leadout { toc.leadout().zero()
+		? total_samples_
+		: static_cast<int64_t>(toc.leadout().samples()) };
+
+	auto checksums = Checksums {};
+	checksums.reserve(offsets.size());
+
+	for (auto i = std::size_t { 0 }; i < offsets.size(); ++i)
+	{
+		const auto start { static_cast<int64_t>(offsets[i].samples()) };
+		const auto end   { i + 1 < offsets.size()
+			? static_cast<int64_t>(offsets[i + 1].samples())
+			: leadout };
+
+		// The weight of a sample is its 1-based position in the track, i.e.
+		// its 1-based position in the input minus the start of the track
+
+		const auto first { i == 0
+			? std::min(start + SKIP_FRONT, end)
+			: start };
+		const auto last  { i + 1 == offsets.size()
+			? std::max(end - SKIP_BACK, first)
+			: end };
+
+		const auto [ sum_first, weighted_first ] { prefix(first) };
+		const auto [ sum_last,  weighted_last  ] { prefix(last) };
+
+		const auto checksum { (weighted_last - weighted_first)
+			- static_cast<uint32_t>(start) * (sum_last - sum_first) };
+
+		auto track = ChecksumSet { static_cast<int32_t>(
+				(end - start) / CDDA::SAMPLES_PER_FRAME) };
+		track.insert(arcstk::checksum::type::ARCS1,
+				arcstk::Checksum { checksum });
+
+		checksums.push_back(track);
+	}
+
+	return checksums;
+}
+
+
+void SectorIndex::write(std::ostream& out) const
+{
+	using details::write_le;
+
+	out << SECTOR_INDEX_MAGIC;
+
+	write_le(out, SECTOR_INDEX_VERSION, 4);
+	write_le(out, static_cast<uint64_t>(total_samples_), 8);
+	write_le(out, sum_, 4);
+	write_le(out, weighted_sum_, 4);
+
+	for (const auto& value : sectors_)
+	{
+		write_le(out, value, 4);
+	}
+}
+
+
+std::pair<uint32_t, uint32_t> SectorIndex::prefix(const int64_t sample) const
+{
+	if (!supported(sample))
+	{
+		throw std::invalid_argument("Sector index has no prefix sums for "
+				"sample " + std::to_string(sample));
+	}
+
+	if (sample == total_samples_)
+	{
+		return { sum_, weighted_sum_ };
+	}
+
+	const auto sector { static_cast<std::size_t>(
+			sample / CDDA::SAMPLES_PER_FRAME) };
+
+	if (sample % CDDA::SAMPLES_PER_FRAME == 0)
+	{
+		if (sector == 0)
+		{
+			return { 0, 0 };
+		}
+
+		const auto v { (sector - 1) * SECTOR_INDEX_VALUES };
+		return { sectors_[v], sectors_[v + 1] };
+	}
+
+	// One sample before the end of the sector: remove its last sample
+
+	const auto v    { sector * SECTOR_INDEX_VALUES };
+	const auto last { sectors_[v + 2] };
+
+	return { sectors_[v] - last,
+		sectors_[v + 1] - static_cast<uint32_t>(sample + 1) * last };
+}
+
+
+bool SectorIndex::supported(const int64_t sample) const noexcept
+{
+	if (sample < 0 || sample > total_samples_)
+	{
+		return false;
+	}
+
+	const auto position { sample % CDDA::SAMPLES_PER_FRAME };
+
+	return sample == total_samples_
+		|| position == 0
+		|| position == CDDA::SAMPLES_PER_FRAME - 1;
+}
+
+
+// ChecksumCache::Impl
+
+
+/**
+ * \brief Private implementation of ChecksumCache.
+ */
+class ChecksumCache::Impl final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	Impl();
+
+	/**
+	 * \brief Implements ChecksumCache::find().
+	 */
+	std::unique_ptr<std::pair<Checksums, AudioSize>> find(
+			const std::string& audiofilename,
+			const Context context, const ChecksumtypeSet& types,
+			const AudioSize& leadout, const Points& offsets) const;
+
+	/**
+	 * \brief Implements ChecksumCache::insert().
+	 */
+	void insert(const std::string& audiofilename,
+			const Context context, const ChecksumtypeSet& types,
+			const Points& offsets,
+			const std::pair<Checksums, AudioSize>& result);
+
+	/**
+	 * \brief Implements ChecksumCache::hits().
+	 */
+	int64_t hits() const;
+
+	/**
+	 * \brief Implements ChecksumCache::size().
+	 */
+	std::size_t size() const;
+
+	/**
+	 * \brief Implements ChecksumCache::clear().
+	 */
+	void clear();
+
+private:
+
+	/**
+	 * \brief A remembered calculation.
+	 */
+	struct Entry final
+	{
+		Context context;
+		ChecksumtypeSet types;
+		Points offsets;
+		Checksums checksums;
+		AudioSize leadout;
+	};
+
+	/**
+	 * \brief Find an entry for the identity that matches the input.
+	 *
+	 * Caller must hold the lock.
+	 *
+	 * \param[in] identity Identity of the audio content
+	 * \param[in] context  Context of the calculation
+	 * \param[in] types    Checksum types to calculate
+	 * \param[in] offsets  Offsets of the input
+	 *
+	 * \return Matching entry or nullptr
+	 */
+	std::shared_ptr<const Entry> find_entry(const std::string& identity,
+			const Context context, const ChecksumtypeSet& types,
+			const Points& offsets) const;
+
+	/**
+	 * \brief Remember an entry for an identity, replacing an equivalent one.
+	 *
+	 * Caller must hold the lock.
+	 *
+	 * \param[in] identity Identity of the audio content
+	 * \param[in] entry    Entry to remember
+	 */
+	void insert_entry(const std::string& identity,
+			const std::shared_ptr<const Entry>& entry);
+
+	/**
+	 * \brief Calculations by identity of the audio content.
+	 *
+	 * A calculation is shared by all identities of its file.
+	 */
+	std::unordered_map<std::string, std::vector<std::shared_ptr<const Entry>>>
+		entries_;
+
+	/**
+	 * \brief Number of calculations remembered.
+	 */
+	std::size_t size_;
+
+	/**
+	 * \brief Number of successful lookups.
+	 */
+	mutable std::atomic<int64_t> hits_;
+
+	/**
+	 * \brief Guards entries_ and size_.
+	 */
+	mutable std::mutex mutex_;
+};
+
+
+ChecksumCache::Impl::Impl()
+	: entries_ { /* empty */ }
+	, size_    { 0 }
+	, hits_    { 0 }
+	, mutex_   { /* default */ }
+{
+	// empty
+}
+
+
+std::unique_ptr<std::pair<Checksums, AudioSize>> ChecksumCache::Impl::find(
+		const std::string& audiofilename,
+		const Context context, const ChecksumtypeSet& types,
+		const AudioSize& leadout, const Points& offsets) const
+{
+	using details::file_identity;
+	using details::flac_content_identity;
+
+	const auto matches = [&leadout](const std::shared_ptr<const Entry>& e)
+	{
+		return e && (leadout.zero() || leadout == e->leadout);
+	};
+
+	// Hard links are recognized without reading the file
+
+	auto entry { find_entry(file_identity(audiofilename), context, types,
+			offsets) };
+
+	if (!matches(entry))
+	{
+		entry = find_entry(flac_content_identity(audiofilename), context,
+				types, offsets);
+	}
+
+	if (!matches(entry))
+	{
+		return nullptr;
+	}
+
+	++hits_;
+
+	return std::make_unique<std::pair<Checksums, AudioSize>>(
+			entry->checksums, entry->leadout);
+}
+
+
+void ChecksumCache::Impl::insert(const std::string& audiofilename,
+		const Context context, const ChecksumtypeSet& types,
+		const Points& offsets,
+		const std::pair<Checksums, AudioSize>& result)
+{
+	const auto identities = std::array<std::string, 2> {
+		details::file_identity(audiofilename),
+		details::flac_content_identity(audiofilename)
+	};
+
+	const auto entry { std::make_shared<const Entry>(Entry {
+			context, types, offsets, result.first, result.second }) };
+
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	auto inserted { false };
+
+	for (const auto& identity : identities)
+	{
+		if (!identity.empty())
+		{
+			insert_entry(identity, entry);
+			inserted = true;
+		}
+	}
+
+	if (inserted)
+	{
+		++size_;
+	}
+}
+
+
+int64_t ChecksumCache::Impl::hits() const
+{
+	return hits_.load();
+}
+
+
+std::size_t ChecksumCache::Impl::size() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	return size_;
+}
+
+
+void ChecksumCache::Impl::clear()
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+	size_ = 0;
+}
+
+
+std::shared_ptr<const ChecksumCache::Impl::Entry>
+	ChecksumCache::Impl::find_entry(const std::string& identity,
+		const Context context, const ChecksumtypeSet& types,
+		const Points& offsets) const
+{
+	if (identity.empty())
+	{
+		return nullptr;
+	}
+
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto found { entries_.find(identity) };
+
+	if (found == entries_.end())
+	{
+		return nullptr;
+	}
+
+	const auto entry { std::find_if(found->second.begin(),
+			found->second.end(),
+			[&](const std::shared_ptr<const Entry>& e)
+			{
+				return e->context == context && e->types == types
+					&& e->offsets == offsets;
+			}) };
+
+	return entry == found->second.end() ? nullptr : *entry;
+}
+
+
+void ChecksumCache::Impl::insert_entry(const std::string& identity,
+		const std::shared_ptr<const Entry>& entry)
+{
+	auto& entries { entries_[identity] };
+
+	const auto equivalent { std::find_if(entries.begin(), entries.end(),
+			[&entry](const std::shared_ptr<const Entry>& e)
+			{
+				return e->context == entry->context
+					&& e->types == entry->types
+					&& e->offsets == entry->offsets;
+			}) };
+
+	if (equivalent != entries.end())
+	{
+		*equivalent = entry;
+		return;
+	}
+
+	entries.push_back(entry);
+}
+
+
+// ChecksumCache
+
+
+ChecksumCache::ChecksumCache()
+	: impl_ { std::make_unique<ChecksumCache::Impl>() }
+{
+	// empty
+}
+
+
+ChecksumCache::~ChecksumCache() noexcept = default;
+
+
+std::unique_ptr<std::pair<Checksums, AudioSize>> ChecksumCache::find(
+		const std::string& audiofilename,
+		const Context context, const ChecksumtypeSet& types,
+		const AudioSize& leadout, const Points& offsets) const
+{
+	return impl_->find(audiofilename, context, types, leadout, offsets);
+}
+
+
+void ChecksumCache::insert(const std::string& audiofilename,
+		const Context context, const ChecksumtypeSet& types,
+		const Points& offsets,
+		const std::pair<Checksums, AudioSize>& result)
+{
+	impl_->insert(audiofilename, context, types, offsets, result);
+}
+
+
+int64_t ChecksumCache::hits() const
+{
+	return impl_->hits();
+}
+
+
+std::size_t ChecksumCache::size() const
+{
+	return impl_->size();
+}
+
+
+void ChecksumCache::clear()
+{
+	impl_->clear();
+}
+
+
+// ARCSCalculator
+
+
+ARCSCalculator::ARCSCalculator(const ChecksumtypeSet& typeset)
+	: types_               { typeset }
+	, read_buffer_size_    { BLOCKSIZE::DEFAULT }
+	, track_callback_      { /* empty */ }
+	, progress_callback_   { /* empty */ }
+	, cancellation_        { /* default */ }
+	, statistics_          { /* empty */ }
+	, statistics_enabled_  { false }
+	, statistics_callback_ { /* empty */ }
+	, sector_index_        { nullptr }
+	, checksum_cache_      { nullptr }
+{
+	/* empty */
+}
+
+
+ARCSCalculator::ARCSCalculator()
+	: ARCSCalculator(
+			{ arcstk::checksum::type::ARCS1, arcstk::checksum::type::ARCS2 })
+{
+	/* empty */
+}
+
+
+std::pair<Checksums, ToC> ARCSCalculator::calculate(
+		const std::string& audiofilename,
+		const ToC& toc)
+{
+	ARCS_LOG_DEBUG << "Calculate by ToC and single audiofilename";
+
+	// A Calculation requires two informations about the input audio data:
+	//
+	// 1.) the LBA offset of each track
+	//	=>	which are either known at this point by inspecting the ToC or by
+	//		knowing that the audiofile represents a single track.
+	//
+	// 2.) the size of the audio input, which requires to know at least one of
+	// the following four:
+	//	a) the LBA track offset of the leadout frame
+	//	b) the total number of 16bit samples in <audiofilename>
+	//	c) the total number of bytes in <audiofilename> representing samples
+	//	d) the length of the last track
+	//	=>	which may or may not be represented in the ToC
+
+	// Not all ToC providing file formats contain sufficient information to
+	// calculate the leadout - simple CueSheets for example do not. Therefore,
+	// ToCs are accepted to be incomplete up to this point. They may contain
+	// only the offstes but not the leadout.
+
+	// However, this means we additionally have to inspect the audio file to get
+	// the missing information.
+
+	// The total PCM byte count is exclusively known to the AudioReader in
+	// the process of reading the audio file. (We cannot deduce it from the
+	// mere file size.) Every AudioReader reports the size of the audio input
+	// before it passes the first sample, and the Calculations accept this
+	// update. Thus, there is no need to acquire the size in advance, which
+	// would require to open and probe the audio file a second time.
+
+	statistics_.clear();
+
+	// A SectorIndex can only be recorded by reading the file
+
+	const auto cached { checksum_cache_ && !sector_index_
+		? checksum_cache_->find(audiofilename, Context::ALBUM, types(),
+				toc.leadout(), toc.offsets())
+		: nullptr };
+
+	if (cached)
+	{
+		ARCS_LOG_DEBUG << "Reuse checksums of identical audio for "
+			<< audiofilename;
+
+		if (track_callback_)
+		{
+			for (auto i = std::size_t { 0 }; i < cached->first.size(); ++i)
+			{
+				track_callback_(static_cast<int>(i + 1), cached->first[i]);
+			}
+		}
+
+		auto updated_toc { toc };
+		updated_toc.set_leadout(cached->second);
+
+		return std::make_pair(cached->first, updated_toc);
+	}
+
+	auto reader { create(audiofilename) };
+
+	const auto [ track_checksums, leadout ] {
+		process(*reader, audiofilename, Context::ALBUM, types(),
+				toc.leadout(), toc.offsets(), 1, 0, -1 /* entire file */,
+				sector_index_)
+	};
+
+	record(*reader);
+	recycle(std::move(reader));
+
+	if (leadout.zero())
+	{
+		throw std::runtime_error("AudioReader did not report the size of "
+				+ audiofilename);
+	}
+
+	if (checksum_cache_)
+	{
+		checksum_cache_->insert(audiofilename, Context::ALBUM, types(),
+				toc.offsets(), { track_checksums, leadout });
+	}
+
+	if (toc.leadout() == leadout)
+	{
+		return std::make_pair(track_checksums, toc);
+	}
+
+	auto updated_toc { toc };
+	updated_toc.set_leadout(leadout);
+
+	return std::make_pair(track_checksums, updated_toc);
+}
+
+
+std::pair<Checksums, ToC> ARCSCalculator::calculate(
+		const std::string& audiofilename,
+		const ToC& toc, const SectorIndex& index)
+{
+	const auto only_arcs1 { types().size() == 1
+		&& types().count(arcstk::checksum::type::ARCS1) == 1 };
+
+	if (!only_arcs1 || !index.covers(toc))
+	{
+		ARCS_LOG_DEBUG << "SectorIndex is not applicable, read audio file";
+
+		return calculate(audiofilename, toc);
+	}
+
+	ARCS_LOG_DEBUG << "Calculate by ToC and SectorIndex";
+
+	statistics_.clear();
+
+	const auto checksums { index.arcs1(toc) };
+
+	if (track_callback_)
+	{
+		for (auto i = std::size_t { 0 }; i < checksums.size(); ++i)
+		{
+			track_callback_(static_cast<int>(i + 1), checksums[i]);
+		}
+	}
+
+	if (!toc.leadout().zero())
+	{
+		return std::make_pair(checksums, toc);
+	}
+
+	auto updated_toc { toc };
+	updated_toc.set_leadout(AudioSize {
+			static_cast<int32_t>(index.total_samples()), UNIT::SAMPLES });
+
+	return std::make_pair(checksums, updated_toc);
+}
+
+
+std::pair<Checksums, ToC> ARCSCalculator::calculate(
+		const std::vector<std::string>& audiofilenames, const ToC& toc)
+{
+	using details::get_algorithms_or_throw;
+	using details::init_calculations;
+	using details::merge_results;
+	using details::process_audio_file;
+	using details::ConcatenationProcessor;
+	using details::MultiCalculationProcessor;
+	using details::ProgressProcessor;
+	using details::SectorIndexProcessor;
+	using details::TrackCompletionProcessor;
+
+	ARCS_LOG_DEBUG << "Calculate by ToC and multiple audiofilenames";
+
+	if (audiofilenames.empty())
+	{
+		throw std::invalid_argument("No audio files to calculate");
+	}
+
+	if (audiofilenames.size() == 1)
+	{
+		return calculate(audiofilenames.front(), toc);
+	}
+
+	// Since the files are read one after another, the size of the entire
+	// stream would only be known when the last file is opened. The
+	// Calculation needs it in advance, so if the ToC does not provide a
+	// leadout, the sizes of the files are acquired.
+
+	auto leadout { toc.leadout() };
+
+	if (leadout.zero())
+	{
+		auto total_samples = int64_t { 0 };
+
+		for (const auto& audiofilename : audiofilenames)
+		{
+			auto reader { create(audiofilename) };
+			total_samples += reader->acquire_size(audiofilename)->samples();
+			recycle(std::move(reader));
+		}
+
+		if (total_samples > std::numeric_limits<int32_t>::max())
+		{
+			throw std::invalid_argument("Audio files are too big for a CD");
+		}
+
+		leadout = AudioSize {
+			static_cast<int32_t>(total_samples), UNIT::SAMPLES };
+	}
+
+	const auto algorithms { get_algorithms_or_throw(types()) };
+
+	auto calculations { init_calculations(Context::ALBUM, algorithms, leadout,
+			toc.offsets()) };
+
+	auto processor = MultiCalculationProcessor {};
+
+	for (auto& c : calculations)
+	{
+		processor.add(c);
+	}
+
+	// Report each track as soon as the stream passes its end
+
+	const auto offsets { toc.offsets() };
+
+	auto tracks = TrackCompletionProcessor { processor, calculations, offsets,
+		1, track_callback_ };
+
+	// The size of the stream is already known, thus the progress refers to
+	// the entire stream instead of the current file
+
+	auto progress = ProgressProcessor { track_callback_
+		? static_cast<SampleProcessor&>(tracks)
+		: processor, cancellation_, progress_callback_, leadout };
+
+	// Record the entire stream in the SectorIndex, if any
+
+	auto empty_index = SectorIndex {};
+
+	auto indexer = SectorIndexProcessor { progress,
+		sector_index_ ? *sector_index_ : empty_index };
+
+	auto stream = ConcatenationProcessor { sector_index_
+		? static_cast<SampleProcessor&>(indexer)
+		: progress };
+
+	statistics_.clear();
+
+	auto next { prefetch(audiofilenames.front()) };
+
+	for (auto i = std::size_t { 0 }; i < audiofilenames.size(); ++i)
+	{
+		auto reader { next.get() };
+
+		if (i + 1 < audiofilenames.size())
+		{
+			next = prefetch(audiofilenames[i + 1]);
+		}
+
+		reader->set_statistics_enabled(statistics_enabled_);
+
+		process_audio_file(audiofilenames[i], *reader, read_buffer_size(),
+				stream);
+
+		record(*reader);
+		recycle(std::move(reader));
+	}
+
+	stream.finish();
+
+	ARCS_LOG_DEBUG << "Processed " << stream.samples_processed()
+		<< " samples from " << audiofilenames.size() << " files";
+
+	details::log_incomplete(calculations);
+
+	auto updated_toc { toc };
+
+	if (toc.leadout() != leadout)
+	{
+		updated_toc.set_leadout(leadout);
+	}
+
+	const auto checksums { merge_results(calculations) };
+
+	ARCSDEC_TRACE3(calculation_end, statistics_.back().file_id,
+			stream.samples_processed(), checksums.size());
+
+	return std::make_pair(checksums, updated_toc);
+}
+
+
+Checksums ARCSCalculator::calculate(const std::string& audiofilename,
+		const ToC& toc, const std::vector<int>& tracks)
+{
+	using std::to_string;
+
+	ARCS_LOG_DEBUG << "Calculate selected tracks by ToC and single "
+		"audiofilename";
+
+	const auto total_tracks { toc.total_tracks() };
+
+	for (const auto& track : tracks)
+	{
+		if (track < 1 || track > total_tracks)
+		{
+			throw std::invalid_argument("Track " + to_string(track)
+					+ " is not in the ToC");
+		}
+	}
+
+	statistics_.clear();
+
+	auto reader { create(audiofilename) };
+
+	const auto offsets { toc.offsets() };
+
+	// The leadout is only required to know where the last track ends
+
+	auto leadout { toc.leadout() };
+
+	if (std::find(tracks.begin(), tracks.end(), total_tracks) != tracks.end())
+	{
+		leadout = details::ensure_leadout(leadout, *reader, audiofilename);
+	}
+
+	// Consecutive tracks are calculated together in a single pass over
+	// their samples
+
+	auto selected { tracks };
+	std::sort(selected.begin(), selected.end());
+	selected.erase(std::unique(selected.begin(), selected.end()),
+			selected.end());
+
+	auto results = std::vector<ChecksumSet>(
+			static_cast<std::size_t>(total_tracks), ChecksumSet { 0 });
+
+	for (auto run { selected.begin() }; run != selected.end(); )
+	{
+		auto run_end { std::next(run) };
+
+		while (run_end != selected.end() && *run_end == *(run_end - 1) + 1)
+		{
+			++run_end;
+		}
+
+		const auto first_track { *run };
+		const auto last_track  { *(run_end - 1) };
+
+		const auto first { int64_t { offsets.at(
+				static_cast<std::size_t>(first_track - 1)).samples() } };
+		const auto end   { int64_t { last_track < total_tracks
+			? offsets.at(static_cast<std::size_t>(last_track)).samples()
+			: leadout.samples() } };
+
+		ARCS_LOG(DEBUG1) << "Tracks " << first_track << " - " << last_track
+			<< ": samples " << first << " - " << (end - 1);
+
+		auto points = Points {};
+
+		for (auto t { first_track }; t <= last_track; ++t)
+		{
+			points.emplace_back(offsets.at(static_cast<std::size_t>(t - 1))
+					.samples() - first, UNIT::SAMPLES);
+		}
+
+		// The first and last track have to be flagged to skip the samples
+		// AccurateRip ignores at the start and the end of the disc
+
+		const auto size {
+			AudioSize { static_cast<int32_t>(end - first), UNIT::SAMPLES } };
+
+		const auto [ run_checksums, run_size ] {
+			process(*reader, audiofilename,
+					to_context(first_track == 1, last_track == total_tracks),
+					types(), size, points, first_track, first, end - first,
+					nullptr)
+		};
+
+		record(*reader);
+
+		if (run_checksums.size() != points.size())
+		{
+			throw std::runtime_error("Calculation of tracks "
+					+ to_string(first_track) + " - " + to_string(last_track)
+					+ " in file " + audiofilename + " yielded "
+					+ to_string(run_checksums.size()) + " results");
+		}
+
+		std::copy(run_checksums.begin(), run_checksums.end(),
+				results.begin() + (first_track - 1));
+
+		run = run_end;
+	}
+
+	auto checksums = Checksums{};
+
+	for (const auto& track : tracks)
+	{
+		checksums.push_back(results[static_cast<std::size_t>(track - 1)]);
+	}
+
+	recycle(std::move(reader));
+
+	return checksums;
+}
 
-	// Calculate second to second last track
 
-	for (uint16_t i = 1; i < audiofilenames.size() - 1; ++i)
+Checksums ARCSCalculator::calculate(
+	const std::vector<std::string>& audiofilenames,
+	const bool first_file_is_first_track,
+	const bool last_file_is_last_track)
+{
+	ARCS_LOG_DEBUG <<
+		"Calculate by audiofilenames and flags for 1st and last track";
+
+	if (audiofilenames.empty())
 	{
-		track = calculate(audiofilenames[i], false, false);
+		return Checksums(0);
+	}
 
-		checksums.push_back(track);
+	// Select the reader for the next file and warm the cache while the
+	// current file is processed. This hides the latency of opening each file
+	// on slow storage.
+
+	const auto last { audiofilenames.size() - 1 };
+
+	auto checksums = Checksums{};
+
+	statistics_.clear();
+
+	// Apply skipping only on the first and last file
+
+	const auto context_of = [&](const std::size_t i)
+	{
+		return to_context(i == 0 && first_file_is_first_track,
+				i == last && last_file_is_last_track);
+	};
+
+	// Look up all files before reading, thus only files not found are
+	// prefetched
+
+	auto cached =
+		std::vector<std::unique_ptr<std::pair<Checksums, AudioSize>>>(last + 1);
+
+	if (checksum_cache_)
+	{
+		for (auto i = std::size_t { 0 }; i <= last; ++i)
+		{
+			cached[i] = checksum_cache_->find(audiofilenames[i], context_of(i),
+					types(), {/*no size*/}, {/*no offsets*/});
+		}
 	}
 
-	// Calculate last track
+	const auto next_to_read = [&cached, last](std::size_t i)
+	{
+		while (i <= last && cached[i])
+		{
+			++i;
+		}
+
+		return i;
+	};
+
+	auto to_read { next_to_read(0) };
+	auto next    { to_read <= last
+		? prefetch(audiofilenames[to_read])
+		: std::future<std::unique_ptr<AudioReader>> {} };
 
-	track = calculate(audiofilenames.back(), false, last_file_is_last_track);
+	for (auto i = std::size_t { 0 }; i <= last; ++i)
+	{
+		const auto ctx { context_of(i) };
+
+		auto track_checksums = Checksums {};
+
+		if (cached[i])
+		{
+			ARCS_LOG_DEBUG << "Reuse checksums of identical audio for "
+				<< audiofilenames[i];
+
+			track_checksums = cached[i]->first;
+		} else
+		{
+			auto reader { next.get() };
+
+			to_read = next_to_read(i + 1);
+
+			if (to_read <= last)
+			{
+				next = prefetch(audiofilenames[to_read]);
+			}
+
+			auto result { process(*reader, audiofilenames[i], ctx, types(),
+					{/*no size*/}, {/*no offsets*/}, 1, 0, -1 /* entire file */,
+					nullptr) };
+
+			record(*reader);
+			recycle(std::move(reader));
+
+			if (checksum_cache_)
+			{
+				checksum_cache_->insert(audiofilenames[i], ctx, types(),
+						{/*no offsets*/}, result);
+			}
+
+			track_checksums = std::move(result.first);
+		}
 
-	checksums.push_back(track);
+		checksums.push_back(track_checksums.empty()
+				? ChecksumSet { 0 }
+				: track_checksums[0]);
+
+		if (track_callback_)
+		{
+			track_callback_(static_cast<int>(i + 1), checksums.back());
+		}
+	}
 
 	return checksums;
 }
@@ -643,18 +2407,23 @@ std::pair<Checksums, AudioSize> ARCSCalculator::calculate(
 		const Settings& settings, const ChecksumtypeSet& types,
 		const AudioSize& leadout, const Points& offsets)
 {
-	using details::get_algorithms_or_throw;
-	using details::init_calculations;
-	using details::merge_results;
-	using details::process_audio_file;
-	using details::MultiCalculationProcessor;
-
 	ARCS_LOG_DEBUG <<
 		"Calculate by single audiofilename and complete input data";
 
-	// Put it all together
+	auto cached { checksum_cache_
+		? checksum_cache_->find(audiofilename, settings.context(), types,
+				leadout, offsets)
+		: nullptr };
 
-	const auto algorithms { get_algorithms_or_throw(types) };
+	if (cached)
+	{
+		ARCS_LOG_DEBUG << "Reuse checksums of identical audio for "
+			<< audiofilename;
+
+		statistics_.clear();
+
+		return std::move(*cached);
+	}
 
 	auto reader { create(audiofilename) };
 
@@ -663,47 +2432,102 @@ std::pair<Checksums, AudioSize> ARCSCalculator::calculate(
 		// TODO Wouldn't it be sufficient to do this exclusively for ALBUM?
 	};
 
+	auto result {
+		process(*reader, audiofilename, settings, types, updated_leadout,
+				offsets, 1, 0, -1 /* entire file */, nullptr)
+	};
+
+	statistics_.clear();
+	record(*reader);
+	recycle(std::move(reader));
+
+	if (checksum_cache_)
+	{
+		checksum_cache_->insert(audiofilename, settings.context(), types,
+				offsets, result);
+	}
+
+	return result;
+}
+
+
+std::pair<Checksums, AudioSize> ARCSCalculator::process(AudioReader& reader,
+		const std::string& audiofilename,
+		const Settings& settings, const ChecksumtypeSet& types,
+		const AudioSize& leadout, const Points& offsets,
+		const int first_track, const int64_t first, const int64_t total,
+		SectorIndex* index) const
+{
+	using details::get_algorithms_or_throw;
+	using details::init_calculations;
+	using details::merge_results;
+	using details::process_audio_file;
+	using details::process_audio_range;
+	using details::MultiCalculationProcessor;
+	using details::ProgressProcessor;
+	using details::SectorIndexProcessor;
+	using details::TrackCompletionProcessor;
+
+	// Put it all together
+
+	const auto algorithms { get_algorithms_or_throw(types) };
+
 	auto calculations {
-		init_calculations(settings, algorithms, updated_leadout, offsets) };
+		init_calculations(settings, algorithms, leadout, offsets) };
 
 	// Run
 
+	auto processor = MultiCalculationProcessor {};
+
+	for (auto& c : calculations)
 	{
-		MultiCalculationProcessor processor{};
+		processor.add(c);
+	}
 
-		for (auto& c : calculations)
-		{
-			processor.add(c);
-		}
+	// Report each track as soon as the input passes its end
 
-		process_audio_file(audiofilename, std::move(reader),
-				read_buffer_size(), processor);
-	}
+	auto tracks = TrackCompletionProcessor { processor, calculations, offsets,
+		first_track, track_callback_ };
 
-	// Check results
+	auto input = ProgressProcessor { track_callback_ && !offsets.empty()
+		? static_cast<SampleProcessor&>(tracks)
+		: processor, cancellation_, progress_callback_, leadout };
 
-	for (const auto& c : calculations)
-	{
-		if (not c.complete())
-		{
-			ARCS_LOG_ERROR << "Calculation not complete "
-				"after last input sample: "
-				<< "Expected total samples: " << c.samples_expected()
-				<< " "
-				<< "Processed total samples: " << c.samples_processed();
-		}
+	// Record the input in the SectorIndex, if any
 
-		if (c.samples_todo() < 0)
-		{
-			ARCS_LOG_WARNING << "More samples than expected. "
-				<< "Expected: " << c.samples_expected()
-				<< " "
-				<< "Processed: " << c.samples_processed();
-		}
+	auto empty_index = SectorIndex {};
+
+	auto indexer = SectorIndexProcessor { input, index ? *index : empty_index };
+
+	auto& head { index
+		? static_cast<SampleProcessor&>(indexer)
+		: input };
+
+	reader.set_statistics_enabled(statistics_enabled_);
+
+	if (total < 0)
+	{
+		process_audio_file(audiofilename, reader, read_buffer_size(), head);
+	} else
+	{
+		process_audio_range(audiofilename, reader, read_buffer_size(),
+				first, total, head);
 	}
 
+	// Take the leadout from the reader if it was not known in advance
+
+	const auto updated_leadout {
+		leadout.zero() ? processor.audiosize() : leadout };
+
+	// Check results
+
+	details::log_incomplete(calculations);
+
 	const auto checksums { merge_results(calculations) };
 
+	ARCSDEC_TRACE3(calculation_end, reader.statistics().file_id,
+			input.samples_processed(), checksums.size());
+
 	if (checksums.size() == 0)
 	{
 		ARCS_LOG_ERROR << "Calculations lead to no result, return empty set";
@@ -713,6 +2537,55 @@ std::pair<Checksums, AudioSize> ARCSCalculator::calculate(
 }
 
 
+std::future<std::pair<Checksums, ToC>> ARCSCalculator::calculate_async(
+		const std::string& audiofilename, const ToC& toc,
+		const Cancellation& cancellation) const
+{
+	auto calculator { *this };
+	calculator.set_cancellation(cancellation);
+
+	return std::async(std::launch::async,
+		[calculator, audiofilename, toc]() mutable
+		{
+			return calculator.calculate(audiofilename, toc);
+		});
+}
+
+
+std::future<std::pair<Checksums, ToC>> ARCSCalculator::calculate_async(
+		const std::vector<std::string>& audiofilenames, const ToC& toc,
+		const Cancellation& cancellation) const
+{
+	auto calculator { *this };
+	calculator.set_cancellation(cancellation);
+
+	return std::async(std::launch::async,
+		[calculator, audiofilenames, toc]() mutable
+		{
+			return calculator.calculate(audiofilenames, toc);
+		});
+}
+
+
+std::future<Checksums> ARCSCalculator::calculate_async(
+		const std::vector<std::string>& audiofilenames,
+		const bool first_file_is_first_track,
+		const bool last_file_is_last_track,
+		const Cancellation& cancellation) const
+{
+	auto calculator { *this };
+	calculator.set_cancellation(cancellation);
+
+	return std::async(std::launch::async,
+		[calculator, audiofilenames, first_file_is_first_track,
+			last_file_is_last_track]() mutable
+		{
+			return calculator.calculate(audiofilenames,
+					first_file_is_first_track, last_file_is_last_track);
+		});
+}
+
+
 void ARCSCalculator::set_types(const ChecksumtypeSet& typeset)
 {
 	types_ = typeset;
@@ -725,6 +2598,97 @@ ChecksumtypeSet ARCSCalculator::types() const
 }
 
 
+void ARCSCalculator::set_track_callback(const TrackCallback& callback)
+{
+	track_callback_ = callback;
+}
+
+
+const TrackCallback& ARCSCalculator::track_callback() const
+{
+	return track_callback_;
+}
+
+
+void ARCSCalculator::set_progress_callback(const ProgressCallback& callback)
+{
+	progress_callback_ = callback;
+}
+
+
+const ProgressCallback& ARCSCalculator::progress_callback() const
+{
+	return progress_callback_;
+}
+
+
+void ARCSCalculator::set_cancellation(const Cancellation& cancellation)
+{
+	cancellation_ = cancellation;
+}
+
+
+const Cancellation& ARCSCalculator::cancellation() const
+{
+	return cancellation_;
+}
+
+
+SectorIndex* ARCSCalculator::sector_index() const
+{
+	return sector_index_;
+}
+
+
+void ARCSCalculator::set_sector_index(SectorIndex* index)
+{
+	sector_index_ = index;
+}
+
+
+ChecksumCache* ARCSCalculator::checksum_cache() const
+{
+	return checksum_cache_;
+}
+
+
+void ARCSCalculator::set_checksum_cache(ChecksumCache* cache)
+{
+	checksum_cache_ = cache;
+}
+
+
+const std::vector<ReaderStatistics>& ARCSCalculator::statistics() const
+{
+	return statistics_;
+}
+
+
+void ARCSCalculator::set_statistics_enabled(const bool enabled)
+{
+	statistics_enabled_ = enabled;
+}
+
+
+bool ARCSCalculator::statistics_enabled() const
+{
+	return statistics_enabled_;
+}
+
+
+void ARCSCalculator::set_statistics_callback(
+		const StatisticsCallback& callback)
+{
+	statistics_callback_ = callback;
+}
+
+
+const StatisticsCallback& ARCSCalculator::statistics_callback() const
+{
+	return statistics_callback_;
+}
+
+
 void ARCSCalculator::set_read_buffer_size(const int64_t total_samples)
 {
 	read_buffer_size_ = total_samples;
@@ -737,6 +2701,30 @@ int64_t ARCSCalculator::read_buffer_size() const
 }
 
 
+std::future<std::unique_ptr<AudioReader>> ARCSCalculator::prefetch(
+		const std::string& audiofilename) const
+{
+	return std::async(std::launch::async,
+		[this, audiofilename]()
+		{
+			details::prefetch_file(audiofilename);
+
+			return create(audiofilename);
+		});
+}
+
+
+void ARCSCalculator::record(const AudioReader& reader)
+{
+	statistics_.push_back(reader.statistics());
+
+	if (statistics_callback_)
+	{
+		statistics_callback_(statistics_.back());
+	}
+}
+
+
 Context ARCSCalculator::to_context(
 	const bool is_first_track,
 	const bool is_last_track) const
@@ -799,6 +2787,66 @@ void ARIdCalculator::set_audio(const AudioInfo& audio)
 	audio_ = audio;
 }
 
+
+// AlbumCalculator
+
+
+AlbumCalculator::AlbumCalculator(const ChecksumtypeSet& types)
+	: parser_     { /* default */ }
+	, calculator_ { types }
+{
+	/* empty */
+}
+
+
+AlbumCalculator::AlbumCalculator()
+	: parser_     { /* default */ }
+	, calculator_ { /* default */ }
+{
+	/* empty */
+}
+
+
+std::tuple<std::unique_ptr<ARId>, ToC, Checksums> AlbumCalculator::calculate(
+		const std::string& metafilename, const std::string& audiofilename)
+{
+	ARCS_LOG_DEBUG << "Calculate album by metadata file and audiofilename";
+
+	const auto toc { parser_.parse(metafilename) };
+
+	auto [ checksums, completed_toc ] {
+		calculator_.calculate(audiofilename, *toc) };
+
+	auto id { make_arid(completed_toc) };
+
+	return std::make_tuple(std::move(id), std::move(completed_toc),
+			std::move(checksums));
+}
+
+
+const ToCParser* AlbumCalculator::toc_parser() const
+{
+	return &parser_;
+}
+
+
+void AlbumCalculator::set_toc_parser(const ToCParser& parser)
+{
+	parser_ = parser;
+}
+
+
+const ARCSCalculator* AlbumCalculator::arcs_calculator() const
+{
+	return &calculator_;
+}
+
+
+void AlbumCalculator::set_arcs_calculator(const ARCSCalculator& calculator)
+{
+	calculator_ = calculator;
+}
+
 } // namespace v_1_0_0
 } // namespace arcsdec
 
@@ -24,7 +24,11 @@
 #endif
 
 #include <cstdint>  // for uint32_t, int32_t
+#include <functional> // for function
+#include <iosfwd>   // for istream, ostream
 #include <memory>   // for unique_ptr
+#include <string>   // for string
+#include <vector>   // for vector
 
 
 namespace arcsdec
@@ -101,6 +105,21 @@ std::vector<Calculation> init_calculations(const arcstk::Settings& settings,
  */
 Checksums merge_results(const std::vector<Calculation>& calculations);
 
+/**
+ * \brief Combine the results of the specified Calculation instances for a
+ * single track.
+ *
+ * Only the ChecksumSet of track \c index is merged, thus this is cheaper than
+ * merge_results() if a single track is required.
+ *
+ * \param[in] calculations Calculations to aggregate the results from
+ * \param[in] index        0-based index of the track
+ *
+ * \return Aggregated results for the track, empty if it is not available
+ */
+ChecksumSet merge_result(const std::vector<Calculation>& calculations,
+		const std::size_t index);
+
 /**
  * \brief Derive an audiofile from a ToC.
  *
@@ -113,6 +132,19 @@ Checksums merge_results(const std::vector<Calculation>& calculations);
  */
 // std::string get_audiofilename(const ToC& toc);
 
+/**
+ * \brief Configure an AudioReader with a buffer size and a SampleProcessor.
+ *
+ * The \c buffer_size is specified as number of 32 bit PCM samples. If it is
+ * not within the legal range, the reader keeps its default.
+ *
+ * \param[in] reader         Audio reader
+ * \param[in] buffer_size    Read buffer size in number of samples
+ * \param[in] processor      The SampleProcessor to use
+ */
+void configure_reader(AudioReader& reader, const int64_t buffer_size,
+		SampleProcessor& processor);
+
 /**
  * \brief Worker: process an audio file via specified SampleProcessor.
  *
@@ -125,10 +157,47 @@ Checksums merge_results(const std::vector<Calculation>& calculations);
  * \param[in] processor      The SampleProcessor to use
  */
 void process_audio_file(const std::string& audiofilename,
-		std::unique_ptr<AudioReader> reader, const int64_t buffer_size,
+		AudioReader& reader, const int64_t buffer_size,
+		SampleProcessor& processor);
+
+/**
+ * \brief Worker: process a range of an audio file via specified
+ * SampleProcessor.
+ *
+ * \param[in] audiofilename  Name of the audiofile
+ * \param[in] reader         Audio reader
+ * \param[in] buffer_size    Read buffer size in number of samples
+ * \param[in] first          Index of the first sample to process
+ * \param[in] total          Total number of samples to process
+ * \param[in] processor      The SampleProcessor to use
+ */
+void process_audio_range(const std::string& audiofilename,
+		AudioReader& reader, const int64_t buffer_size,
+		const int64_t first, const int64_t total,
 		SampleProcessor& processor);
 
 
+/**
+ * \brief Log calculations that did not process the expected samples.
+ *
+ * \param[in] calculations The calculations to inspect
+ */
+void log_incomplete(const std::vector<Calculation>& calculations);
+
+
+/**
+ * \brief Hint the operating system that a file will be read soon.
+ *
+ * The file is not read by this function. Instead, the operating system is
+ * asked to start reading it into its cache, such that the file is already
+ * in memory when it is opened for reading. Errors are ignored since this is
+ * only an optimization.
+ *
+ * \param[in] filename Name of the file to prefetch
+ */
+void prefetch_file(const std::string& filename);
+
+
 /**
  * \brief Ensure a non-zero leadout.
  *
@@ -139,6 +208,57 @@ AudioSize ensure_leadout(const AudioSize& leadout,
 		const AudioReader& reader, const std::string& audiofilename);
 
 
+/**
+ * \brief Write the \c bytes lowest bytes of \c value in little endian order.
+ *
+ * \param[in] out   Stream to write to
+ * \param[in] value Value to write
+ * \param[in] bytes Number of bytes to write
+ */
+void write_le(std::ostream& out, const uint64_t value, const int bytes);
+
+
+/**
+ * \brief Read a value of \c bytes bytes in little endian order.
+ *
+ * \param[in] in    Stream to read from
+ * \param[in] bytes Number of bytes to read
+ *
+ * \return Value read
+ *
+ * \throw std::runtime_error If \c in ends before \c bytes were read
+ */
+uint64_t read_le(std::istream& in, const int bytes);
+
+
+/**
+ * \brief Identity of a file in the filesystem.
+ *
+ * Consists of device, inode, size and modification time, hence hard links to
+ * the same file have the same identity.
+ *
+ * \param[in] filename Name of the file
+ *
+ * \return Identity of the file or an empty string if it cannot be determined
+ */
+std::string file_identity(const std::string& filename);
+
+
+/**
+ * \brief Identity of the audio content of a FLAC file.
+ *
+ * Consists of sample rate, number of channels, bits per sample, total number
+ * of samples and the MD5 of the decoded samples as stored in the STREAMINFO
+ * block. Only the first bytes of the file are read, nothing is decoded.
+ *
+ * \param[in] filename Name of the file
+ *
+ * \return Identity of the content or an empty string if \c filename is not a
+ * FLAC file or its STREAMINFO lacks the MD5 or the number of samples
+ */
+std::string flac_content_identity(const std::string& filename);
+
+
 /**
  * \brief SampleProcessor that updates a Calculation.
  */
@@ -222,6 +342,15 @@ public:
 
 	void add(Calculation& c);
 
+	/**
+	 * \brief AudioSize most recently received by update_audiosize().
+	 *
+	 * Zero if the processor did not receive an AudioSize.
+	 *
+	 * \return The AudioSize reported by the reader
+	 */
+	AudioSize audiosize() const;
+
 private:
 
 	void do_start_input() final;
@@ -237,6 +366,329 @@ private:
 	 * \brief Internal pointer to the processors to wrap.
 	 */
 	std::vector<CalculationProcessor> processors_;
+
+	/**
+	 * \brief AudioSize most recently received.
+	 */
+	AudioSize audiosize_;
+};
+
+
+/**
+ * \brief SampleProcessor that joins the input of several files gaplessly.
+ *
+ * Passes the samples of each file to a target SampleProcessor such that the
+ * target sees a single continuous stream. The target is informed about the
+ * start of the input only once, with the first file. The AudioSizes of the
+ * single files are not passed since the target expects the size of the
+ * entire stream. The end of the stream must be signalled explicitly by
+ * finish() after the last file.
+ */
+class ConcatenationProcessor final : public SampleProcessor
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] target The SampleProcessor to pass the stream to
+	 */
+	explicit ConcatenationProcessor(SampleProcessor& target);
+
+	// not copy-constructible, not copy-assignable
+
+	ConcatenationProcessor(const ConcatenationProcessor&) = delete;
+	ConcatenationProcessor& operator=(const ConcatenationProcessor&) = delete;
+
+	/**
+	 * \brief Signal the end of the stream to the target.
+	 */
+	void finish();
+
+	/**
+	 * \brief Number of PCM 32 bit samples passed to the target.
+	 *
+	 * \return Number of samples passed
+	 */
+	int64_t samples_processed() const;
+
+private:
+
+	void do_start_input() final;
+
+	void do_append_samples(SampleInputIterator begin, SampleInputIterator end)
+		final;
+
+	void do_update_audiosize(const AudioSize& size) final;
+
+	void do_end_input() final;
+
+	/**
+	 * \brief The SampleProcessor to pass the stream to.
+	 */
+	SampleProcessor* target_;
+
+	/**
+	 * \brief TRUE iff the start of the stream was passed.
+	 */
+	bool started_;
+
+	/**
+	 * \brief Sample counter.
+	 */
+	int64_t total_samples_;
+};
+
+
+/**
+ * \brief SampleProcessor that reports each track as soon as it is complete.
+ *
+ * Passes the samples to a target SampleProcessor that updates the
+ * Calculations. Sequences of samples are split at the track boundaries
+ * specified by the offsets. After the last sample of a track is passed, the
+ * callback is called with the checksums of this track. The last track is
+ * reported after the end of the input is passed.
+ */
+class TrackCompletionProcessor final : public SampleProcessor
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] target       SampleProcessor that updates \c calculations
+	 * \param[in] calculations Calculations to take the checksums from
+	 * \param[in] offsets      Offsets of the tracks
+	 * \param[in] first_track  Number of the track at the first offset
+	 * \param[in] callback     Function to call with each completed track
+	 */
+	TrackCompletionProcessor(SampleProcessor& target,
+			const std::vector<Calculation>& calculations,
+			const Points& offsets, const int first_track,
+			const std::function<void(const int, const ChecksumSet&)>&
+				callback);
+
+	// not copy-constructible, not copy-assignable
+
+	TrackCompletionProcessor(const TrackCompletionProcessor&) = delete;
+	TrackCompletionProcessor& operator=(const TrackCompletionProcessor&) = delete;
+
+private:
+
+	void do_start_input() final;
+
+	void do_append_samples(SampleInputIterator begin, SampleInputIterator end)
+		final;
+
+	void do_update_audiosize(const AudioSize& size) final;
+
+	void do_end_input() final;
+
+	/**
+	 * \brief Call the callback with the checksums of the next track.
+	 */
+	void notify_next();
+
+	/**
+	 * \brief The SampleProcessor to pass the samples to.
+	 */
+	SampleProcessor* target_;
+
+	/**
+	 * \brief The Calculations to take the checksums from.
+	 */
+	const std::vector<Calculation>* calculations_;
+
+	/**
+	 * \brief Index of the first sample after each track except the last.
+	 */
+	std::vector<int64_t> boundaries_;
+
+	/**
+	 * \brief Number of the track at the first offset.
+	 */
+	int first_track_;
+
+	/**
+	 * \brief Function to call with each completed track.
+	 */
+	std::function<void(const int, const ChecksumSet&)> callback_;
+
+	/**
+	 * \brief Number of samples passed to the target.
+	 */
+	int64_t total_samples_;
+
+	/**
+	 * \brief Number of tracks already reported.
+	 */
+	int tracks_completed_;
+};
+
+
+/**
+ * \brief SampleProcessor that reports the progress and checks for
+ * cancellation.
+ *
+ * Passes all signals to a target SampleProcessor. Before each sequence of
+ * samples is passed, the Cancellation is checked. After each sequence is
+ * passed, the callback is called with the number of samples passed and the
+ * total size of the input.
+ */
+class ProgressProcessor final : public SampleProcessor
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * The total size is updated by each update of the audio size.
+	 *
+	 * \param[in] target       The SampleProcessor to pass the samples to
+	 * \param[in] cancellation Token to check before each sequence
+	 * \param[in] callback     Function to call with the progress, may be empty
+	 * \param[in] total        Total size of the input, may be zero()
+	 */
+	ProgressProcessor(SampleProcessor& target,
+			const Cancellation& cancellation,
+			const std::function<void(const int64_t, const AudioSize&)>&
+				callback,
+			const AudioSize& total);
+
+	// not copy-constructible, not copy-assignable
+
+	ProgressProcessor(const ProgressProcessor&) = delete;
+	ProgressProcessor& operator=(const ProgressProcessor&) = delete;
+
+	/**
+	 * \brief Number of PCM 32 bit samples passed to the target.
+	 *
+	 * \return Number of samples passed
+	 */
+	int64_t samples_processed() const;
+
+private:
+
+	void do_start_input() final;
+
+	void do_append_samples(SampleInputIterator begin, SampleInputIterator end)
+		final;
+
+	void do_update_audiosize(const AudioSize& size) final;
+
+	void do_end_input() final;
+
+	/**
+	 * \brief Throw CalculationCancelled iff the cancellation was requested.
+	 */
+	void check_cancellation() const;
+
+	/**
+	 * \brief The SampleProcessor to pass the samples to.
+	 */
+	SampleProcessor* target_;
+
+	/**
+	 * \brief Token to check before each sequence.
+	 */
+	Cancellation cancellation_;
+
+	/**
+	 * \brief Function to call with the progress.
+	 */
+	std::function<void(const int64_t, const AudioSize&)> callback_;
+
+	/**
+	 * \brief Total size of the input.
+	 */
+	AudioSize total_;
+
+	/**
+	 * \brief Number of samples passed to the target.
+	 */
+	int64_t total_samples_;
+};
+
+
+/**
+ * \brief SampleProcessor that records the samples in a SectorIndex.
+ *
+ * Passes all signals to a target SampleProcessor. The SectorIndex is cleared
+ * on the start of the input.
+ */
+class SectorIndexProcessor final : public SampleProcessor
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] target The SampleProcessor to pass the samples to
+	 * \param[in] index  The SectorIndex to record the samples in
+	 */
+	SectorIndexProcessor(SampleProcessor& target, SectorIndex& index);
+
+	// not copy-constructible, not copy-assignable
+
+	SectorIndexProcessor(const SectorIndexProcessor&) = delete;
+	SectorIndexProcessor& operator=(const SectorIndexProcessor&) = delete;
+
+private:
+
+	void do_start_input() final;
+
+	void do_append_samples(SampleInputIterator begin, SampleInputIterator end)
+		final;
+
+	void do_update_audiosize(const AudioSize& size) final;
+
+	void do_end_input() final;
+
+	/**
+	 * \brief The SampleProcessor to pass the samples to.
+	 */
+	SampleProcessor* target_;
+
+	/**
+	 * \brief The SectorIndex to record the samples in.
+	 */
+	SectorIndex* index_;
+};
+
+
+/**
+ * \brief SampleProcessor that only counts the samples it receives.
+ *
+ * Used for measuring the throughput of an AudioReader.
+ */
+class SampleCounter final : public SampleProcessor
+{
+public:
+
+	SampleCounter();
+
+	/**
+	 * \brief Number of PCM 32 bit samples processed.
+	 *
+	 * \return Number of samples processed
+	 */
+	int64_t samples_processed() const;
+
+private:
+
+	void do_start_input() final;
+
+	void do_append_samples(SampleInputIterator begin, SampleInputIterator end)
+		final;
+
+	void do_update_audiosize(const AudioSize& size) final;
+
+	void do_end_input() final;
+
+	/**
+	 * \brief Sample counter.
+	 */
+	int64_t total_samples_;
 };
 
 } // namespace details
@@ -0,0 +1,852 @@
+/**
+ * \file
+ *
+ * \brief Implements a local index of AccurateRip responses and a matcher.
+ */
+
+#ifndef __LIBARCSDEC_DBARINDEX_HPP__
+#include "dbarindex.hpp"
+#endif
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp>   // for ARCS_LOG_DEBUG
+#endif
+
+extern "C"
+{
+#include <fcntl.h>       // for open, O_RDONLY
+#include <sys/mman.h>    // for mmap, munmap
+#include <sys/stat.h>    // for fstat
+#include <unistd.h>      // for close
+}
+
+#include <algorithm>     // for find, lower_bound, max, min
+#include <array>         // for array
+#include <cstddef>       // for size_t
+#include <cstdint>       // for uint32_t, uint64_t
+#include <cstring>       // for memcmp
+#include <fstream>       // for ifstream, ofstream
+#include <iterator>      // for istreambuf_iterator
+#include <map>           // for map
+#include <stdexcept>     // for invalid_argument, runtime_error
+#include <string>        // for string, to_string
+#include <tuple>         // for tie
+#include <vector>        // for vector
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+namespace
+{
+
+/**
+ * \brief Identifies an index file.
+ */
+constexpr char INDEX_MAGIC[] = "ARDX";
+
+/**
+ * \brief Written in host byte order to detect the byte order of the index.
+ */
+constexpr uint32_t INDEX_BYTE_ORDER = 0x01020304;
+
+/**
+ * \brief Version of the format of the index file.
+ */
+constexpr uint32_t INDEX_VERSION = 1;
+
+/**
+ * \brief Header of the index file.
+ */
+struct IndexHeader final
+{
+	char     magic[4];
+	uint32_t byte_order;
+	uint32_t version;
+	uint32_t discs;
+};
+
+/**
+ * \brief Directory entry for a disc in the index file.
+ *
+ * The directory follows the header and is sorted by key().
+ */
+struct IndexEntry final
+{
+	uint32_t disc_id_1;
+	uint32_t disc_id_2;
+	uint32_t cddb_id;
+	uint32_t tracks;
+	uint32_t pressings;
+	uint32_t reserved;
+	uint64_t offset;
+};
+
+static_assert(sizeof(IndexHeader) == 16, "Unexpected padding of header");
+static_assert(sizeof(IndexEntry) == 32, "Unexpected padding of entry");
+
+/**
+ * \brief Key to sort the discs in the directory.
+ */
+using DiscKey = std::array<uint32_t, 4>;
+
+/**
+ * \brief Key of a directory entry.
+ *
+ * \param[in] entry Directory entry
+ *
+ * \return Key of \c entry
+ */
+DiscKey key(const IndexEntry& entry)
+{
+	return { entry.disc_id_1, entry.disc_id_2, entry.cddb_id, entry.tracks };
+}
+
+/**
+ * \brief Key of an ARId.
+ *
+ * \param[in] id ARId
+ *
+ * \return Key of \c id
+ */
+DiscKey key(const ARId& id)
+{
+	return { id.disc_id_1(), id.disc_id_2(), id.cddb_id(),
+		static_cast<uint32_t>(id.track_count()) };
+}
+
+/**
+ * \brief Reference values of a track in a dBAR block.
+ *
+ * Confidence, checksum and checksum of frame 450.
+ */
+using DBARTrack = std::array<uint32_t, 3>;
+
+/**
+ * \brief Read a little endian 32 bit value from a dBAR file.
+ *
+ * \param[in] bytes Bytes to read the value from
+ *
+ * \return Value read
+ */
+uint32_t le32(const unsigned char* bytes)
+{
+	return static_cast<uint32_t>(bytes[0])
+		| static_cast<uint32_t>(bytes[1]) <<  8
+		| static_cast<uint32_t>(bytes[2]) << 16
+		| static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+/**
+ * \brief Parse the blocks of a dBAR file.
+ *
+ * A block consists of the track count (1 byte), disc id 1, disc id 2 and
+ * CDDB id (4 bytes each) and for each track the confidence (1 byte), the
+ * checksum and the checksum of frame 450 (4 bytes each). Values are little
+ * endian.
+ *
+ * \param[in]     filename Name of the dBAR file
+ * \param[in,out] discs    Blocks by disc to add the blocks to
+ *
+ * \throw std::runtime_error If the file cannot be read or is invalid
+ */
+void parse_dbar(const std::string& filename,
+		std::map<DiscKey, std::vector<std::vector<DBARTrack>>>& discs)
+{
+	auto in = std::ifstream { filename, std::ios::in | std::ios::binary };
+
+	if (!in)
+	{
+		throw std::runtime_error("Could not open dBAR file " + filename);
+	}
+
+	const auto bytes = std::vector<unsigned char> {
+		std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+	auto pos = std::size_t { 0 };
+
+	while (pos < bytes.size())
+	{
+		if (bytes.size() - pos < 13)
+		{
+			throw std::runtime_error("Incomplete block header in dBAR file "
+					+ filename + " at byte " + std::to_string(pos));
+		}
+
+		const auto tracks { static_cast<std::size_t>(bytes[pos]) };
+
+		if (tracks == 0 || bytes.size() - pos - 13 < tracks * 9)
+		{
+			throw std::runtime_error("Invalid block in dBAR file "
+					+ filename + " at byte " + std::to_string(pos));
+		}
+
+		const auto disc = DiscKey { le32(&bytes[pos + 1]),
+			le32(&bytes[pos + 5]), le32(&bytes[pos + 9]),
+			static_cast<uint32_t>(tracks) };
+
+		pos += 13;
+
+		auto block = std::vector<DBARTrack>(tracks);
+
+		for (auto& track : block)
+		{
+			track = { bytes[pos], le32(&bytes[pos + 1]),
+				le32(&bytes[pos + 5]) };
+			pos += 9;
+		}
+
+		// A block that is already known, e.g. from a dBAR file passed twice,
+		// would add a duplicate pressing
+
+		auto& blocks { discs[disc] };
+
+		if (std::find(blocks.begin(), blocks.end(), block) == blocks.end())
+		{
+			blocks.push_back(std::move(block));
+		}
+	}
+}
+
+/**
+ * \brief Write a value in host byte order.
+ *
+ * \param[in] out   Stream to write to
+ * \param[in] value Value to write
+ */
+template <typename T>
+void write_raw(std::ofstream& out, const T& value)
+{
+	out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+
+// DBARResponse
+
+
+DBARResponse::DBARResponse()
+	: tracks_    { 0 }
+	, pressings_ { 0 }
+	, data_      { nullptr }
+{
+	// empty
+}
+
+
+DBARResponse::DBARResponse(const int tracks, const int pressings,
+		const uint32_t* data)
+	: tracks_    { tracks }
+	, pressings_ { pressings }
+	, data_      { data }
+{
+	// empty
+}
+
+
+int DBARResponse::tracks() const noexcept
+{
+	return tracks_;
+}
+
+
+int DBARResponse::pressings() const noexcept
+{
+	return pressings_;
+}
+
+
+bool DBARResponse::empty() const noexcept
+{
+	return pressings_ == 0;
+}
+
+
+const uint32_t* DBARResponse::checksums(const int track) const noexcept
+{
+	return data_ + static_cast<std::size_t>(track)
+		* static_cast<std::size_t>(pressings_);
+}
+
+
+const uint32_t* DBARResponse::confidences(const int track) const noexcept
+{
+	return data_ + static_cast<std::size_t>(tracks_ + track)
+		* static_cast<std::size_t>(pressings_);
+}
+
+
+const uint32_t* DBARResponse::frame450_checksums(const int track) const
+	noexcept
+{
+	return data_ + static_cast<std::size_t>(2 * tracks_ + track)
+		* static_cast<std::size_t>(pressings_);
+}
+
+
+// DBARIndex::Impl
+
+
+/**
+ * \brief Private implementation of DBARIndex.
+ */
+class DBARIndex::Impl final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] filename Name of the index file
+	 */
+	explicit Impl(const std::string& filename);
+
+	/**
+	 * \brief Destructor.
+	 */
+	~Impl() noexcept;
+
+	Impl(const Impl&) = delete;
+	Impl& operator=(const Impl&) = delete;
+
+	/**
+	 * \brief Implements DBARIndex::find().
+	 */
+	DBARResponse find(const ARId& id) const;
+
+	/**
+	 * \brief Implements DBARIndex::size().
+	 */
+	std::size_t size() const noexcept;
+
+private:
+
+	/**
+	 * \brief Check the mapped file and set entries_ and size_.
+	 *
+	 * \param[in] filename Name of the index file
+	 *
+	 * \throw std::runtime_error If the file is not a valid index
+	 */
+	void validate(const std::string& filename);
+
+	/**
+	 * \brief Mapped index file.
+	 */
+	void* data_;
+
+	/**
+	 * \brief Size of the mapped index file in bytes.
+	 */
+	std::size_t length_;
+
+	/**
+	 * \brief Directory of the index.
+	 */
+	const IndexEntry* entries_;
+
+	/**
+	 * \brief Number of entries in the directory.
+	 */
+	std::size_t size_;
+};
+
+
+DBARIndex::Impl::Impl(const std::string& filename)
+	: data_    { nullptr }
+	, length_  { 0 }
+	, entries_ { nullptr }
+	, size_    { 0 }
+{
+	const auto fd { ::open(filename.c_str(), O_RDONLY) };
+
+	if (fd < 0)
+	{
+		throw std::runtime_error("Could not open index file " + filename);
+	}
+
+	struct ::stat stat_buf;
+
+	if (::fstat(fd, &stat_buf) != 0 || stat_buf.st_size <= 0)
+	{
+		::close(fd);
+		throw std::runtime_error("Index file is empty: " + filename);
+	}
+
+	length_ = static_cast<std::size_t>(stat_buf.st_size);
+
+	data_ = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	::close(fd);
+
+	if (data_ == MAP_FAILED)
+	{
+		data_ = nullptr;
+		throw std::runtime_error("Could not map index file " + filename);
+	}
+
+	try
+	{
+		validate(filename);
+
+	} catch (...)
+	{
+		::munmap(data_, length_);
+		throw;
+	}
+
+	ARCS_LOG_DEBUG << "Mapped index of " << size_ << " discs from " << filename;
+}
+
+
+DBARIndex::Impl::~Impl() noexcept
+{
+	if (data_)
+	{
+		::munmap(data_, length_);
+	}
+}
+
+
+DBARResponse DBARIndex::Impl::find(const ARId& id) const
+{
+	const auto end { entries_ + size_ };
+
+	const auto wanted { key(id) };
+
+	const auto entry { std::lower_bound(entries_, end, wanted,
+			[](const IndexEntry& e, const DiscKey& k) { return key(e) < k; }) };
+
+	if (entry == end || key(*entry) != wanted)
+	{
+		return DBARResponse {};
+	}
+
+	return DBARResponse { static_cast<int>(entry->tracks),
+		static_cast<int>(entry->pressings),
+		reinterpret_cast<const uint32_t*>(
+				static_cast<const char*>(data_) + entry->offset) };
+}
+
+
+std::size_t DBARIndex::Impl::size() const noexcept
+{
+	return size_;
+}
+
+
+void DBARIndex::Impl::validate(const std::string& filename)
+{
+	const auto bytes { static_cast<const char*>(data_) };
+
+	if (length_ < sizeof(IndexHeader))
+	{
+		throw std::runtime_error("Index file is too short: " + filename);
+	}
+
+	const auto header { reinterpret_cast<const IndexHeader*>(bytes) };
+
+	if (std::memcmp(header->magic, INDEX_MAGIC, sizeof(header->magic)) != 0)
+	{
+		throw std::runtime_error("Not an index file: " + filename);
+	}
+
+	if (header->byte_order != INDEX_BYTE_ORDER)
+	{
+		throw std::runtime_error("Index file " + filename
+				+ " was built on a host with different byte order");
+	}
+
+	if (header->version != INDEX_VERSION)
+	{
+		throw std::runtime_error("Unsupported version of index file "
+				+ filename);
+	}
+
+	const auto discs { static_cast<std::size_t>(header->discs) };
+
+	if ((length_ - sizeof(IndexHeader)) / sizeof(IndexEntry) < discs)
+	{
+		throw std::runtime_error("Directory of index file " + filename
+				+ " is incomplete");
+	}
+
+	const auto entries {
+		reinterpret_cast<const IndexEntry*>(bytes + sizeof(IndexHeader)) };
+
+	for (auto i = std::size_t { 0 }; i < discs; ++i)
+	{
+		const auto& e { entries[i] };
+
+		const auto values { 3 * static_cast<uint64_t>(e.tracks) * e.pressings };
+
+		if (e.tracks == 0 || e.tracks > 99 || e.pressings == 0
+			|| e.offset % sizeof(uint32_t) != 0
+			|| e.offset > length_
+			|| (length_ - e.offset) / sizeof(uint32_t) < values
+			|| (i > 0 && !(key(entries[i - 1]) < key(e))))
+		{
+			throw std::runtime_error("Invalid entry " + std::to_string(i)
+					+ " in index file " + filename);
+		}
+	}
+
+	entries_ = entries;
+	size_    = discs;
+}
+
+
+// DBARIndex
+
+
+void DBARIndex::build(const std::vector<std::string>& dbar_files,
+		const std::string& filename)
+{
+	auto discs = std::map<DiscKey, std::vector<std::vector<DBARTrack>>> {};
+
+	for (const auto& dbar_file : dbar_files)
+	{
+		parse_dbar(dbar_file, discs);
+	}
+
+	auto out = std::ofstream { filename,
+		std::ios::out | std::ios::binary | std::ios::trunc };
+
+	if (!out)
+	{
+		throw std::runtime_error("Could not create index file " + filename);
+	}
+
+	auto header = IndexHeader {};
+	std::copy(INDEX_MAGIC, INDEX_MAGIC + sizeof(header.magic), header.magic);
+	header.byte_order = INDEX_BYTE_ORDER;
+	header.version    = INDEX_VERSION;
+	header.discs      = static_cast<uint32_t>(discs.size());
+
+	write_raw(out, header);
+
+	// Directory
+
+	auto offset = uint64_t { sizeof(IndexHeader)
+		+ discs.size() * sizeof(IndexEntry) };
+
+	for (const auto& [ disc, blocks ] : discs)
+	{
+		const auto entry = IndexEntry { disc[0], disc[1], disc[2], disc[3],
+			static_cast<uint32_t>(blocks.size()), 0, offset };
+
+		write_raw(out, entry);
+
+		offset += 3 * disc[3] * blocks.size() * sizeof(uint32_t);
+	}
+
+	// Values of each disc in columns: checksums, confidences, frame 450
+
+	for (const auto& [ disc, blocks ] : discs)
+	{
+		for (const auto column : std::array<std::size_t, 3> { 1, 0, 2 })
+		{
+			for (auto t = std::size_t { 0 }; t < disc[3]; ++t)
+			{
+				for (const auto& block : blocks)
+				{
+					write_raw(out, block[t][column]);
+				}
+			}
+		}
+	}
+
+	if (!out.flush())
+	{
+		throw std::runtime_error("Could not write index file " + filename);
+	}
+
+	ARCS_LOG_DEBUG << "Built index of " << discs.size() << " discs from "
+		<< dbar_files.size() << " dBAR files";
+}
+
+
+DBARIndex::DBARIndex(const std::string& filename)
+	: impl_ { std::make_unique<DBARIndex::Impl>(filename) }
+{
+	// empty
+}
+
+
+DBARIndex::~DBARIndex() noexcept = default;
+
+
+DBARResponse DBARIndex::find(const ARId& id) const
+{
+	return impl_->find(id);
+}
+
+
+std::size_t DBARIndex::size() const noexcept
+{
+	return impl_->size();
+}
+
+
+// ARTrackMatch
+
+
+ARTrackMatch::ARTrackMatch()
+	: pressing_   { -1 }
+	, type_       { arcstk::checksum::type::ARCS1 }
+	, confidence_ { 0 }
+{
+	// empty
+}
+
+
+ARTrackMatch::ARTrackMatch(const int pressing,
+		const arcstk::checksum::type type, const uint32_t confidence)
+	: pressing_   { pressing }
+	, type_       { type }
+	, confidence_ { confidence }
+{
+	// empty
+}
+
+
+bool ARTrackMatch::matches() const noexcept
+{
+	return pressing_ >= 0;
+}
+
+
+int ARTrackMatch::pressing() const noexcept
+{
+	return pressing_;
+}
+
+
+arcstk::checksum::type ARTrackMatch::type() const noexcept
+{
+	return type_;
+}
+
+
+uint32_t ARTrackMatch::confidence() const noexcept
+{
+	return confidence_;
+}
+
+
+// ARMatch
+
+
+ARMatch::ARMatch()
+	: candidate_ { -1 }
+	, tracks_    { /* empty */ }
+{
+	// empty
+}
+
+
+ARMatch::ARMatch(const int candidate, const std::vector<ARTrackMatch>& tracks)
+	: candidate_ { candidate }
+	, tracks_    { tracks }
+{
+	// empty
+}
+
+
+bool ARMatch::found() const noexcept
+{
+	return candidate_ >= 0;
+}
+
+
+bool ARMatch::matches() const noexcept
+{
+	return found() && matching_tracks() == static_cast<int>(tracks_.size());
+}
+
+
+int ARMatch::matching_tracks() const noexcept
+{
+	return static_cast<int>(std::count_if(tracks_.begin(), tracks_.end(),
+			[](const ARTrackMatch& t) { return t.matches(); }));
+}
+
+
+int ARMatch::candidate() const noexcept
+{
+	return candidate_;
+}
+
+
+const std::vector<ARTrackMatch>& ARMatch::tracks() const noexcept
+{
+	return tracks_;
+}
+
+
+// ARMatcher
+
+
+namespace
+{
+
+/**
+ * \brief Match the checksums of a track against all pressings.
+ *
+ * \param[in] response  Response of the disc
+ * \param[in] track     0-based index of the track
+ * \param[in] checksums Checksums of the track
+ *
+ * \return Match of the track
+ */
+ARTrackMatch match_track(const DBARResponse& response, const int track,
+		const arcstk::ChecksumSet& checksums)
+{
+	using arcstk::checksum::type;
+
+	const auto v1 { checksums.get(type::ARCS1) };
+	const auto v2 { checksums.get(type::ARCS2) };
+
+	const auto has_v1 { static_cast<uint32_t>(!v1.empty()) };
+	const auto has_v2 { static_cast<uint32_t>(!v2.empty()) };
+	const auto arcs1  { v1.value() };
+	const auto arcs2  { v2.value() };
+
+	const auto refs       { response.checksums(track) };
+	const auto confidence { response.confidences(track) };
+	const auto pressings  { response.pressings() };
+
+	// Score of a pressing is its confidence + 1 if it matches, otherwise 0.
+	// Branch-free to let the compiler vectorize the loop.
+
+	auto best = uint32_t { 0 };
+
+	for (auto p { 0 }; p < pressings; ++p)
+	{
+		const auto hit { (static_cast<uint32_t>(refs[p] == arcs1) & has_v1)
+			| (static_cast<uint32_t>(refs[p] == arcs2) & has_v2) };
+		const auto score { hit * (confidence[p] + 1) };
+
+		best = score > best ? score : best;
+	}
+
+	if (best == 0)
+	{
+		return ARTrackMatch {};
+	}
+
+	for (auto p { 0 }; p < pressings; ++p)
+	{
+		if (confidence[p] + 1 != best)
+		{
+			continue;
+		}
+
+		if (has_v2 && refs[p] == arcs2)
+		{
+			return ARTrackMatch { p, type::ARCS2, confidence[p] };
+		}
+
+		if (has_v1 && refs[p] == arcs1)
+		{
+			return ARTrackMatch { p, type::ARCS1, confidence[p] };
+		}
+	}
+
+	return ARTrackMatch {}; // not reached
+}
+
+} // namespace
+
+
+ARMatcher::ARMatcher(const DBARIndex& index)
+	: index_ { &index }
+{
+	// empty
+}
+
+
+ARMatch ARMatcher::match(const ARId& id, const Checksums& checksums) const
+{
+	return match(id, std::vector<Checksums> { checksums });
+}
+
+
+ARMatch ARMatcher::match(const ARId& id,
+		const std::vector<Checksums>& candidates) const
+{
+	const auto response { index_->find(id) };
+
+	if (response.empty() || candidates.empty())
+	{
+		return ARMatch {};
+	}
+
+	auto best_candidate  = int { 0 };
+	auto best_tracks     = std::vector<ARTrackMatch> {};
+	auto best_matches    = int { -1 };
+	auto best_confidence = uint64_t { 0 };
+
+	for (auto c = std::size_t { 0 }; c < candidates.size(); ++c)
+	{
+		const auto& checksums { candidates[c] };
+
+		auto tracks = std::vector<ARTrackMatch>(
+				static_cast<std::size_t>(response.tracks()));
+
+		auto matches    = int { 0 };
+		auto confidence = uint64_t { 0 };
+
+		const auto total { std::min(checksums.size(),
+				static_cast<std::size_t>(response.tracks())) };
+
+		for (auto t = std::size_t { 0 }; t < total; ++t)
+		{
+			tracks[t] = match_track(response, static_cast<int>(t),
+					checksums[t]);
+
+			if (tracks[t].matches())
+			{
+				++matches;
+				confidence += tracks[t].confidence();
+			}
+		}
+
+		if (std::tie(matches, confidence)
+				> std::tie(best_matches, best_confidence))
+		{
+			best_candidate  = static_cast<int>(c);
+			best_tracks     = std::move(tracks);
+			best_matches    = matches;
+			best_confidence = confidence;
+		}
+	}
+
+	return ARMatch { best_candidate, best_tracks };
+}
+
+
+std::vector<ARMatch> ARMatcher::match(const std::vector<ARId>& ids,
+		const std::vector<std::vector<Checksums>>& candidates) const
+{
+	if (ids.size() != candidates.size())
+	{
+		throw std::invalid_argument("Number of ARIds and candidates differ");
+	}
+
+	auto matches = std::vector<ARMatch> {};
+	matches.reserve(ids.size());
+
+	for (auto i = std::size_t { 0 }; i < ids.size(); ++i)
+	{
+		matches.push_back(match(ids[i], candidates[i]));
+	}
+
+	return matches;
+}
+
+} // namespace v_1_0_0
+} // namespace arcsdec
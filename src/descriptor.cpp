@@ -38,7 +38,7 @@ inline namespace v_1_0_0
 
 std::string name(Format format)
 {
-	static const std::array<std::string, 11> names =
+	static const std::array<std::string, FORMAT_COUNT> names =
 	{
 		"unknown",
 		"cue",
@@ -61,7 +61,7 @@ std::string name(Format format)
 
 std::string name(Codec codec)
 {
-	static const std::array<std::string, 14> names =
+	static const std::array<std::string, CODEC_COUNT> names =
 	{
 		"unknown",
 		"PCM_S16BE",
@@ -380,6 +380,12 @@ ByteSequence::const_reference Bytes::operator[](
 }
 
 
+bool Bytes::is_wildcard(ByteSequence::size_type i) const
+{
+	return seq_.is_wildcard(i);
+}
+
+
 Bytes& Bytes::swap(Bytes& b) // noexcept
 {
 	using std::swap;
@@ -583,6 +589,18 @@ std::unique_ptr<FileReaderDescriptor> FileReader::descriptor() const
 }
 
 
+bool FileReader::reset()
+{
+	return this->do_reset();
+}
+
+
+bool FileReader::do_reset()
+{
+	return false;
+}
+
+
 // InputFormatException
 
 
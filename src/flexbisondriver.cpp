@@ -12,7 +12,9 @@
 #include <arcstk/logging.hpp>
 #endif
 
+#include <cstddef>     // for size_t
 #include <fstream>     // for ifstream
+#include <ios>         // for ios_base
 #include <stdexcept>   // for invalid_argument
 #include <string>      // for vector
 #include <vector>      // for string
@@ -79,6 +81,54 @@ std::string lexer_strip_quotes(const std::string& s)
 	return s.substr(1, s.length() - 2);
 }
 
+
+
+// MemoryBuffer
+
+
+MemoryBuffer::MemoryBuffer(const char* data, const std::size_t size)
+{
+	// The buffer is only used for reading, thus casting away const is safe
+	auto begin { const_cast<char*>(data) };
+	this->setg(begin, begin, begin + size);
+}
+
+
+MemoryBuffer::pos_type MemoryBuffer::seekoff(off_type off,
+		std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	if (!(which & std::ios_base::in))
+	{
+		return pos_type(off_type(-1));
+	}
+
+	auto target = off_type { off };
+
+	if (dir == std::ios_base::cur)
+	{
+		target += this->gptr() - this->eback();
+	} else if (dir == std::ios_base::end)
+	{
+		target += this->egptr() - this->eback();
+	}
+
+	if (target < 0 || target > this->egptr() - this->eback())
+	{
+		return pos_type(off_type(-1));
+	}
+
+	this->setg(this->eback(), this->eback() + target, this->egptr());
+
+	return pos_type(target);
+}
+
+
+MemoryBuffer::pos_type MemoryBuffer::seekpos(pos_type pos,
+		std::ios_base::openmode which)
+{
+	return this->seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
 } // namespace details
 } // namespace v_1_0_0
 } // namespace arcsdec
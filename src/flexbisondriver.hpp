@@ -9,9 +9,17 @@
  * classes.
  */
 
+#ifndef __LIBARCSDEC_METAPARSER_HPP__
+#include "metaparser.hpp"   // for MetadataParseException
+#endif
+
+#include <cstddef>     // for size_t
 #include <fstream>     // for ifstream
+#include <ios>         // for ios_base
+#include <istream>     // for istream
 #include <memory>      // for unique_ptr
 #include <ostream>     // for ostream
+#include <streambuf>   // for streambuf
 #include <stdexcept>   // for runtime_error
 #include <string>      // for string
 #include <type_traits> // for void_t
@@ -349,6 +357,32 @@ public:
 };
 
 
+/**
+ * \brief Read-only stream buffer on a region of memory.
+ *
+ * The memory is not copied. It must remain valid as long as the buffer is used.
+ */
+class MemoryBuffer final : public std::streambuf
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] data Start of the memory region
+	 * \param[in] size Size of the memory region in bytes
+	 */
+	MemoryBuffer(const char* data, const std::size_t size);
+
+protected:
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+			std::ios_base::openmode which) override;
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+};
+
+
 #if defined(__GNUG__)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Weffc++"
@@ -480,12 +514,39 @@ public:
 		}
 	}
 
+	/**
+	 * \brief Run parser on a region of memory.
+	 *
+	 * The memory is not copied. It must remain valid until parsing is
+	 * completed.
+	 *
+	 * \param[in] data Start of the content to parse
+	 * \param[in] size Size of the content in bytes
+	 *
+	 * \throw MetadataParseException If the content could not be parsed
+	 */
+	void parse(const char* data, const std::size_t size)
+	{
+		MemoryBuffer buffer { data, size };
+		std::istream input { &buffer };
+
+		this->set_input(input);
+
+		if (this->parse() != 0)
+		{
+			throw MetadataParseException("Failed to parse buffer");
+		}
+	}
+
 	/**
 	 * \brief Clear parsed content and reset location.
+	 *
+	 * Also resets the lexer, thus the driver can be reused for a new input.
 	 */
 	void reset()
 	{
 		this->current_loc_.reset();
+		this->lexer_->reset();
 	}
 
 	/**
@@ -0,0 +1,55 @@
+#ifndef __LIBARCSDEC_LOGLEVEL_HPP__
+#define __LIBARCSDEC_LOGLEVEL_HPP__
+
+/**
+ * \internal
+ *
+ * \file
+ *
+ * \brief Compile-time maximum log level for hot paths.
+ *
+ * Log statements that are executed for every block of samples evaluate their
+ * level and access the global logger each time. ARCSDEC_LOG() works like
+ * ARCS_LOG() but removes every statement with a level above the maximum log
+ * level from the code, including the evaluation of its stream expression.
+ *
+ * The maximum log level is set by LIBARCSDEC_MAX_LOGLEVEL as the name of an
+ * arcstk::LOGLEVEL, e.g. -DLIBARCSDEC_MAX_LOGLEVEL=INFO. If it is not set,
+ * every level is compiled.
+ */
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp> // for ARCS_LOG, LOGLEVEL
+#endif
+
+#ifndef LIBARCSDEC_MAX_LOGLEVEL
+#define LIBARCSDEC_MAX_LOGLEVEL DEBUG4
+#endif
+
+/**
+ * \brief Log with the specified level unless it exceeds the maximum log level.
+ *
+ * \param[in] LEVEL Name of an arcstk::LOGLEVEL, e.g. DEBUG1
+ */
+#define ARCSDEC_LOG(LEVEL) \
+	if (arcstk::LOGLEVEL::LEVEL > arcsdec::details::max_loglevel) {} \
+	else ARCS_LOG(LEVEL)
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+namespace details
+{
+
+/**
+ * \brief Maximum log level compiled into hot paths.
+ */
+constexpr auto max_loglevel = arcstk::LOGLEVEL::LIBARCSDEC_MAX_LOGLEVEL;
+
+} // namespace details
+} // namespace v_1_0_0
+} // namespace arcsdec
+
+#endif
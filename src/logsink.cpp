@@ -0,0 +1,392 @@
+/**
+ * \file
+ *
+ * \brief Implements a non-blocking sink for log messages.
+ */
+
+#ifndef __LIBARCSDEC_LOGSINK_HPP__
+#include "logsink.hpp"
+#endif
+
+extern "C" {
+#include <sys/types.h>   // for ssize_t
+}
+
+#include <atomic>             // for atomic
+#include <condition_variable> // for condition_variable
+#include <cstddef>            // for size_t
+#include <cstdint>            // for uint64_t
+#include <cstdio>             // for FILE, fopencookie, funopen, fwrite, ...
+#include <memory>             // for unique_ptr, make_unique
+#include <mutex>              // for mutex, lock_guard, unique_lock
+#include <string>             // for string
+#include <thread>             // for thread
+
+#if defined(__GLIBC__)
+#define LIBARCSDEC_LOGSINK_FOPENCOOKIE
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) \
+	|| defined(__OpenBSD__)
+#define LIBARCSDEC_LOGSINK_FUNOPEN
+#endif
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+
+// AsyncLogSink::Impl
+
+
+/**
+ * \brief Private implementation of AsyncLogSink.
+ *
+ * Messages are appended to a pending buffer. The worker thread swaps the
+ * pending buffer with its own and writes it to the target without holding the
+ * lock. Both buffers are reserved to the capacity in advance, thus logging does
+ * not allocate.
+ */
+class AsyncLogSink::Impl final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] target   Stream to write the messages to
+	 * \param[in] capacity Maximal number of bytes buffered
+	 */
+	Impl(std::FILE* target, const std::size_t capacity);
+
+	/**
+	 * \brief Destructor.
+	 */
+	~Impl() noexcept;
+
+	Impl(const Impl&) = delete;
+	Impl& operator=(const Impl&) = delete;
+
+	/**
+	 * \brief Implements AsyncLogSink::stream().
+	 */
+	std::FILE* stream() const noexcept;
+
+	/**
+	 * \brief Implements AsyncLogSink::flush().
+	 */
+	void flush();
+
+	/**
+	 * \brief Implements AsyncLogSink::dropped().
+	 */
+	uint64_t dropped() const noexcept;
+
+private:
+
+	/**
+	 * \brief Append data to the pending buffer or drop it if it does not fit.
+	 *
+	 * \param[in] data Data to append
+	 * \param[in] size Number of bytes in \c data
+	 */
+	void append(const char* data, const std::size_t size);
+
+	/**
+	 * \brief Open a stream that passes its output to append().
+	 *
+	 * \return Stream or nullptr if custom streams are not supported
+	 */
+	std::FILE* open_stream();
+
+	/**
+	 * \brief Loop of the worker thread.
+	 */
+	void run();
+
+#if defined(LIBARCSDEC_LOGSINK_FOPENCOOKIE)
+
+	/**
+	 * \brief Write function of the stream for fopencookie().
+	 */
+	static ssize_t write(void* cookie, const char* data, std::size_t size);
+
+#elif defined(LIBARCSDEC_LOGSINK_FUNOPEN)
+
+	/**
+	 * \brief Write function of the stream for funopen().
+	 */
+	static int write(void* cookie, const char* data, int size);
+
+#endif
+
+	/**
+	 * \brief Stream to write the messages to.
+	 */
+	std::FILE* target_;
+
+	/**
+	 * \brief Maximal number of bytes pending.
+	 */
+	const std::size_t capacity_;
+
+	/**
+	 * \brief Messages not yet taken by the worker.
+	 */
+	std::string pending_;
+
+	/**
+	 * \brief TRUE iff the worker is writing messages to the target.
+	 */
+	bool writing_;
+
+	/**
+	 * \brief TRUE iff the worker is to stop after writing pending_.
+	 */
+	bool stop_;
+
+	/**
+	 * \brief Number of messages dropped.
+	 */
+	std::atomic<uint64_t> dropped_;
+
+	/**
+	 * \brief Guards pending_, writing_ and stop_.
+	 */
+	std::mutex mutex_;
+
+	/**
+	 * \brief Notifies the worker about pending messages or stop_.
+	 */
+	std::condition_variable ready_;
+
+	/**
+	 * \brief Notifies waiting flushes about written messages.
+	 */
+	std::condition_variable drained_;
+
+	/**
+	 * \brief Stream that passes its output to append() or nullptr.
+	 */
+	std::FILE* stream_;
+
+	/**
+	 * \brief Thread that writes the messages to the target.
+	 */
+	std::thread worker_;
+};
+
+
+AsyncLogSink::Impl::Impl(std::FILE* target, const std::size_t capacity)
+	: target_   { target }
+	, capacity_ { capacity }
+	, pending_  { /* empty */ }
+	, writing_  { false }
+	, stop_     { false }
+	, dropped_  { 0 }
+	, mutex_    { /* default */ }
+	, ready_    { /* default */ }
+	, drained_  { /* default */ }
+	, stream_   { nullptr }
+	, worker_   { /* empty */ }
+{
+	pending_.reserve(capacity_);
+
+	stream_ = open_stream();
+
+	if (stream_)
+	{
+		std::setvbuf(stream_, nullptr, _IOLBF, BUFSIZ);
+
+		worker_ = std::thread { &AsyncLogSink::Impl::run, this };
+	}
+}
+
+
+AsyncLogSink::Impl::~Impl() noexcept
+{
+	if (!stream_)
+	{
+		return;
+	}
+
+	// Closing the stream passes its remaining output to append()
+
+	std::fclose(stream_);
+
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+
+	ready_.notify_one();
+	worker_.join();
+}
+
+
+std::FILE* AsyncLogSink::Impl::stream() const noexcept
+{
+	return stream_ ? stream_ : target_;
+}
+
+
+void AsyncLogSink::Impl::flush()
+{
+	if (!stream_)
+	{
+		std::fflush(target_);
+		return;
+	}
+
+	std::fflush(stream_);
+
+	auto lock = std::unique_lock<std::mutex> { mutex_ };
+	drained_.wait(lock, [this]{ return pending_.empty() && !writing_; });
+}
+
+
+uint64_t AsyncLogSink::Impl::dropped() const noexcept
+{
+	return dropped_.load();
+}
+
+
+void AsyncLogSink::Impl::append(const char* data, const std::size_t size)
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		if (pending_.size() + size > capacity_)
+		{
+			++dropped_;
+			return;
+		}
+
+		pending_.append(data, size);
+	}
+
+	ready_.notify_one();
+}
+
+
+std::FILE* AsyncLogSink::Impl::open_stream()
+{
+#if defined(LIBARCSDEC_LOGSINK_FOPENCOOKIE)
+
+	auto functions = cookie_io_functions_t {};
+	functions.write = &AsyncLogSink::Impl::write;
+
+	return ::fopencookie(this, "w", functions);
+
+#elif defined(LIBARCSDEC_LOGSINK_FUNOPEN)
+
+	return ::funopen(this, nullptr, &AsyncLogSink::Impl::write, nullptr,
+			nullptr);
+
+#else
+
+	return nullptr;
+
+#endif
+}
+
+
+void AsyncLogSink::Impl::run()
+{
+	auto buffer = std::string {};
+	buffer.reserve(capacity_);
+
+	auto lock = std::unique_lock<std::mutex> { mutex_ };
+
+	while (true)
+	{
+		ready_.wait(lock, [this]{ return stop_ || !pending_.empty(); });
+
+		if (pending_.empty())
+		{
+			break; // stop_ is set and everything is written
+		}
+
+		pending_.swap(buffer);
+		writing_ = true;
+
+		lock.unlock();
+
+		std::fwrite(buffer.data(), 1, buffer.size(), target_);
+		std::fflush(target_);
+		buffer.clear();
+
+		lock.lock();
+
+		writing_ = false;
+		drained_.notify_all();
+	}
+}
+
+
+#if defined(LIBARCSDEC_LOGSINK_FOPENCOOKIE)
+
+ssize_t AsyncLogSink::Impl::write(void* cookie, const char* data,
+		std::size_t size)
+{
+	static_cast<AsyncLogSink::Impl*>(cookie)->append(data, size);
+
+	// Report dropped messages as written, the stream must not fail
+
+	return static_cast<ssize_t>(size);
+}
+
+#elif defined(LIBARCSDEC_LOGSINK_FUNOPEN)
+
+int AsyncLogSink::Impl::write(void* cookie, const char* data, int size)
+{
+	static_cast<AsyncLogSink::Impl*>(cookie)->append(data,
+			static_cast<std::size_t>(size));
+
+	// Report dropped messages as written, the stream must not fail
+
+	return size;
+}
+
+#endif
+
+
+// AsyncLogSink
+
+
+AsyncLogSink::AsyncLogSink(std::FILE* target)
+	: AsyncLogSink { target, DEFAULT_CAPACITY }
+{
+	// empty
+}
+
+
+AsyncLogSink::AsyncLogSink(std::FILE* target, const std::size_t capacity)
+	: impl_ { std::make_unique<AsyncLogSink::Impl>(target, capacity) }
+{
+	// empty
+}
+
+
+AsyncLogSink::~AsyncLogSink() noexcept = default;
+
+
+std::FILE* AsyncLogSink::stream() const noexcept
+{
+	return impl_->stream();
+}
+
+
+void AsyncLogSink::flush()
+{
+	impl_->flush();
+}
+
+
+uint64_t AsyncLogSink::dropped() const noexcept
+{
+	return impl_->dropped();
+}
+
+} // namespace v_1_0_0
+} // namespace arcsdec
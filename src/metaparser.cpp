@@ -9,13 +9,18 @@
 #include "metaparser.hpp"
 #endif
 
+#ifndef __LIBARCSDEC_SELECTION_HPP__
+#include "selection.hpp"       // for FileReaderRegistry, cast_reader
+#endif
+
 #ifndef __LIBARCSTK_LOGGING_HPP__
 #include <arcstk/logging.hpp>  // for ARCS_LOG_DEBUG
 #endif
 
-#include <memory>   // for unique_ptr
-#include <string>   // for string
-#include <utility>  // for move
+#include <exception> // for exception
+#include <memory>    // for unique_ptr
+#include <string>    // for string
+#include <utility>   // for move
 
 
 namespace arcsdec
@@ -38,6 +43,13 @@ std::unique_ptr<ToC> MetadataParserImpl::parse(const std::string& filename)
 }
 
 
+std::unique_ptr<ToC> MetadataParserImpl::parse(const char* data,
+		const std::size_t size)
+{
+	return this->do_parse_buffer(data, size);
+}
+
+
 std::unique_ptr<FileReaderDescriptor> MetadataParserImpl::descriptor() const
 {
 	return this->do_descriptor();
@@ -73,12 +85,33 @@ std::unique_ptr<ToC> MetadataParser::parse(const std::string& filename)
 }
 
 
+std::unique_ptr<ToC> MetadataParser::parse(const char* data,
+		const std::size_t size)
+{
+	ARCS_LOG_DEBUG << "Try to read metadata from buffer of " << size
+		<< " bytes";
+
+	auto toc = impl_->parse(data, size);
+
+	ARCS_LOG_DEBUG << "Metadata successfully read from buffer";
+
+	return toc;
+}
+
+
 std::unique_ptr<FileReaderDescriptor> MetadataParser::do_descriptor() const
 {
 	return impl_->descriptor();
 }
 
 
+bool MetadataParser::do_reset()
+{
+	// MetadataParserImpls keep no state between inputs
+	return true;
+}
+
+
 // MetadataParseException
 
 
@@ -111,6 +144,39 @@ void frames_to_msf(long frames, int* m, int* s, int* f)
 	*m = frames;
 }
 
+
+std::unique_ptr<ToC> parse_cuesheet_text(const std::string& cuesheet)
+{
+	const auto desc { FileReaderRegistry::default_toc_selection()->get(
+			Format::CUE, Codec::NONE, *FileReaderRegistry::readers()) };
+
+	if (!desc)
+	{
+		throw MetadataParseException("No parser for cue sheets available");
+	}
+
+	auto parser { cast_reader<MetadataParser>(desc->create_reader()).first };
+
+	if (!parser)
+	{
+		throw MetadataParseException("Reader " + desc->id()
+				+ " is not a metadata parser");
+	}
+
+	try
+	{
+		return parser->parse(cuesheet.data(), cuesheet.size());
+
+	} catch (const MetadataParseException&)
+	{
+		throw;
+
+	} catch (const std::exception& e)
+	{
+		throw MetadataParseException(e.what());
+	}
+}
+
 } // namespace details
 } // namespace v_1_0_0
 } // namespace arcsdec
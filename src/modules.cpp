@@ -0,0 +1,190 @@
+/**
+ * \file
+ *
+ * \brief Implementation of loading FileReaders from modules.
+ */
+
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"
+#endif
+
+#ifndef __LIBARCSDEC_DESCRIPTOR_HPP__
+#include "descriptor.hpp"     // for FileReader
+#endif
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp> // for ARCS_LOG_DEBUG
+#endif
+
+extern "C"
+{
+#include <dlfcn.h>     // [glibc, Linux] for dlopen, dlsym, dlerror, RTLD_NOW
+}
+
+#include <cstdlib>     // for getenv
+#include <map>         // for map
+#include <memory>      // for unique_ptr
+#include <mutex>       // for mutex, lock_guard
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string
+#include <vector>      // for vector
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+namespace details
+{
+
+namespace
+{
+
+/**
+ * \brief Load the module with the specified name.
+ *
+ * Each module is opened once, its handle is shared by all of its factories.
+ * Modules are never unloaded since FileReaders created by a module refer to
+ * its code.
+ *
+ * Not thread-safe, called by load_factory() that serializes the calls.
+ *
+ * \param[in] name Name of the module
+ *
+ * \return Handle of the module
+ *
+ * \throw std::runtime_error If the module could not be loaded
+ */
+void* load_module(const std::string& name)
+{
+	static std::map<std::string, void*> modules;
+
+	const auto loaded { modules.find(name) };
+
+	if (loaded != modules.end())
+	{
+		return loaded->second;
+	}
+
+	void* handle = nullptr;
+	auto errors  = std::string {};
+
+	for (const auto& path : module_paths(name))
+	{
+		handle = ::dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+		if (handle)
+		{
+			ARCS_LOG_DEBUG << "Loaded module " << path;
+			break;
+		}
+
+		const auto error { ::dlerror() };
+		errors += std::string { error ? error : "unknown error" } + "; ";
+	}
+
+	if (!handle)
+	{
+		throw std::runtime_error("Could not load module " + name + ": "
+				+ errors);
+	}
+
+	modules.emplace(name, handle);
+
+	return handle;
+}
+
+
+/**
+ * \brief Load the module with the specified name and return a factory.
+ *
+ * \param[in] name    Name of the module
+ * \param[in] factory Name of the factory function
+ *
+ * \return Factory function of the module
+ *
+ * \throw std::runtime_error If the module could not be loaded
+ */
+ModuleFactory load_factory(const std::string& name, const std::string& factory)
+{
+	static std::mutex mutex;
+	static std::map<std::string, ModuleFactory> factories;
+
+	const std::lock_guard<std::mutex> lock(mutex);
+
+	const auto key { name + ":" + factory };
+
+	const auto loaded { factories.find(key) };
+
+	if (loaded != factories.end())
+	{
+		return loaded->second;
+	}
+
+	const auto handle { load_module(name) };
+
+	::dlerror(); // clear
+	const auto symbol { ::dlsym(handle, factory.c_str()) };
+
+	if (!symbol)
+	{
+		throw std::runtime_error("Module " + name + " does not export "
+				+ factory);
+	}
+
+	const auto function { reinterpret_cast<ModuleFactory>(symbol) };
+
+	factories.emplace(key, function);
+
+	return function;
+}
+
+} // namespace
+
+
+std::string module_filename(const std::string& name)
+{
+	return "libarcsdec-" + name + ".so";
+}
+
+
+std::vector<std::string> module_paths(const std::string& name)
+{
+	const auto filename { module_filename(name) };
+
+	auto paths = std::vector<std::string> {};
+
+	const auto env { std::getenv("LIBARCSDEC_MODULE_PATH") };
+
+	if (env && *env)
+	{
+		paths.push_back(std::string { env } + "/" + filename);
+	}
+
+#ifdef LIBARCSDEC_MODULE_DIR
+	paths.push_back(std::string { LIBARCSDEC_MODULE_DIR } + "/" + filename);
+#endif
+
+	paths.push_back(filename);
+
+	return paths;
+}
+
+
+std::unique_ptr<FileReader> create_module_reader(const std::string& name)
+{
+	return create_module_reader(name, MODULE_FACTORY);
+}
+
+
+std::unique_ptr<FileReader> create_module_reader(const std::string& name,
+		const std::string& factory)
+{
+	const auto create { load_factory(name, factory) };
+
+	return std::unique_ptr<FileReader>(create());
+}
+
+} // namespace details
+} // namespace v_1_0_0
+} // namespace arcsdec
@@ -0,0 +1,165 @@
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#define __LIBARCSDEC_MODULES_HPP__
+
+/**
+ * \file
+ *
+ * \brief Load FileReaders from separately built modules on demand.
+ */
+
+#include <memory>      // for unique_ptr
+#include <string>      // for string
+#include <vector>      // for vector
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+class FileReader;
+
+namespace details
+{
+
+/**
+ * \internal
+ *
+ * \defgroup modulesImpl API for loading readers from modules
+ *
+ * \ingroup descriptors
+ *
+ * \brief API for loading readers from modules.
+ *
+ * If libarcsdec is built with WITH_MODULES, each optional reader is built as a
+ * loadable module instead of being linked into the library. The descriptor of
+ * the reader remains in the library and is registered as usual, thus selection
+ * does not require any module. The module, together with the third party
+ * libraries it depends on, is loaded the first time its descriptor creates a
+ * FileReader.
+ *
+ * A module exports its factory function by LIBARCSDEC_MODULE_FACTORY. A module
+ * that provides a further FileReader, e.g. a MetadataParser for metadata
+ * embedded in its audio format, exports a factory function for it by
+ * LIBARCSDEC_MODULE_NAMED_FACTORY.
+ *
+ * \warning
+ * This API is currently *nix-only. It uses dlopen.
+ *
+ * @{
+ */
+
+/**
+ * \brief Type of the factory function a module exports.
+ */
+using ModuleFactory = FileReader* (*)();
+
+/**
+ * \brief Name of the factory function a module exports.
+ */
+constexpr char MODULE_FACTORY[] = "libarcsdec_create_reader";
+
+/**
+ * \brief Name of the factory function for a module's cue sheet parser.
+ */
+constexpr char MODULE_CUESHEET_FACTORY[] = "libarcsdec_create_cuesheet_parser";
+
+/**
+ * \brief Filename of the module with the specified name.
+ *
+ * \param[in] name Name of the module, e.g. "readerflac"
+ *
+ * \return Filename of the module
+ */
+std::string module_filename(const std::string& name);
+
+/**
+ * \brief Paths to try for loading the module with the specified name.
+ *
+ * The directory in environment variable LIBARCSDEC_MODULE_PATH is tried first,
+ * then the install directory for modules. Finally the plain filename is tried,
+ * which lets the dynamic linker search its default paths.
+ *
+ * \param[in] name Name of the module, e.g. "readerflac"
+ *
+ * \return Paths to try in the order of precedence
+ */
+std::vector<std::string> module_paths(const std::string& name);
+
+/**
+ * \brief Create a FileReader by the module with the specified name.
+ *
+ * The module is loaded on the first call and remains loaded until the process
+ * exits.
+ *
+ * \param[in] name Name of the module, e.g. "readerflac"
+ *
+ * \return A FileReader created by the module
+ *
+ * \throw std::runtime_error If the module could not be loaded
+ */
+std::unique_ptr<FileReader> create_module_reader(const std::string& name);
+
+/**
+ * \brief Create a FileReader by the specified factory of a module.
+ *
+ * \param[in] name    Name of the module, e.g. "readerflac"
+ * \param[in] factory Name of the factory function, e.g. MODULE_FACTORY
+ *
+ * \return A FileReader created by the module
+ *
+ * \throw std::runtime_error If the module could not be loaded
+ */
+std::unique_ptr<FileReader> create_module_reader(const std::string& name,
+		const std::string& factory);
+
+/** @} */
+
+} // namespace details
+} // namespace v_1_0_0
+} // namespace arcsdec
+
+
+extern "C"
+{
+
+/**
+ * \brief Factory function of a module, exported by LIBARCSDEC_MODULE_FACTORY.
+ *
+ * \return A FileReader owned by the caller
+ */
+arcsdec::FileReader* libarcsdec_create_reader();
+
+/**
+ * \brief Factory function for the cue sheet parser of a module.
+ *
+ * \return A FileReader owned by the caller
+ */
+arcsdec::FileReader* libarcsdec_create_cuesheet_parser();
+
+} // extern "C"
+
+
+/**
+ * \brief Export a factory function of a module under the specified name.
+ *
+ * The name must be one of the factory functions declared above, i.e.
+ * MODULE_FACTORY or MODULE_CUESHEET_FACTORY.
+ *
+ * \param[in] name    Name of the exported function
+ * \param[in] factory Function returning a std::unique_ptr<FileReader>
+ */
+#define LIBARCSDEC_MODULE_NAMED_FACTORY(name, factory) \
+	extern "C" arcsdec::FileReader* name()             \
+	{                                                  \
+		return factory().release();                    \
+	}
+
+/**
+ * \brief Export the factory function of a module.
+ *
+ * \param[in] factory Function returning a std::unique_ptr<FileReader>
+ */
+#define LIBARCSDEC_MODULE_FACTORY(factory) \
+	LIBARCSDEC_MODULE_NAMED_FACTORY(libarcsdec_create_reader, factory)
+
+#endif
@@ -154,6 +154,13 @@ public:
 	 * \param[in] token_length Length of the current token (eg. yyleng)
 	 */
 	void shift_pos(const int line_no, const int token_length);
+
+	/**
+	 * \brief Reset position, line number and start condition.
+	 *
+	 * Makes the lexer ready for a new input.
+	 */
+	void reset();
 };
 
 } // namespace yycuesheet
@@ -20,6 +20,7 @@
 #endif
 
 #include <cstdint>  // for int32_t
+#include <cstddef>  // for size_t
 #include <memory>   // for unique_ptr
 #include <string>   // for string
 
@@ -80,6 +81,9 @@ private:
 
 	std::unique_ptr<ToC> do_parse(const std::string& filename) final;
 
+	std::unique_ptr<ToC> do_parse_buffer(const char* data,
+			const std::size_t size) final;
+
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
 };
 
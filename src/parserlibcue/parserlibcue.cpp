@@ -14,8 +14,8 @@
 #ifndef __LIBARCSDEC_METAPARSER_HPP__
 #include "metaparser.hpp"         // for MetadataParseException
 #endif
-#ifndef __LIBARCSDEC_SELECTION_HPP__
-#include "selection.hpp"          // for RegisterDescriptor
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"            // for LIBARCSDEC_MODULE_FACTORY
 #endif
 
 #ifndef __LIBARCSTK_METADATA_HPP__
@@ -29,6 +29,7 @@ extern "C" {
 #include <libcue/libcue.h>
 }
 
+#include <cstddef>   // for size_t
 #include <cstdio>    // for fopen, fclose, FILE
 #include <iomanip>   // for setw
 #include <memory>    // for unique_ptr
@@ -133,6 +134,26 @@ CdPtr Make_CdPtr::operator()(const std::string& filename) const
 }
 
 
+CdPtr Make_CdPtr::operator()(const char* data, const std::size_t size) const
+{
+	// libcue expects a null-terminated string
+	const auto cue_data = std::string(data, size);
+
+	ARCS_LOG(DEBUG1) << "Start reading Cuesheet data with libcue";
+
+	auto cd_ptr = CdPtr(::cue_parse_string(cue_data.c_str()));
+
+	if (!cd_ptr.get())
+	{
+		throw MetadataParseException("Failed to parse Cuesheet data");
+	}
+
+	ARCS_LOG(DEBUG1) << "Cuesheet data successfully read";
+
+	return cd_ptr;
+}
+
+
 // CueOpenFile
 
 
@@ -151,6 +172,15 @@ CueOpenFile::CueOpenFile(const std::string& filename)
 }
 
 
+CueOpenFile::CueOpenFile(const char* data, const std::size_t size)
+	: cd_info_ { nullptr }
+{
+	static const Make_CdPtr make_cd;
+
+	cd_info_ = make_cd(data, size);
+}
+
+
 CueInfo CueOpenFile::info() const
 {
 	const auto cd_info = cd_info_.get();
@@ -268,89 +298,55 @@ CueInfo CueParserImpl::parse_worker(const std::string& filename) const
 }
 
 
-std::unique_ptr<ToC> CueParserImpl::do_parse(const std::string& filename)
+CueInfo CueParserImpl::parse_worker(const char* data, const std::size_t size)
+	const
 {
-	const auto cue_info = this->parse_worker(filename);
-
-	return make_toc(std::get<1>(cue_info),  // offsets
-					std::get<3>(cue_info)); // filenames
+	return CueOpenFile { data, size }.info();
 }
 
 
-std::unique_ptr<FileReaderDescriptor> CueParserImpl::do_descriptor() const
-{
-	return std::make_unique<DescriptorCue>();
-}
-
-
-} // namespace libcue
-} // namespace details
-
-
-// DescriptorCue
-
-
-DescriptorCue::~DescriptorCue() noexcept = default;
-
-
-std::string DescriptorCue::do_id() const
+std::unique_ptr<ToC> CueParserImpl::do_parse(const std::string& filename)
 {
-	return "libcue";
-}
-
+	const auto cue_info = this->parse_worker(filename);
 
-std::string DescriptorCue::do_name() const
-{
-	return "Libcue";
+	return make_toc(std::get<1>(cue_info),  // offsets
+					std::get<3>(cue_info)); // filenames
 }
 
 
-InputType DescriptorCue::do_input_type() const
+std::unique_ptr<ToC> CueParserImpl::do_parse_buffer(const char* data,
+		const std::size_t size)
 {
-	return InputType::TOC;
-}
-
+	const auto cue_info = this->parse_worker(data, size);
 
-bool DescriptorCue::do_accepts_codec(Codec codec) const
-{
-	ARCS_LOG(DEBUG1) << "Is Codec NONE?";
-	return codec == Codec::NONE;
+	return make_toc(std::get<1>(cue_info),  // offsets
+					std::get<3>(cue_info)); // filenames
 }
 
 
-std::set<Format> DescriptorCue::define_formats() const
+std::unique_ptr<FileReaderDescriptor> CueParserImpl::do_descriptor() const
 {
-	return { Format::CUE };
+	return std::make_unique<DescriptorCue>();
 }
 
 
-LibInfo DescriptorCue::do_libraries() const
-{
-	return { libinfo_entry_filepath("libcue") };
-}
+// create_reader
 
 
-std::unique_ptr<FileReader> DescriptorCue::do_create_reader() const
+std::unique_ptr<FileReader> create_reader()
 {
-	auto impl = std::make_unique<details::libcue::CueParserImpl>();
+	auto impl = std::make_unique<CueParserImpl>();
 	return std::make_unique<MetadataParser>(std::move(impl));
 }
 
-
-std::unique_ptr<FileReaderDescriptor> DescriptorCue::do_clone() const
-{
-	return std::make_unique<DescriptorCue>();
-}
-
-
-// Add this descriptor to the metadata descriptor registry
-
-namespace {
-
-const auto d = RegisterDescriptor<DescriptorCue>{};
-
-} // namespace
+} // namespace libcue
+} // namespace details
 
 } // namespace v_1_0_0
 } // namespace arcsdec
 
+#ifdef LIBARCSDEC_BUILD_MODULE
+
+LIBARCSDEC_MODULE_FACTORY(arcsdec::details::libcue::create_reader)
+
+#endif
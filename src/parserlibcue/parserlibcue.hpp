@@ -58,6 +58,21 @@ private:
 	std::unique_ptr<FileReaderDescriptor> do_clone() const final;
 };
 
+namespace details
+{
+namespace libcue
+{
+
+/**
+ * \brief Create a MetadataParser as specified by DescriptorCue.
+ *
+ * \return MetadataParser as specified by DescriptorCue
+ */
+std::unique_ptr<FileReader> create_reader();
+
+} // namespace libcue
+} // namespace details
+
 } // namespace v_1_0_0
 } // namespace arcsdec
 
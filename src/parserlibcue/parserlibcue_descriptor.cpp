@@ -0,0 +1,102 @@
+/**
+ * \file
+ *
+ * \brief Implements descriptor for CueSheets parsed by libcue.
+ */
+
+#ifndef __LIBARCSDEC_PARSERLIBCUE_HPP__
+#include "parserlibcue.hpp"
+#endif
+
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"        // for create_module_reader
+#endif
+
+#ifndef __LIBARCSDEC_SELECTION_HPP__
+#include "selection.hpp"      // for RegisterDescriptor
+#endif
+
+#ifndef __LIBARCSTK_LOGGING_HPP__
+#include <arcstk/logging.hpp> // for ARCS_LOG
+#endif
+
+#include <memory>   // for unique_ptr, make_unique
+#include <set>      // for set
+#include <string>   // for string
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+
+// DescriptorCue
+
+
+DescriptorCue::~DescriptorCue() noexcept = default;
+
+
+std::string DescriptorCue::do_id() const
+{
+	return "libcue";
+}
+
+
+std::string DescriptorCue::do_name() const
+{
+	return "Libcue";
+}
+
+
+InputType DescriptorCue::do_input_type() const
+{
+	return InputType::TOC;
+}
+
+
+bool DescriptorCue::do_accepts_codec(Codec codec) const
+{
+	ARCS_LOG(DEBUG1) << "Is Codec NONE?";
+	return codec == Codec::NONE;
+}
+
+
+std::set<Format> DescriptorCue::define_formats() const
+{
+	return { Format::CUE };
+}
+
+
+LibInfo DescriptorCue::do_libraries() const
+{
+	return { libinfo_entry_filepath("libcue") };
+}
+
+
+std::unique_ptr<FileReader> DescriptorCue::do_create_reader() const
+{
+#ifdef LIBARCSDEC_WITH_MODULES
+	return details::create_module_reader("parserlibcue");
+#else
+	return details::libcue::create_reader();
+#endif
+}
+
+
+std::unique_ptr<FileReaderDescriptor> DescriptorCue::do_clone() const
+{
+	return std::make_unique<DescriptorCue>();
+}
+
+
+// Add this descriptor to the metadata descriptor registry
+
+namespace {
+
+const auto d = RegisterDescriptor<DescriptorCue>{};
+
+} // namespace
+
+} // namespace v_1_0_0
+} // namespace arcsdec
@@ -23,6 +23,7 @@ extern "C" {
 #include <libcue/libcue.h>  // for Cd
 }
 
+#include <cstddef>  // for size_t
 #include <cstdint>  // for uint16_t, int32_t
 #include <memory>   // for unique_ptr
 #include <string>   // for string
@@ -96,6 +97,7 @@ using CdPtr = std::unique_ptr<::Cd, Free_Cd>;
 struct Make_CdPtr final
 {
 	CdPtr operator()(const std::string& filename) const;
+	CdPtr operator()(const char* data, const std::size_t size) const;
 };
 
 
@@ -118,6 +120,16 @@ public:
 	 */
 	explicit CueOpenFile(const std::string& filename);
 
+	/**
+	 * \brief Open Cuesheet from a region of memory.
+	 *
+	 * \param[in] data Start of the Cuesheet data
+	 * \param[in] size Size of the Cuesheet data in bytes
+	 *
+	 * \throw MetadataParseException If the Cue data could not be parsed
+	 */
+	CueOpenFile(const char* data, const std::size_t size);
+
 	CueOpenFile(CueOpenFile&& file) noexcept;
 	CueOpenFile& operator = (CueOpenFile&& file) noexcept;
 
@@ -155,8 +167,23 @@ private:
 	 */
 	CueInfo parse_worker(const std::string& filename) const;
 
+	/**
+	 * \brief Return Cue data.
+	 *
+	 * \param[in] data Start of the Cuesheet data
+	 * \param[in] size Size of the Cuesheet data in bytes
+	 *
+	 * \return The CueInfo of the parsed Cuesheet
+	 *
+	 * \throw MetadataParseException If the Cue data could not be parsed
+	 */
+	CueInfo parse_worker(const char* data, const std::size_t size) const;
+
 	std::unique_ptr<ToC> do_parse(const std::string& filename) final;
 
+	std::unique_ptr<ToC> do_parse_buffer(const char* data,
+			const std::size_t size) final;
+
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
 };
 
@@ -52,14 +52,33 @@ namespace cdrtoc
 using arcstk::ToC;
 
 
-std::unique_ptr<ToC> TocParserImpl::do_parse(const std::string& filename)
+namespace
 {
-	auto p_handler = ParserToCHandler{};
 
-	{
-		auto l_handler = DefaultLexerHandler { /* default */ } ;
-		auto driver    = Driver { &l_handler, &p_handler };
+#if defined(__GNUG__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
 
+/**
+ * \brief Handlers and driver that are reused for subsequent inputs.
+ *
+ * Constructing a Driver allocates lexer and parser. When many small files are
+ * parsed, this setup dominates the runtime. Since the Driver is not thread
+ * safe, each thread keeps its own instance.
+ */
+class ReusableDriver final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	ReusableDriver()
+		: p_handler_ { /* default */ }
+		, l_handler_ { /* default */ }
+		, driver_    { &l_handler_, &p_handler_ }
+	{
 #ifdef YYDEBUG
 		const auto lexer_level  = 1;
 		ARCS_LOG_DEBUG << "Set lexer debug level: " << lexer_level;
@@ -74,13 +93,76 @@ std::unique_ptr<ToC> TocParserImpl::do_parse(const std::string& filename)
 		ARCS_LOG_DEBUG << "Parser debug info is deactivated";
 #endif
 
-		driver.set_lexer_debug_level(lexer_level);
-		driver.set_parser_debug_level(parser_level);
+		driver_.set_lexer_debug_level(lexer_level);
+		driver_.set_parser_debug_level(parser_level);
+	}
+
+	/**
+	 * \brief Parse the specified input.
+	 *
+	 * \param[in] input Input as accepted by Driver::parse()
+	 *
+	 * \return ToC represented by the input
+	 */
+	template <typename... Input>
+	std::unique_ptr<ToC> parse(const Input&... input)
+	{
+		driver_.parse(input...);
 
-		driver.parse(filename);
+		return p_handler_.get_toc();
 	}
 
-	return p_handler.get_toc();
+private:
+
+	/**
+	 * \brief Internal parser handler.
+	 */
+	ParserToCHandler p_handler_;
+
+	/**
+	 * \brief Internal lexer handler.
+	 */
+	DefaultLexerHandler l_handler_;
+
+	/**
+	 * \brief Internal driver.
+	 */
+	Driver driver_;
+};
+
+#if defined(__GNUG__)
+#pragma GCC diagnostic pop
+#endif
+
+
+/**
+ * \brief Parse the specified input with the driver of the current thread.
+ *
+ * \param[in] input Input as accepted by Driver::parse()
+ *
+ * \return ToC represented by the input
+ */
+template <typename... Input>
+std::unique_ptr<ToC> parse_input(const Input&... input)
+{
+	thread_local ReusableDriver driver;
+
+	return driver.parse(input...);
+}
+
+} // namespace
+
+
+std::unique_ptr<ToC> TocParserImpl::do_parse(const std::string& filename)
+{
+	return parse_input(filename);
+}
+
+
+std::unique_ptr<ToC> TocParserImpl::do_parse_buffer(const char* data,
+		const std::size_t size)
+{
+	return parse_input(data, size);
 }
 
 
@@ -19,6 +19,7 @@
 #include "metaparser.hpp"        // for MetaparserImpl
 #endif
 
+#include <cstddef>  // for size_t
 #include <memory>   // for unique_ptr
 #include <string>   // for string
 
@@ -58,6 +59,9 @@ class TocParserImpl final : public MetadataParserImpl
 {
 	std::unique_ptr<ToC> do_parse(const std::string& filename) final;
 
+	std::unique_ptr<ToC> do_parse_buffer(const char* data,
+			const std::size_t size) final;
+
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
 };
 
@@ -17,8 +17,11 @@
 #ifndef __LIBARCSDEC_LIBINSPECT_HPP__
 #include "libinspect.hpp"   // for first_libname_match
 #endif
-#ifndef __LIBARCSDEC_SELECTION_HPP__
-#include "selection.hpp"    // for RegisterDescriptor
+#ifndef __LIBARCSDEC_LOGLEVEL_HPP__
+#include "loglevel.hpp"     // for max_loglevel
+#endif
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"      // for LIBARCSDEC_MODULE_FACTORY
 #endif
 
 #ifndef __LIBARCSTK_METADATA_HPP__
@@ -36,18 +39,11 @@ extern "C"
 #include <libavutil/avutil.h>
 }
 
-// required for using <string.h>
-#ifdef __STDC_ALLOC_LIB__
-	#define __STDC_WANT_LIB_EXT2__ 1
-#else
-	#define _POSIX_C_SOURCE 200809L
-#endif
-#include <string.h>   // for strdup (C)
-
 #include <algorithm>  // for remove
 #include <cerrno>     // for EAGAIN
 #include <climits>    // for CHAR_BIT
-#include <cstdarg>    // for va_list
+#include <cstdarg>    // for va_list, va_copy, va_end
+#include <cstdio>     // for vsnprintf
 #include <cstdlib>    // for size_t, abs
 #include <cstring>    // for strlen
 #include <functional> // for function, bind, placeholders
@@ -83,58 +79,51 @@ void arcs_av_log(void* /*v*/, int level, const char* fmt, std::va_list args)
 
 	// Decide whether to print anything at the first place
 
-	if (LEVEL > CLIP_LOGGING_LEVEL
+	if (LEVEL > max_loglevel
+			|| LEVEL > CLIP_LOGGING_LEVEL
 			|| LEVEL > arcstk::Logging::instance().level()
 			|| LEVEL == LOGLEVEL::NONE)
 	{
 		return;
 	}
 
-	// Format message as passed by ffmpeg
+	// Format message as passed by ffmpeg. Messages that fit in the local
+	// buffer are formatted once, longer messages are formatted again by a copy
+	// of the argument list since args can only be traversed once.
 
 	std::string text { "[FFMPEG] " };
 
 	{
+		std::va_list args_copy;
+		va_copy(args_copy, args);
+
 		char buf[384];
 
 		// print to local buffer
-		auto length { std::vsnprintf(buf, sizeof buf, fmt, args) };
+		const auto length { std::vsnprintf(buf, sizeof buf, fmt, args) };
 
 		if (length < 0) {
 			// formatting error, abort logging
+			va_end(args_copy);
 			ARCS_LOG_ERROR << "Failed to format message from FFMPEG";
 			return;
+		}
+
+		if (static_cast<unsigned>(length) < sizeof buf)
+		{
+			// message was successfully formatted
+			text.append(buf, static_cast<std::size_t>(length));
 		} else
 		{
-			char* msg;
-
-			if (static_cast<unsigned>(length) < sizeof buf)
-			{
-				// message was successfully formatted, allocate a copy
-				msg = ::strdup(buf);
-			} else
-			{
-				// message was truncated, allocate a buffer that is large enough
-				msg = static_cast<char*>(::malloc(length + 1U));
-			}
-
-			if (!msg)
-			{
-				// allocation error, abort logging
-				ARCS_LOG_ERROR << "Failed to log message from FFMPEG";
-				return;
-			}
-
-			// format the message again if buffer is large enought this time
-			if (static_cast<unsigned>(length) >= sizeof buf)
-			{
-				length = std::vsnprintf(msg, length + 1U, fmt, args);
-			}
-
-			text += msg;
+			// message was truncated, format it again directly into text
+			const auto prefix { text.size() };
+			text.resize(prefix + static_cast<std::size_t>(length));
 
-			::free(msg);
+			std::vsnprintf(&text[prefix], static_cast<std::size_t>(length) + 1U,
+					fmt, args_copy);
 		}
+
+		va_end(args_copy);
 	}
 
 	// Remove newline(s) from message text
@@ -1219,7 +1208,12 @@ FFmpegAudioReaderImpl::FFmpegAudioReaderImpl()
 }
 
 
-FFmpegAudioReaderImpl::~FFmpegAudioReaderImpl() noexcept = default;
+FFmpegAudioReaderImpl::~FFmpegAudioReaderImpl() noexcept
+{
+	// The producer thread of the open input calls this instance
+
+	this->stop_producer();
+}
 
 
 std::unique_ptr<AudioSize> FFmpegAudioReaderImpl::do_acquire_size(
@@ -1336,6 +1330,14 @@ std::unique_ptr<FileReaderDescriptor> FFmpegAudioReaderImpl::do_descriptor()
 }
 
 
+bool FFmpegAudioReaderImpl::do_reset()
+{
+	// All FFmpeg contexts are owned by do_process_file() and released on
+	// return, no state is kept between inputs.
+	return true;
+}
+
+
 void FFmpegAudioReaderImpl::frame_callback(AVFramePtr frame)
 {
 	this->pass_frame(std::move(frame));
@@ -1667,96 +1669,24 @@ void operator << (std::ostream& out, const ::AVStream* stream)
 	print_stream_info(out, stream);
 }
 
-} // namespace ffmpeg
-} // namespace details
-
-
-// DescriptorFFmpeg
-
-
-DescriptorFFmpeg::~DescriptorFFmpeg() noexcept = default;
-
-
-std::string DescriptorFFmpeg::do_id() const
-{
-	return "ffmpeg";
-}
-
-
-std::string DescriptorFFmpeg::do_name() const
-{
-	return "FFmpeg";
-}
-
-
-std::set<Format> DescriptorFFmpeg::define_formats() const
-{
-	return
-	{
-		Format::WAV,
-		Format::FLAC,
-		Format::APE,
-		Format::CAF,
-		Format::M4A,
-		Format::OGG,
-		// not WV,
-		Format::AIFF
-		//TODO Format::WMA
-	};
-}
-
-
-std::set<Codec> DescriptorFFmpeg::define_codecs() const
-{
-	return {
-		Codec::PCM_S16BE,
-		Codec::PCM_S16BE_PLANAR,
-		Codec::PCM_S16LE,
-		Codec::PCM_S16LE_PLANAR,
-		Codec::PCM_S32BE,
-		Codec::PCM_S32BE_PLANAR,
-		Codec::PCM_S32LE,
-		Codec::PCM_S32LE_PLANAR,
-		Codec::FLAC,
-		// not WAVEPACK
-		Codec::MONKEY,
-		Codec::ALAC
-		//TODO Codec::WMALOSSLESS
-	};
-}
-
 
-LibInfo DescriptorFFmpeg::do_libraries() const
-{
-	return {
-		libinfo_entry_filepath("libavformat"),
-		libinfo_entry_filepath("libavcodec"),
-		libinfo_entry_filepath("libavutil"),
-	};
-}
+// create_reader
 
 
-std::unique_ptr<FileReader> DescriptorFFmpeg::do_create_reader() const
+std::unique_ptr<FileReader> create_reader()
 {
-	auto impl { std::make_unique<details::ffmpeg::FFmpegAudioReaderImpl>() };
+	auto impl { std::make_unique<FFmpegAudioReaderImpl>() };
 	return std::make_unique<AudioReader>(std::move(impl));
 }
 
-
-std::unique_ptr<FileReaderDescriptor> DescriptorFFmpeg::do_clone() const
-{
-	return std::make_unique<DescriptorFFmpeg>();
-}
-
-
-// Add this descriptor to the audio descriptor registry
-
-namespace {
-
-const auto d = RegisterDescriptor<DescriptorFFmpeg>{};
-
-} // namespace
+} // namespace ffmpeg
+} // namespace details
 
 } // namespace v_1_0_0
 } // namespace arcsdec
 
+#ifdef LIBARCSDEC_BUILD_MODULE
+
+LIBARCSDEC_MODULE_FACTORY(arcsdec::details::ffmpeg::create_reader)
+
+#endif
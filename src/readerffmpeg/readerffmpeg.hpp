@@ -79,6 +79,21 @@ private:
 	std::unique_ptr<FileReaderDescriptor> do_clone() const final;
 };
 
+namespace details
+{
+namespace ffmpeg
+{
+
+/**
+ * \brief Create an AudioReader as specified by DescriptorFFmpeg.
+ *
+ * \return AudioReader as specified by DescriptorFFmpeg
+ */
+std::unique_ptr<FileReader> create_reader();
+
+} // namespace ffmpeg
+} // namespace details
+
 } // namespace v_1_0_0
 } // namespace arcsdec
 
@@ -0,0 +1,120 @@
+/**
+ * \file
+ *
+ * \brief Implements descriptor for audio files read by ffmpeg.
+ */
+
+#ifndef __LIBARCSDEC_READERFFMPEG_HPP__
+#include "readerffmpeg.hpp"
+#endif
+
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"        // for create_module_reader
+#endif
+
+#ifndef __LIBARCSDEC_SELECTION_HPP__
+#include "selection.hpp"      // for RegisterDescriptor
+#endif
+
+#include <memory>   // for unique_ptr, make_unique
+#include <set>      // for set
+#include <string>   // for string
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+
+// DescriptorFFmpeg
+
+
+DescriptorFFmpeg::~DescriptorFFmpeg() noexcept = default;
+
+
+std::string DescriptorFFmpeg::do_id() const
+{
+	return "ffmpeg";
+}
+
+
+std::string DescriptorFFmpeg::do_name() const
+{
+	return "FFmpeg";
+}
+
+
+std::set<Format> DescriptorFFmpeg::define_formats() const
+{
+	return
+	{
+		Format::WAV,
+		Format::FLAC,
+		Format::APE,
+		Format::CAF,
+		Format::M4A,
+		Format::OGG,
+		// not WV,
+		Format::AIFF
+		//TODO Format::WMA
+	};
+}
+
+
+std::set<Codec> DescriptorFFmpeg::define_codecs() const
+{
+	return {
+		Codec::PCM_S16BE,
+		Codec::PCM_S16BE_PLANAR,
+		Codec::PCM_S16LE,
+		Codec::PCM_S16LE_PLANAR,
+		Codec::PCM_S32BE,
+		Codec::PCM_S32BE_PLANAR,
+		Codec::PCM_S32LE,
+		Codec::PCM_S32LE_PLANAR,
+		Codec::FLAC,
+		// not WAVEPACK
+		Codec::MONKEY,
+		Codec::ALAC
+		//TODO Codec::WMALOSSLESS
+	};
+}
+
+
+LibInfo DescriptorFFmpeg::do_libraries() const
+{
+	return {
+		libinfo_entry_filepath("libavformat"),
+		libinfo_entry_filepath("libavcodec"),
+		libinfo_entry_filepath("libavutil"),
+	};
+}
+
+
+std::unique_ptr<FileReader> DescriptorFFmpeg::do_create_reader() const
+{
+#ifdef LIBARCSDEC_WITH_MODULES
+	return details::create_module_reader("readerffmpeg");
+#else
+	return details::ffmpeg::create_reader();
+#endif
+}
+
+
+std::unique_ptr<FileReaderDescriptor> DescriptorFFmpeg::do_clone() const
+{
+	return std::make_unique<DescriptorFFmpeg>();
+}
+
+
+// Add this descriptor to the audio descriptor registry
+
+namespace {
+
+const auto d = RegisterDescriptor<DescriptorFFmpeg>{};
+
+} // namespace
+
+} // namespace v_1_0_0
+} // namespace arcsdec
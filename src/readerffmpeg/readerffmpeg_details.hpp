@@ -1212,6 +1212,8 @@ private:
 
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
 
+	bool do_reset() final;
+
 	/**
 	 * \brief Callback for decoded single frame.
 	 *
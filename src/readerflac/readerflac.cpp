@@ -18,12 +18,15 @@
 #ifndef __LIBARCSDEC_LIBINSPECT_HPP__
 #include "libinspect.hpp"       // for libinfo_entry_filepath
 #endif
-#ifndef __LIBARCSDEC_SELECTION_HPP__
-#include "selection.hpp"        // for RegisterDescriptor
+#ifndef __LIBARCSDEC_METAPARSER_HPP__
+#include "metaparser.hpp"       // for MetadataParser, parse_cuesheet_text
+#endif
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"          // for LIBARCSDEC_MODULE_FACTORY
 #endif
 
 #ifndef __LIBARCSTK_METADATA_HPP__
-#include <arcstk/metadata.hpp>  // for AudioSize
+#include <arcstk/metadata.hpp>  // for AudioSize, ToC, make_toc, CDDA
 #endif
 #ifndef __LIBARCSTK_LOGGING_HPP__
 #include <arcstk/logging.hpp>   // for ARCS_LOG_ERROR, _WARNING, _INFO, _DEBUG
@@ -38,12 +41,17 @@
 								// FLAC__StreamMetadata
 								// for FLAC__Frame
 
+#include <algorithm>   // for max, min, transform
+#include <cctype>      // for toupper
+#include <cstddef>     // for size_t
+#include <cstdint>     // for int32_t, int64_t
 #include <limits>      // for numeric_limits
 #include <memory>      // for unique_ptr
 #include <set>         // for set
 #include <sstream>     // for ostringstream
 #include <string>      // for string
 #include <utility>     // for make_unique, move
+#include <vector>      // for vector
 
 
 namespace arcsdec
@@ -56,6 +64,8 @@ namespace flac
 {
 
 using arcstk::AudioSize;
+using arcstk::CDDA;
+using arcstk::make_toc;
 
 
 // FlacMetadataHandler
@@ -219,6 +229,9 @@ FlacAudioReaderImpl::FlacAudioReaderImpl()
 	: smplseq_          { /* empty */ }
 	, metadata_handler_ { /* empty */ }
 	, error_handler_    { /* empty */ }
+	, first_            { 0 }
+	, samples_todo_     { -1 }
+	, callback_error_   { /* empty */ }
 {
 	// empty
 }
@@ -228,12 +241,44 @@ FlacAudioReaderImpl::FlacAudioReaderImpl()
 		const ::FLAC__Frame* frame,
 		const ::FLAC__int32* const buffer[])
 {
-	smplseq_.wrap_int_buffer(buffer[0], buffer[1], frame->header.blocksize);
+	if (callback_error_)
+	{
+		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+	}
+
+	auto blocksize { frame->header.blocksize };
+
+	if (samples_todo_ >= 0) // Reading a range
+	{
+		if (samples_todo_ < blocksize)
+		{
+			blocksize = static_cast<decltype(blocksize)>(samples_todo_);
+		}
+
+		samples_todo_ -= blocksize;
+
+		if (blocksize == 0)
+		{
+			return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+		}
+	}
+
+	smplseq_.wrap_int_buffer(buffer[0], buffer[1], blocksize);
 
 	using std::cbegin;
 	using std::cend;
 
-	this->signal_appendsamples(cbegin(smplseq_), cend(smplseq_));
+	// Exceptions must not be thrown through the C code of libFLAC
+
+	try
+	{
+		this->signal_appendsamples(cbegin(smplseq_), cend(smplseq_));
+	}
+	catch (...)
+	{
+		callback_error_ = std::current_exception();
+		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+	}
 
 	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
@@ -242,27 +287,53 @@ FlacAudioReaderImpl::FlacAudioReaderImpl()
 void FlacAudioReaderImpl::metadata_callback(
 		const ::FLAC__StreamMetadata* metadata)
 {
-	switch (metadata->type)
+	// Exceptions must not be thrown through the C code of libFLAC, the
+	// next call of write_callback() aborts the decoder
+
+	if (callback_error_)
 	{
-		case FLAC__METADATA_TYPE_STREAMINFO:
+		return;
+	}
 
-			this->signal_updateaudiosize(
-					to_audiosize(metadata->data.stream_info.total_samples,
-						UNIT::SAMPLES));
+	try
+	{
+		switch (metadata->type)
+		{
+			case FLAC__METADATA_TYPE_STREAMINFO:
+			{
+				auto total { static_cast<int64_t>(
+						metadata->data.stream_info.total_samples) };
 
-			metadata_handler_->validate(*metadata);
-			// Note: Streaminfo could already have been validated explicitly
+				if (samples_todo_ >= 0) // Reading a range
+				{
+					total = std::max(int64_t { 0 },
+							std::min(samples_todo_, total - first_));
+					samples_todo_ = total;
+				}
 
-			break;
+				this->signal_updateaudiosize(
+						to_audiosize(total, UNIT::SAMPLES));
 
-		case FLAC__METADATA_TYPE_CUESHEET:
+				metadata_handler_->validate(*metadata);
+				// Note: Streaminfo could already have been validated
+				// explicitly
 
-			metadata_handler_->cuesheet(*metadata);
+				break;
+			}
 
-			break;
+			case FLAC__METADATA_TYPE_CUESHEET:
 
-		default:
-			break;
+				metadata_handler_->cuesheet(*metadata);
+
+				break;
+
+			default:
+				break;
+		}
+	}
+	catch (...)
+	{
+		callback_error_ = std::current_exception();
 	}
 }
 
@@ -270,7 +341,19 @@ void FlacAudioReaderImpl::metadata_callback(
 void FlacAudioReaderImpl::error_callback(
 		::FLAC__StreamDecoderErrorStatus status)
 {
-	error_handler_->error(status);
+	// As in metadata_callback(), the exception is rethrown later
+
+	try
+	{
+		error_handler_->error(status);
+	}
+	catch (...)
+	{
+		if (!callback_error_)
+		{
+			callback_error_ = std::current_exception();
+		}
+	}
 }
 
 
@@ -305,11 +388,90 @@ std::unique_ptr<AudioSize> FlacAudioReaderImpl::do_acquire_size(
 
 void FlacAudioReaderImpl::do_process_file(const std::string& filename)
 {
-	set_md5_checking(false); // TODO part of validation?
+	decode(filename, 0, -1 /* entire file */);
+}
+
+
+void FlacAudioReaderImpl::do_process_range(const std::string& filename,
+		const int64_t first, const int64_t total)
+{
+	decode(filename, first, std::max(int64_t { 0 }, total));
+}
+
+
+void FlacAudioReaderImpl::do_open(const std::string& filename)
+{
+	first_          = 0;
+	samples_todo_   = -1;
+	callback_error_ = nullptr;
 
 	this->signal_startinput();
 
-	// Process decoded samples
+	if (!init_decoder(filename))
+	{
+		throw FileReadException("Could not initialize FLAC decoder for "
+				+ filename);
+	}
+
+	// Streaminfo provides the size before the first block is requested
+
+	const auto success { this->process_until_end_of_metadata() };
+
+	this->rethrow_callback_error();
+
+	if (!success)
+	{
+		throw FileReadException("Could not decode metadata of " + filename);
+	}
+}
+
+
+bool FlacAudioReaderImpl::do_read_block()
+{
+	// Decoding a single frame passes its samples by write_callback()
+
+	if (this->get_state() == ::FLAC__STREAM_DECODER_END_OF_STREAM)
+	{
+		this->signal_endinput();
+		return false;
+	}
+
+	const auto success { this->process_single() };
+
+	this->rethrow_callback_error();
+
+	if (!success)
+	{
+		auto msg = std::ostringstream{};
+		msg << "Decoding failed, last decoder state: "
+			<< this->get_state().as_cstring();
+
+		throw FileReadException(msg.str());
+	}
+
+	return true;
+}
+
+
+void FlacAudioReaderImpl::do_close()
+{
+	if (this->get_state() != ::FLAC__STREAM_DECODER_UNINITIALIZED)
+	{
+		this->finish();
+	}
+}
+
+
+bool FlacAudioReaderImpl::init_decoder(const std::string& filename)
+{
+	// Instance may be reused for multiple files. If processing the previous
+	// file was aborted, the decoder is still initialized.
+	if (this->get_state() != ::FLAC__STREAM_DECODER_UNINITIALIZED)
+	{
+		this->finish();
+	}
+
+	set_md5_checking(false); // TODO part of validation?
 
 	const auto init_status = this->init(filename);
 
@@ -319,11 +481,31 @@ void FlacAudioReaderImpl::do_process_file(const std::string& filename)
 		ARCS_LOG_ERROR << "FLAC__StreamDecoderInitStatus: "
 				<< std::string{
 					::FLAC__StreamDecoderInitStatusString[init_status] };
-		return;
+		return false;
 	}
 
 	ARCS_LOG(DEBUG3) << "Initialized decoder successfully";
 
+	return true;
+}
+
+
+void FlacAudioReaderImpl::decode(const std::string& filename,
+		const int64_t first, const int64_t total)
+{
+	first_          = first;
+	samples_todo_   = total;
+	callback_error_ = nullptr;
+
+	this->signal_startinput();
+
+	// Process decoded samples
+
+	if (!init_decoder(filename))
+	{
+		return;
+	}
+
 	// Get channel order to decide whether order must be swapped.
 	// FLAC says: "Where defined, the channel order follows SMPTE/ITU-R
 	// recommendations." and only defines left/right orderings.
@@ -353,7 +535,41 @@ void FlacAudioReaderImpl::do_process_file(const std::string& filename)
 	}
 	// end channel order stuff
 
-	const bool success = this->process_until_end_of_stream();
+	auto success = bool { true };
+
+	if (samples_todo_ < 0)
+	{
+		success = this->process_until_end_of_stream();
+	} else
+	{
+		// Metadata is required to clip the range before seeking
+
+		success = this->process_until_end_of_metadata();
+
+		if (success && first_ > 0 && samples_todo_ > 0)
+		{
+			ARCS_LOG(DEBUG1) << "Seek to sample " << first_;
+
+			success = this->seek_absolute(
+					static_cast<::FLAC__uint64>(first_));
+		}
+
+		while (success && samples_todo_ > 0 && this->get_state()
+				!= ::FLAC__STREAM_DECODER_END_OF_STREAM)
+		{
+			success = this->process_single();
+		}
+	}
+
+	samples_todo_ = -1;
+
+	if (callback_error_)
+	{
+		// The decoder was aborted by a callback
+
+		this->finish();
+		this->rethrow_callback_error();
+	}
 
 	if (!success)
 	{
@@ -370,6 +586,20 @@ void FlacAudioReaderImpl::do_process_file(const std::string& filename)
 }
 
 
+void FlacAudioReaderImpl::rethrow_callback_error()
+{
+	if (!callback_error_)
+	{
+		return;
+	}
+
+	auto error { callback_error_ };
+	callback_error_ = nullptr;
+
+	std::rethrow_exception(error);
+}
+
+
 std::unique_ptr<FileReaderDescriptor> FlacAudioReaderImpl::do_descriptor()
 	const
 {
@@ -377,53 +607,192 @@ std::unique_ptr<FileReaderDescriptor> FlacAudioReaderImpl::do_descriptor()
 }
 
 
-} // namespace details
-} // namespace flac
+bool FlacAudioReaderImpl::do_reset()
+{
+	if (this->get_state() != ::FLAC__STREAM_DECODER_UNINITIALIZED)
+	{
+		this->finish();
+	}
 
+	first_          = 0;
+	samples_todo_   = -1;
+	callback_error_ = nullptr;
 
-// DescriptorFlac
+	if (auto validator = dynamic_cast<AudioValidator*>(
+				metadata_handler_.get()))
+	{
+		validator->clear_errors();
+	}
+
+	return true;
+}
 
 
-DescriptorFlac::~DescriptorFlac() noexcept = default;
+// cuesheet_toc
 
 
-std::string DescriptorFlac::do_id() const
+std::unique_ptr<ToC> cuesheet_toc(const FLAC::Metadata::CueSheet& cuesheet,
+		const std::string& filename)
 {
-	return "flac";
+	if (!cuesheet.get_is_cd())
+	{
+		throw MetadataParseException(
+				"Embedded CUESHEET does not correspond to a CD");
+	}
+
+	auto offsets   = std::vector<int32_t>{};
+	auto filenames = std::vector<std::string>{};
+	auto leadout   = int32_t { 0 };
+
+	for (auto t { 0u }; t < cuesheet.get_num_tracks(); ++t)
+	{
+		const auto track { cuesheet.get_track(t) };
+
+		if (track.get_number() == 170) // lead-out on a CD
+		{
+			leadout = cast_or_throw<int32_t>(static_cast<int64_t>(
+					track.get_offset() / CDDA::SAMPLES_PER_FRAME));
+			continue;
+		}
+
+		if (track.get_num_indices() < 1)
+		{
+			throw MetadataParseException("Track " + std::to_string(
+						static_cast<unsigned>(track.get_number()))
+					+ " has no index");
+		}
+
+		// Index 1 marks the track start, index 0 a pregap
+		auto index { track.get_index(0) };
+
+		for (auto i { 0u }; i < track.get_num_indices(); ++i)
+		{
+			if (track.get_index(i).number == 1)
+			{
+				index = track.get_index(i);
+				break;
+			}
+		}
+
+		const auto samples { track.get_offset() + index.offset };
+
+		offsets.push_back(cast_or_throw<int32_t>(
+				static_cast<int64_t>(samples / CDDA::SAMPLES_PER_FRAME)));
+		filenames.push_back(filename);
+	}
+
+	if (offsets.empty()
+		|| offsets.size() > static_cast<std::size_t>(CDDA::MAX_TRACKCOUNT))
+	{
+		throw MetadataParseException("Invalid number of tracks in CUESHEET: "
+				+ std::to_string(offsets.size()));
+	}
+
+	if (leadout == 0)
+	{
+		throw MetadataParseException("CUESHEET has no lead-out track");
+	}
+
+	return make_toc(leadout, offsets, filenames);
 }
 
 
-std::string DescriptorFlac::do_name() const
+// cuesheet_comment
+
+
+std::string cuesheet_comment(const FLAC::Metadata::VorbisComment& tags)
 {
-	return "Flac";
+	for (auto c { 0u }; c < tags.get_num_comments(); ++c)
+	{
+		const auto comment { tags.get_comment(c) };
+
+		auto name = std::string(comment.get_field_name(),
+				comment.get_field_name_length());
+
+		// Field names are case-insensitive ASCII
+		std::transform(name.begin(), name.end(), name.begin(),
+				[](const unsigned char ch)
+				{ return static_cast<char>(std::toupper(ch)); });
+
+		if (name == "CUESHEET")
+		{
+			return std::string(comment.get_field_value(),
+					comment.get_field_value_length());
+		}
+	}
+
+	return {};
 }
 
 
-std::set<Format> DescriptorFlac::define_formats() const
+// FlacCuesheetParserImpl
+
+
+std::unique_ptr<ToC> FlacCuesheetParserImpl::do_parse(
+		const std::string& filename)
 {
-	return { Format::FLAC }; // TODO OGG ?
+	auto cuesheet = FLAC::Metadata::CueSheet{};
+
+	if (FLAC::Metadata::get_cuesheet(filename.c_str(), cuesheet))
+	{
+		ARCS_LOG_DEBUG << "Found CUESHEET metadata block";
+
+		return cuesheet_toc(cuesheet, filename);
+	}
+
+	auto tags = FLAC::Metadata::VorbisComment{};
+
+	if (FLAC::Metadata::get_tags(filename.c_str(), tags))
+	{
+		const auto text { cuesheet_comment(tags) };
+
+		if (!text.empty())
+		{
+			ARCS_LOG_DEBUG << "Found CUESHEET Vorbis comment";
+
+			auto toc { parse_cuesheet_text(text) };
+
+			// A cue sheet has no lead-out, but the FLAC file has its length
+			auto info = FLAC::Metadata::StreamInfo{};
+
+			if (FLAC::Metadata::get_streaminfo(filename.c_str(), info)
+					&& info.get_total_samples() > 0)
+			{
+				toc->set_leadout(AudioSize { cast_or_throw<int32_t>(
+						static_cast<int64_t>(info.get_total_samples()
+							/ CDDA::SAMPLES_PER_FRAME)),
+						arcstk::UNIT::FRAMES });
+			}
+
+			return toc;
+		}
+	}
+
+	throw MetadataParseException("No embedded Cuesheet found in file "
+			+ filename);
 }
 
 
-std::set<Codec> DescriptorFlac::define_codecs() const
+std::unique_ptr<ToC> FlacCuesheetParserImpl::do_parse_buffer(
+		const char* /* data */, const std::size_t /* size */)
 {
-	return { Codec::FLAC };
+	throw MetadataParseException(
+			"Reading embedded Cuesheets from memory is not supported");
 }
 
 
-LibInfo DescriptorFlac::do_libraries() const
+std::unique_ptr<FileReaderDescriptor> FlacCuesheetParserImpl::do_descriptor()
+	const
 {
-	return { libinfo_entry_filepath("libFLAC++"),
-			 libinfo_entry_filepath("libFLAC") };
+	return std::make_unique<DescriptorFlacCuesheet>();
 }
 
 
-std::unique_ptr<FileReader> DescriptorFlac::do_create_reader() const
-{
-	using details::flac::FlacAudioReaderImpl;
-	using details::flac::FlacDefaultMetadataHandler;
-	using details::flac::FlacDefaultErrorHandler;
+// create_reader
 
+
+std::unique_ptr<FileReader> create_reader()
+{
 	auto impl = std::make_unique<FlacAudioReaderImpl>();
 	impl->register_metadata_handler(
 			std::make_unique<FlacDefaultMetadataHandler>());
@@ -434,20 +803,26 @@ std::unique_ptr<FileReader> DescriptorFlac::do_create_reader() const
 }
 
 
-std::unique_ptr<FileReaderDescriptor> DescriptorFlac::do_clone() const
+// create_cuesheet_parser
+
+
+std::unique_ptr<FileReader> create_cuesheet_parser()
 {
-	return std::make_unique<DescriptorFlac>();
+	auto impl = std::make_unique<FlacCuesheetParserImpl>();
+	return std::make_unique<MetadataParser>(std::move(impl));
 }
 
+} // namespace details
+} // namespace flac
 
-// Add this descriptor to the audio descriptor registry
-
-namespace {
+} // namespace v_1_0_0
+} // namespace arcsdec
 
-const auto d = RegisterDescriptor<DescriptorFlac>{};
+#ifdef LIBARCSDEC_BUILD_MODULE
 
-} // namespace
+LIBARCSDEC_MODULE_FACTORY(arcsdec::details::flac::create_reader)
 
-} // namespace v_1_0_0
-} // namespace arcsdec
+LIBARCSDEC_MODULE_NAMED_FACTORY(libarcsdec_create_cuesheet_parser,
+		arcsdec::details::flac::create_cuesheet_parser)
 
+#endif
@@ -29,7 +29,7 @@ inline namespace v_1_0_0
  *
  * The Flac AudioReader will only read files in fLaC file format. fLaC/Ogg is
  * currently not supported. Validation requires CDDA conform samples. Embedded
- * Cuesheets are ignored.
+ * Cuesheets are ignored, they are read by DescriptorFlacCuesheet.
  */
 class DescriptorFlac final : public FileReaderDescriptor
 {
@@ -62,6 +62,69 @@ private:
 	std::unique_ptr<FileReaderDescriptor> do_clone() const final;
 };
 
+
+/**
+ * \brief A MetadataParser for Cuesheets embedded in fLaC/fLaC files.
+ *
+ * Reads the ToC from the CUESHEET metadata block or, if there is none, from
+ * the CUESHEET Vorbis comment. Only the metadata blocks are read, no audio is
+ * decoded.
+ */
+class DescriptorFlacCuesheet final : public FileReaderDescriptor
+{
+public:
+
+	/**
+	 * \brief Default destructor.
+	 */
+	~DescriptorFlacCuesheet() noexcept final;
+
+private:
+
+	std::string do_id() const final;
+
+	/**
+	 * \brief Returns "FlacCuesheet".
+	 *
+	 * \return "FlacCuesheet"
+	 */
+	std::string do_name() const final;
+
+	InputType do_input_type() const final;
+
+	LibInfo do_libraries() const final;
+
+	std::set<Format> define_formats() const final;
+
+	std::set<Codec> define_codecs() const final;
+
+	std::unique_ptr<FileReader> do_create_reader() const final;
+
+	std::unique_ptr<FileReaderDescriptor> do_clone() const final;
+};
+
+namespace details
+{
+namespace flac
+{
+
+/**
+ * \brief Create an AudioReader as specified by DescriptorFlac.
+ *
+ * \return AudioReader as specified by DescriptorFlac
+ */
+std::unique_ptr<FileReader> create_reader();
+
+/**
+ * \brief Create a MetadataParser as specified by DescriptorFlacCuesheet.
+ *
+ * \return MetadataParser as specified by DescriptorFlacCuesheet
+ */
+std::unique_ptr<FileReader> create_cuesheet_parser();
+
+} // namespace flac
+} // namespace details
+
 } // namespace v_1_0_0
 } // namespace arcsdec
 
@@ -0,0 +1,155 @@
+/**
+ * \file
+ *
+ * \brief Implements descriptors for FLAC audio files and embedded Cuesheets.
+ */
+
+#ifndef __LIBARCSDEC_READERFLAC_HPP__
+#include "readerflac.hpp"
+#endif
+
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"        // for create_module_reader,
+                              // MODULE_CUESHEET_FACTORY
+#endif
+
+#ifndef __LIBARCSDEC_SELECTION_HPP__
+#include "selection.hpp"      // for RegisterDescriptor
+#endif
+
+#include <memory>   // for unique_ptr, make_unique
+#include <set>      // for set
+#include <string>   // for string
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+
+// DescriptorFlac
+
+
+DescriptorFlac::~DescriptorFlac() noexcept = default;
+
+
+std::string DescriptorFlac::do_id() const
+{
+	return "flac";
+}
+
+
+std::string DescriptorFlac::do_name() const
+{
+	return "Flac";
+}
+
+
+std::set<Format> DescriptorFlac::define_formats() const
+{
+	return { Format::FLAC }; // TODO OGG ?
+}
+
+
+std::set<Codec> DescriptorFlac::define_codecs() const
+{
+	return { Codec::FLAC };
+}
+
+
+LibInfo DescriptorFlac::do_libraries() const
+{
+	return { libinfo_entry_filepath("libFLAC++"),
+			 libinfo_entry_filepath("libFLAC") };
+}
+
+
+std::unique_ptr<FileReader> DescriptorFlac::do_create_reader() const
+{
+#ifdef LIBARCSDEC_WITH_MODULES
+	return details::create_module_reader("readerflac");
+#else
+	return details::flac::create_reader();
+#endif
+}
+
+
+std::unique_ptr<FileReaderDescriptor> DescriptorFlac::do_clone() const
+{
+	return std::make_unique<DescriptorFlac>();
+}
+
+
+// DescriptorFlacCuesheet
+
+
+DescriptorFlacCuesheet::~DescriptorFlacCuesheet() noexcept = default;
+
+
+std::string DescriptorFlacCuesheet::do_id() const
+{
+	return "flaccue";
+}
+
+
+std::string DescriptorFlacCuesheet::do_name() const
+{
+	return "FlacCuesheet";
+}
+
+
+InputType DescriptorFlacCuesheet::do_input_type() const
+{
+	return InputType::TOC;
+}
+
+
+LibInfo DescriptorFlacCuesheet::do_libraries() const
+{
+	return { libinfo_entry_filepath("libFLAC++"),
+			 libinfo_entry_filepath("libFLAC") };
+}
+
+
+std::set<Format> DescriptorFlacCuesheet::define_formats() const
+{
+	return { Format::FLAC };
+}
+
+
+std::set<Codec> DescriptorFlacCuesheet::define_codecs() const
+{
+	return { Codec::FLAC };
+}
+
+
+std::unique_ptr<FileReader> DescriptorFlacCuesheet::do_create_reader() const
+{
+#ifdef LIBARCSDEC_WITH_MODULES
+	return details::create_module_reader("readerflac",
+			details::MODULE_CUESHEET_FACTORY);
+#else
+	return details::flac::create_cuesheet_parser();
+#endif
+}
+
+
+std::unique_ptr<FileReaderDescriptor> DescriptorFlacCuesheet::do_clone() const
+{
+	return std::make_unique<DescriptorFlacCuesheet>();
+}
+
+
+// Add these descriptors to the descriptor registry
+
+namespace {
+
+const auto d  = RegisterDescriptor<DescriptorFlac>{};
+
+const auto dc = RegisterDescriptor<DescriptorFlacCuesheet>{};
+
+} // namespace
+
+} // namespace v_1_0_0
+} // namespace arcsdec
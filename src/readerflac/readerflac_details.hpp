@@ -15,6 +15,9 @@
 #ifndef __LIBARCSDEC_AUDIOREADER_HPP__
 #include "audioreader.hpp"    // for AudioReaderImpl, DefaultValidator
 #endif
+#ifndef __LIBARCSDEC_METAPARSER_HPP__
+#include "metaparser.hpp"     // for MetadataParserImpl
+#endif
 
 #ifndef __LIBARCSTK_SAMPLES_HPP__
 #include <arcstk/samples.hpp> // for SampleSequence
@@ -28,8 +31,11 @@
 								// for FLAC__int32
 								// for FLAC__Frame
 
-#include <memory>   // for unique_ptr
-#include <string>   // for string
+#include <cstddef>   // for size_t
+#include <cstdint>   // for int64_t
+#include <exception> // for exception_ptr
+#include <memory>    // for unique_ptr
+#include <string>    // for string
 
 
 namespace arcsdec
@@ -48,6 +54,7 @@ namespace flac
 {
 
 using arcstk::SampleSequence;
+using arcstk::ToC;
 
 /**
  * \internal
@@ -209,6 +216,10 @@ public:
 	/**
 	 * \brief Pass frames to internal handler.
 	 *
+	 * An exception thrown by the SampleProcessor, e.g. CalculationCancelled,
+	 * must not pass the decoder. It is kept and the decoder is aborted. The
+	 * exception is rethrown after the decoder returned.
+	 *
 	 * \param[in] frame  The frame describing object as defined by FLAC
 	 * \param[in] buffer The sample buffer
 	 *
@@ -257,8 +268,45 @@ private:
 
 	void do_process_file(const std::string& filename) final;
 
+	void do_process_range(const std::string& filename, const int64_t first,
+			const int64_t total) final;
+
+	void do_open(const std::string& filename) final;
+
+	bool do_read_block() final;
+
+	void do_close() final;
+
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
 
+	bool do_reset() final;
+
+	/**
+	 * \brief Initialize the decoder for \c filename.
+	 *
+	 * \param[in] filename The filename of the file to process
+	 *
+	 * \return TRUE iff the decoder was initialized
+	 */
+	bool init_decoder(const std::string& filename);
+
+	/**
+	 * \brief Decode the file or a range of samples of the file.
+	 *
+	 * \param[in] filename The filename of the file to process
+	 * \param[in] first    Index of the first sample to process
+	 * \param[in] total    Total samples to process, negative for all
+	 */
+	void decode(const std::string& filename, const int64_t first,
+			const int64_t total);
+
+	/**
+	 * \brief Rethrow the exception a callback has kept, if any.
+	 *
+	 * \throw Any exception thrown in a callback since the last call
+	 */
+	void rethrow_callback_error();
+
 	/**
 	 * \brief Internal SampleSequence instance.
 	 */
@@ -273,6 +321,66 @@ private:
 	 * \brief Handles errors.
 	 */
 	std::unique_ptr<FlacErrorHandler> error_handler_;
+
+	/**
+	 * \brief Index of the first sample of the range to read.
+	 */
+	int64_t first_;
+
+	/**
+	 * \brief Samples left to pass from the range, negative if no range.
+	 */
+	int64_t samples_todo_;
+
+	/**
+	 * \brief Exception thrown in a callback, rethrown when decoder returns.
+	 */
+	std::exception_ptr callback_error_;
+};
+
+
+/**
+ * \brief Build a ToC from a CUESHEET metadata block.
+ *
+ * The offset of each track is the position of its index 1. The offset of the
+ * lead-out track is the lead-out of the ToC.
+ *
+ * \param[in] cuesheet CUESHEET metadata block
+ * \param[in] filename Name of the FLAC file, used as filename of each track
+ *
+ * \return ToC represented by \c cuesheet
+ *
+ * \throw MetadataParseException If \c cuesheet does not represent a CD ToC
+ */
+std::unique_ptr<ToC> cuesheet_toc(const FLAC::Metadata::CueSheet& cuesheet,
+		const std::string& filename);
+
+
+/**
+ * \brief Text of the CUESHEET Vorbis comment.
+ *
+ * \param[in] tags Vorbis comment block
+ *
+ * \return Text of the CUESHEET comment or an empty string if there is none
+ */
+std::string cuesheet_comment(const FLAC::Metadata::VorbisComment& tags);
+
+
+/**
+ * \brief MetadataParser implementation for Cuesheets embedded in FLAC files.
+ *
+ * The CUESHEET metadata block is preferred over the CUESHEET Vorbis comment
+ * since it has sample precision. The lead-out for a CUESHEET Vorbis comment is
+ * the total number of samples in STREAMINFO.
+ */
+class FlacCuesheetParserImpl final : public MetadataParserImpl
+{
+	std::unique_ptr<ToC> do_parse(const std::string& filename) final;
+
+	std::unique_ptr<ToC> do_parse_buffer(const char* data,
+			const std::size_t size) final;
+
+	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
 };
 
 /** @} */
@@ -17,8 +17,11 @@
 #ifndef __LIBARCSDEC_LIBINSPECT_HPP__
 #include "libinspect.hpp"   // for first_libname_match
 #endif
-#ifndef __LIBARCSDEC_SELECTION_HPP__
-#include "selection.hpp"    // for RegisterDescriptor
+#ifndef __LIBARCSDEC_LOGLEVEL_HPP__
+#include "loglevel.hpp"     // for ARCSDEC_LOG
+#endif
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"      // for LIBARCSDEC_MODULE_FACTORY
 #endif
 
 #ifndef __LIBARCSTK_METADATA_HPP__
@@ -64,6 +67,14 @@ namespace sndfile
 // LibsndfileAudioReaderImpl
 
 
+LibsndfileAudioReaderImpl::LibsndfileAudioReaderImpl()
+	: audiofile_ { /* empty */ }
+	, buffer_    { /* empty */ }
+{
+	// empty
+}
+
+
 LibsndfileAudioReaderImpl::~LibsndfileAudioReaderImpl() noexcept = default;
 
 
@@ -145,7 +156,7 @@ void LibsndfileAudioReaderImpl::do_process_file(const std::string& filename)
 	{
 		++blocks_processed;
 
-		ARCS_LOG_DEBUG << "READ BLOCK " << blocks_processed;
+		ARCSDEC_LOG(DEBUG) << "READ BLOCK " << blocks_processed;
 
 		// Expected amount was read?
 
@@ -182,9 +193,9 @@ void LibsndfileAudioReaderImpl::do_process_file(const std::string& filename)
 
 		sequence.wrap_int_buffer(&buffer[0], buffer.size());
 
-		ARCS_LOG(DEBUG1) << "  Size: "
+		ARCSDEC_LOG(DEBUG1) << "  Size: "
 				<< (buffer.size() * sizeof(buffer[0])) << " bytes";
-		ARCS_LOG(DEBUG1) << "        "
+		ARCSDEC_LOG(DEBUG1) << "        "
 				<< (buffer.size() / CDDA::NUMBER_OF_CHANNELS)
 				<< " Stereo PCM samples (32 bit)";
 
@@ -195,94 +206,96 @@ void LibsndfileAudioReaderImpl::do_process_file(const std::string& filename)
 }
 
 
-std::unique_ptr<FileReaderDescriptor> LibsndfileAudioReaderImpl::do_descriptor()
-	const
+void LibsndfileAudioReaderImpl::do_open(const std::string& filename)
 {
-	return std::make_unique<DescriptorSndfile>();
-}
+	using arcstk::UNIT;
 
+	auto audiofile { std::make_unique<SndfileHandle>(filename, SFM_READ) };
 
-} // namespace sndfile
-} // namespace details
-
+	if (audiofile->error())
+	{
+		throw FileReadException(audiofile->strError());
+	}
 
-// DescriptorSndfile
+	if (audiofile->samplerate() - CDDA::SAMPLES_PER_SECOND != 0
+			|| audiofile->channels() - CDDA::NUMBER_OF_CHANNELS != 0)
+	{
+		throw InvalidAudioException("File " + filename
+				+ " does not seem to be CDDA");
+	}
 
+	this->signal_startinput();
+	this->signal_updateaudiosize(
+			to_audiosize(audiofile->frames(), UNIT::SAMPLES));
 
-DescriptorSndfile::~DescriptorSndfile() noexcept = default;
+	audiofile_ = std::move(audiofile);
+}
 
 
-std::string DescriptorSndfile::do_id() const
+bool LibsndfileAudioReaderImpl::do_read_block()
 {
-	return "libsndfile";
-}
+	buffer_.resize(static_cast<std::size_t>(
+				this->samples_per_read() * CDDA::NUMBER_OF_CHANNELS));
 
+	const auto ints_in_block { audiofile_->read(buffer_.data(),
+			static_cast<sf_count_t>(buffer_.size())) };
 
-std::string DescriptorSndfile::do_name() const
-{
-	return "Libsndfile";
-}
+	if (ints_in_block <= 0)
+	{
+		this->signal_endinput();
+		return false;
+	}
 
+	auto sequence = SampleSequence<int16_t, false>{};
+	sequence.wrap_int_buffer(buffer_.data(),
+			static_cast<std::size_t>(ints_in_block));
 
-std::set<Format> DescriptorSndfile::define_formats() const
-{
-	return {
-		Format::WAV,
-		Format::FLAC,
-		Format::AIFF
-		//Format::OGG // FIXME Accept OGG once it works!
-		//Format::CAF // FIXME Accept CAF once it works!
-	};
+	this->signal_appendsamples(sequence.begin(), sequence.end());
+
+	return true;
 }
 
 
-std::set<Codec> DescriptorSndfile::define_codecs() const
+void LibsndfileAudioReaderImpl::do_close()
 {
-	return {
-		Codec::PCM_S16BE,
-		Codec::PCM_S16BE_PLANAR,
-		Codec::PCM_S16LE,
-		Codec::PCM_S16LE_PLANAR,
-		Codec::PCM_S32BE,
-		Codec::PCM_S32BE_PLANAR,
-		Codec::PCM_S32LE,
-		Codec::PCM_S32LE_PLANAR,
-		Codec::FLAC,
-		Codec::ALAC
-	};
+	audiofile_.reset();
 }
 
 
-LibInfo DescriptorSndfile::do_libraries() const
+std::unique_ptr<FileReaderDescriptor> LibsndfileAudioReaderImpl::do_descriptor()
+	const
 {
-	return { libinfo_entry_filepath("libsndfile") };
+	return std::make_unique<DescriptorSndfile>();
 }
 
 
-std::unique_ptr<FileReader> DescriptorSndfile::do_create_reader() const
+bool LibsndfileAudioReaderImpl::do_reset()
 {
-	using details::sndfile::LibsndfileAudioReaderImpl;
+	audiofile_.reset();
+	buffer_.clear();
 
-	auto impl = std::make_unique<LibsndfileAudioReaderImpl>();
-
-	return std::make_unique<AudioReader>(std::move(impl));
+	return true;
 }
 
 
-std::unique_ptr<FileReaderDescriptor> DescriptorSndfile::do_clone() const
-{
-	return std::make_unique<DescriptorSndfile>();
-}
-
+// create_reader
 
-// Add this descriptor to the audio descriptor registry
 
-namespace {
+std::unique_ptr<FileReader> create_reader()
+{
+	auto impl = std::make_unique<LibsndfileAudioReaderImpl>();
 
-const auto d = RegisterDescriptor<DescriptorSndfile>{};
+	return std::make_unique<AudioReader>(std::move(impl));
+}
 
-} // namespace
+} // namespace sndfile
+} // namespace details
 
 } // namespace v_1_0_0
 } // namespace arcsdec
 
+#ifdef LIBARCSDEC_BUILD_MODULE
+
+LIBARCSDEC_MODULE_FACTORY(arcsdec::details::sndfile::create_reader)
+
+#endif
@@ -68,6 +68,21 @@ private:
 	std::unique_ptr<FileReaderDescriptor> do_clone() const final;
 };
 
+namespace details
+{
+namespace sndfile
+{
+
+/**
+ * \brief Create an AudioReader as specified by DescriptorSndfile.
+ *
+ * \return AudioReader as specified by DescriptorSndfile
+ */
+std::unique_ptr<FileReader> create_reader();
+
+} // namespace sndfile
+} // namespace details
+
 } // namespace v_1_0_0
 } // namespace arcsdec
 
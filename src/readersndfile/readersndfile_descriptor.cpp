@@ -0,0 +1,108 @@
+/**
+ * \file
+ *
+ * \brief Implements descriptor for audio files read by libsndfile.
+ */
+
+#ifndef __LIBARCSDEC_READERSNDFILE_HPP__
+#include "readersndfile.hpp"
+#endif
+
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"        // for create_module_reader
+#endif
+
+#ifndef __LIBARCSDEC_SELECTION_HPP__
+#include "selection.hpp"      // for RegisterDescriptor
+#endif
+
+#include <memory>   // for unique_ptr, make_unique
+#include <set>      // for set
+#include <string>   // for string
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+
+// DescriptorSndfile
+
+
+DescriptorSndfile::~DescriptorSndfile() noexcept = default;
+
+
+std::string DescriptorSndfile::do_id() const
+{
+	return "libsndfile";
+}
+
+
+std::string DescriptorSndfile::do_name() const
+{
+	return "Libsndfile";
+}
+
+
+std::set<Format> DescriptorSndfile::define_formats() const
+{
+	return {
+		Format::WAV,
+		Format::FLAC,
+		Format::AIFF
+		//Format::OGG // FIXME Accept OGG once it works!
+		//Format::CAF // FIXME Accept CAF once it works!
+	};
+}
+
+
+std::set<Codec> DescriptorSndfile::define_codecs() const
+{
+	return {
+		Codec::PCM_S16BE,
+		Codec::PCM_S16BE_PLANAR,
+		Codec::PCM_S16LE,
+		Codec::PCM_S16LE_PLANAR,
+		Codec::PCM_S32BE,
+		Codec::PCM_S32BE_PLANAR,
+		Codec::PCM_S32LE,
+		Codec::PCM_S32LE_PLANAR,
+		Codec::FLAC,
+		Codec::ALAC
+	};
+}
+
+
+LibInfo DescriptorSndfile::do_libraries() const
+{
+	return { libinfo_entry_filepath("libsndfile") };
+}
+
+
+std::unique_ptr<FileReader> DescriptorSndfile::do_create_reader() const
+{
+#ifdef LIBARCSDEC_WITH_MODULES
+	return details::create_module_reader("readersndfile");
+#else
+	return details::sndfile::create_reader();
+#endif
+}
+
+
+std::unique_ptr<FileReaderDescriptor> DescriptorSndfile::do_clone() const
+{
+	return std::make_unique<DescriptorSndfile>();
+}
+
+
+// Add this descriptor to the audio descriptor registry
+
+namespace {
+
+const auto d = RegisterDescriptor<DescriptorSndfile>{};
+
+} // namespace
+
+} // namespace v_1_0_0
+} // namespace arcsdec
@@ -16,8 +16,13 @@
 #include "audioreader.hpp"  // for AudioReaderImpl
 #endif
 
+#include <cstdint>  // for int16_t
 #include <memory>   // for unique_ptr
 #include <string>   // for string
+#include <vector>   // for vector
+
+
+class SndfileHandle;
 
 
 namespace arcsdec
@@ -58,6 +63,11 @@ class LibsndfileAudioReaderImpl final : public AudioReaderImpl
 
 public:
 
+	/**
+	 * \brief Constructor.
+	 */
+	LibsndfileAudioReaderImpl();
+
 	/**
 	 * \brief Default destructor.
 	 */
@@ -70,7 +80,25 @@ private:
 
 	void do_process_file(const std::string& filename) final;
 
+	void do_open(const std::string& filename) final;
+
+	bool do_read_block() final;
+
+	void do_close() final;
+
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
+
+	bool do_reset() final;
+
+	/**
+	 * \brief The file opened by do_open().
+	 */
+	std::unique_ptr<SndfileHandle> audiofile_;
+
+	/**
+	 * \brief Buffer for the 16 bit samples of the current block.
+	 */
+	std::vector<int16_t> buffer_;
 };
 
 
@@ -17,6 +17,9 @@
 #ifndef __LIBARCSDEC_LIBINSPECT_HPP__
 #include "libinspect.hpp"   // for first_libname_match
 #endif
+#ifndef __LIBARCSDEC_LOGLEVEL_HPP__
+#include "loglevel.hpp"     // for ARCSDEC_LOG
+#endif
 #ifndef __LIBARCSDEC_SAMPLEPROC_HPP__
 #include "sampleproc.hpp"   // for BLOCKSIZE
 #endif
@@ -39,11 +42,11 @@ extern "C" {
 #include <sys/stat.h> // for ::stat
 }
 
-#include <algorithm>  // for mismatch
+#include <algorithm>  // for mismatch, min
 #include <array>      // for array
 #include <cstdint>    // for uint8_t, uint16_t, uint32_t, int32_t, int64_t
 #include <fstream>    // for ifstream
-#include <ios>        // for streamsize
+#include <ios>        // for streamsize, ios_base
 #include <limits>     // for numeric_limits
 #include <memory>     // for unique_ptr
 #include <set>        // for set
@@ -414,6 +417,9 @@ void WavAudioHandler::start_file(const std::string& filename,
 	ARCS_LOG_DEBUG << "Start reading WAV file: " << filename;
 
 	phys_file_size_ = phys_file_size;
+	state_          = S_INITIAL; // instance may be reused for multiple files
+
+	validator_.clear_errors();
 }
 
 
@@ -555,6 +561,9 @@ WavAudioReaderImpl::WavAudioReaderImpl()
 
 WavAudioReaderImpl::WavAudioReaderImpl(std::unique_ptr<WavAudioHandler> hndlr)
 	: audio_handler_ { std::move(hndlr) }
+	, in_            { /* empty */ }
+	, bytes_todo_    { 0 }
+	, samples_       { /* empty */ }
 {
 	// empty
 }
@@ -575,6 +584,7 @@ std::unique_ptr<AudioSize> WavAudioReaderImpl::do_acquire_size(
 		wav_process_file(audiofilename, samples_per_read(),
 				nullptr /* no AudioHandler, no validation */,
 				nullptr /* no AudioReader, no signal emission */,
+				0, -1 /* entire file */,
 				total_pcm_bytes);
 	}
 	catch (const std::ifstream::failure& f)
@@ -603,7 +613,103 @@ void WavAudioReaderImpl::do_process_file(const std::string& audiofilename)
 	auto total_pcm_bytes = int64_t { 0 }; /* ignore */
 
 	wav_process_file(audiofilename, samples_per_read(), audio_handler_.get(),
-			this, total_pcm_bytes);
+			this, 0, -1 /* entire file */, total_pcm_bytes);
+}
+
+
+void WavAudioReaderImpl::do_process_range(const std::string& audiofilename,
+		const int64_t first, const int64_t total)
+{
+	// Validate And Calculate, seek to the range, emit AudioReader signals
+
+	auto total_pcm_bytes = int64_t { 0 }; /* ignore */
+
+	wav_process_file(audiofilename, samples_per_read(), audio_handler_.get(),
+			this, first, total, total_pcm_bytes);
+}
+
+
+void WavAudioReaderImpl::do_open(const std::string& audiofilename)
+{
+	// Validate and skip the header, read the audio data block by block
+
+	if (audio_handler_)
+	{
+		audio_handler_->start_file(audiofilename,
+				retrieve_file_size_bytes(audiofilename));
+	}
+
+	auto in { std::make_unique<std::ifstream>() };
+
+	in->exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+	try
+	{
+		in->open(audiofilename, std::ifstream::in | std::ifstream::binary);
+	}
+	catch (const std::ifstream::failure& f)
+	{
+		throw FileReadException(f.what(), 1);
+	}
+
+	auto total_pcm_bytes = int64_t { 0 };
+
+	wav_process_file_worker(*in, samples_per_read(), audio_handler_.get(),
+			nullptr /* stop at audio data */, 0, -1 /* entire file */,
+			total_pcm_bytes);
+
+	this->signal_startinput();
+	this->signal_updateaudiosize(to_audiosize(total_pcm_bytes, UNIT::BYTES));
+
+	in_         = std::move(in);
+	bytes_todo_ = total_pcm_bytes;
+}
+
+
+bool WavAudioReaderImpl::do_read_block()
+{
+	const auto samples { std::min(bytes_todo_ / CDDA::BYTES_PER_SAMPLE,
+			samples_per_read()) };
+
+	if (samples <= 0)
+	{
+		this->signal_endinput();
+		return false;
+	}
+
+	samples_.resize(static_cast<std::size_t>(samples));
+
+	const auto bytes { samples * CDDA::BYTES_PER_SAMPLE };
+
+	try
+	{
+		in_->read(reinterpret_cast<char*>(samples_.data()), bytes);
+	}
+	catch (const std::ifstream::failure& f)
+	{
+		throw FileReadException(f.what());
+	}
+
+	bytes_todo_ -= bytes;
+
+	// Hand the buffer over to the queue and read the next block to the
+	// recycled buffer
+
+	this->signal_appendbuffer(samples_);
+
+	return true;
+}
+
+
+void WavAudioReaderImpl::do_close()
+{
+	in_.reset();
+	bytes_todo_ = 0;
+
+	if (audio_handler_)
+	{
+		audio_handler_->end_file();
+	}
 }
 
 
@@ -614,6 +720,17 @@ std::unique_ptr<FileReaderDescriptor> WavAudioReaderImpl::do_descriptor()
 }
 
 
+bool WavAudioReaderImpl::do_reset()
+{
+	// The audio handler resets its state when the next file is started
+	in_.reset();
+	bytes_todo_ = 0;
+	samples_.clear();
+
+	return true;
+}
+
+
 const WavAudioHandler* WavAudioReaderImpl::audio_handler() const
 {
 	return audio_handler_.get();
@@ -809,10 +926,10 @@ int64_t wav_read_pcm_data(std::ifstream& in,
 
 		++total_blocks_read;
 
-		ARCS_LOG_DEBUG << "READ BLOCK " << total_blocks_read
+		ARCSDEC_LOG(DEBUG) << "READ BLOCK " << total_blocks_read
 			<< "/" << estimated_blocks;
-		ARCS_LOG(DEBUG1) << "Size: " << read_bytes << " bytes";
-		ARCS_LOG(DEBUG1) << "      " << samples.size()
+		ARCSDEC_LOG(DEBUG1) << "Size: " << read_bytes << " bytes";
+		ARCSDEC_LOG(DEBUG1) << "      " << samples.size()
 				<< " Stereo PCM samples (32 bit)";
 
 		using std::cbegin;
@@ -861,6 +978,8 @@ int64_t wav_process_file_worker(std::ifstream& in,
 		const int64_t    samples_per_read,
 		WavAudioHandler* audio_handler,
 		AudioReaderImpl* audio_reader,
+		const int64_t    first_sample,
+		const int64_t    total_samples,
 		int64_t&         total_pcm_bytes)
 {
 	using std::to_string;
@@ -974,39 +1093,78 @@ int64_t wav_process_file_worker(std::ifstream& in,
 				audio_handler->subchunk_data(subchunk_size);
 			}
 
+			// Also checked if the caller reads the audio data on its own
+
+			if (subchunk_size > std::numeric_limits<int32_t>::max())
+			{
+				auto msg = std::ostringstream{};
+				msg << "Data subchunk declares a size of "
+					<< subchunk_size
+					<< " bytes which exceeds expected size.";
+				throw InvalidAudioException(msg.str());
+			}
+
 			if (audio_reader)
 			{
-				if (subchunk_size <= std::numeric_limits<int32_t>::max())
+				// Determine the range of audio bytes to read
+
+				const auto skip_bytes { std::min(subchunk_size,
+						first_sample * CDDA::BYTES_PER_SAMPLE) };
+
+				auto range_bytes { subchunk_size - skip_bytes };
+
+				if (total_samples >= 0)
 				{
-					audio_reader->signal_updateaudiosize(
-						{ static_cast<int32_t>(subchunk_size), UNIT::BYTES });
-				} else
+					range_bytes = std::min(range_bytes,
+							total_samples * CDDA::BYTES_PER_SAMPLE);
+				}
+
+				audio_reader->signal_updateaudiosize(
+					{ static_cast<int32_t>(range_bytes), UNIT::BYTES });
+
+				if (skip_bytes > 0)
 				{
-					auto msg = std::ostringstream{};
-					msg << "Data subchunk declares a size of "
-						<< subchunk_size
-						<< " bytes which exceeds expected size.";
-					throw InvalidAudioException(msg.str());
+					ARCS_LOG(DEBUG1) << "Skip " << skip_bytes
+						<< " audio bytes before range";
+
+					in.seekg(skip_bytes, std::ios_base::cur);
+					total_bytes_read += skip_bytes;
 				}
 
 				// Read audio bytes in blocks and emit AudioReader signals
 
 				const auto block_bytes_read = wav_read_pcm_data(in,
 						samples_per_read, *audio_reader,
-						total_pcm_bytes);
+						range_bytes);
 
 				total_bytes_read += block_bytes_read;
 
-				if (block_bytes_read != subchunk_size)
+				if (block_bytes_read != range_bytes)
 				{
 					std::ostringstream msg;
 					msg << "Expected to read "
-						<< total_pcm_bytes
+						<< range_bytes
 						<< " audio bytes but could only read "
 						<< block_bytes_read
 						<< " audio bytes.";
 					throw FileReadException(msg.str(), total_bytes_read + 1);
 				}
+
+				const auto rest_bytes {
+					subchunk_size - skip_bytes - range_bytes };
+
+				if (rest_bytes > 0 && audio_handler
+						&& audio_handler->requests_all_subchunks())
+				{
+					in.seekg(rest_bytes, std::ios_base::cur);
+					total_bytes_read += rest_bytes;
+				}
+			}
+
+			if (!audio_reader)
+			{
+				ARCS_LOG(DEBUG1) << "Stop at the start of the audio data";
+				break;
 			}
 
 			if (!audio_handler || !audio_handler->requests_all_subchunks())
@@ -1058,6 +1216,8 @@ void wav_process_file(const std::string& filename,
 		const int64_t    samples_per_read,
 		WavAudioHandler* audio_handler,
 		AudioReaderImpl* audio_reader,
+		const int64_t    first_sample,
+		const int64_t    total_samples,
 		int64_t&         total_pcm_bytes)
 {
 	if (filename.empty())
@@ -1093,7 +1253,7 @@ void wav_process_file(const std::string& filename,
 
 	const int64_t bytes_read {
 		wav_process_file_worker(in, samples_per_read, audio_handler,
-				audio_reader, total_pcm_bytes) };
+				audio_reader, first_sample, total_samples, total_pcm_bytes) };
 
 	ARCS_LOG_DEBUG << "Read " << bytes_read << " bytes from audio file";
 
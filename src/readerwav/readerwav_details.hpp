@@ -866,12 +866,41 @@ private:
 
 	void do_process_file(const std::string& filename) final;
 
+	void do_process_range(const std::string& filename, const int64_t first,
+			const int64_t total) final;
+
+	void do_open(const std::string& filename) final;
+
+	bool do_read_block() final;
+
+	void do_close() final;
+
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
 
+	bool do_reset() final;
+
 	/**
 	 * \brief Validator handler instance.
 	 */
 	std::unique_ptr<WavAudioHandler> audio_handler_;
+
+	/**
+	 * \brief Input stream of the file opened by do_open().
+	 */
+	std::unique_ptr<std::ifstream> in_;
+
+	/**
+	 * \brief Audio bytes of the open file not yet read.
+	 */
+	int64_t bytes_todo_;
+
+	/**
+	 * \brief Buffer for the samples of the current block.
+	 *
+	 * The buffer is handed over to the queue of blocks and replaced by a
+	 * recycled buffer.
+	 */
+	std::vector<arcstk::sample_t> samples_;
 };
 
 
@@ -958,10 +987,15 @@ int64_t wav_read_bytes(std::ifstream& in, const int32_t amount,
  * \brief Worker method for wav_process_file(): Read WAV file and optionally
  * use a handler on it.
  *
+ * If \c audio_reader is nullptr, reading stops at the start of the audio
+ * data. The audio data is then the next to read from \c in.
+ *
  * \param[in]  in               The ifstream to read from
  * \param[in]  samples_per_read Block size in samples
  * \param[in]  audio_handler    Optional audio handler
  * \param[in]  audio_reader     Optional audio reader
+ * \param[in]  first_sample     Index of the first sample to pass
+ * \param[in]  total_samples    Samples to pass, negative for all
  * \param[out] total_pcm_bytes  Number of total bytes representing PCM samples
  *
  * \return Number of actually read bytes
@@ -973,16 +1007,23 @@ int64_t wav_process_file_worker(std::ifstream& in,
 		const int64_t    samples_per_read,
 		WavAudioHandler* audio_handler,
 		AudioReaderImpl* audio_reader,
+		const int64_t    first_sample,
+		const int64_t    total_samples,
 		int64_t&         total_pcm_bytes);
 
 /**
  * \brief Read the WAV file and optionally use a handler on it. This function
  * provides the implementation of WavAudioReader::process_file().
  *
+ * The samples before \c first_sample are skipped by seeking, the samples
+ * after <tt>first_sample + total_samples</tt> are not read.
+ *
  * \param[in]  filename         The file to read from
  * \param[in]  samples_per_read Block size in samples
  * \param[in]  audio_handler    Optional audio handler
  * \param[in]  audio_reader     Optional audio reader
+ * \param[in]  first_sample     Index of the first sample to pass
+ * \param[in]  total_samples    Samples to pass, negative for all
  * \param[out] total_pcm_bytes  Number of total bytes representing PCM samples
  *
  * \throw FileReadException If any problem occurred during reading from in
@@ -992,6 +1033,8 @@ void wav_process_file(const std::string& filename,
 		const int64_t    samples_per_read,
 		WavAudioHandler* audio_handler,
 		AudioReaderImpl* audio_reader,
+		const int64_t    first_sample,
+		const int64_t    total_samples,
 		int64_t&         total_pcm_bytes);
 
 /**
@@ -17,8 +17,14 @@
 #ifndef __LIBARCSDEC_LIBINSPECT_HPP__
 #include "libinspect.hpp"   // for first_libname_match
 #endif
-#ifndef __LIBARCSDEC_SELECTION_HPP__
-#include "selection.hpp"    // for RegisterDescriptor
+#ifndef __LIBARCSDEC_LOGLEVEL_HPP__
+#include "loglevel.hpp"     // for ARCSDEC_LOG
+#endif
+#ifndef __LIBARCSDEC_METAPARSER_HPP__
+#include "metaparser.hpp"   // for MetadataParser, parse_cuesheet_text
+#endif
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"      // for LIBARCSDEC_MODULE_FACTORY
 #endif
 
 #ifndef __LIBARCSTK_IDENTIFIER_HPP__
@@ -38,6 +44,7 @@ extern "C" {
 #include <wavpack/wavpack.h>
 }
 
+#include <algorithm> // for max, min
 #include <cstdint>   // for uint8_t, uint64_t, int32_t, int64_t
 #include <cstdlib>   // for size_t, free
 #include <memory>    // for unique_ptr
@@ -80,10 +87,10 @@ void Free_WavpackContext::operator()(::WavpackContext* ctx) const
 }
 
 
-WavpackContextPtr get_context(const std::string& filename) noexcept
+WavpackContextPtr get_context(const std::string& filename, const int flags)
+	noexcept
 {
-	const int flags = OPEN_WVC | OPEN_NO_CHECKSUM ;
-	char*     error = nullptr;
+	char* error = nullptr;
 
 	auto ctxp = WavpackContextPtr {
 		::WavpackOpenFileInput(filename.c_str(), error, flags, 0) };
@@ -175,6 +182,13 @@ WavpackOpenFile::WavpackOpenFile(const std::string& filename)
 }
 
 
+WavpackOpenFile::WavpackOpenFile(const std::string& filename, const int flags)
+	: context_ { get_context(filename, flags) }
+{
+	// empty
+}
+
+
 WavpackOpenFile::~WavpackOpenFile() noexcept = default;
 
 
@@ -330,12 +344,39 @@ int64_t WavpackOpenFile::read_pcm_samples(
 	const auto samples_read = ::WavpackUnpackSamples(context_.get(),
 			&(buffer[0]), pcm_samples_to_read);
 
-	ARCS_LOG_DEBUG << "    Read " << samples_read << " PCM samples (32 bit)";
+	ARCSDEC_LOG(DEBUG) << "    Read " << samples_read
+		<< " PCM samples (32 bit)";
 
 	return samples_read;
 }
 
 
+bool WavpackOpenFile::seek(const int64_t sample) const
+{
+	return ::WavpackSeekSample64(context_.get(), sample);
+}
+
+
+std::string WavpackOpenFile::tag(const std::string& item) const
+{
+	// Passing no buffer yields the length of the value
+	const auto length = ::WavpackGetTagItem(context_.get(), item.c_str(),
+			nullptr, 0);
+
+	if (length <= 0)
+	{
+		return {};
+	}
+
+	auto value = std::vector<char>(static_cast<std::size_t>(length) + 1);
+
+	::WavpackGetTagItem(context_.get(), item.c_str(), value.data(),
+			length + 1);
+
+	return std::string(value.data(), static_cast<std::size_t>(length));
+}
+
+
 bool WavpackOpenFile::success() const
 {
 	return context_ != nullptr;
@@ -453,6 +494,17 @@ AudioValidator::codec_set_type WavpackValidatingHandler::do_codecs() const
 // WavpackAudioReaderImpl
 
 
+WavpackAudioReaderImpl::WavpackAudioReaderImpl()
+	: validate_handler_ { /* empty */ }
+	, file_             { /* empty */ }
+	, left_right_       { true }
+	, samples_todo_     { 0 }
+	, buffer_           { /* empty */ }
+{
+	// empty
+}
+
+
 std::unique_ptr<AudioSize> WavpackAudioReaderImpl::do_acquire_size(
 	const std::string& filename)
 {
@@ -471,6 +523,20 @@ std::unique_ptr<AudioSize> WavpackAudioReaderImpl::do_acquire_size(
 
 
 void WavpackAudioReaderImpl::do_process_file(const std::string& filename)
+{
+	decode(filename, 0, -1 /* entire file */);
+}
+
+
+void WavpackAudioReaderImpl::do_process_range(const std::string& filename,
+		const int64_t first, const int64_t total)
+{
+	decode(filename, first, std::max(int64_t { 0 }, total));
+}
+
+
+void WavpackAudioReaderImpl::decode(const std::string& filename,
+		const int64_t first, const int64_t total)
 {
 	this->signal_startinput();
 
@@ -506,14 +572,37 @@ void WavpackAudioReaderImpl::do_process_file(const std::string& filename)
 
 	// Notify about correct size
 
-	const int64_t total_samples { file.total_pcm_samples() };
+	const auto first_sample { std::min(first, file.total_pcm_samples()) };
+
+	auto total_samples { file.total_pcm_samples() - first_sample };
+
+	if (total >= 0)
+	{
+		total_samples = std::min(total, total_samples);
+	}
 
 	{
-		const auto size = to_audiosize(file.total_pcm_samples(), UNIT::SAMPLES);
+		const auto size = to_audiosize(total_samples, UNIT::SAMPLES);
 		this->signal_updateaudiosize(size);
 	}
 
 
+	// Skip samples before the range
+
+	if (first_sample > 0 && total_samples > 0)
+	{
+		ARCS_LOG(DEBUG1) << "Seek to sample " << first_sample;
+
+		if (!file.seek(first_sample))
+		{
+			auto msg = std::ostringstream{};
+			msg << "Could not seek to sample " << first_sample;
+
+			throw FileReadException(msg.str());
+		}
+	}
+
+
 	// Samples reading loop
 
 	{
@@ -521,21 +610,27 @@ void WavpackAudioReaderImpl::do_process_file(const std::string& filename)
 		using std::cbegin;
 		using std::cend;
 
-		auto sequence = InterleavedSamples<sample_t> { file.channel_order() };
-		auto buffer   = std::vector<sample_t>{};
-		buffer.resize(this->samples_per_read());
-
 		// Request Half the Number of Samples in a Block in one Read.
 		// Thus a Sequence will Have Exactly the Size of a Block.
-		const auto wv_samples_to_read = int64_t {
-			static_cast<int64_t>(this->samples_per_read() / 2) };
+		// At least one sample is read, even for tiny blocks.
+		const auto wv_samples_to_read { std::max(int64_t { 1 },
+				this->samples_per_read() / CDDA::NUMBER_OF_CHANNELS) };
+
+		auto sequence = InterleavedSamples<sample_t> { file.channel_order() };
+		auto buffer   = std::vector<sample_t>(static_cast<std::size_t>(
+					wv_samples_to_read * CDDA::NUMBER_OF_CHANNELS));
 
 		auto wv_samples_read = int64_t { 0 };
 		for (int64_t i = total_samples; i > 0; i -= wv_samples_to_read)
 		{
-			ARCS_LOG_DEBUG << "READ SEQUENCE, remaining samples " << i;
+			ARCSDEC_LOG(DEBUG) << "READ SEQUENCE, remaining samples " << i;
 
-			wv_samples_read = file.read_pcm_samples(wv_samples_to_read, buffer);
+			// Do not read beyond the range
+			const auto wv_samples_requested {
+				std::min(i, wv_samples_to_read) };
+
+			wv_samples_read = file.read_pcm_samples(wv_samples_requested,
+					buffer);
 
 			if (wv_samples_read != wv_samples_to_read)
 			{
@@ -550,7 +645,7 @@ void WavpackAudioReaderImpl::do_process_file(const std::string& filename)
 					msg << "    Read unexpected number of samples: "
 						<< wv_samples_read
 						<< ", but expected "
-						<< wv_samples_to_read;
+						<< wv_samples_requested;
 
 					throw FileReadException(msg.str());
 				}
@@ -559,7 +654,7 @@ void WavpackAudioReaderImpl::do_process_file(const std::string& filename)
 						wv_samples_read * CDDA::NUMBER_OF_CHANNELS));
 			}
 
-			ARCS_LOG_DEBUG << "    Size: " << buffer.size()
+			ARCSDEC_LOG(DEBUG) << "    Size: " << buffer.size()
 					<< " integers, add to current block";
 
 			sequence.wrap_int_buffer(buffer.data(), buffer.size());
@@ -574,76 +669,124 @@ void WavpackAudioReaderImpl::do_process_file(const std::string& filename)
 }
 
 
-std::unique_ptr<FileReaderDescriptor> WavpackAudioReaderImpl::do_descriptor()
-	const
+void WavpackAudioReaderImpl::do_open(const std::string& filename)
 {
-	return std::make_unique<DescriptorWavpack>();
-}
+	this->signal_startinput();
 
+	auto file { std::make_unique<WavpackOpenFile>(filename) };
 
-void WavpackAudioReaderImpl::register_validate_handler(
-		std::unique_ptr<WavpackValidatingHandler> validator)
-{
-	validate_handler_ = std::move(validator);
+	if (!file->success())
+	{
+		throw FileReadException("Could not open Wavpack file " + filename);
+	}
+
+	if (validate_handler_ && !perform_validations(*file))
+	{
+		throw InvalidAudioException("Validation failed for " + filename);
+	}
+
+	left_right_   = file->channel_order();
+	samples_todo_ = file->total_pcm_samples();
+
+	this->signal_updateaudiosize(to_audiosize(samples_todo_, UNIT::SAMPLES));
+
+	file_ = std::move(file);
 }
 
 
-bool WavpackAudioReaderImpl::perform_validations(const WavpackOpenFile& file)
+bool WavpackAudioReaderImpl::do_read_block()
 {
-	return  validate_handler_->validate_format(file)
-		&&  validate_handler_->validate_mode(file)
-		&&  validate_handler_->validate_cdda(file)
-		&&  validate_handler_->validate_version(file);
-}
+	if (samples_todo_ <= 0)
+	{
+		this->signal_endinput();
+		return false;
+	}
 
-} // namespace wavpack
-} // namespace details
+	// As in decode(), a block is half the number of integers in the buffer
 
-/// @}
+	const auto requested { std::min(samples_todo_, std::max(int64_t { 1 },
+				this->samples_per_read() / CDDA::NUMBER_OF_CHANNELS)) };
 
+	buffer_.resize(static_cast<std::size_t>(
+				requested * CDDA::NUMBER_OF_CHANNELS));
 
-// DescriptorWavpack
+	const auto samples_read { file_->read_pcm_samples(requested, buffer_) };
 
+	if (samples_read != requested)
+	{
+		auto msg = std::ostringstream{};
+		msg << "Read unexpected number of samples: " << samples_read
+			<< ", but expected " << requested;
 
-DescriptorWavpack::~DescriptorWavpack() noexcept = default;
+		throw FileReadException(msg.str());
+	}
 
+	samples_todo_ -= samples_read;
 
-std::string DescriptorWavpack::do_id() const
-{
-	return "wavpack";
+	auto sequence = InterleavedSamples<int32_t> { left_right_ };
+	sequence.wrap_int_buffer(buffer_.data(),
+			static_cast<std::size_t>(samples_read * CDDA::NUMBER_OF_CHANNELS));
+
+	using std::cbegin;
+	using std::cend;
+
+	this->signal_appendsamples(cbegin(sequence), cend(sequence));
+
+	return true;
 }
 
 
-std::string DescriptorWavpack::do_name() const
+void WavpackAudioReaderImpl::do_close()
 {
-	return "Wavpack";
+	file_.reset();
+	samples_todo_ = 0;
 }
 
 
-std::set<Format> DescriptorWavpack::define_formats() const
+std::unique_ptr<FileReaderDescriptor> WavpackAudioReaderImpl::do_descriptor()
+	const
 {
-	return { Format::WV };
+	return std::make_unique<DescriptorWavpack>();
 }
 
 
-std::set<Codec> DescriptorWavpack::define_codecs() const
+bool WavpackAudioReaderImpl::do_reset()
 {
-	return { Codec::WAVPACK };
+	file_.reset();
+	left_right_   = true;
+	samples_todo_ = 0;
+	buffer_.clear();
+
+	if (validate_handler_)
+	{
+		validate_handler_->clear_errors();
+	}
+
+	return true;
 }
 
 
-LibInfo  DescriptorWavpack::do_libraries() const
+void WavpackAudioReaderImpl::register_validate_handler(
+		std::unique_ptr<WavpackValidatingHandler> validator)
 {
-	return { libinfo_entry_filepath("libwavpack") };
+	validate_handler_ = std::move(validator);
 }
 
 
-std::unique_ptr<FileReader> DescriptorWavpack::do_create_reader() const
+bool WavpackAudioReaderImpl::perform_validations(const WavpackOpenFile& file)
 {
-	using details::wavpack::WAVPACK_CDDA_t;
-	using details::wavpack::WavpackAudioReaderImpl;
-	using details::wavpack::WavpackValidatingHandler;
+	return  validate_handler_->validate_format(file)
+		&&  validate_handler_->validate_mode(file)
+		&&  validate_handler_->validate_cdda(file)
+		&&  validate_handler_->validate_version(file);
+}
 
+
+// create_reader
+
+
+std::unique_ptr<FileReader> create_reader()
+{
 	auto valid = std::make_unique<WAVPACK_CDDA_t>();
 	auto handler = std::make_unique<WavpackValidatingHandler>(std::move(valid));
 
@@ -654,21 +797,82 @@ std::unique_ptr<FileReader> DescriptorWavpack::do_create_reader() const
 }
 
 
-std::unique_ptr<FileReaderDescriptor> DescriptorWavpack::do_clone() const
+// WavpackCuesheetParserImpl
+
+
+std::unique_ptr<ToC> WavpackCuesheetParserImpl::do_parse(
+		const std::string& filename)
 {
-	return std::make_unique<DescriptorWavpack>();
+	const auto file = WavpackOpenFile { filename, OPEN_TAGS };
+
+	if (!file.success())
+	{
+		throw FileReadException("Could not open Wavpack file " + filename);
+	}
+
+	const auto text { file.tag("cuesheet") };
+
+	if (text.empty())
+	{
+		throw MetadataParseException("No embedded Cuesheet found in file "
+				+ filename);
+	}
+
+	ARCS_LOG_DEBUG << "Found cuesheet tag";
+
+	auto toc { parse_cuesheet_text(text) };
+
+	// A cue sheet has no lead-out, but the Wavpack file has its length
+	const auto total_samples { file.total_pcm_samples() };
+
+	if (total_samples > 0)
+	{
+		toc->set_leadout(AudioSize { cast_or_throw<int32_t>(
+				total_samples / CDDA::SAMPLES_PER_FRAME),
+				arcstk::UNIT::FRAMES });
+	}
+
+	return toc;
 }
 
 
-// Add this descriptor to the audio descriptor registry
+std::unique_ptr<ToC> WavpackCuesheetParserImpl::do_parse_buffer(
+		const char* /* data */, const std::size_t /* size */)
+{
+	throw MetadataParseException(
+			"Reading embedded Cuesheets from memory is not supported");
+}
 
-namespace {
 
-const auto d = RegisterDescriptor<DescriptorWavpack>{};
+std::unique_ptr<FileReaderDescriptor>
+	WavpackCuesheetParserImpl::do_descriptor() const
+{
+	return std::make_unique<DescriptorWavpackCuesheet>();
+}
 
-} // namespace
 
-} // namespace v_1_0_0
+// create_cuesheet_parser
+
+
+std::unique_ptr<FileReader> create_cuesheet_parser()
+{
+	auto impl = std::make_unique<WavpackCuesheetParserImpl>();
+	return std::make_unique<MetadataParser>(std::move(impl));
+}
+
+} // namespace wavpack
+} // namespace details
 
+/// @}
+
+} // namespace v_1_0_0
 } // namespace arcsdec
 
+#ifdef LIBARCSDEC_BUILD_MODULE
+
+LIBARCSDEC_MODULE_FACTORY(arcsdec::details::wavpack::create_reader)
+
+LIBARCSDEC_MODULE_NAMED_FACTORY(libarcsdec_create_cuesheet_parser,
+		arcsdec::details::wavpack::create_cuesheet_parser)
+
+#endif
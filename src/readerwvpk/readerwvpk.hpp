@@ -69,6 +69,68 @@ private:
 	std::unique_ptr<FileReaderDescriptor> do_clone() const final;
 };
 
+
+/**
+ * \brief A MetadataParser for Cuesheets embedded in Wavpack files.
+ *
+ * Reads the ToC from the "cuesheet" tag of a Wavpack file. Only the tags are
+ * read, no audio is decoded.
+ */
+class DescriptorWavpackCuesheet final : public FileReaderDescriptor
+{
+public:
+
+	/**
+	 * \brief Default destructor.
+	 */
+	~DescriptorWavpackCuesheet() noexcept final;
+
+private:
+
+	std::string do_id() const final;
+
+	/**
+	 * \brief Returns "WavpackCuesheet".
+	 *
+	 * \return "WavpackCuesheet"
+	 */
+	std::string do_name() const final;
+
+	InputType do_input_type() const final;
+
+	std::set<Format> define_formats() const final;
+
+	std::set<Codec> define_codecs() const final;
+
+	LibInfo do_libraries() const final;
+
+	std::unique_ptr<FileReader> do_create_reader() const final;
+
+	std::unique_ptr<FileReaderDescriptor> do_clone() const final;
+};
+
+namespace details
+{
+namespace wavpack
+{
+
+/**
+ * \brief Create an AudioReader as specified by DescriptorWavpack.
+ *
+ * \return AudioReader as specified by DescriptorWavpack
+ */
+std::unique_ptr<FileReader> create_reader();
+
+/**
+ * \brief Create a MetadataParser as specified by DescriptorWavpackCuesheet.
+ *
+ * \return MetadataParser as specified by DescriptorWavpackCuesheet
+ */
+std::unique_ptr<FileReader> create_cuesheet_parser();
+
+} // namespace wavpack
+} // namespace details
+
 } // namespace v_1_0_0
 } // namespace arcsdec
 
@@ -0,0 +1,155 @@
+/**
+ * \file
+ *
+ * \brief Implements descriptors for Wavpack audio files and embedded Cuesheets.
+ */
+
+#ifndef __LIBARCSDEC_READERWVPK_HPP__
+#include "readerwvpk.hpp"
+#endif
+
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"        // for create_module_reader,
+                              // MODULE_CUESHEET_FACTORY
+#endif
+
+#ifndef __LIBARCSDEC_SELECTION_HPP__
+#include "selection.hpp"      // for RegisterDescriptor
+#endif
+
+#include <memory>   // for unique_ptr, make_unique
+#include <set>      // for set
+#include <string>   // for string
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+
+
+// DescriptorWavpack
+
+
+DescriptorWavpack::~DescriptorWavpack() noexcept = default;
+
+
+std::string DescriptorWavpack::do_id() const
+{
+	return "wavpack";
+}
+
+
+std::string DescriptorWavpack::do_name() const
+{
+	return "Wavpack";
+}
+
+
+std::set<Format> DescriptorWavpack::define_formats() const
+{
+	return { Format::WV };
+}
+
+
+std::set<Codec> DescriptorWavpack::define_codecs() const
+{
+	return { Codec::WAVPACK };
+}
+
+
+LibInfo  DescriptorWavpack::do_libraries() const
+{
+	return { libinfo_entry_filepath("libwavpack") };
+}
+
+
+std::unique_ptr<FileReader> DescriptorWavpack::do_create_reader() const
+{
+#ifdef LIBARCSDEC_WITH_MODULES
+	return details::create_module_reader("readerwvpk");
+#else
+	return details::wavpack::create_reader();
+#endif
+}
+
+
+std::unique_ptr<FileReaderDescriptor> DescriptorWavpack::do_clone() const
+{
+	return std::make_unique<DescriptorWavpack>();
+}
+
+
+// DescriptorWavpackCuesheet
+
+
+DescriptorWavpackCuesheet::~DescriptorWavpackCuesheet() noexcept = default;
+
+
+std::string DescriptorWavpackCuesheet::do_id() const
+{
+	return "wavpackcue";
+}
+
+
+std::string DescriptorWavpackCuesheet::do_name() const
+{
+	return "WavpackCuesheet";
+}
+
+
+InputType DescriptorWavpackCuesheet::do_input_type() const
+{
+	return InputType::TOC;
+}
+
+
+std::set<Format> DescriptorWavpackCuesheet::define_formats() const
+{
+	return { Format::WV };
+}
+
+
+std::set<Codec> DescriptorWavpackCuesheet::define_codecs() const
+{
+	return { Codec::WAVPACK };
+}
+
+
+LibInfo DescriptorWavpackCuesheet::do_libraries() const
+{
+	return { libinfo_entry_filepath("libwavpack") };
+}
+
+
+std::unique_ptr<FileReader> DescriptorWavpackCuesheet::do_create_reader()
+	const
+{
+#ifdef LIBARCSDEC_WITH_MODULES
+	return details::create_module_reader("readerwvpk",
+			details::MODULE_CUESHEET_FACTORY);
+#else
+	return details::wavpack::create_cuesheet_parser();
+#endif
+}
+
+
+std::unique_ptr<FileReaderDescriptor> DescriptorWavpackCuesheet::do_clone()
+	const
+{
+	return std::make_unique<DescriptorWavpackCuesheet>();
+}
+
+
+// Add these descriptors to the descriptor registry
+
+namespace {
+
+const auto d  = RegisterDescriptor<DescriptorWavpack>{};
+
+const auto dc = RegisterDescriptor<DescriptorWavpackCuesheet>{};
+
+} // namespace
+
+} // namespace v_1_0_0
+} // namespace arcsdec
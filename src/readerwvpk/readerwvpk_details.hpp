@@ -15,11 +15,15 @@
 #ifndef __LIBARCSDEC_AUDIOREADER_HPP__
 #include "audioreader.hpp"  // for AudioReaderImpl
 #endif
+#ifndef __LIBARCSDEC_METAPARSER_HPP__
+#include "metaparser.hpp"   // for MetadataParserImpl
+#endif
 
 extern "C" {
 #include <wavpack/wavpack.h>  // for WavpackContext
 }
 
+#include <cstddef>   // for size_t
 #include <cstdint>   // for uint8_t, int32_t, int64_t
 #include <exception> // for exception
 #include <memory>    // for unique_ptr
@@ -73,10 +77,12 @@ using WavpackContextPtr =
  * \brief Open a Wavpack file.
  *
  * \param[in] filename Wavpack filename
+ * \param[in] flags    Flags for WavpackOpenFileInput()
  *
  * \return WavpackContext
  */
-extern WavpackContextPtr get_context(const std::string& filename) noexcept;
+extern WavpackContextPtr get_context(const std::string& filename,
+		const int flags = OPEN_WVC | OPEN_NO_CHECKSUM) noexcept;
 
 
 /**
@@ -185,6 +191,14 @@ public:
 	 */
 	explicit WavpackOpenFile(const std::string& filename);
 
+	/**
+	 * \brief Open wavpack file with the given name and flags.
+	 *
+	 * \param[in] filename The file to open
+	 * \param[in] flags    Flags for WavpackOpenFileInput(), e.g. OPEN_TAGS
+	 */
+	WavpackOpenFile(const std::string& filename, const int flags);
+
 	/**
 	 * \brief Default destructor.
 	 */
@@ -302,6 +316,28 @@ public:
 	int64_t read_pcm_samples(const int64_t pcm_samples_to_read,
 		std::vector<int32_t>& buffer) const;
 
+	/**
+	 * \brief Seek to the specified 32 bit PCM sample.
+	 *
+	 * The next call of read_pcm_samples() will start with this sample.
+	 *
+	 * \param[in] sample Index of the 32 bit PCM sample to seek to
+	 *
+	 * \return TRUE iff seeking succeeded
+	 */
+	bool seek(const int64_t sample) const;
+
+	/**
+	 * \brief Returns the value of the specified APEv2 or ID3v1 tag item.
+	 *
+	 * The file must have been opened with OPEN_TAGS.
+	 *
+	 * \param[in] item Name of the tag item, case-insensitive
+	 *
+	 * \return Value of the item or an empty string if there is none
+	 */
+	std::string tag(const std::string& item) const;
+
 	/**
 	 * \brief Return TRUE iff file could be opened.
 	 *
@@ -393,6 +429,11 @@ class WavpackAudioReaderImpl final : public AudioReaderImpl
 {
 public:
 
+	/**
+	 * \brief Constructor.
+	 */
+	WavpackAudioReaderImpl();
+
 	/**
 	 * \brief Register a validating handler.
 	 *
@@ -407,8 +448,29 @@ private:
 
 	void do_process_file(const std::string& filename) final;
 
+	void do_process_range(const std::string& filename, const int64_t first,
+			const int64_t total) final;
+
+	void do_open(const std::string& filename) final;
+
+	bool do_read_block() final;
+
+	void do_close() final;
+
 	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
 
+	bool do_reset() final;
+
+	/**
+	 * \brief Decode the file or a range of samples of the file.
+	 *
+	 * \param[in] filename The filename of the file to process
+	 * \param[in] first    Index of the first sample to process
+	 * \param[in] total    Total samples to process, negative for all
+	 */
+	void decode(const std::string& filename, const int64_t first,
+			const int64_t total);
+
 	/**
 	 * \brief Perform the actual validation process.
 	 *
@@ -422,6 +484,43 @@ private:
 	 * \brief Validating handler of this instance.
 	 */
 	std::unique_ptr<WavpackValidatingHandler> validate_handler_;
+
+	/**
+	 * \brief The file opened by do_open().
+	 */
+	std::unique_ptr<WavpackOpenFile> file_;
+
+	/**
+	 * \brief TRUE iff the channel order of the open file is left/right.
+	 */
+	bool left_right_;
+
+	/**
+	 * \brief Samples of the open file not yet read.
+	 */
+	int64_t samples_todo_;
+
+	/**
+	 * \brief Buffer for the samples of the current block.
+	 */
+	std::vector<int32_t> buffer_;
+};
+
+
+/**
+ * \brief MetadataParser implementation for Cuesheets embedded in Wavpack
+ * files.
+ *
+ * The lead-out of the ToC is the total number of samples in the file.
+ */
+class WavpackCuesheetParserImpl final : public MetadataParserImpl
+{
+	std::unique_ptr<ToC> do_parse(const std::string& filename) final;
+
+	std::unique_ptr<ToC> do_parse_buffer(const char* data,
+			const std::size_t size) final;
+
+	std::unique_ptr<FileReaderDescriptor> do_descriptor() const final;
 };
 
 
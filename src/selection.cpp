@@ -8,19 +8,38 @@
 #include "selection.hpp"
 #endif
 
+#ifndef __LIBARCSDEC_AUDIOREADER_HPP__
+#include "audioreader.hpp"    // for ReaderStatistics
+#endif
 #ifndef __LIBARCSDEC_DESCRIPTOR_HPP__
 #include "descriptor.hpp"     // for FileReaderDescriptor
 #endif
+#ifndef __LIBARCSDEC_TRACEPOINTS_HPP__
+#include "tracepoints.hpp"    // for ARCSDEC_TRACE4, tracepoints_enabled
+#endif
 
 #ifndef __LIBARCSTK_LOGGING_HPP__
 #include <arcstk/logging.hpp> // for ARCS_LOG, _WARNING, _DEBUG
 #endif
 
-#include <algorithm>    // for find_if
+#include <algorithm>    // for find_if, min, max
+#include <array>        // for array
+#include <atomic>       // for atomic
+#include <cmath>        // for ceil
+#include <cstddef>      // for size_t
+#include <fstream>      // for ifstream
+#include <ios>          // for streamoff
+#include <istream>      // for istream, getline
 #include <iterator>     // for begin, end
-#include <memory>       // for unique_ptr, make_unique
+#include <limits>       // for numeric_limits
+#include <map>          // for map
+#include <memory>       // for unique_ptr, make_unique, shared_ptr
+#include <mutex>        // for mutex, lock_guard
+#include <ostream>      // for ostream
 #include <set>          // for set
+#include <sstream>      // for istringstream
 #include <string>       // for string
+#include <tuple>        // for tuple, get
 #include <type_traits>  // for remove_reference
 #include <utility>      // for pair, make_pair, move
 
@@ -46,6 +65,334 @@ constexpr uint32_t TOTAL_BYTES_TO_READ = 44;
 // sufficient to identify all other formats currently supported.
 
 
+namespace
+{
+
+/**
+ * \brief Compiled FormatTable for a FormatList, if available.
+ *
+ * \param[in] formats The FormatList to get the table for
+ *
+ * \return Compiled table for \c formats or nullptr
+ */
+const details::FormatTable* table_for(const FormatList* formats)
+{
+	return formats == FileReaderRegistry::formats()
+		? FileReaderRegistry::format_table()
+		: nullptr;
+}
+
+
+/**
+ * \brief Emit tracepoint \c select for a selection decision.
+ *
+ * \param[in] filename Name of the file the decision is for
+ * \param[in] type     Format and codec of the file
+ * \param[in] selected Descriptor selected or nullptr
+ */
+void trace_selection(const std::string& filename,
+		const std::pair<Format, Codec>& type,
+		const FileReaderDescriptor* selected)
+{
+	if (details::tracepoints_enabled)
+	{
+		const auto id { selected ? selected->id() : std::string {} };
+
+		ARCSDEC_TRACE4(select, filename.c_str(),
+				static_cast<unsigned>(type.first),
+				static_cast<unsigned>(type.second), id.c_str());
+	}
+}
+
+
+
+/**
+ * \brief TRUE iff \c bytes contain the ASCII code \c id at position \c pos.
+ *
+ * \param[in] bytes Bytes to inspect
+ * \param[in] pos   Position of the code
+ * \param[in] id    Four character code to compare
+ *
+ * \return TRUE iff \c id occurrs at \c pos
+ */
+bool has_fourcc(const Bytes& bytes, const std::size_t pos, const char* id)
+{
+	if (pos + 4 > bytes.size())
+	{
+		return false;
+	}
+
+	for (auto i = std::size_t { 0 }; i < 4; ++i)
+	{
+		if (bytes[pos + i] != static_cast<unsigned char>(id[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * \brief Read an unsigned little endian 16 bit integer from \c bytes.
+ */
+unsigned le16(const Bytes& bytes, const std::size_t pos)
+{
+	return pos + 2 > bytes.size() ? 0u
+		: unsigned { bytes[pos] } | unsigned { bytes[pos + 1] } << 8;
+}
+
+
+/**
+ * \brief Read an unsigned big endian 16 bit integer from \c bytes.
+ */
+unsigned be16(const Bytes& bytes, const std::size_t pos)
+{
+	return pos + 2 > bytes.size() ? 0u
+		: unsigned { bytes[pos] } << 8 | unsigned { bytes[pos + 1] };
+}
+
+
+/**
+ * \brief Determine the codec of a RIFF/WAVE file from its 'fmt ' chunk.
+ *
+ * The registered WAV format only matches the canonical header of CDDA with
+ * PCM samples, thus other format tags are not recognized.
+ *
+ * \param[in] bytes The first bytes of the file
+ *
+ * \return Codec of the file
+ */
+Codec wav_codec(const Bytes& bytes)
+{
+	static constexpr unsigned WAVE_FORMAT_PCM = 0x0001;
+
+	if (!has_fourcc(bytes, 12, "fmt ") || le16(bytes, 20) != WAVE_FORMAT_PCM)
+	{
+		return Codec::UNKNOWN;
+	}
+
+	switch (le16(bytes, 34)) // wBitsPerSample
+	{
+		case 16: return Codec::PCM_S16LE;
+		case 32: return Codec::PCM_S32LE;
+		default: break;
+	}
+
+	return Codec::UNKNOWN;
+}
+
+
+/**
+ * \brief Determine the codec of an AIFF file from its COMM chunk.
+ *
+ * The registered AIFF format does not match AIFF-C, thus the samples are
+ * always uncompressed and big endian.
+ *
+ * \param[in] bytes The first bytes of the file
+ *
+ * \return Codec of the file
+ */
+Codec aiff_codec(const Bytes& bytes)
+{
+	if (!has_fourcc(bytes, 12, "COMM"))
+	{
+		return Codec::UNKNOWN;
+	}
+
+	switch (be16(bytes, 26)) // sampleSize
+	{
+		case 16: return Codec::PCM_S16BE;
+		case 32: return Codec::PCM_S32BE;
+		default: break;
+	}
+
+	return Codec::UNKNOWN;
+}
+
+
+/**
+ * \brief Determine the codec of a CAF file from its 'desc' chunk.
+ *
+ * \param[in] bytes The first bytes of the file
+ *
+ * \return Codec of the file
+ */
+Codec caf_codec(const Bytes& bytes)
+{
+	if (has_fourcc(bytes, 8, "desc") && has_fourcc(bytes, 28, "alac"))
+	{
+		return Codec::ALAC;
+	}
+
+	return Codec::UNKNOWN;
+}
+
+
+/**
+ * \brief Determine the codec of an Ogg file from its first packet.
+ *
+ * \param[in] bytes The first bytes of the file
+ *
+ * \return Codec of the file
+ */
+Codec ogg_codec(const Bytes& bytes)
+{
+	// The first packet follows the 27 bytes of the page header and the
+	// segment table whose length is stored in the last header byte.
+
+	if (bytes.size() < 27)
+	{
+		return Codec::UNKNOWN;
+	}
+
+	const auto packet = std::size_t { 27 } + bytes[26];
+
+	if (packet + 5 <= bytes.size() && bytes[packet] == 0x7F
+			&& has_fourcc(bytes, packet + 1, "FLAC"))
+	{
+		return Codec::FLAC;
+	}
+
+	return Codec::UNKNOWN;
+}
+
+
+/**
+ * \brief Find a box of the specified type in a range of an MP4 file.
+ *
+ * On success, \c range is set to the payload of the box found.
+ *
+ * \param[in] in        The file to inspect
+ * \param[in,out] range Range to search in
+ * \param[in] type      Type of the box
+ *
+ * \return TRUE iff a box of type \c type was found in \c range
+ */
+bool find_box(std::ifstream& in,
+		std::pair<std::streamoff, std::streamoff>& range, const char* type)
+{
+	static constexpr std::size_t MAX_BOXES_PER_LEVEL = 64;
+
+	auto pos = range.first;
+	auto header = std::array<char, 16> {};
+
+	for (auto i = std::size_t { 0 };
+			i < MAX_BOXES_PER_LEVEL && range.second - pos >= 8; ++i)
+	{
+		in.seekg(pos);
+		in.read(header.data(), 8);
+
+		if (!in)
+		{
+			return false;
+		}
+
+		const auto byte = [&header](const std::size_t n) -> std::streamoff
+		{
+			return static_cast<unsigned char>(header[n]);
+		};
+
+		auto size = byte(0) << 24 | byte(1) << 16 | byte(2) << 8 | byte(3);
+		auto header_size = std::streamoff { 8 };
+
+		if (size == 1) // 64 bit size follows the type
+		{
+			in.read(header.data() + 8, 8);
+
+			if (!in)
+			{
+				return false;
+			}
+
+			size = 0;
+			for (auto n = std::size_t { 8 }; n < 16; ++n)
+			{
+				size = size << 8 | byte(n);
+			}
+			header_size = 16;
+		} else if (size == 0) // box extends to the end
+		{
+			size = range.second - pos;
+		}
+
+		if (size < header_size)
+		{
+			return false;
+		}
+
+		if (std::equal(type, type + 4, header.begin() + 4))
+		{
+			range = { pos + header_size, pos + size };
+			return true;
+		}
+
+		pos += size;
+	}
+
+	return false;
+}
+
+
+/**
+ * \brief Determine the codec of an MP4 file from its sample description.
+ *
+ * The sample description ('stsd') of the first track is inspected.
+ *
+ * \param[in] filename Name of the file
+ *
+ * \return Codec of the file
+ */
+Codec m4a_codec(const std::string& filename)
+{
+	std::ifstream in(filename, std::ifstream::in | std::ifstream::binary);
+
+	if (!in.seekg(0, std::ios::end))
+	{
+		return Codec::UNKNOWN;
+	}
+
+	auto range = std::make_pair(std::streamoff { 0 },
+			static_cast<std::streamoff>(in.tellg()));
+
+	for (const auto& type : { "moov", "trak", "mdia", "minf", "stbl", "stsd" })
+	{
+		if (!find_box(in, range, type))
+		{
+			ARCS_LOG(DEBUG1) << "MP4 box '" << type << "' not found";
+			return Codec::UNKNOWN;
+		}
+	}
+
+	// stsd: version + flags (4), entry count (4), first entry: size (4),
+	// type (4)
+
+	auto entry = std::array<char, 16> {};
+	in.seekg(range.first);
+	in.read(entry.data(), entry.size());
+
+	if (!in)
+	{
+		return Codec::UNKNOWN;
+	}
+
+	static constexpr auto alac = std::array<char, 4> { 'a', 'l', 'a', 'c' };
+
+	if (std::equal(alac.begin(), alac.end(), entry.begin() + 12))
+	{
+		return Codec::ALAC;
+	}
+
+	ARCS_LOG(DEBUG1) << "MP4 sample entry is '"
+		<< std::string(entry.begin() + 12, entry.end()) << "'";
+
+	return Codec::UNKNOWN;
+}
+
+} // namespace
+
+
 // FileType
 
 
@@ -68,18 +415,36 @@ public:
 	 */
 	std::pair<Format, Codec> type(const FormatList* formats) const;
 
+	/**
+	 * \brief Determine file type from the Matcher that matched the file.
+	 *
+	 * A \c matcher that is nullptr indicates an unknown format.
+	 */
+	std::pair<Format, Codec> type(const Matcher* matcher) const;
+
 	/**
 	 * \brief Determines the format of a specified file.
+	 *
+	 * If \c hint is not nullptr, it is tried before \c formats are checked.
+	 * If \c table is not nullptr, it must be compiled from \c formats and is
+	 * used instead of trying each element of \c formats.
+	 *
+	 * \return The Matcher that matched the file or nullptr
 	 */
-	std::unique_ptr<Matcher> format(const FormatList* formats) const;
+	const Matcher* format(const FormatList* formats,
+		const details::FormatTable* table, const Matcher* hint) const;
 
 	/**
 	 * \brief Determines the Codec of a specified file.
-	*
+	 *
+	 * The codec is determined from the bytes read and, for some formats, from
+	 * further metadata in the file. A codec that is not in \c codecs is
+	 * reported as Codec::UNKNOWN.
+	 *
 	 * Codec::UNKNOWN indicates that the codec could not be determined.
 	 * Codec::NONE indicates that the file is not an audio file.
 	 */
-	Codec codec(const std::set<Codec>& codecs) const;
+	Codec codec(const Format format, const std::set<Codec>& codecs) const;
 
 	/**
 	 * \brief Filename.
@@ -93,7 +458,7 @@ public:
 	 *
 	 * \return The sequence of bytes read from the file.
 	 */
-	Bytes bytes() const;
+	const Bytes& bytes() const;
 
 protected:
 
@@ -134,8 +499,12 @@ FileType::FileType(const std::string& filename)
 
 std::pair<Format, Codec> FileType::type(const FormatList* formats) const
 {
-	const auto format_d = format(formats);
+	return type(format(formats, table_for(formats), nullptr));
+}
+
 
+std::pair<Format, Codec> FileType::type(const Matcher* format_d) const
+{
 	if (!format_d)
 	{
 		ARCS_LOG_WARNING << "Failed to recognize format and codec";
@@ -145,7 +514,7 @@ std::pair<Format, Codec> FileType::type(const FormatList* formats) const
 
 	ARCS_LOG_INFO << "Format is '" << name(format) << "'";
 
-	const auto codec  = format_d ? this->codec(format_d->codecs())
+	const auto codec  = format_d ? this->codec(format, format_d->codecs())
 		: Codec::UNKNOWN;
 
 	ARCS_LOG_INFO << "Codec is '" << name(codec) << "'";
@@ -154,11 +523,34 @@ std::pair<Format, Codec> FileType::type(const FormatList* formats) const
 }
 
 
-std::unique_ptr<Matcher> FileType::format(
-		const FormatList* formats) const
+const Matcher* FileType::format(const FormatList* formats,
+		const details::FormatTable* table, const Matcher* hint) const
 {
 	ARCS_LOG_DEBUG << "Try to recognize file format: " << filename();
 
+	if (hint && hint->matches(bytes()) && hint->matches(filename()))
+	{
+		ARCS_LOG_DEBUG << "Format " << hint->name() << " accepted (as before)";
+		return hint;
+	}
+
+	if (table)
+	{
+		const auto accepted { table->match(bytes(), filename()) };
+
+		if (accepted)
+		{
+			ARCS_LOG_DEBUG << "Format " << accepted->name() << " accepted";
+		} else
+		{
+			ARCS_LOG_DEBUG << "File format is unknown. (Checked for "
+				<< table->size()
+				<< " different formats.)";
+		}
+
+		return accepted;
+	}
+
 	for (const auto& accepted : *formats)
 	{
 		ARCS_LOG(DEBUG1) << "Check for format: " << accepted->name();
@@ -171,7 +563,7 @@ std::unique_ptr<Matcher> FileType::format(
 			{
 				ARCS_LOG(DEBUG1) << accepted->name() << ": filename matched";
 				ARCS_LOG_DEBUG << "Format " << accepted->name() << " accepted";
-				return accepted->clone();
+				return accepted.get();
 			}
 
 			ARCS_LOG(DEBUG1) << accepted->name() << ": filename did not match";
@@ -187,7 +579,8 @@ std::unique_ptr<Matcher> FileType::format(
 }
 
 
-Codec FileType::codec(const std::set<Codec>& codecs) const
+Codec FileType::codec(const Format format, const std::set<Codec>& codecs)
+	const
 {
 	ARCS_LOG_DEBUG << "Try to recognize codec: " << filename();
 
@@ -196,26 +589,40 @@ Codec FileType::codec(const std::set<Codec>& codecs) const
 		return Codec::NONE;
 	}
 
-	// TODO Implement codec analysis
+	auto codec = Codec::UNKNOWN;
 
-	ARCS_LOG(DEBUG1) << "This is not yet implemented";
-
-	// TODO Iterate over codecs and check each for a match with bytes
-	if (codecs.size() == 1) // Make Codec::NONE work
+	switch (format)
 	{
-		const auto codec = *codecs.begin();
+		case Format::WAV:  codec = wav_codec(bytes());    break;
+		case Format::AIFF: codec = aiff_codec(bytes());   break;
+		case Format::CAF:  codec = caf_codec(bytes());    break;
+		case Format::OGG:  codec = ogg_codec(bytes());    break;
+		case Format::M4A:  codec = m4a_codec(filename()); break;
+		default:
+		{
+			// The magic bytes of the other formats already identify the codec
 
-		ARCS_LOG(DEBUG1) << "Format supports only codec '" <<
-			arcsdec::name(codec) << "', so just assume this";
+			if (codecs.size() == 1) // Make Codec::NONE work
+			{
+				codec = *codecs.begin();
 
-		// TODO Activate/deactivate Validation?
+				ARCS_LOG(DEBUG1) << "Format supports only codec '" <<
+					arcsdec::name(codec) << "', so just assume this";
+			}
 
-		return codec;
+			return codec;
+		}
 	}
 
-	ARCS_LOG_DEBUG << "Try to recognize codec: " << filename();
+	if (codecs.find(codec) == codecs.end())
+	{
+		ARCS_LOG(DEBUG1) << "Codec '" << arcsdec::name(codec)
+			<< "' is not supported for format " << arcsdec::name(format);
 
-	return Codec::UNKNOWN;
+		return Codec::UNKNOWN;
+	}
+
+	return codec;
 }
 
 
@@ -225,7 +632,7 @@ std::string FileType::filename() const
 }
 
 
-Bytes FileType::bytes() const
+const Bytes& FileType::bytes() const
 {
 	return bytes_;
 }
@@ -246,6 +653,18 @@ DescriptorPreference::type DescriptorPreference::preference(
 }
 
 
+uint64_t DescriptorPreference::revision() const
+{
+	return this->do_revision();
+}
+
+
+uint64_t DescriptorPreference::do_revision() const
+{
+	return 0;
+}
+
+
 // DefaultPreference
 
 
@@ -255,15 +674,29 @@ DescriptorPreference::type DefaultPreference::do_preference(
 {
 	constexpr static unsigned PENALTY_FOR_NONSPECIFICNESS = 2;
 
-	if (!desc.accepts(format, codec))
+	if (InputType::AUDIO != desc.input_type())
+	{
+		return MIN_PREFERENCE;
+	}
+
+	// If the codec could not be recognized, the format must suffice.
+	const auto accepted = Codec::UNKNOWN == codec
+		? desc.accepts(format)
+		: desc.accepts(format, codec);
+
+	if (!accepted)
 	{
 		return MIN_PREFERENCE;
 	}
 
 	// Prefer specific readers over multi-format readers.
-	return MAX_PREFERENCE
-			- ((desc.formats().size() - 1) * PENALTY_FOR_NONSPECIFICNESS
-				- (desc.codecs().size()  - 1));
+	const auto penalty =
+		(desc.formats().size() - 1) * PENALTY_FOR_NONSPECIFICNESS
+		+ (desc.codecs().size() - 1);
+
+	return penalty < MAX_PREFERENCE
+		? MAX_PREFERENCE - static_cast<type>(penalty)
+		: MIN_PREFERENCE + 1;
 }
 
 
@@ -295,38 +728,470 @@ FormatPreference::type FormatPreference::do_preference(
 }
 
 
-// FileReaderSelector
-
-
-FileReaderSelector::~FileReaderSelector() noexcept = default;
+// TocPreference
 
 
-std::unique_ptr<FileReaderDescriptor> FileReaderSelector::select(
-		const Format format, const Codec codec, const FileReaders& readers,
-		const DescriptorPreference& strategy) const
+TocPreference::type TocPreference::do_preference(
+		const Format format,
+		const Codec codec,
+		const FileReaderDescriptor& desc) const
 {
-	ARCS_LOG_DEBUG << "Try to select a FileReader for filetype "
-		<< name(format) << "/" << name(codec);
-
-	if (readers.empty())
+	if (InputType::TOC != desc.input_type())
 	{
-		ARCS_LOG_WARNING << "No FileReaderDescriptors to select from";
-		return nullptr;
+		return MIN_PREFERENCE;
 	}
 
-	auto descriptor = do_select(format, codec, readers, strategy);
+	return FormatPreference {}.preference(format, codec, desc);
+}
 
-	if (!descriptor)
-	{
-		ARCS_LOG_WARNING << "Could not select a matching descriptor";
-		return nullptr;
-	}
 
-	ARCS_LOG_DEBUG << "Reader descriptor '" << descriptor->name()
-		<< "' selected" << " (id: " << descriptor->id() << ")";
+// ReaderThroughput::Impl
 
-	return descriptor;
-}
+
+/**
+ * \brief Private implementation of ReaderThroughput.
+ */
+class ReaderThroughput::Impl final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	Impl();
+
+	/**
+	 * \brief Implements ReaderThroughput::record().
+	 */
+	void record(const std::string& reader_id, const Format format,
+			const Codec codec, const int64_t samples, const double seconds);
+
+	/**
+	 * \brief Implements ReaderThroughput::samples_per_second().
+	 */
+	double samples_per_second(const std::string& reader_id,
+			const Format format, const Codec codec) const;
+
+	/**
+	 * \brief Implements ReaderThroughput::best().
+	 */
+	double best(const Format format, const Codec codec) const;
+
+	/**
+	 * \brief Implements ReaderThroughput::save().
+	 */
+	void save(std::ostream& out) const;
+
+	/**
+	 * \brief Implements ReaderThroughput::load().
+	 */
+	void load(std::istream& in);
+
+	/**
+	 * \brief Implements ReaderThroughput::clear().
+	 */
+	void clear();
+
+	/**
+	 * \brief Implements ReaderThroughput::size().
+	 */
+	std::size_t size() const;
+
+	/**
+	 * \brief Implements ReaderThroughput::revision().
+	 */
+	uint64_t revision() const;
+
+private:
+
+	/**
+	 * \brief Id of the fastest reader for a pair of Format and Codec.
+	 *
+	 * Requires mutex_ to be held.
+	 *
+	 * \param[in] format Format
+	 * \param[in] codec  Codec
+	 *
+	 * \return Id of the fastest reader or an empty string
+	 */
+	std::string fastest(const Format format, const Codec codec) const;
+
+	/**
+	 * \brief Key of a measurement.
+	 */
+	using Key = std::tuple<std::string, Format, Codec>;
+
+	/**
+	 * \brief Accumulated number of samples and seconds.
+	 */
+	using Measurement = std::pair<int64_t, double>;
+
+	/**
+	 * \brief Measurements by reader id, Format and Codec.
+	 */
+	std::map<Key, Measurement> measurements_;
+
+	/**
+	 * \brief Revision of measurements_.
+	 */
+	std::atomic<uint64_t> revision_;
+
+	/**
+	 * \brief Guards measurements_.
+	 */
+	mutable std::mutex mutex_;
+};
+
+
+ReaderThroughput::Impl::Impl()
+	: measurements_ { /* empty */ }
+	, revision_     { 0 }
+	, mutex_        { /* default */ }
+{
+	// empty
+}
+
+
+void ReaderThroughput::Impl::record(const std::string& reader_id,
+		const Format format, const Codec codec, const int64_t samples,
+		const double seconds)
+{
+	if (samples <= 0 || seconds <= 0)
+	{
+		return;
+	}
+
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto previous { fastest(format, codec) };
+
+	auto& m = measurements_[Key { reader_id, format, codec }];
+	m.first  += samples;
+	m.second += seconds;
+
+	if (fastest(format, codec) != previous)
+	{
+		++revision_;
+	}
+}
+
+
+std::string ReaderThroughput::Impl::fastest(const Format format,
+		const Codec codec) const
+{
+	auto result = std::string {};
+	auto best   = double { 0.0 };
+
+	for (const auto& m : measurements_)
+	{
+		if (std::get<1>(m.first) != format || std::get<2>(m.first) != codec)
+		{
+			continue;
+		}
+
+		const auto value {
+			static_cast<double>(m.second.first) / m.second.second };
+
+		if (value > best)
+		{
+			best   = value;
+			result = std::get<0>(m.first);
+		}
+	}
+
+	return result;
+}
+
+
+double ReaderThroughput::Impl::samples_per_second(const std::string& reader_id,
+		const Format format, const Codec codec) const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto m { measurements_.find(Key { reader_id, format, codec }) };
+
+	return m != measurements_.end()
+		? static_cast<double>(m->second.first) / m->second.second
+		: 0.0;
+}
+
+
+double ReaderThroughput::Impl::best(const Format format, const Codec codec)
+	const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	auto result = double { 0.0 };
+
+	for (const auto& m : measurements_)
+	{
+		if (std::get<1>(m.first) == format && std::get<2>(m.first) == codec)
+		{
+			result = std::max(result,
+				static_cast<double>(m.second.first) / m.second.second);
+		}
+	}
+
+	return result;
+}
+
+
+void ReaderThroughput::Impl::save(std::ostream& out) const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	for (const auto& m : measurements_)
+	{
+		out << std::get<0>(m.first)       << ' '
+			<< name(std::get<1>(m.first)) << ' '
+			<< name(std::get<2>(m.first)) << ' '
+			<< m.second.first             << ' '
+			<< m.second.second            << '\n';
+	}
+}
+
+
+void ReaderThroughput::Impl::load(std::istream& in)
+{
+	// Map names to enum values
+
+	std::map<std::string, Format> formats;
+	for (auto f = unsigned { 0 }; f < FORMAT_COUNT; ++f)
+	{
+		formats.emplace(name(static_cast<Format>(f)), static_cast<Format>(f));
+	}
+
+	std::map<std::string, Codec> codecs;
+	for (auto c = unsigned { 0 }; c < CODEC_COUNT; ++c)
+	{
+		codecs.emplace(name(static_cast<Codec>(c)), static_cast<Codec>(c));
+	}
+
+	auto line = std::string {};
+	while (std::getline(in, line))
+	{
+		auto fields = std::istringstream { line };
+
+		auto id      = std::string {};
+		auto format  = std::string {};
+		auto codec   = std::string {};
+		auto samples = int64_t { 0 };
+		auto seconds = double { 0.0 };
+
+		if (!(fields >> id >> format >> codec >> samples >> seconds))
+		{
+			ARCS_LOG_WARNING << "Skip unparseable throughput line: " << line;
+			continue;
+		}
+
+		const auto f { formats.find(format) };
+		const auto c { codecs.find(codec) };
+
+		if (f == formats.end() || c == codecs.end())
+		{
+			ARCS_LOG_WARNING << "Skip throughput line with unknown format or"
+				" codec: " << line;
+			continue;
+		}
+
+		record(id, f->second, c->second, samples, seconds);
+	}
+}
+
+
+void ReaderThroughput::Impl::clear()
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	if (!measurements_.empty())
+	{
+		measurements_.clear();
+		++revision_;
+	}
+}
+
+
+std::size_t ReaderThroughput::Impl::size() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	return measurements_.size();
+}
+
+
+uint64_t ReaderThroughput::Impl::revision() const
+{
+	return revision_.load();
+}
+
+
+// ReaderThroughput
+
+
+ReaderThroughput::ReaderThroughput()
+	: impl_ { std::make_unique<ReaderThroughput::Impl>() }
+{
+	// empty
+}
+
+
+ReaderThroughput::~ReaderThroughput() noexcept = default;
+
+
+void ReaderThroughput::record(const std::string& reader_id,
+		const Format format, const Codec codec, const int64_t samples,
+		const double seconds)
+{
+	impl_->record(reader_id, format, codec, samples, seconds);
+}
+
+
+void ReaderThroughput::record(const ReaderStatistics& statistics,
+		const Format format, const Codec codec)
+{
+	impl_->record(statistics.reader_id, format, codec, statistics.samples,
+			statistics.open_seconds + statistics.decode_seconds);
+}
+
+
+double ReaderThroughput::samples_per_second(const std::string& reader_id,
+		const Format format, const Codec codec) const
+{
+	return impl_->samples_per_second(reader_id, format, codec);
+}
+
+
+double ReaderThroughput::best(const Format format, const Codec codec) const
+{
+	return impl_->best(format, codec);
+}
+
+
+void ReaderThroughput::save(std::ostream& out) const
+{
+	impl_->save(out);
+}
+
+
+void ReaderThroughput::load(std::istream& in)
+{
+	impl_->load(in);
+}
+
+
+void ReaderThroughput::clear()
+{
+	impl_->clear();
+}
+
+
+std::size_t ReaderThroughput::size() const
+{
+	return impl_->size();
+}
+
+
+uint64_t ReaderThroughput::revision() const
+{
+	return impl_->revision();
+}
+
+
+// ThroughputPreference
+
+
+ThroughputPreference::ThroughputPreference()
+	: ThroughputPreference(FileReaderRegistry::throughput())
+{
+	// empty
+}
+
+
+ThroughputPreference::ThroughputPreference(
+		const ReaderThroughput* throughput)
+	: throughput_ { throughput }
+{
+	// empty
+}
+
+
+const ReaderThroughput* ThroughputPreference::throughput() const
+{
+	return throughput_;
+}
+
+
+uint64_t ThroughputPreference::do_revision() const
+{
+	return throughput_ ? throughput_->revision() : 0;
+}
+
+
+DescriptorPreference::type ThroughputPreference::do_preference(
+		const Format format, const Codec codec,
+		const FileReaderDescriptor& desc) const
+{
+	// Measured descriptors get a preference in the upper half of the range,
+	// unmeasured descriptors in the lower half.
+
+	constexpr static type HALF = (MAX_PREFERENCE - MIN_PREFERENCE) / 2;
+
+	const auto default_pref { DefaultPreference{}.preference(format, codec,
+			desc) };
+
+	if (default_pref == MIN_PREFERENCE)
+	{
+		return MIN_PREFERENCE;
+	}
+
+	const auto measured { throughput_
+		? throughput_->samples_per_second(desc.id(), format, codec)
+		: 0.0 };
+
+	if (measured <= 0.0)
+	{
+		return std::max(MIN_PREFERENCE + 1, default_pref / 2);
+	}
+
+	const auto best { throughput_->best(format, codec) };
+
+	return HALF + static_cast<type>(
+			std::ceil((MAX_PREFERENCE - HALF) * (measured / best)));
+}
+
+
+// FileReaderSelector
+
+
+FileReaderSelector::~FileReaderSelector() noexcept = default;
+
+
+std::unique_ptr<FileReaderDescriptor> FileReaderSelector::select(
+		const Format format, const Codec codec, const FileReaders& readers,
+		const DescriptorPreference& strategy) const
+{
+	ARCS_LOG_DEBUG << "Try to select a FileReader for filetype "
+		<< name(format) << "/" << name(codec);
+
+	if (readers.empty())
+	{
+		ARCS_LOG_WARNING << "No FileReaderDescriptors to select from";
+		return nullptr;
+	}
+
+	auto descriptor = do_select(format, codec, readers, strategy);
+
+	if (!descriptor)
+	{
+		ARCS_LOG_WARNING << "Could not select a matching descriptor";
+		return nullptr;
+	}
+
+	ARCS_LOG_DEBUG << "Reader descriptor '" << descriptor->name()
+		<< "' selected" << " (id: " << descriptor->id() << ")";
+
+	return descriptor;
+}
 
 
 // DefaultSelector
@@ -339,78 +1204,238 @@ std::unique_ptr<FileReaderDescriptor> DefaultSelector::do_select(
 	FileReaderDescriptor* result    = nullptr;
 	DescriptorPreference::type pref = DescriptorPreference::MIN_PREFERENCE;
 
-	DescriptorPreference::type curr_pref = pref;
+	DescriptorPreference::type curr_pref = pref;
+
+	for (auto& i : readers)
+	{
+		ARCS_LOG(DEBUG1) << "Check descriptor " << i.second->name();
+
+		curr_pref = p.preference(format, codec, *i.second);
+
+		ARCS_LOG(DEBUG1) << i.second->name() << ": preference for "
+			<< name(format) << '/' << name(codec) << " is " << curr_pref;
+
+		if (curr_pref > pref)
+		{
+			result = i.second.get();
+			pref   = curr_pref;
+		}
+	}
+
+	if (!result)
+	{
+		return nullptr;
+	}
+
+	ARCS_LOG(DEBUG1) << "First descriptor with highest preference: '"
+			<< result->name()
+			<< "'";
+
+	return result->clone();
+}
+
+
+// IdSelector
+
+
+IdSelector::IdSelector(const std::string& reader_id)
+	: reader_id_ { reader_id }
+{
+	// empty
+}
+
+
+std::string IdSelector::reader_id() const
+{
+	return reader_id_;
+}
+
+
+std::unique_ptr<FileReaderDescriptor> IdSelector::do_select(
+		const Format /* format */, const Codec /* codec */,
+		const FileReaders& descs,
+		const DescriptorPreference& /* p */) const
+{
+	ARCS_LOG(DEBUG1) << "Try to select descriptor with id '"
+		<< reader_id() << "'";
+
+	auto it { descs.find(reader_id()) };
+	return it != descs.end() ? it->second->clone() : nullptr;
+}
+
+
+// FileReaderSelection
+
+
+FileReaderSelection::~FileReaderSelection() noexcept = default;
+
+
+std::unique_ptr<FileReaderDescriptor> FileReaderSelection::get(
+		const Format format, const Codec codec, const FileReaders& descs) const
+{
+	return this->do_get(format, codec, descs);
+}
+
+
+uint64_t FileReaderSelection::revision() const
+{
+	return this->do_revision();
+}
+
+
+uint64_t FileReaderSelection::do_revision() const
+{
+	return 0;
+}
+
+
+// FormatTable
+
+
+namespace details
+{
+
+FormatTable::FormatTable()
+	: matchers_  { /* empty */ }
+	, positions_ { /* empty */ }
+	, compiled_  { 0 }
+{
+	// empty
+}
+
+
+FormatTable::FormatTable(const FormatList& formats)
+	: FormatTable()
+{
+	for (const auto& f : formats)
+	{
+		add(f.get());
+	}
+}
+
+
+void FormatTable::add(const Matcher* matcher)
+{
+	if (!matcher)
+	{
+		return;
+	}
+
+	matchers_.push_back(matcher);
+
+	if (matchers_.size() > MAX_COMPILED)
+	{
+		ARCS_LOG(DEBUG1) << "Format " << matcher->name()
+			<< " will be matched uncompiled";
+		return;
+	}
 
-	for (auto& i : readers)
+	const auto bit { mask_type { 1 } << (matchers_.size() - 1) };
+
+	const auto reference { matcher->reference_bytes() };
+	const auto sequence  { reference.sequence() };
+	const auto first     { std::size_t { reference.offset() } };
+	const auto last      { first + sequence.size() }; // past-the-end
+
+	// Positions not yet present accept any byte for the Matchers compiled
+	// before.
+
+	if (last > positions_.size())
 	{
-		ARCS_LOG(DEBUG1) << "Check descriptor " << i.second->name();
+		auto any = std::array<mask_type, ByteSequence::max_byte_value + 1> {};
+		any.fill(compiled_);
 
-		curr_pref = p.preference(format, codec, *i.second);
+		positions_.resize(last, any);
+	}
 
-		ARCS_LOG(DEBUG1) << i.second->name() << ": preference for "
-			<< name(format) << '/' << name(codec) << " is " << curr_pref;
+	for (auto pos = std::size_t { 0 }; pos < positions_.size(); ++pos)
+	{
+		auto& accepting = positions_[pos];
 
-		if (curr_pref > pref)
+		if (pos < first || pos >= last || sequence.is_wildcard(pos - first))
 		{
-			result = i.second.get();
-			pref   = curr_pref;
+			for (auto& a : accepting)
+			{
+				a |= bit;
+			}
+		} else
+		{
+			accepting[sequence[pos - first]] |= bit;
 		}
 	}
 
-	if (!result)
-	{
-		return nullptr;
-	}
+	compiled_ |= bit;
+}
 
-	ARCS_LOG(DEBUG1) << "First descriptor with highest preference: '"
-			<< result->name()
-			<< "'";
 
-	return result->clone();
-}
+const Matcher* FormatTable::match(const Bytes& bytes,
+		const std::string& filename) const
+{
+	auto accepted { candidates(bytes) };
 
+	// Matchers are tried in order of their bit position
 
-// IdSelector
+	for (auto i = std::size_t { 0 }; accepted; ++i, accepted >>= 1)
+	{
+		if ((accepted & 1) && matchers_[i]->matches(filename))
+		{
+			return matchers_[i];
+		}
+	}
 
+	for (auto i = MAX_COMPILED; i < matchers_.size(); ++i)
+	{
+		if (matchers_[i]->matches(bytes) && matchers_[i]->matches(filename))
+		{
+			return matchers_[i];
+		}
+	}
 
-IdSelector::IdSelector(const std::string& reader_id)
-	: reader_id_ { reader_id }
-{
-	// empty
+	return nullptr;
 }
 
 
-std::string IdSelector::reader_id() const
+FormatTable::mask_type FormatTable::candidates(const Bytes& bytes) const
 {
-	return reader_id_;
-}
+	auto accepted { compiled_ };
 
+	if (bytes.size() == 0)
+	{
+		return accepted; // Matcher::matches() accepts empty input
+	}
 
-std::unique_ptr<FileReaderDescriptor> IdSelector::do_select(
-		const Format /* format */, const Codec /* codec */,
-		const FileReaders& descs,
-		const DescriptorPreference& /* p */) const
-{
-	ARCS_LOG(DEBUG1) << "Try to select descriptor with id '"
-		<< reader_id() << "'";
+	const auto first { std::size_t { bytes.offset() } };
+	const auto last  { std::min(first + bytes.size(), positions_.size()) };
 
-	auto it { descs.find(reader_id()) };
-	return it != descs.end() ? it->second->clone() : nullptr;
-}
+	// Each byte value indexes a row of positions_, hence the row must cover
+	// the entire range of byte_type.
 
+	static_assert(std::numeric_limits<ByteSequence::byte_type>::max()
+			<= ByteSequence::max_byte_value, "Byte value exceeds table row");
 
-// FileReaderSelection
+	for (auto pos = first; pos < last && accepted; ++pos)
+	{
+		// A wildcard in the input accepts any Matcher at this position
 
+		if (bytes.is_wildcard(pos - first))
+		{
+			continue;
+		}
 
-FileReaderSelection::~FileReaderSelection() noexcept = default;
+		accepted &= positions_[pos][bytes[pos - first]];
+	}
 
+	return accepted;
+}
 
-std::unique_ptr<FileReaderDescriptor> FileReaderSelection::get(
-		const Format format, const Codec codec, const FileReaders& descs) const
+
+std::size_t FormatTable::size() const
 {
-	return this->do_get(format, codec, descs);
+	return matchers_.size();
 }
 
+} // namespace details
+
 
 // FileReaderRegistry
 
@@ -418,20 +1443,27 @@ std::unique_ptr<FileReaderDescriptor> FileReaderSelection::get(
 FormatList FileReaderRegistry::formats_;
 
 
+details::FormatTable FileReaderRegistry::format_table_;
+
+
 std::unique_ptr<FileReaders> FileReaderRegistry::readers_;
 
 
 std::unique_ptr<FileReaderSelection>
 	FileReaderRegistry::default_audio_selection_ =
 		std::make_unique<FileReaderPreferenceSelection<
-			FormatPreference, DefaultSelector>
+			DefaultPreference, DefaultSelector>
 		>();
 
 
+std::unique_ptr<ReaderThroughput> FileReaderRegistry::throughput_ =
+	std::make_unique<ReaderThroughput>();
+
+
 std::unique_ptr<FileReaderSelection>
 	FileReaderRegistry::default_toc_selection_ =
 		std::make_unique<FileReaderPreferenceSelection<
-			FormatPreference, DefaultSelector>
+			TocPreference, DefaultSelector>
 		>();
 
 
@@ -458,6 +1490,12 @@ const FormatList* FileReaderRegistry::formats()
 }
 
 
+const details::FormatTable* FileReaderRegistry::format_table()
+{
+	return &format_table_;
+}
+
+
 const FileReaders* FileReaderRegistry::readers()
 {
 	return readers_.get();
@@ -476,10 +1514,20 @@ const FileReaderSelection* FileReaderRegistry::default_toc_selection()
 }
 
 
+ReaderThroughput* FileReaderRegistry::throughput()
+{
+	return throughput_.get();
+}
+
+
 void FileReaderRegistry::add_format(std::unique_ptr<Matcher> m)
 {
 	// ... does not seem to require any further static initialization
-	if (m) { formats_.push_back(std::move(m)); }
+	if (m)
+	{
+		formats_.push_back(std::move(m));
+		format_table_.add(formats_.back().get());
+	}
 }
 
 
@@ -545,6 +1593,18 @@ std::unique_ptr<FileReaderDescriptor> select_descriptor(
 }
 
 
+std::pair<Format, Codec> file_type(const std::string& filename,
+		const FormatList& formats)
+{
+	if (filename.empty())
+	{
+		throw FileReadException("Filename must not be empty");
+	}
+
+	return FileType(filename).type(&formats);
+}
+
+
 std::unique_ptr<FileReader> select_reader(
 		const std::string& filename,
 		const FileReaderSelection& selection,
@@ -555,6 +1615,279 @@ std::unique_ptr<FileReader> select_reader(
 	return d ? d->create_reader() : nullptr;
 }
 
+
+uint64_t next_configuration_id()
+{
+	static std::atomic<uint64_t> last_id { 0 };
+
+	return ++last_id;
+}
+
+
+// SelectionCache::Impl
+
+
+/**
+ * \brief Private implementation of SelectionCache.
+ */
+class SelectionCache::Impl final
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 */
+	Impl();
+
+	/**
+	 * \brief Implements SelectionCache::descriptor().
+	 */
+	std::shared_ptr<const FileReaderDescriptor> descriptor(
+			const std::string& filename,
+			const FileReaderSelection& selection,
+			const FormatList& formats,
+			const FileReaders& readers);
+
+	/**
+	 * \brief Implements SelectionCache::configure().
+	 */
+	bool configure(const SelectionConfiguration& configuration);
+
+	/**
+	 * \brief Implements SelectionCache::clear().
+	 */
+	void clear();
+
+	/**
+	 * \brief Implements SelectionCache::size().
+	 */
+	std::size_t size() const;
+
+private:
+
+	/**
+	 * \brief Forget all decisions, requires mutex_ to be held.
+	 */
+	void clear_unlocked();
+
+	/**
+	 * \brief Key for a selection decision.
+	 */
+	using DecisionKey = std::pair<Format, Codec>;
+
+	/**
+	 * \brief Key for the Matcher that last matched a filename suffix.
+	 */
+	using MatcherKey = ci_string;
+
+	/**
+	 * \brief Configuration the decisions are valid for.
+	 */
+	SelectionConfiguration configuration_;
+
+	/**
+	 * \brief Selected descriptors by format and codec.
+	 */
+	std::map<DecisionKey, std::shared_ptr<const FileReaderDescriptor>>
+		decisions_;
+
+	/**
+	 * \brief Matchers that recognized a file by its suffix.
+	 */
+	std::map<MatcherKey, const Matcher*> matchers_;
+
+	/**
+	 * \brief Compiled table for a FormatList other than the registered one.
+	 */
+	std::unique_ptr<FormatTable> table_;
+
+	/**
+	 * \brief Guards configuration_, decisions_, matchers_ and table_.
+	 */
+	mutable std::mutex mutex_;
+};
+
+
+SelectionCache::Impl::Impl()
+	: configuration_ { 0, 0, 0 }
+	, decisions_     { /* empty */ }
+	, matchers_      { /* empty */ }
+	, table_         { nullptr }
+	, mutex_         { /* default */ }
+{
+	// empty
+}
+
+
+std::shared_ptr<const FileReaderDescriptor> SelectionCache::Impl::descriptor(
+		const std::string& filename,
+		const FileReaderSelection& selection,
+		const FormatList& formats,
+		const FileReaders& readers)
+{
+	if (filename.empty())
+	{
+		throw FileReadException("Filename must not be empty");
+	}
+
+	const auto suffix_key = MatcherKey {
+		get_suffix(filename, ".").c_str() };
+
+	const Matcher* hint = nullptr;
+	const FormatTable* table = table_for(&formats);
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto m { matchers_.find(suffix_key) };
+		if (m != matchers_.end())
+		{
+			hint = m->second;
+		}
+
+		if (!table)
+		{
+			if (!table_)
+			{
+				table_ = std::make_unique<FormatTable>(formats);
+			}
+			table = table_.get();
+		}
+	}
+
+	// Reading the file bytes cannot be avoided, but the FormatList is only
+	// scanned if the Matcher used for the previous file with this suffix does
+	// not match.
+
+	const auto file_type { FileType(filename) };
+	const auto matcher   { file_type.format(&formats, table, hint) };
+	const auto type      { file_type.type(matcher) };
+
+	const auto decision_key = DecisionKey { type.first, type.second };
+
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+
+		if (matcher && matcher != hint)
+		{
+			matchers_[suffix_key] = matcher;
+		}
+
+		const auto d { decisions_.find(decision_key) };
+		if (d != decisions_.end())
+		{
+			ARCS_LOG(DEBUG1) << "Use known selection for "
+				<< name(type.first) << "/" << name(type.second);
+
+			trace_selection(filename, type, d->second.get());
+
+			return d->second;
+		}
+	}
+
+	auto selected = std::shared_ptr<const FileReaderDescriptor> {
+		selection.get(type.first, type.second, readers) };
+
+	if (!selected)
+	{
+		ARCS_LOG_WARNING << "No reader available.";
+	}
+
+	// If another thread was faster, use its decision for consistency
+
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto& decision {
+		decisions_.emplace(decision_key, std::move(selected)).first->second };
+
+	trace_selection(filename, type, decision.get());
+
+	return decision;
+}
+
+
+bool SelectionCache::Impl::configure(
+		const SelectionConfiguration& configuration)
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	if (configuration == configuration_)
+	{
+		return false;
+	}
+
+	ARCS_LOG(DEBUG1) << "Selection configuration changed, forget decisions";
+
+	clear_unlocked();
+	configuration_ = configuration;
+
+	return true;
+}
+
+
+void SelectionCache::Impl::clear()
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	clear_unlocked();
+}
+
+
+void SelectionCache::Impl::clear_unlocked()
+{
+	decisions_.clear();
+	matchers_.clear();
+	table_.reset();
+}
+
+
+std::size_t SelectionCache::Impl::size() const
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+
+	return decisions_.size();
+}
+
+
+// SelectionCache
+
+
+SelectionCache::SelectionCache()
+	: impl_ { std::make_unique<SelectionCache::Impl>() }
+{
+	// empty
+}
+
+
+SelectionCache::~SelectionCache() noexcept = default;
+
+
+std::shared_ptr<const FileReaderDescriptor> SelectionCache::descriptor(
+		const std::string& filename,
+		const FileReaderSelection& selection,
+		const FormatList& formats,
+		const FileReaders& readers)
+{
+	return impl_->descriptor(filename, selection, formats, readers);
+}
+
+
+bool SelectionCache::configure(const SelectionConfiguration& configuration)
+{
+	return impl_->configure(configuration);
+}
+
+
+void SelectionCache::clear()
+{
+	impl_->clear();
+}
+
+
+std::size_t SelectionCache::size() const
+{
+	return impl_->size();
+}
+
 } // namespace details
 
 
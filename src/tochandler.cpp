@@ -242,6 +242,8 @@ void ParserToCHandler::dump_log() const
 
 void ParserToCHandler::do_start_input()
 {
+	this->reset();
+
 	current_track_ = 1;
 	ARCS_LOG(DEBUG3) << "Set current track to 1";
 }
@@ -301,6 +303,17 @@ std::unique_ptr<ToC> ParserToCHandler::get_toc() const
 }
 
 
+void ParserToCHandler::reset()
+{
+	offsets_.clear();
+	filenames_.clear();
+	isrcs_.clear();
+	current_track_ = 0;
+	mcn_.clear();
+	disc_id_.clear();
+}
+
+
 void ParserToCHandler::append_isrc(const std::string& isrc)
 {
 	isrcs_.push_back(isrc);
@@ -219,6 +219,14 @@ public:
 	 */
 	std::unique_ptr<ToC> get_toc() const;
 
+	/**
+	 * \brief Discard all parsed values.
+	 *
+	 * Makes the handler ready for a new input. This is implied by
+	 * start_input().
+	 */
+	void reset();
+
 	/**
 	 * \brief Append a track's ISRC.
 	 *
@@ -0,0 +1,93 @@
+#ifndef __LIBARCSDEC_TRACEPOINTS_HPP__
+#define __LIBARCSDEC_TRACEPOINTS_HPP__
+
+/**
+ * \internal
+ *
+ * \file
+ *
+ * \brief Static tracepoints (USDT) of libarcsdec.
+ *
+ * If libarcsdec is built with LIBARCSDEC_WITH_TRACEPOINTS, the tracepoints are
+ * compiled to USDT probes of provider \c libarcsdec that can be attached to by
+ * tools like bpftrace, perf or SystemTap. An unattached probe is a single
+ * no-op instruction. Otherwise, the tracepoints and the evaluation of their
+ * arguments are removed completely.
+ *
+ * Probes and arguments:
+ *
+ * <table>
+ *   <tr><td>file_open</td>
+ *       <td>file id, filename, reader id</td></tr>
+ *   <tr><td>file_close</td>
+ *       <td>file id, samples, blocks</td></tr>
+ *   <tr><td>select</td>
+ *       <td>filename, format, codec, reader id</td></tr>
+ *   <tr><td>block</td>
+ *       <td>file id, samples in block</td></tr>
+ *   <tr><td>read_error</td>
+ *       <td>file id, reader id, error message</td></tr>
+ *   <tr><td>calculation_end</td>
+ *       <td>file id of last file, samples, number of tracks</td></tr>
+ * </table>
+ *
+ * Strings are passed as pointers to null-terminated strings, format and codec
+ * as their numeric value. The file id is the process-wide id of a file opened
+ * by an AudioReader, see ReaderStatistics::file_id.
+ *
+ * Arguments that are expensive to compute may be computed in a block guarded
+ * by details::tracepoints_enabled, which is removed if tracepoints are not
+ * compiled.
+ */
+
+#ifdef LIBARCSDEC_WITH_TRACEPOINTS
+
+extern "C"
+{
+#include <sys/sdt.h>   // for DTRACE_PROBE2, DTRACE_PROBE3, DTRACE_PROBE4
+}
+
+#define ARCSDEC_TRACE2(probe, a1, a2) \
+	DTRACE_PROBE2(libarcsdec, probe, a1, a2)
+#define ARCSDEC_TRACE3(probe, a1, a2, a3) \
+	DTRACE_PROBE3(libarcsdec, probe, a1, a2, a3)
+#define ARCSDEC_TRACE4(probe, a1, a2, a3, a4) \
+	DTRACE_PROBE4(libarcsdec, probe, a1, a2, a3, a4)
+
+#else
+
+// Arguments are referenced in dead code to avoid warnings about unused
+// variables that are only passed to tracepoints
+
+#define ARCSDEC_TRACE2(probe, a1, a2) \
+	do { if (false) { (void)(a1); (void)(a2); } } while (false)
+#define ARCSDEC_TRACE3(probe, a1, a2, a3) \
+	do { if (false) { (void)(a1); (void)(a2); (void)(a3); } } while (false)
+#define ARCSDEC_TRACE4(probe, a1, a2, a3, a4) \
+	do { if (false) { (void)(a1); (void)(a2); (void)(a3); (void)(a4); } \
+	} while (false)
+
+#endif
+
+
+namespace arcsdec
+{
+inline namespace v_1_0_0
+{
+namespace details
+{
+
+/**
+ * \brief TRUE iff tracepoints are compiled.
+ */
+#ifdef LIBARCSDEC_WITH_TRACEPOINTS
+constexpr bool tracepoints_enabled = true;
+#else
+constexpr bool tracepoints_enabled = false;
+#endif
+
+} // namespace details
+} // namespace v_1_0_0
+} // namespace arcsdec
+
+#endif
@@ -5,6 +5,9 @@
 #include "sampleproc.hpp"
 #endif
 
+#include <cstdint>   // for int64_t
+#include <iterator>  // for distance
+
 
 /**
  * \brief Mock for a SampleProcessor.
@@ -35,5 +38,47 @@ class Mock_SampleProcessor: public arcsdec::SampleProcessor
 	}
 };
 
+
+/**
+ * \brief Mock for a SampleProcessor that counts what it receives.
+ */
+class Mock_SampleCounter: public arcsdec::SampleProcessor
+{
+public:
+
+	/**
+	 * \brief Number of samples received.
+	 */
+	int64_t samples = 0;
+
+	/**
+	 * \brief Number of samples declared by the last AudioSize received.
+	 */
+	int64_t declared = -1;
+
+private:
+
+	void do_start_input() final
+	{
+		samples = 0;
+	}
+
+	void do_append_samples(arcstk::SampleInputIterator begin,
+			arcstk::SampleInputIterator end) final
+	{
+		samples += std::distance(begin, end);
+	}
+
+	void do_update_audiosize(const arcstk::AudioSize &size) final
+	{
+		declared = size.samples();
+	}
+
+	void do_end_input() final
+	{
+		// empty
+	}
+};
+
 #endif
 
@@ -0,0 +1,63 @@
+#ifndef __LIBARCSDEC_WAVWRITER_HPP__
+#define __LIBARCSDEC_WAVWRITER_HPP__
+
+/**
+ * \file
+ *
+ * \brief Writer for RIFF/WAV files of CDDA samples as used by the fixtures.
+ */
+
+#include <cstdint>   // for uint32_t
+#include <fstream>   // for ofstream
+#include <iterator>  // for distance
+#include <ostream>   // for ostream
+#include <string>    // for string
+#include <vector>    // for vector
+
+
+/**
+ * \brief Write samples to a file as CDDA in a WAV container.
+ *
+ * \param[in] filename Name of the file
+ * \param[in] begin    First sample to write
+ * \param[in] end      Sample after the last sample to write
+ */
+inline void write_wav(const std::string& filename,
+		std::vector<uint32_t>::const_iterator begin,
+		std::vector<uint32_t>::const_iterator end)
+{
+	const auto put = [](std::ostream& out, const uint32_t value,
+			const int bytes)
+	{
+		for (auto i { 0 }; i < bytes; ++i)
+		{
+			out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+		}
+	};
+
+	const auto data_size {
+		static_cast<uint32_t>(std::distance(begin, end)) * 4 };
+
+	auto out = std::ofstream { filename, std::ios::binary };
+
+	out << "RIFF";
+	put(out, 36 + data_size, 4);
+	out << "WAVEfmt ";
+	put(out, 16, 4);        // size of format chunk
+	put(out, 1, 2);         // PCM
+	put(out, 2, 2);         // channels
+	put(out, 44100, 4);     // samples per second
+	put(out, 44100 * 4, 4); // bytes per second
+	put(out, 4, 2);         // block align
+	put(out, 16, 2);        // bits per sample
+	out << "data";
+	put(out, data_size, 4);
+
+	for (auto s { begin }; s != end; ++s)
+	{
+		put(out, *s, 4); // left channel in the lower 16 bits
+	}
+}
+
+#endif
+
@@ -0,0 +1,488 @@
+#include "catch2/catch_test_macros.hpp"
+
+/**
+ * \file
+ *
+ * \brief Regression tests for allocations and peak memory of the AudioReaders.
+ *
+ * The testcase replaces the allocation functions of the C library by counting
+ * wrappers. Since operator new allocates by malloc, this also covers
+ * allocations by C++ code. Counting requires glibc and is not available with
+ * AddressSanitizer, which replaces the allocation functions itself.
+ */
+
+#ifndef __LIBARCSDEC_AUDIOREADER_HPP__
+#include "audioreader.hpp"              // for AudioReader
+#endif
+#ifndef __LIBARCSDEC_SAMPLEPROC_HPP__
+#include "sampleproc.hpp"               // for SampleProcessor
+#endif
+#ifndef __LIBARCSDEC_SELECTION_HPP__
+#include "selection.hpp"                // for FileReaderRegistry, cast_reader
+#endif
+#ifndef __LIBARCSDEC_WAVWRITER_HPP__
+#include "wavwriter.hpp"                // for write_wav
+#endif
+
+#include <algorithm>  // for max
+#include <atomic>     // for atomic
+#include <cerrno>     // for errno, ENOMEM
+#include <cstddef>    // for size_t
+#include <cstdint>    // for int64_t, uint32_t
+#include <cstdio>     // for remove
+#include <filesystem> // for temp_directory_path
+#include <fstream>    // for ifstream, ofstream
+#include <string>     // for string, getline, stoll
+#include <vector>     // for vector
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#if defined(__has_feature)
+#if !__has_feature(address_sanitizer)
+#define ALLOCATIONS_COUNTED
+#endif
+#else
+#define ALLOCATIONS_COUNTED
+#endif
+#endif
+
+#ifdef ALLOCATIONS_COUNTED
+#include <malloc.h>   // for malloc_usable_size
+#endif
+
+
+namespace
+{
+
+/**
+ * \brief Number of allocations since start of the process.
+ */
+std::atomic<int64_t> allocations { 0 };
+
+/**
+ * \brief Number of bytes currently allocated.
+ */
+std::atomic<int64_t> heap_bytes { 0 };
+
+/**
+ * \brief Maximal value of heap_bytes since it was last reset.
+ */
+std::atomic<int64_t> heap_peak { 0 };
+
+
+#ifdef ALLOCATIONS_COUNTED
+
+/**
+ * \brief Count an allocation of \c ptr.
+ *
+ * \param[in] ptr Pointer to allocated memory or nullptr
+ *
+ * \return \c ptr
+ */
+void* count_allocation(void* ptr)
+{
+	if (ptr)
+	{
+		++allocations;
+
+		const auto bytes { heap_bytes += static_cast<int64_t>(
+				::malloc_usable_size(ptr)) };
+
+		auto peak { heap_peak.load() };
+		while (bytes > peak && !heap_peak.compare_exchange_weak(peak, bytes))
+		{
+			// retry
+		}
+	}
+
+	return ptr;
+}
+
+
+/**
+ * \brief Count the release of \c ptr.
+ *
+ * \param[in] ptr Pointer to memory to be released or nullptr
+ */
+void count_release(void* ptr)
+{
+	if (ptr)
+	{
+		heap_bytes -= static_cast<int64_t>(::malloc_usable_size(ptr));
+	}
+}
+
+#endif
+
+
+/**
+ * \brief Current or peak resident set size of this process.
+ *
+ * \param[in] key Either "VmRSS:" or "VmHWM:"
+ *
+ * \return Size in bytes or -1 if unknown
+ */
+int64_t resident_bytes(const std::string& key)
+{
+	auto status = std::ifstream { "/proc/self/status" };
+	auto line   = std::string {};
+
+	while (std::getline(status, line))
+	{
+		if (line.compare(0, key.size(), key) == 0)
+		{
+			return std::stoll(line.substr(key.size())) * 1024; // in kB
+		}
+	}
+
+	return -1;
+}
+
+
+/**
+ * \brief Reset the peak resident set size to the current size.
+ *
+ * \return TRUE iff the peak could be reset
+ */
+bool reset_resident_peak()
+{
+	auto clear_refs = std::ofstream { "/proc/self/clear_refs" };
+	clear_refs << "5";
+
+	return static_cast<bool>(clear_refs.flush());
+}
+
+
+/**
+ * \brief Memory profile of reading a file.
+ */
+struct Profile final
+{
+	/**
+	 * \brief Number of blocks read.
+	 */
+	std::size_t blocks = 0;
+
+	/**
+	 * \brief Maximal number of allocations between two blocks.
+	 *
+	 * The first blocks are not considered since they may include the setup.
+	 */
+	int64_t steady_allocations = 0;
+
+	/**
+	 * \brief Peak of allocated bytes over the allocated bytes at start.
+	 */
+	int64_t heap_peak = 0;
+
+	/**
+	 * \brief Peak resident set size over the size at start or -1.
+	 */
+	int64_t resident_peak = -1;
+};
+
+
+/**
+ * \brief SampleProcessor that records the allocation count for each block.
+ *
+ * Records are stored without allocating.
+ */
+class AllocationProbe final : public arcsdec::SampleProcessor
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] capacity Maximal number of blocks to record
+	 */
+	explicit AllocationProbe(const std::size_t capacity)
+		: counts_ ( capacity )
+		, blocks_ { 0 }
+	{
+		// empty
+	}
+
+	/**
+	 * \brief Maximal number of allocations between two blocks, except for
+	 * the first \c skip blocks.
+	 *
+	 * \param[in] skip Number of blocks to skip
+	 *
+	 * \return Maximal number of allocations per block
+	 */
+	int64_t max_allocations(const std::size_t skip) const
+	{
+		auto max = int64_t { 0 };
+
+		for (auto i { skip + 1 }; i < std::min(blocks_, counts_.size()); ++i)
+		{
+			max = std::max(max, counts_[i] - counts_[i - 1]);
+		}
+
+		return max;
+	}
+
+	/**
+	 * \brief Number of blocks received.
+	 *
+	 * \return Number of blocks received
+	 */
+	std::size_t blocks() const
+	{
+		return blocks_;
+	}
+
+private:
+
+	void do_start_input() final
+	{
+		// empty
+	}
+
+	void do_append_samples(arcstk::SampleInputIterator /*begin*/,
+			arcstk::SampleInputIterator /*end*/) final
+	{
+		if (blocks_ < counts_.size())
+		{
+			counts_[blocks_] = allocations.load();
+		}
+
+		++blocks_;
+	}
+
+	void do_update_audiosize(const arcstk::AudioSize &/*size*/) final
+	{
+		// empty
+	}
+
+	void do_end_input() final
+	{
+		// empty
+	}
+
+	std::vector<int64_t> counts_;
+	std::size_t blocks_;
+};
+
+
+/**
+ * \brief Profile reading \c filename with the reader of the specified id.
+ *
+ * \param[in] reader_id        Id of the reader to use
+ * \param[in] filename         File to read
+ * \param[in] samples_per_read Samples per block
+ *
+ * \return Profile of reading or a Profile with no blocks if the reader is not
+ * available
+ */
+Profile profile(const std::string& reader_id, const std::string& filename,
+		const int64_t samples_per_read)
+{
+	auto result = Profile {};
+
+	const auto desc { arcsdec::FileReaderRegistry::reader(reader_id) };
+
+	if (!desc)
+	{
+		return result;
+	}
+
+	auto reader { arcsdec::details::cast_reader<arcsdec::AudioReader>(
+			desc->create_reader()).first };
+
+	auto probe = AllocationProbe { 100000 };
+
+	reader->set_processor(probe);
+	reader->set_samples_per_read(samples_per_read);
+
+	const auto heap_start { heap_bytes.load() };
+	heap_peak = heap_start;
+
+	const auto resident_start { resident_bytes("VmRSS:") };
+	const auto resident_reset { reset_resident_peak() };
+
+	reader->process_file(filename);
+
+	const auto resident_end { resident_bytes("VmHWM:") };
+
+	result.blocks = probe.blocks();
+	result.steady_allocations = probe.max_allocations(2);
+	result.heap_peak = heap_peak.load() - heap_start;
+
+	if (resident_reset && resident_start >= 0 && resident_end >= 0)
+	{
+		result.resident_peak = std::max(int64_t { 0 },
+				resident_end - resident_start);
+	}
+
+	return result;
+}
+
+} // namespace
+
+
+#ifdef ALLOCATIONS_COUNTED
+
+extern "C"
+{
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t number, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void* __libc_valloc(std::size_t size);
+void* __libc_pvalloc(std::size_t size);
+void  __libc_free(void* ptr);
+
+void* malloc(std::size_t size)
+{
+	return count_allocation(__libc_malloc(size));
+}
+
+void* calloc(std::size_t number, std::size_t size)
+{
+	return count_allocation(__libc_calloc(number, size));
+}
+
+void* realloc(void* ptr, std::size_t size)
+{
+	// The old block is only released if the reallocation succeeds
+
+	const auto old_bytes { ptr ? ::malloc_usable_size(ptr) : 0 };
+	const auto result { __libc_realloc(ptr, size) };
+
+	if (result || size == 0)
+	{
+		heap_bytes -= static_cast<int64_t>(old_bytes);
+	}
+
+	return count_allocation(result);
+}
+
+void* reallocarray(void* ptr, std::size_t number, std::size_t size)
+{
+	auto bytes = std::size_t { 0 };
+
+	if (__builtin_mul_overflow(number, size, &bytes))
+	{
+		errno = ENOMEM;
+		return nullptr;
+	}
+
+	return realloc(ptr, bytes);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size)
+{
+	return count_allocation(__libc_memalign(alignment, size));
+}
+
+void* memalign(std::size_t alignment, std::size_t size)
+{
+	return count_allocation(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void** ptr, std::size_t alignment, std::size_t size)
+{
+	*ptr = count_allocation(__libc_memalign(alignment, size));
+	return *ptr ? 0 : ENOMEM;
+}
+
+void* valloc(std::size_t size)
+{
+	return count_allocation(__libc_valloc(size));
+}
+
+void* pvalloc(std::size_t size)
+{
+	return count_allocation(__libc_pvalloc(size));
+}
+
+void free(void* ptr)
+{
+	count_release(ptr);
+	__libc_free(ptr);
+}
+
+} // extern "C"
+
+#endif
+
+
+TEST_CASE ("Allocations and peak memory of AudioReaders", "[allocations]" )
+{
+#ifndef ALLOCATIONS_COUNTED
+	SKIP("Allocations are only counted with glibc and without ASan");
+#endif
+
+	// Budgets per reader. FFmpeg allocates a frame for each frame it decodes
+	// and libwavpack allocates a buffer for each WavPack block it reads.
+
+	const auto reference { (std::filesystem::temp_directory_path()
+			/ "libarcsdec_allocations.wav").string() };
+
+	{
+		const auto silence = std::vector<uint32_t>(441000); // 10 seconds
+		write_wav(reference, silence.begin(), silence.end());
+	}
+
+	const auto kib = int64_t { 1024 };
+
+	SECTION ("wavpcm reads without allocating in steady state")
+	{
+		const auto p { profile("wavpcm", reference, 4096) };
+
+		REQUIRE ( p.blocks > 100 );
+		CHECK ( p.steady_allocations == 0 );
+		CHECK ( p.heap_peak <= 4096 * 4 + 64 * kib );
+
+		if (p.resident_peak >= 0)
+		{
+			CHECK ( p.resident_peak <= 4096 * kib );
+		}
+	}
+
+	SECTION ("ffmpeg stays within its budget")
+	{
+		const auto p { profile("ffmpeg", reference, 4096) };
+
+		if (p.blocks > 0)
+		{
+			CHECK ( p.steady_allocations <= 16 );
+			CHECK ( p.heap_peak <= 8192 * kib );
+		}
+	}
+
+	// The FLAC and WavPack files have 24 frames or blocks of 1025 samples,
+	// thus there are enough blocks to reach the steady state
+
+	SECTION ("flac stays within its budget")
+	{
+		if (!arcsdec::FileReaderRegistry::reader("flac"))
+		{
+			SKIP("Reader flac is not available");
+		}
+
+		const auto p { profile("flac", "test02.flac", 256) };
+
+		REQUIRE ( p.blocks >= 24 );
+		CHECK ( p.steady_allocations == 0 );
+		CHECK ( p.heap_peak <= 1024 * kib );
+	}
+
+	SECTION ("wavpack stays within its budget")
+	{
+		if (!arcsdec::FileReaderRegistry::reader("wavpack"))
+		{
+			SKIP("Reader wavpack is not available");
+		}
+
+		const auto p { profile("wavpack", "test02.wv", 256) };
+
+		REQUIRE ( p.blocks >= 24 );
+		CHECK ( p.steady_allocations <= 4 );
+		CHECK ( p.heap_peak <= 1024 * kib );
+	}
+
+	std::remove(reference.c_str());
+}
@@ -10,6 +10,69 @@
 #include "audioreader.hpp"              // TO BE TESTED
 #endif
 
+#ifndef __LIBARCSDEC_READERMOCKS_HPP__
+#include "readermocks.hpp"              // for Mock_SampleCounter
+#endif
+
+#include <algorithm>  // for min
+#include <cstddef>    // for size_t
+#include <cstdint>    // for int64_t
+#include <memory>     // for make_unique, unique_ptr
+#include <numeric>    // for iota
+#include <stdexcept>  // for logic_error
+#include <string>     // for string
+#include <vector>     // for vector
+
+
+/**
+ * \brief Mock for an AudioReaderImpl that cannot seek.
+ *
+ * Provides 1025 samples in blocks of 100 samples. Each sample is its index.
+ */
+class Mock_AudioReaderImpl final : public arcsdec::AudioReaderImpl
+{
+public:
+
+	~Mock_AudioReaderImpl() noexcept final
+	{
+		this->stop_producer();
+	}
+
+private:
+
+	std::unique_ptr<arcsdec::AudioSize> do_acquire_size(
+			const std::string& /*filename*/) final
+	{
+		return std::make_unique<arcsdec::AudioSize>(1025,
+				arcsdec::UNIT::SAMPLES);
+	}
+
+	void do_process_file(const std::string& /*filename*/) final
+	{
+		auto buffer = std::vector<arcstk::sample_t> {};
+
+		this->signal_startinput();
+		this->signal_updateaudiosize({ 1025, arcsdec::UNIT::SAMPLES });
+
+		for (auto i { 0 }; i < 1025; i += 100)
+		{
+			buffer.resize(static_cast<std::size_t>(std::min(100, 1025 - i)));
+			std::iota(buffer.begin(), buffer.end(),
+					static_cast<arcstk::sample_t>(i));
+
+			this->signal_appendbuffer(buffer);
+		}
+
+		this->signal_endinput();
+	}
+
+	std::unique_ptr<arcsdec::FileReaderDescriptor> do_descriptor() const
+		final
+	{
+		return nullptr;
+	}
+};
+
 
 TEST_CASE ( "LittleEndianBytes", "[littleendianbytes]" )
 {
@@ -56,3 +119,133 @@ TEST_CASE ( "BigEndianBytes", "[bigendianbytes]" )
 	}
 }
 
+
+TEST_CASE ( "AudioReaderImpl", "[audioreaderimpl]" )
+{
+	auto r = Mock_AudioReaderImpl{};
+
+	auto counter = Mock_SampleCounter{};
+	r.attach_processor(counter);
+
+	SECTION ( "Default implementation of process_range() passes the range" )
+	{
+		r.process_range("foo", 150, 320);
+
+		CHECK ( counter.samples  == 320 );
+		CHECK ( counter.declared == 320 );
+	}
+
+	SECTION ( "Default implementation of process_range() truncates the range" )
+	{
+		r.process_range("foo", 1000, 200);
+
+		CHECK ( counter.samples  == 25 );
+		CHECK ( counter.declared == 25 );
+	}
+
+	SECTION ( "Processor is restored after process_range()" )
+	{
+		r.process_range("foo", 0, 10);
+		r.process_file("foo");
+
+		CHECK ( counter.samples  == 1025 );
+		CHECK ( counter.declared == 1025 );
+	}
+
+	SECTION ( "Statistics describe the last input processed" )
+	{
+		r.process_file("foo");
+
+		const auto& statistics { r.statistics() };
+
+		CHECK ( statistics.blocks  == 11 );
+		CHECK ( statistics.samples == 1025 );
+		CHECK ( statistics.peak_block_bytes == 100 * sizeof(arcstk::sample_t) );
+		CHECK ( statistics.reader_id.empty() );
+
+		// Times are not measured by default
+
+		CHECK ( not r.statistics_enabled() );
+		CHECK ( statistics.processing_seconds == 0.0 );
+		CHECK ( statistics.decode_seconds     == 0.0 );
+	}
+
+	SECTION ( "Enabled statistics measure the times" )
+	{
+		r.set_statistics_enabled(true);
+		r.process_file("foo");
+
+		const auto& statistics { r.statistics() };
+
+		CHECK ( statistics.blocks  == 11 );
+		CHECK ( statistics.samples == 1025 );
+		CHECK ( statistics.processing_seconds > 0.0 );
+		CHECK ( statistics.decode_seconds    >= 0.0 );
+	}
+
+	SECTION ( "Default implementation of next_block() pulls all samples" )
+	{
+		r.open("foo");
+
+		auto total  = std::size_t { 0 };
+		auto blocks = 0;
+		auto sorted = true;
+
+		for (auto b { r.next_block() }; !b.empty(); b = r.next_block())
+		{
+			for (const auto& sample : b)
+			{
+				sorted = sorted && sample == total++;
+			}
+
+			++blocks;
+		}
+
+		CHECK ( r.input_size().samples() == 1025 );
+
+		r.close();
+
+		CHECK ( total  == 1025 );
+		CHECK ( blocks == 11 );
+		CHECK ( sorted );
+		CHECK ( counter.samples == 0 );
+	}
+
+	SECTION ( "Destroying the reader with an open input stops reading" )
+	{
+		auto open_reader { std::make_unique<Mock_AudioReaderImpl>() };
+
+		open_reader->open("foo");
+
+		CHECK ( open_reader->next_block().size() == 100 );
+
+		open_reader.reset();
+	}
+
+	SECTION ( "Closing the input before its end stops reading" )
+	{
+		r.open("foo");
+
+		CHECK ( r.next_block().size() == 100 );
+
+		r.close();
+		r.process_file("foo");
+
+		CHECK ( counter.samples  == 1025 );
+		CHECK ( counter.declared == 1025 );
+	}
+
+	SECTION ( "next_block() without an open input throws" )
+	{
+		CHECK_THROWS_AS ( r.next_block(), std::logic_error );
+	}
+
+	SECTION ( "open() with an open input throws" )
+	{
+		r.open("foo");
+
+		CHECK_THROWS_AS ( r.open("bar"), std::logic_error );
+
+		r.close();
+	}
+}
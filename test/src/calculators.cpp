@@ -19,6 +19,29 @@
 #ifndef __LIBARCSDEC_SELECTION_HPP__
 #include "selection.hpp"                // for FileReaderRegistry
 #endif
+#ifndef __LIBARCSDEC_WAVWRITER_HPP__
+#include "wavwriter.hpp"                // for write_wav
+#endif
+
+#ifndef __LIBARCSTK_ALGORITHMS_HPP__
+#include <arcstk/algorithms.hpp>        // for AccurateRip::V1andV2
+#endif
+
+extern "C" {
+#include <unistd.h>  // for link
+}
+
+#include <chrono>     // for seconds
+#include <cstdint>    // for int64_t, uint32_t
+#include <cstdio>     // for remove
+#include <filesystem> // for last_write_time
+#include <fstream>    // for ifstream, ofstream
+#include <memory>     // for make_unique
+#include <sstream>    // for ostringstream, stringstream
+#include <stdexcept>  // for invalid_argument
+#include <string>     // for string
+#include <utility>    // for move
+#include <vector>     // for vector
 
 
 using arcsdec::ReaderAndFormatHolder;
@@ -36,6 +59,176 @@ class Mock_ReaderAndFormatHolder : public ReaderAndFormatHolder
 };
 
 
+namespace
+{
+
+/**
+ * \brief Compute ARCSv1 for an album by summing each track directly.
+ *
+ * \param[in] samples Samples of the album
+ * \param[in] offsets Offsets of the tracks in samples
+ *
+ * \return ARCSv1 of each track
+ */
+std::vector<uint32_t> brute_force_arcs1(const std::vector<uint32_t>& samples,
+		const std::vector<int64_t>& offsets)
+{
+	auto checksums = std::vector<uint32_t> {};
+
+	const auto total { static_cast<int64_t>(samples.size()) };
+
+	for (auto t = std::size_t { 0 }; t < offsets.size(); ++t)
+	{
+		const auto start { offsets[t] };
+		const auto end   { t + 1 < offsets.size() ? offsets[t + 1] : total };
+
+		const auto first { t == 0 ? start + 2939 : start };
+		const auto last  { t + 1 == offsets.size() ? end - 2940 : end };
+
+		auto checksum = uint32_t { 0 };
+
+		for (auto p { first }; p < last; ++p)
+		{
+			checksum += static_cast<uint32_t>(p - start + 1) * samples[p];
+		}
+
+		checksums.push_back(checksum);
+	}
+
+	return checksums;
+}
+
+/**
+ * \brief Deterministic pseudo-random samples.
+ *
+ * \param[in] total Number of samples
+ *
+ * \return Samples
+ */
+std::vector<uint32_t> make_samples(const std::size_t total)
+{
+	auto samples = std::vector<uint32_t>(total);
+	auto state = uint32_t { 0x12345678 };
+
+	for (auto& s : samples)
+	{
+		state = state * 1664525 + 1013904223;
+		s = state;
+	}
+
+	return samples;
+}
+
+/**
+ * \brief Write a cue sheet with the specified tracks of a single file.
+ *
+ * \param[in] filename  Name of the cue sheet
+ * \param[in] audiofile Name of the audio file
+ * \param[in] frames    Offset of each track in frames
+ */
+void write_cue(const std::string& filename, const std::string& audiofile,
+		const std::vector<int32_t>& frames)
+{
+	auto out = std::ofstream { filename };
+
+	out << "FILE \"" << audiofile << "\" WAVE\n";
+
+	for (auto t = std::size_t { 0 }; t < frames.size(); ++t)
+	{
+		const auto f { frames[t] };
+
+		out << "  TRACK " << (t < 9 ? "0" : "") << (t + 1) << " AUDIO\n"
+			<< "    INDEX 01 "
+			<< (f / 4500 < 10 ? "0" : "") << f / 4500 << ":"
+			<< (f / 75 % 60 < 10 ? "0" : "") << f / 75 % 60 << ":"
+			<< (f % 75 < 10 ? "0" : "") << f % 75 << "\n";
+	}
+}
+
+/**
+ * \brief Checksums of samples, calculated by libarcstk directly.
+ *
+ * \param[in] samples Samples of the album
+ * \param[in] toc     Complete ToC of the album
+ *
+ * \return ARCSv1 and ARCSv2 of each track
+ */
+arcstk::Checksums reference_checksums(const std::vector<uint32_t>& samples,
+		const arcstk::ToC& toc)
+{
+	auto calculation { arcstk::make_calculation(
+			std::make_unique<arcstk::AccurateRip::V1andV2>(), toc) };
+
+	calculation->update(samples.begin(), samples.end());
+
+	return calculation->result();
+}
+
+/**
+ * \brief Check that Checksums have the same values for each track.
+ *
+ * \param[in] checksums Checksums to check
+ * \param[in] expected  Expected Checksums
+ */
+void check_checksums(const arcstk::Checksums& checksums,
+		const arcstk::Checksums& expected)
+{
+	using arcstk::checksum::type;
+
+	REQUIRE ( checksums.size() == expected.size() );
+
+	for (auto t = std::size_t { 0 }; t < expected.size(); ++t)
+	{
+		CHECK ( checksums[t].get(type::ARCS1) == expected[t].get(type::ARCS1) );
+		CHECK ( checksums[t].get(type::ARCS2) == expected[t].get(type::ARCS2) );
+	}
+}
+
+/**
+ * \brief Checksums of audio files, each calculated by a call of its own.
+ *
+ * \param[in] c     Calculator to use
+ * \param[in] files Names of the audio files
+ *
+ * \return Checksums of the files, the first and last file as album bounds
+ */
+arcstk::Checksums sequential_checksums(arcsdec::ARCSCalculator& c,
+		const std::vector<std::string>& files)
+{
+	auto checksums = arcstk::Checksums {};
+
+	for (auto i = std::size_t { 0 }; i < files.size(); ++i)
+	{
+		checksums.push_back(c.calculate(files[i], i == 0,
+					i + 1 == files.size()));
+	}
+
+	return checksums;
+}
+
+/**
+ * \brief Write audio files of 100, 200 and 300 frames of distinct samples.
+ *
+ * \return Names of the audio files
+ */
+std::vector<std::string> write_wav_files()
+{
+	const auto samples { make_samples(600 * 588) };
+
+	const auto files = std::vector<std::string> {
+		"test-file1.wav", "test-file2.wav", "test-file3.wav" };
+
+	write_wav(files[0], samples.begin(), samples.begin() + 100 * 588);
+	write_wav(files[1], samples.begin() + 100 * 588,
+			samples.begin() + 300 * 588);
+	write_wav(files[2], samples.begin() + 300 * 588, samples.end());
+
+	return files;
+}
+
+} // namespace
+
+
 TEST_CASE ( "ReaderAndFormatHolder", "[readerandformatholder]")
 {
 	using arcsdec::FileReaderRegistry;
@@ -91,6 +284,23 @@ TEST_CASE ( "SelectionPerformer", "[selectionperformer]")
 
 		CHECK ( reader != nullptr );
 	}
+
+	SECTION ( "Moved-from instance remains usable" )
+	{
+		auto source = SelectionPerformer<AudioReader>{};
+		auto target { std::move(source) };
+
+		CHECK ( target.file_reader("test01.wav", &h) != nullptr );
+		CHECK ( source.file_reader("test01.wav", &h) != nullptr );
+
+		auto assigned = SelectionPerformer<AudioReader>{};
+		assigned = std::move(target);
+
+		target.clear_selection_cache();
+		target.set_selection(assigned.selection());
+
+		CHECK ( target.file_reader("test01.wav", &h) != nullptr );
+	}
 }
 
 
@@ -105,8 +315,9 @@ TEST_CASE ( "AudioInfo", "[calculators]")
 	{
 		CHECK ( i.readers() == FileReaderRegistry::readers() );
 		CHECK ( not i.readers()->empty() );
-		CHECK ( 5 <= i.readers()->size() ); // cue, wavpcm, ffmpeg, flac, wvpk
-		CHECK ( 8 >= i.readers()->size() ); // + toc, libcue, sndfile
+		CHECK ( 7 <= i.readers()->size() ); // cue, wavpcm, ffmpeg, flac,
+		                                     // flaccue, wvpk, wavpackcue
+		CHECK ( 10 >= i.readers()->size() ); // + toc, libcue, sndfile
 	}
 
 	SECTION( "Get size of wav file correctly" )
@@ -129,8 +340,9 @@ TEST_CASE ( "ToCParser", "[calculators]" )
 	{
 		CHECK ( p.readers() == FileReaderRegistry::readers() );
 		CHECK ( not p.readers()->empty() );
-		CHECK ( 5 <= p.readers()->size() ); // cue, wavpcm, ffmpeg, flac, wvpk
-		CHECK ( 8 >= p.readers()->size() ); // + toc, libcue, sndfile
+		CHECK ( 7 <= p.readers()->size() ); // cue, wavpcm, ffmpeg, flac,
+		                                     // flaccue, wvpk, wavpackcue
+		CHECK ( 10 >= p.readers()->size() ); // + toc, libcue, sndfile
 	}
 
 	SECTION( "Parse CueSheet file correctly" )
@@ -141,6 +353,37 @@ TEST_CASE ( "ToCParser", "[calculators]" )
 		CHECK ( toc->offsets().at(0).frames() ==   150 );
 		CHECK ( toc->offsets().at(1).frames() == 25072 );
 	}
+
+	SECTION( "Parse CueSheet data in memory correctly" )
+	{
+		std::ifstream in { "cuesheet/ok01.cue" };
+		std::ostringstream content;
+		content << in.rdbuf();
+		const auto data { content.str() };
+
+		const auto toc { p.parse(data.data(), data.size(),
+				arcsdec::Format::CUE) };
+
+		CHECK ( toc->total_tracks() == 2 );
+		CHECK ( toc->offsets().at(0).frames() ==   150 );
+		CHECK ( toc->offsets().at(1).frames() == 25072 );
+	}
+
+	SECTION( "Parse many CueSheet files in parallel in input order" )
+	{
+		const auto tocs { p.parse_all({ "cuesheet/ok03.cue",
+				"cuesheet/ok01.cue", "cuesheet/missing.cue",
+				"cuesheet/ok03.cue", "cuesheet/ok01.cue" }, 2) };
+
+		REQUIRE ( tocs.size() == 5 );
+
+		CHECK ( tocs[0]->total_tracks() == 15 );
+		CHECK ( tocs[1]->total_tracks() ==  2 );
+		CHECK ( tocs[2] == nullptr );
+		CHECK ( tocs[3]->total_tracks() == 15 );
+		CHECK ( tocs[4]->total_tracks() ==  2 );
+		CHECK ( tocs[4]->offsets().at(1).frames() == 25072 );
+	}
 }
 
 
@@ -152,7 +395,7 @@ TEST_CASE ( "ARCSCalculator", "[calculators]" )
 
 	SECTION ("Initial DescriptorSet is present and complete")
 	{
-		CHECK ( 8 >= c.readers()->size() );
+		CHECK ( 10 >= c.readers()->size() );
 		CHECK ( not c.readers()->empty() );
 	}
 
@@ -163,6 +406,262 @@ TEST_CASE ( "ARCSCalculator", "[calculators]" )
 		CHECK ( checksums.empty() );
 	}
 
+	SECTION( "Read several wav files in input order" )
+	{
+		const auto files { write_wav_files() };
+
+		const auto checksums = c.calculate(files, true, true);
+		const auto expected { sequential_checksums(c, files) };
+
+		for (const auto& file : files)
+		{
+			std::remove(file.c_str());
+		}
+
+		check_checksums(checksums, expected);
+	}
+
+	SECTION( "Report each track as soon as it is complete" )
+	{
+		auto tracks = std::vector<int>{};
+
+		c.set_track_callback(
+			[&tracks](const int track, const arcstk::ChecksumSet&)
+			{
+				tracks.push_back(track);
+			});
+
+		const auto checksums = c.calculate(
+				std::vector<std::string>{ "test01.wav", "test01.wav" },
+				true, true);
+
+		CHECK ( tracks == std::vector<int>{ 1, 2 } );
+	}
+
+	SECTION( "Report each track of a file with the final checksums" )
+	{
+		const auto samples { make_samples(900 * 588) };
+		write_wav("test-tracks.wav", samples.begin(), samples.end());
+
+		const auto toc { arcstk::make_toc(900, { 0, 300, 600 },
+				std::vector<std::string>(3, "test-tracks.wav")) };
+
+		auto tracks   = std::vector<int>{};
+		auto reported = arcstk::Checksums {};
+
+		c.set_track_callback(
+			[&tracks, &reported](const int track,
+				const arcstk::ChecksumSet& checksums)
+			{
+				tracks.push_back(track);
+				reported.push_back(checksums);
+			});
+
+		const auto result { c.calculate("test-tracks.wav", *toc) };
+
+		std::remove("test-tracks.wav");
+
+		CHECK ( tracks == std::vector<int>{ 1, 2, 3 } );
+		check_checksums(reported, result.first);
+		check_checksums(reported, reference_checksums(samples, *toc));
+	}
+
+	SECTION( "Report the progress against the size of the input" )
+	{
+		auto samples = int64_t { 0 };
+		auto total   = int64_t { 0 };
+
+		c.set_progress_callback(
+			[&samples, &total](const int64_t processed,
+				const arcsdec::AudioSize& size)
+			{
+				samples = processed;
+				total   = size.samples();
+			});
+
+		c.calculate("test01.wav", true, true);
+
+		CHECK ( samples == 1025 );
+		CHECK ( total   == 1025 );
+	}
+
+	SECTION( "Calculate several wav files in the background" )
+	{
+		const auto files { write_wav_files() };
+
+		auto result { c.calculate_async(files, true, true) };
+
+		const auto checksums { result.get() };
+		const auto expected { sequential_checksums(c, files) };
+
+		for (const auto& file : files)
+		{
+			std::remove(file.c_str());
+		}
+
+		check_checksums(checksums, expected);
+	}
+
+	SECTION( "Cancelled calculation throws" )
+	{
+		auto cancellation = arcsdec::Cancellation {};
+		cancellation.cancel();
+
+		auto result { c.calculate_async(
+				std::vector<std::string>{ "test01.wav" }, true, true,
+				cancellation) };
+
+		CHECK_THROWS_AS ( result.get(), arcsdec::CalculationCancelled );
+	}
+
+	SECTION( "Calculation is cancelled mid-stream from the callback" )
+	{
+		// Two blocks of the minimal size
+
+		const auto samples { make_samples(2 * arcsdec::BLOCKSIZE::MIN) };
+		write_wav("test-cancel.wav", samples.begin(), samples.end());
+
+		auto cancellation = arcsdec::Cancellation {};
+		auto reports      = 0;
+
+		c.set_read_buffer_size(arcsdec::BLOCKSIZE::MIN);
+		c.set_progress_callback(
+			[&cancellation, &reports](const int64_t, const arcsdec::AudioSize&)
+			{
+				++reports;
+				cancellation.cancel();
+			});
+
+		auto result { c.calculate_async(
+				std::vector<std::string>{ "test-cancel.wav" }, true, true,
+				cancellation) };
+
+		CHECK_THROWS_AS ( result.get(), arcsdec::CalculationCancelled );
+
+		std::remove("test-cancel.wav");
+
+		// Only the first block was processed
+
+		CHECK ( reports == 1 );
+	}
+
+	SECTION( "Statistics contain an entry for each file read" )
+	{
+		c.set_statistics_enabled(true);
+		c.calculate(std::vector<std::string>{ "test01.wav", "test01.wav" },
+				true, true);
+
+		REQUIRE ( c.statistics().size() == 2 );
+		CHECK ( c.statistics()[0].reader_id == "wavpcm" );
+		CHECK ( c.statistics()[0].samples   == 1025 );
+		CHECK ( c.statistics()[1].samples   == 1025 );
+		CHECK ( c.statistics()[0].processing_seconds > 0.0 );
+	}
+
+	SECTION( "Disabled statistics only count the samples" )
+	{
+		c.calculate(std::vector<std::string>{ "test01.wav" }, true, true);
+
+		REQUIRE ( c.statistics().size() == 1 );
+		CHECK ( c.statistics()[0].reader_id.empty() );
+		CHECK ( c.statistics()[0].samples == 1025 );
+		CHECK ( c.statistics()[0].processing_seconds == 0.0 );
+	}
+
+	SECTION( "Statistics of a calculation in the background are reported" )
+	{
+		auto reported = std::vector<arcsdec::ReaderStatistics> {};
+
+		c.set_statistics_enabled(true);
+		c.set_statistics_callback(
+			[&reported](const arcsdec::ReaderStatistics& statistics)
+			{
+				reported.push_back(statistics);
+			});
+
+		c.calculate_async(std::vector<std::string>{ "test01.wav",
+				"test01.wav" }, true, true).get();
+
+		REQUIRE ( reported.size() == 2 );
+		CHECK ( reported[0].reader_id == "wavpcm" );
+		CHECK ( reported[1].samples   == 1025 );
+		CHECK ( c.statistics().empty() );
+	}
+
+	SECTION( "Reject selected tracks that are not in the ToC" )
+	{
+		const auto toc { arcsdec::ToCParser{}.parse("cuesheet/ok01.cue") };
+
+		CHECK_THROWS_AS ( c.calculate("test01.wav", *toc, { 3 }),
+				std::invalid_argument );
+		CHECK_THROWS_AS ( c.calculate("test01.wav", *toc, { 0 }),
+				std::invalid_argument );
+	}
+
+	SECTION( "Selected tracks are calculated like the album" )
+	{
+		const auto samples { make_samples(1200 * 588) };
+		write_wav("test-selected.wav", samples.begin(), samples.end());
+
+		const auto toc { arcstk::make_toc(1200, { 0, 300, 600, 900 },
+				std::vector<std::string>(4, "test-selected.wav")) };
+		const auto album { reference_checksums(samples, *toc) };
+
+		auto tracks = std::vector<int>{};
+
+		c.set_track_callback(
+			[&tracks](const int track, const arcstk::ChecksumSet&)
+			{
+				tracks.push_back(track);
+			});
+
+		const auto checksums { c.calculate("test-selected.wav", *toc,
+				{ 4, 1, 2 }) };
+
+		std::remove("test-selected.wav");
+
+		// Tracks 1 and 2 are read in a single pass, track 4 in another
+
+		CHECK ( c.statistics().size() == 2 );
+		CHECK ( tracks == std::vector<int>{ 1, 2, 4 } );
+
+		check_checksums(checksums, { album[3], album[0], album[1] });
+	}
+
+	SECTION( "Split audio files are calculated like the single file" )
+	{
+		const auto samples { make_samples(900 * 588) };
+
+		// Split inside track 1 off the sector bounds and inside track 2
+
+		const auto split1 { samples.begin() + 200 * 588 + 17 };
+		const auto split2 { samples.begin() + 450 * 588 };
+
+		write_wav("test-whole.wav", samples.begin(), samples.end());
+		write_wav("test-split1.wav", samples.begin(), split1);
+		write_wav("test-split2.wav", split1, split2);
+		write_wav("test-split3.wav", split2, samples.end());
+
+		const auto toc { arcstk::make_toc(900, { 0, 300, 600 },
+				std::vector<std::string>(3, "test-whole.wav")) };
+
+		const auto whole { c.calculate("test-whole.wav", *toc) };
+		const auto split { c.calculate(std::vector<std::string>{
+				"test-split1.wav", "test-split2.wav", "test-split3.wav" },
+				*toc) };
+
+		CHECK_THROWS_AS ( c.calculate(std::vector<std::string>{}, *toc),
+				std::invalid_argument );
+
+		std::remove("test-whole.wav");
+		std::remove("test-split1.wav");
+		std::remove("test-split2.wav");
+		std::remove("test-split3.wav");
+
+		check_checksums(whole.first, reference_checksums(samples, *toc));
+		check_checksums(split.first, whole.first);
+	}
+
 	// TODO Check whether flac is compiled in before testing
 	//
 	//SECTION( "Read flac file correctly" )
@@ -174,6 +673,287 @@ TEST_CASE ( "ARCSCalculator", "[calculators]" )
 }
 
 
+TEST_CASE ( "SectorIndex", "[calculators]" )
+{
+	using arcsdec::SectorIndex;
+	using arcsdec::AudioSize;
+	using arcstk::checksum::type;
+
+	// 40 sectors of pseudo-random samples
+
+	const auto samples { make_samples(40 * 588) };
+
+	auto index = SectorIndex {};
+
+	// Append in blocks that do not align with the sectors
+
+	for (auto i = std::size_t { 0 }; i < samples.size(); i += 1000)
+	{
+		const auto end { std::min(i + 1000, samples.size()) };
+		index.append(samples.begin() + i, samples.begin() + end);
+	}
+
+	REQUIRE ( index.total_samples() == 40 * 588 );
+
+	const auto toc_for = [](const std::vector<int32_t>& frames)
+	{
+		auto toc { arcstk::make_toc(frames,
+				std::vector<std::string>(frames.size(), "file.wav")) };
+		toc->set_leadout(AudioSize { 40, arcstk::UNIT::FRAMES });
+		return toc;
+	};
+
+	const auto check_toc = [&](const std::vector<int32_t>& frames)
+	{
+		const auto toc { toc_for(frames) };
+
+		REQUIRE ( index.covers(*toc) );
+
+		auto offsets = std::vector<int64_t> {};
+		for (const auto& f : frames)
+		{
+			offsets.push_back(f * 588);
+		}
+
+		const auto expected { brute_force_arcs1(samples, offsets) };
+		const auto checksums { index.arcs1(*toc) };
+
+		REQUIRE ( checksums.size() == expected.size() );
+
+		for (auto i = std::size_t { 0 }; i < expected.size(); ++i)
+		{
+			CHECK ( checksums[i].get(type::ARCS1).value() == expected[i] );
+		}
+
+		// Cross-check with the calculation of libarcstk
+
+		const auto reference { reference_checksums(samples, *toc) };
+
+		REQUIRE ( reference.size() == checksums.size() );
+
+		for (auto i = std::size_t { 0 }; i < reference.size(); ++i)
+		{
+			CHECK ( checksums[i].get(type::ARCS1)
+					== reference[i].get(type::ARCS1) );
+		}
+	};
+
+
+	SECTION ( "ARCSv1 for a single track equals direct summation" )
+	{
+		check_toc({ 0 });
+	}
+
+	SECTION ( "ARCSv1 for several tracks equals direct summation" )
+	{
+		check_toc({ 0, 7, 19, 23 });
+		check_toc({ 3, 12, 30 });
+	}
+
+	SECTION ( "Lengths of the tracks are set in frames" )
+	{
+		const auto checksums { index.arcs1(*toc_for({ 0, 7, 19 })) };
+
+		REQUIRE ( checksums.size() == 3 );
+		CHECK ( checksums[0].length() ==  7 );
+		CHECK ( checksums[1].length() == 12 );
+		CHECK ( checksums[2].length() == 21 );
+	}
+
+	SECTION ( "Index restored from its binary format computes the same" )
+	{
+		auto buffer = std::stringstream {};
+		index.write(buffer);
+
+		CHECK ( buffer.str().size() == 4 + 4 + 8 + 4 + 4 + 40 * 12 );
+
+		const auto restored = SectorIndex { buffer };
+		const auto toc { toc_for({ 0, 7, 19, 23 }) };
+
+		REQUIRE ( restored.total_samples() == index.total_samples() );
+
+		const auto checksums { restored.arcs1(*toc) };
+		const auto expected  { index.arcs1(*toc) };
+
+		REQUIRE ( checksums.size() == expected.size() );
+
+		for (auto i = std::size_t { 0 }; i < expected.size(); ++i)
+		{
+			CHECK ( checksums[i].get(type::ARCS1).value()
+					== expected[i].get(type::ARCS1).value() );
+		}
+	}
+
+	SECTION ( "Truncated or foreign input is rejected" )
+	{
+		auto buffer = std::stringstream {};
+		index.write(buffer);
+
+		auto truncated = std::stringstream {
+			buffer.str().substr(0, buffer.str().size() - 1) };
+		auto foreign   = std::stringstream { "RIFF" + buffer.str() };
+
+		CHECK_THROWS_AS ( SectorIndex { truncated }, std::runtime_error );
+		CHECK_THROWS_AS ( SectorIndex { foreign },   std::runtime_error );
+	}
+
+	SECTION ( "ToC with a leadout beyond the index is not covered" )
+	{
+		auto toc { toc_for({ 0, 7 }) };
+		toc->set_leadout(AudioSize { 41, arcstk::UNIT::FRAMES });
+
+		CHECK ( not index.covers(*toc) );
+		CHECK_THROWS_AS ( index.arcs1(*toc), std::invalid_argument );
+	}
+
+	SECTION ( "Calculator does not read the audio file if index covers ToC" )
+	{
+		auto c = arcsdec::ARCSCalculator { { type::ARCS1 } };
+
+		const auto toc { toc_for({ 0, 7, 19, 23 }) };
+		const auto [ checksums, updated_toc ] {
+			c.calculate("does-not-exist.wav", *toc, index) };
+
+		CHECK ( c.statistics().empty() );
+
+		const auto reference { reference_checksums(samples, *toc) };
+
+		REQUIRE ( checksums.size() == reference.size() );
+
+		for (auto i = std::size_t { 0 }; i < reference.size(); ++i)
+		{
+			CHECK ( checksums[i].get(type::ARCS1)
+					== reference[i].get(type::ARCS1) );
+		}
+	}
+}
+
+
+TEST_CASE ( "ChecksumCache", "[calculators]" )
+{
+	using arcsdec::ARCSCalculator;
+	using arcsdec::ChecksumCache;
+
+	auto cache = ChecksumCache {};
+
+	auto c = ARCSCalculator {};
+	c.set_checksum_cache(&cache);
+
+	const auto first { c.calculate("test01.wav", true, true) };
+
+	REQUIRE ( cache.size() == 1 );
+	REQUIRE ( c.statistics().size() == 1 );
+
+	SECTION ( "Same file is not read again" )
+	{
+		const auto second { c.calculate("test01.wav", true, true) };
+
+		CHECK ( cache.hits() == 1 );
+		CHECK ( c.statistics().empty() );
+
+		// The checksums served equal the checksums calculated without cache
+
+		const auto fresh { ARCSCalculator{}.calculate("test01.wav", true,
+				true) };
+
+		CHECK ( first  == fresh );
+		CHECK ( second == fresh );
+	}
+
+	SECTION ( "Modified file is read again" )
+	{
+		namespace fs = std::filesystem;
+
+		const auto file { std::string { "test-modified.wav" } };
+		const auto samples { make_samples(300 * 588) };
+
+		write_wav(file, samples.begin(), samples.begin() + 100 * 588);
+
+		const auto original { c.calculate(file, true, true) };
+		const auto written  { fs::last_write_time(file) };
+
+		// Other content with the same size and a later modification time
+
+		write_wav(file, samples.begin() + 100 * 588,
+				samples.begin() + 200 * 588);
+		fs::last_write_time(file, written + std::chrono::seconds { 1 });
+
+		const auto modified { c.calculate(file, true, true) };
+
+		CHECK ( cache.hits() == 0 );
+		CHECK ( c.statistics().size() == 1 );
+		CHECK ( modified == ARCSCalculator{}.calculate(file, true, true) );
+		CHECK ( not (modified == original) );
+
+		// Other size
+
+		write_wav(file, samples.begin() + 200 * 588, samples.end() - 588);
+
+		const auto truncated { c.calculate(file, true, true) };
+
+		CHECK ( cache.hits() == 0 );
+		CHECK ( truncated == ARCSCalculator{}.calculate(file, true, true) );
+		CHECK ( not (truncated == modified) );
+
+		std::remove(file.c_str());
+	}
+
+	SECTION ( "Hard link to the same file is not read again" )
+	{
+		std::remove("test01-link.wav");
+		REQUIRE ( ::link("test01.wav", "test01-link.wav") == 0 );
+
+		c.calculate("test01-link.wav", true, true);
+
+		CHECK ( cache.hits() == 1 );
+		CHECK ( c.statistics().empty() );
+
+		std::remove("test01-link.wav");
+	}
+
+	SECTION ( "Same file in a different context is read again" )
+	{
+		c.calculate("test01.wav", false, true);
+
+		CHECK ( cache.hits() == 0 );
+		CHECK ( cache.size() == 2 );
+		CHECK ( c.statistics().size() == 1 );
+	}
+
+	SECTION ( "Files found are not read in a calculation of several files" )
+	{
+		const auto files { std::vector<std::string>{ "test01.wav",
+			"test01.wav" } };
+
+		// Files are in contexts FIRST_TRACK and LAST_TRACK, not yet known
+
+		c.calculate(files, true, true);
+
+		CHECK ( cache.hits() == 0 );
+		CHECK ( cache.size() == 3 );
+
+		const auto checksums { c.calculate(files, true, true) };
+
+		CHECK ( checksums.size() == 2 );
+		CHECK ( cache.hits() == 2 );
+		CHECK ( c.statistics().empty() );
+
+		check_checksums(checksums, ARCSCalculator{}.calculate(files, true,
+					true));
+	}
+
+	SECTION ( "Cleared cache does not find anything" )
+	{
+		cache.clear();
+
+		c.calculate("test01.wav", true, true);
+
+		CHECK ( cache.hits() == 0 );
+		CHECK ( c.statistics().size() == 1 );
+	}
+}
+
+
 TEST_CASE ( "ARIdCalculator", "[calculators]" )
 {
 	using arcsdec::ARIdCalculator;
@@ -185,8 +965,9 @@ TEST_CASE ( "ARIdCalculator", "[calculators]" )
 	{
 		CHECK ( c.readers() == FileReaderRegistry::readers() );
 		CHECK ( not c.readers()->empty() );
-		CHECK ( 5 <= c.readers()->size() ); // cue, wavpcm, ffmpeg, flac, wvpk
-		CHECK ( 8 >= c.readers()->size() ); // + toc, libcue, sndfile
+		CHECK ( 7 <= c.readers()->size() ); // cue, wavpcm, ffmpeg, flac,
+		                                     // flaccue, wvpk, wavpackcue
+		CHECK ( 10 >= c.readers()->size() ); // + toc, libcue, sndfile
 	}
 
 	// TODO Provide test files with realistic results
@@ -199,3 +980,59 @@ TEST_CASE ( "ARIdCalculator", "[calculators]" )
 	//}
 }
 
+
+
+TEST_CASE ( "AlbumCalculator", "[calculators]" )
+{
+	using arcsdec::AlbumCalculator;
+	using arcsdec::FileReaderRegistry;
+
+	auto c = AlbumCalculator{};
+
+	SECTION ("Parser and calculator use the default readers")
+	{
+		CHECK ( c.toc_parser()->readers() == FileReaderRegistry::readers() );
+		CHECK ( c.arcs_calculator()->readers() ==
+				FileReaderRegistry::readers() );
+	}
+
+	SECTION ("Calculator uses ARCS1 and ARCS2 by default")
+	{
+		CHECK ( c.arcs_calculator()->types().size() == 2 );
+	}
+
+	SECTION ("Missing metadata file is not processed")
+	{
+		CHECK_THROWS ( c.calculate("cuesheet/missing.cue", "test01.wav") );
+	}
+
+	SECTION ("Album is calculated from cue sheet and audio file")
+	{
+		const auto frames  { std::vector<int32_t>{ 0, 300, 600 } };
+		const auto samples { make_samples(900 * 588) };
+
+		write_wav("test-album.wav", samples.begin(), samples.end());
+		write_cue("test-album.cue", "test-album.wav", frames);
+
+		const auto [ id, toc, checksums ] {
+			c.calculate("test-album.cue", "test-album.wav") };
+
+		std::remove("test-album.wav");
+		std::remove("test-album.cue");
+
+		REQUIRE ( toc.total_tracks() == 3 );
+		CHECK ( toc.offsets().at(0).frames() ==   0 );
+		CHECK ( toc.offsets().at(1).frames() == 300 );
+		CHECK ( toc.offsets().at(2).frames() == 600 );
+		CHECK ( toc.leadout().frames()       == 900 );
+
+		const auto expected_toc { arcstk::make_toc(900, frames,
+				std::vector<std::string>(3, "test-album.wav")) };
+
+		REQUIRE ( id );
+		CHECK ( *id == *arcstk::make_arid(*expected_toc) );
+
+		check_checksums(checksums,
+				reference_checksums(samples, *expected_toc));
+	}
+}
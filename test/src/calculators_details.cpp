@@ -7,15 +7,135 @@
  */
 
 #ifndef __LIBARCSDEC_CALCULATORS_HPP__
-#define __LIBARCSDEC_CALCULATORS_HPP__
+#include "calculators.hpp"              // for Cancellation
 #endif
 #ifndef __LIBARCSDEC_CALCULATORS_DETAILS_HPP__
 #include "calculators_details.hpp"      // TO BE TESTED
 #endif
 
+#ifndef __LIBARCSDEC_READERMOCKS_HPP__
+#include "readermocks.hpp"              // for Mock_SampleCounter
+#endif
+
+#include <cstdint>   // for int64_t
+#include <cstdio>    // for remove
+#include <fstream>   // for ifstream, ofstream
+#include <iterator>  // for istreambuf_iterator
+#include <string>    // for string
+#include <vector>    // for vector
+
 
 TEST_CASE ( "merge_results()", "[merge_results]")
 {
 	// TODO
 }
 
+
+
+TEST_CASE ( "ProgressProcessor", "[calculators_details]")
+{
+	using arcsdec::details::ProgressProcessor;
+
+	auto target       = Mock_SampleCounter {};
+	auto cancellation = arcsdec::Cancellation {};
+	auto reported     = std::vector<int64_t> {};
+
+	auto progress = ProgressProcessor { target, cancellation,
+		[&reported](const int64_t samples, const arcstk::AudioSize& total)
+		{
+			reported.push_back(samples);
+			CHECK ( total.samples() == 200 );
+		},
+		arcstk::AudioSize { /* zero */ } };
+
+	const auto samples { std::vector<arcstk::sample_t>(100) };
+
+	progress.start_input();
+	progress.update_audiosize(arcstk::AudioSize { 200,
+			arcstk::UNIT::SAMPLES });
+
+	SECTION ("Progress is reported after each sequence")
+	{
+		progress.append_samples(samples.begin(), samples.end());
+		progress.append_samples(samples.begin(), samples.end());
+		progress.end_input();
+
+		CHECK ( reported == std::vector<int64_t>{ 100, 200 } );
+		CHECK ( target.samples == 200 );
+	}
+
+	SECTION ("Cancelled input is not passed")
+	{
+		progress.append_samples(samples.begin(), samples.end());
+		cancellation.cancel();
+
+		CHECK_THROWS_AS (
+				progress.append_samples(samples.begin(), samples.end()),
+				arcsdec::CalculationCancelled );
+		CHECK ( target.samples == 100 );
+		CHECK ( progress.samples_processed() == 100 );
+	}
+}
+
+
+TEST_CASE ( "file_identity()", "[calculators_details]")
+{
+	using arcsdec::details::file_identity;
+
+	SECTION ("Same file has same identity")
+	{
+		CHECK ( not file_identity("test01.wav").empty() );
+		CHECK ( file_identity("test01.wav") == file_identity("./test01.wav") );
+	}
+
+	SECTION ("Different files have different identities")
+	{
+		CHECK ( file_identity("test01.wav") != file_identity("test01.flac") );
+	}
+
+	SECTION ("Missing file has no identity")
+	{
+		CHECK ( file_identity("does-not-exist.wav").empty() );
+	}
+}
+
+
+TEST_CASE ( "flac_content_identity()", "[calculators_details]")
+{
+	using arcsdec::details::flac_content_identity;
+
+	SECTION ("FLAC file has an identity from its STREAMINFO")
+	{
+		const auto identity { flac_content_identity("test01.flac") };
+
+		// Format, 1025 samples, MD5
+
+		CHECK ( identity == "flac:0ac442f000000401"
+				"5704d860cd373294dd5b5c1f3d9fba2f" );
+	}
+
+	SECTION ("Copy with different content after STREAMINFO has same identity")
+	{
+		auto in = std::ifstream { "test01.flac", std::ios::binary };
+		auto data = std::string { std::istreambuf_iterator<char>(in),
+			std::istreambuf_iterator<char>() };
+
+		data.back() ^= 0x01;
+
+		{
+			auto out = std::ofstream { "test01-copy.flac", std::ios::binary };
+			out << data;
+		}
+
+		CHECK ( flac_content_identity("test01-copy.flac")
+				== flac_content_identity("test01.flac") );
+
+		std::remove("test01-copy.flac");
+	}
+
+	SECTION ("Non-FLAC file has no identity")
+	{
+		CHECK ( flac_content_identity("test01.wav").empty() );
+		CHECK ( flac_content_identity("does-not-exist.flac").empty() );
+	}
+}
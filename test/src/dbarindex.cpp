@@ -0,0 +1,277 @@
+#include "catch2/catch_test_macros.hpp"
+
+/**
+ * \file
+ *
+ * \brief Fixtures for dbarindex.hpp.
+ */
+
+#ifndef __LIBARCSDEC_DBARINDEX_HPP__
+#include "dbarindex.hpp"                // TO BE TESTED
+#endif
+
+#include <cstdint>   // for uint32_t
+#include <cstdio>    // for remove
+#include <fstream>   // for ofstream
+#include <stdexcept> // for invalid_argument, runtime_error
+#include <string>    // for string
+#include <vector>    // for vector
+
+
+namespace
+{
+
+/**
+ * \brief Append a 32 bit value in little endian order.
+ */
+void put_le32(std::string& bytes, const uint32_t value)
+{
+	for (auto i { 0 }; i < 4; ++i)
+	{
+		bytes += static_cast<char>((value >> (8 * i)) & 0xFF);
+	}
+}
+
+/**
+ * \brief Append a dBAR block.
+ *
+ * \param[in,out] bytes       Bytes to append the block to
+ * \param[in]     id          ARId of the block
+ * \param[in]     checksums   Reference checksum of each track
+ * \param[in]     confidence  Confidence of each track
+ */
+void put_block(std::string& bytes, const arcsdec::ARId& id,
+		const std::vector<uint32_t>& checksums, const uint32_t confidence)
+{
+	bytes += static_cast<char>(id.track_count());
+	put_le32(bytes, id.disc_id_1());
+	put_le32(bytes, id.disc_id_2());
+	put_le32(bytes, id.cddb_id());
+
+	for (const auto& checksum : checksums)
+	{
+		bytes += static_cast<char>(confidence);
+		put_le32(bytes, checksum);
+		put_le32(bytes, 0);
+	}
+}
+
+/**
+ * \brief Write bytes to a file.
+ */
+void write_file(const std::string& filename, const std::string& bytes)
+{
+	auto out = std::ofstream { filename, std::ios::binary };
+	out << bytes;
+}
+
+/**
+ * \brief Create Checksums with an ARCSv1 and ARCSv2 for each track.
+ */
+arcsdec::Checksums make_checksums(const std::vector<uint32_t>& v1,
+		const std::vector<uint32_t>& v2)
+{
+	using arcstk::checksum::type;
+
+	auto checksums = arcsdec::Checksums {};
+
+	for (auto t = std::size_t { 0 }; t < v1.size(); ++t)
+	{
+		auto track = arcstk::ChecksumSet { 0 };
+		track.insert(type::ARCS1, arcstk::Checksum { v1[t] });
+		track.insert(type::ARCS2, arcstk::Checksum { v2[t] });
+		checksums.push_back(track);
+	}
+
+	return checksums;
+}
+
+} // namespace
+
+
+TEST_CASE ( "DBARIndex", "[dbarindex]" )
+{
+	using arcsdec::ARId;
+	using arcsdec::DBARIndex;
+
+	const auto album   = ARId { 3, 0x0001b9f3, 0x00041b8e, 0x1f02e004 };
+	const auto single  = ARId { 1, 0x00000123, 0x00000456, 0x02000a01 };
+	const auto missing = ARId { 2, 0x00000001, 0x00000002, 0x00000003 };
+
+	// Two dBAR files, the album has a pressing in each
+
+	auto first = std::string {};
+	put_block(first, album, { 0x11, 0x12, 0x13 }, 5);
+	put_block(first, single, { 0x99 }, 2);
+	write_file("test-first.dbar", first);
+
+	auto second = std::string {};
+	put_block(second, album, { 0x21, 0x22, 0x23 }, 7);
+	write_file("test-second.dbar", second);
+
+	DBARIndex::build({ "test-first.dbar", "test-second.dbar" },
+			"test-index.ardx");
+
+	SECTION ( "Index contains each disc once" )
+	{
+		const auto index = DBARIndex { "test-index.ardx" };
+
+		CHECK ( index.size() == 2 );
+	}
+
+	SECTION ( "Pressings of a disc are merged in columns" )
+	{
+		const auto index = DBARIndex { "test-index.ardx" };
+
+		const auto response { index.find(album) };
+
+		REQUIRE ( response.tracks()    == 3 );
+		REQUIRE ( response.pressings() == 2 );
+
+		CHECK ( response.checksums(0)[0]   == 0x11 );
+		CHECK ( response.checksums(0)[1]   == 0x21 );
+		CHECK ( response.checksums(2)[1]   == 0x23 );
+		CHECK ( response.confidences(1)[0] == 5 );
+		CHECK ( response.confidences(1)[1] == 7 );
+	}
+
+	SECTION ( "Same dBAR file passed twice adds no pressings" )
+	{
+		DBARIndex::build({ "test-first.dbar", "test-second.dbar",
+				"test-first.dbar" }, "test-twice.ardx");
+
+		const auto index = DBARIndex { "test-twice.ardx" };
+
+		CHECK ( index.size() == 2 );
+		CHECK ( index.find(album).pressings()  == 2 );
+		CHECK ( index.find(single).pressings() == 1 );
+
+		std::remove("test-twice.ardx");
+	}
+
+	SECTION ( "Missing disc has an empty response" )
+	{
+		const auto index = DBARIndex { "test-index.ardx" };
+
+		CHECK ( index.find(missing).empty() );
+	}
+
+	SECTION ( "Invalid files are rejected" )
+	{
+		write_file("test-invalid.dbar", std::string(20, '\x05'));
+
+		CHECK_THROWS_AS ( DBARIndex::build({ "test-invalid.dbar" },
+					"test-invalid.ardx"), std::runtime_error );
+		CHECK_THROWS_AS ( DBARIndex { "test-first.dbar" },
+				std::runtime_error );
+		CHECK_THROWS_AS ( DBARIndex { "does-not-exist.ardx" },
+				std::runtime_error );
+
+		std::remove("test-invalid.dbar");
+		std::remove("test-invalid.ardx");
+	}
+
+	std::remove("test-first.dbar");
+	std::remove("test-second.dbar");
+	std::remove("test-index.ardx");
+}
+
+
+TEST_CASE ( "ARMatcher", "[dbarindex]" )
+{
+	using arcsdec::ARId;
+	using arcsdec::ARMatcher;
+	using arcsdec::DBARIndex;
+	using arcstk::checksum::type;
+
+	const auto album   = ARId { 3, 0x0001b9f3, 0x00041b8e, 0x1f02e004 };
+	const auto missing = ARId { 2, 0x00000001, 0x00000002, 0x00000003 };
+
+	// Pressing 0 has ARCSv1, pressing 1 has ARCSv2 and a higher confidence
+
+	auto bytes = std::string {};
+	put_block(bytes, album, { 0x11, 0x12, 0x13 }, 5);
+	put_block(bytes, album, { 0x21, 0x22, 0x23 }, 7);
+	write_file("test-match.dbar", bytes);
+
+	DBARIndex::build({ "test-match.dbar" }, "test-match.ardx");
+
+	const auto index = DBARIndex { "test-match.ardx" };
+	const auto matcher = ARMatcher { index };
+
+	SECTION ( "Matching ARCSv2 of the pressing with higher confidence" )
+	{
+		const auto match { matcher.match(album,
+				make_checksums({ 0x11, 0x12, 0x13 }, { 0x21, 0x22, 0x23 })) };
+
+		REQUIRE ( match.matches() );
+		CHECK ( match.candidate() == 0 );
+		CHECK ( match.tracks()[0].pressing()   == 1 );
+		CHECK ( match.tracks()[0].type()       == type::ARCS2 );
+		CHECK ( match.tracks()[0].confidence() == 7 );
+	}
+
+	SECTION ( "Matching ARCSv1 only" )
+	{
+		const auto match { matcher.match(album,
+				make_checksums({ 0x11, 0x12, 0x13 }, { 0x31, 0x32, 0x33 })) };
+
+		REQUIRE ( match.matches() );
+		CHECK ( match.tracks()[2].pressing() == 0 );
+		CHECK ( match.tracks()[2].type()     == type::ARCS1 );
+	}
+
+	SECTION ( "Partial match" )
+	{
+		const auto match { matcher.match(album,
+				make_checksums({ 0x11, 0x00, 0x13 }, { 0x31, 0x32, 0x33 })) };
+
+		CHECK ( match.found() );
+		CHECK ( not match.matches() );
+		CHECK ( match.matching_tracks() == 2 );
+		CHECK ( not match.tracks()[1].matches() );
+	}
+
+	SECTION ( "Candidate with most matching tracks is chosen" )
+	{
+		const auto candidates = std::vector<arcsdec::Checksums> {
+			make_checksums({ 0x11, 0x00, 0x00 }, { 0x00, 0x00, 0x00 }),
+			make_checksums({ 0x00, 0x00, 0x00 }, { 0x21, 0x22, 0x23 }),
+			make_checksums({ 0x11, 0x12, 0x00 }, { 0x00, 0x00, 0x00 })
+		};
+
+		const auto match { matcher.match(album, candidates) };
+
+		CHECK ( match.matches() );
+		CHECK ( match.candidate() == 1 );
+	}
+
+	SECTION ( "Disc not in the index is not found" )
+	{
+		const auto match { matcher.match(missing,
+				make_checksums({ 0x11, 0x12 }, { 0x21, 0x22 })) };
+
+		CHECK ( not match.found() );
+		CHECK ( match.candidate() == -1 );
+	}
+
+	SECTION ( "Several discs are matched at once" )
+	{
+		const auto matches { matcher.match(
+			std::vector<ARId>{ album, missing },
+			std::vector<std::vector<arcsdec::Checksums>> {
+				{ make_checksums({ 0x11, 0x12, 0x13 }, { 0, 0, 0 }) },
+				{ make_checksums({ 0x11, 0x12 }, { 0, 0 }) } }) };
+
+		REQUIRE ( matches.size() == 2 );
+		CHECK ( matches[0].matches() );
+		CHECK ( not matches[1].found() );
+
+		CHECK_THROWS_AS ( matcher.match(std::vector<ARId>{ album },
+					std::vector<std::vector<arcsdec::Checksums>> {}),
+				std::invalid_argument );
+	}
+
+	std::remove("test-match.dbar");
+	std::remove("test-match.ardx");
+}
@@ -0,0 +1,131 @@
+#include "catch2/catch_test_macros.hpp"
+
+/**
+ * \file
+ *
+ * \brief Fixtures for logsink.hpp.
+ */
+
+#ifndef __LIBARCSDEC_LOGSINK_HPP__
+#include "logsink.hpp"                  // TO BE TESTED
+#endif
+
+#include <cstdio>         // for FILE, tmpfile, fprintf, rewind, fgets
+#include <string>         // for string
+#include <thread>         // for thread
+#include <type_traits>    // for is_copy_constructible,...
+#include <vector>         // for vector
+
+
+namespace
+{
+
+/**
+ * \brief Read all lines from the beginning of \c file.
+ *
+ * \param[in] file File to read
+ *
+ * \return Lines of \c file
+ */
+std::vector<std::string> read_lines(std::FILE* file)
+{
+	auto lines = std::vector<std::string> {};
+
+	std::rewind(file);
+
+	char buf[256];
+	while (std::fgets(buf, sizeof buf, file))
+	{
+		lines.emplace_back(buf);
+	}
+
+	return lines;
+}
+
+} // namespace
+
+
+TEST_CASE ( "AsyncLogSink", "[asynclogsink]" )
+{
+	using arcsdec::AsyncLogSink;
+
+	auto target { std::tmpfile() };
+	REQUIRE ( target != nullptr );
+
+
+	SECTION ( "Copy constructor and assignment operator are deleted" )
+	{
+		CHECK ( not std::is_copy_constructible<AsyncLogSink>::value );
+		CHECK ( not std::is_copy_assignable<AsyncLogSink>::value );
+	}
+
+	SECTION ( "Messages are written to the target in order" )
+	{
+		auto sink = AsyncLogSink { target };
+
+		REQUIRE ( sink.stream() != nullptr );
+
+		for (auto i { 0 }; i < 100; ++i)
+		{
+			std::fprintf(sink.stream(), "message %d\n", i);
+		}
+
+		sink.flush();
+
+		const auto lines { read_lines(target) };
+
+		REQUIRE ( lines.size() == 100 );
+		CHECK ( lines.front() == "message 0\n" );
+		CHECK ( lines.back()  == "message 99\n" );
+		CHECK ( sink.dropped() == 0 );
+	}
+
+	SECTION ( "Messages from several threads are written completely" )
+	{
+		{
+			auto sink = AsyncLogSink { target };
+
+			auto threads = std::vector<std::thread> {};
+
+			for (auto t { 0 }; t < 4; ++t)
+			{
+				threads.emplace_back([&sink, t]()
+					{
+						for (auto i { 0 }; i < 250; ++i)
+						{
+							std::fprintf(sink.stream(),
+									"thread %d message %d\n", t, i);
+						}
+					});
+			}
+
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			CHECK ( sink.dropped() == 0 );
+		} // Destructor writes remaining messages
+
+		const auto lines { read_lines(target) };
+
+		CHECK ( lines.size() == 1000 );
+	}
+
+	SECTION ( "Messages that exceed the capacity are dropped" )
+	{
+		auto sink = AsyncLogSink { target, 16 };
+
+		if (sink.stream() != target) // custom streams are supported
+		{
+			std::fprintf(sink.stream(), "%s\n",
+					"This message is longer than the capacity");
+			sink.flush();
+
+			CHECK ( sink.dropped() == 1 );
+			CHECK ( read_lines(target).empty() );
+		}
+	}
+
+	std::fclose(target);
+}
@@ -0,0 +1,59 @@
+#include "catch2/catch_test_macros.hpp"
+
+/**
+ * \file
+ *
+ * \brief Fixtures for modules.hpp.
+ */
+
+#ifndef __LIBARCSDEC_MODULES_HPP__
+#include "modules.hpp"                  // TO BE TESTED
+#endif
+
+#ifndef __LIBARCSDEC_DESCRIPTOR_HPP__
+#include "descriptor.hpp"               // for FileReader
+#endif
+
+#include <cstdlib>   // for setenv, unsetenv
+#include <stdexcept> // for runtime_error
+
+
+TEST_CASE ( "Modules are located", "[modules]" )
+{
+	using arcsdec::details::module_filename;
+	using arcsdec::details::module_paths;
+
+
+	SECTION ("Module filename is derived from module name")
+	{
+		CHECK ( "libarcsdec-readerflac.so" == module_filename("readerflac") );
+	}
+
+
+	SECTION ("Plain filename is tried last")
+	{
+		const auto paths { module_paths("readerflac") };
+
+		REQUIRE ( not paths.empty() );
+		CHECK ( "libarcsdec-readerflac.so" == paths.back() );
+	}
+
+
+	SECTION ("Directory from environment is tried first")
+	{
+		::setenv("LIBARCSDEC_MODULE_PATH", "/foo/bar", 1);
+		const auto paths { module_paths("readerflac") };
+		::unsetenv("LIBARCSDEC_MODULE_PATH");
+
+		REQUIRE ( 2 <= paths.size() );
+		CHECK ( "/foo/bar/libarcsdec-readerflac.so" == paths.front() );
+	}
+}
+
+
+TEST_CASE ( "Missing module is reported", "[modules]" )
+{
+	CHECK_THROWS_AS (
+			arcsdec::details::create_module_reader("no-such-module"),
+			std::runtime_error );
+}
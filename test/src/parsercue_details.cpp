@@ -19,8 +19,12 @@
 #ifndef __LIBARCSDEC_TOCHANDLER_HPP__
 #include "tochandler.hpp"               // for ParserToCHandler
 #endif
+#ifndef __LIBARCSDEC_METAPARSER_HPP__
+#include "metaparser.hpp"               // for MetadataParseException
+#endif
 
 #include <fstream> // for ifstream
+#include <sstream> // for ostringstream
 
 
 TEST_CASE ("cuesheet", "[yycuesheet]" )
@@ -263,5 +267,26 @@ TEST_CASE ("cuesheet", "[yycuesheet]" )
 
 		CHECK ( result > 0 );
 	}
+
+	SECTION ("Cuesheet data in memory with syntax errors throws")
+	{
+		std::ifstream file { "cuesheet/error05.cue" };
+		std::ostringstream content;
+		content << file.rdbuf();
+		const auto data { content.str() };
+
+		CHECK_THROWS_AS ( driver.parse(data.data(), data.size()),
+				arcsdec::MetadataParseException );
+	}
+
+	SECTION ("Cuesheet data in memory without syntax errors is OK")
+	{
+		std::ifstream file { "cuesheet/ok01.cue" };
+		std::ostringstream content;
+		content << file.rdbuf();
+		const auto data { content.str() };
+
+		CHECK_NOTHROW ( driver.parse(data.data(), data.size()) );
+	}
 }
 
@@ -97,6 +97,43 @@ TEST_CASE ("DescriptorFlac", "[readerflac]" )
 	{
 		CHECK ( d.formats() == std::set<Format>{ Format::FLAC } );
 	}
+
+	SECTION ("Creates a reader")
+	{
+		CHECK ( d.create_reader() != nullptr );
+	}
+}
+
+
+TEST_CASE ("DescriptorFlacCuesheet", "[readerflac]" )
+{
+	using arcsdec::DescriptorFlacCuesheet;
+	using arcsdec::Format;
+	using arcsdec::Codec;
+	using arcsdec::InputType;
+
+	auto d = DescriptorFlacCuesheet {};
+
+	SECTION ("Returns own name correctly")
+	{
+		CHECK ( "FlacCuesheet" == d.name() );
+	}
+
+	SECTION ("Reads ToC input")
+	{
+		CHECK ( InputType::TOC == d.input_type() );
+	}
+
+	SECTION ("Returns accepted formats and codecs correctly")
+	{
+		CHECK ( d.formats() == std::set<Format>{ Format::FLAC } );
+		CHECK ( d.codecs()  == std::set<Codec>{ Codec::FLAC } );
+	}
+
+	SECTION ("Creates a reader")
+	{
+		CHECK ( d.create_reader() != nullptr );
+	}
 }
 
 
@@ -138,6 +175,14 @@ TEST_CASE ("FileReaderSelection", "[filereaderselection]")
 
 		CHECK ( "flac" == reader->id() );
 	}
+
+	SECTION ( "Default ToC settings select flaccue for FLAC/FLAC" )
+	{
+		auto reader = FileReaderRegistry::default_toc_selection()->get(
+				Format::FLAC, Codec::FLAC, *default_readers );
+
+		CHECK ( "flaccue" == reader->id() );
+	}
 }
 
 
@@ -14,10 +14,77 @@
 #endif
 
 #ifndef __LIBARCSDEC_READERMOCKS_HPP__
-#include "readermocks.hpp"              // for Mock_SampleProcessor
+#include "readermocks.hpp"              // for Mock_SampleProcessor, ...
 #endif
+#ifndef __LIBARCSDEC_CALCULATORS_HPP__
+#include "calculators.hpp"              // for CalculationCancelled
+#endif
+
+#include <cstdint>   // for int64_t
+#include <iterator>  // for distance
+#include <set>       // for set
+
+
+/**
+ * \brief Mock for a SampleProcessor that cancels after some samples.
+ *
+ * Throws CalculationCancelled from append_samples() when the specified
+ * number of samples was received, as ProgressProcessor does.
+ */
+class Mock_CancellingProcessor final : public arcsdec::SampleProcessor
+{
+public:
+
+	/**
+	 * \brief Constructor.
+	 *
+	 * \param[in] limit Number of samples to receive before cancelling
+	 */
+	explicit Mock_CancellingProcessor(const int64_t limit)
+		: samples { 0 }
+		, limit_  { limit }
+	{
+		// empty
+	}
+
+	/**
+	 * \brief Number of samples received.
+	 */
+	int64_t samples;
+
+private:
+
+	void do_start_input() final
+	{
+		samples = 0;
+	}
 
-#include <set>  // for set
+	void do_append_samples(arcstk::SampleInputIterator begin,
+			arcstk::SampleInputIterator end) final
+	{
+		if (samples >= limit_)
+		{
+			throw arcsdec::CalculationCancelled("Cancelled by mock");
+		}
+
+		samples += std::distance(begin, end);
+	}
+
+	void do_update_audiosize(const arcstk::AudioSize& /*size*/) final
+	{
+		// empty
+	}
+
+	void do_end_input() final
+	{
+		// empty
+	}
+
+	/**
+	 * \brief Number of samples to receive before cancelling.
+	 */
+	int64_t limit_;
+};
 
 
 TEST_CASE ("FlacDefaultMetadataHandler", "[readerflac]" )
@@ -54,5 +121,89 @@ TEST_CASE ("FlacAudioReaderImpl", "[readerflac]" )
 		r.process_file("test01.flac");
 		// TODO What the mock sees in its callbacks has to be tested
 	}
+
+	SECTION ("Processes a range of samples")
+	{
+		auto counter = Mock_SampleCounter{};
+		r.attach_processor(counter);
+
+		r.process_range("test01.flac", 100, 200);
+
+		CHECK ( counter.samples  == 200 );
+		CHECK ( counter.declared == 200 );
+	}
+
+	SECTION ("Truncates a range to the end of the file")
+	{
+		auto counter = Mock_SampleCounter{};
+		r.attach_processor(counter);
+
+		r.process_range("test01.flac", 1000, 200);
+
+		CHECK ( counter.samples  == 25 );
+		CHECK ( counter.declared == 25 );
+	}
+
+	SECTION ("Cancellation in the write callback aborts decoding")
+	{
+		// test02.flac has 24 frames of 1025 samples
+
+		auto cancelling = Mock_CancellingProcessor { 2 * 1025 };
+		r.attach_processor(cancelling);
+
+		CHECK_THROWS_AS ( r.process_file("test02.flac"),
+				arcsdec::CalculationCancelled );
+		CHECK ( cancelling.samples == 2 * 1025 );
+
+		// The reader is not affected by the aborted decoder
+
+		auto counter = Mock_SampleCounter{};
+		r.attach_processor(counter);
+
+		r.process_file("test02.flac");
+
+		CHECK ( counter.samples  == 24 * 1025 );
+		CHECK ( counter.declared == 24 * 1025 );
+	}
 }
 
+
+TEST_CASE ("FlacCuesheetParserImpl", "[readerflac]" )
+{
+	using arcsdec::details::flac::FlacCuesheetParserImpl;
+	using arcsdec::MetadataParseException;
+
+	FlacCuesheetParserImpl p;
+
+	SECTION ("Returns correct descriptor")
+	{
+		CHECK ( p.descriptor()->id() == "flaccue" );
+	}
+
+	SECTION ("Throws on a file without embedded Cuesheet")
+	{
+		CHECK_THROWS_AS ( p.parse("test01.flac"), MetadataParseException );
+	}
+
+	SECTION ("Parses CUESHEET block with index 1 and lead-out")
+	{
+		const auto toc { p.parse("test01-cuesheet.flac") };
+
+		REQUIRE ( toc->total_tracks() == 2 );
+		CHECK ( toc->offsets().at(0).frames() ==   0 );
+		CHECK ( toc->offsets().at(1).frames() == 400 );
+		CHECK ( toc->leadout().frames()       == 900 );
+		CHECK ( toc->complete() );
+	}
+
+	SECTION ("Parses CUESHEET comment with lead-out from STREAMINFO")
+	{
+		const auto toc { p.parse("test01-cuetag.flac") };
+
+		REQUIRE ( toc->total_tracks() == 2 );
+		CHECK ( toc->offsets().at(0).frames() ==   0 );
+		CHECK ( toc->offsets().at(1).frames() == 400 );
+		CHECK ( toc->leadout().frames()       == 900 );
+		CHECK ( toc->complete() );
+	}
+}
@@ -14,6 +14,13 @@
 #include "readerwav_details.hpp"
 #endif
 
+#ifndef __LIBARCSDEC_READERMOCKS_HPP__
+#include "readermocks.hpp"              // for Mock_SampleCounter
+#endif
+
+#include <cstddef> // for size_t
+#include <memory>  // for make_unique
+
 
 TEST_CASE ( "RIFFWAV_PCM_CDDA_t constants", "[readerwav]" )
 {
@@ -37,3 +44,56 @@ TEST_CASE ( "RIFFWAV_PCM_CDDA_t constants", "[readerwav]" )
 	CHECK( w.wBitsPerSample()    ==  16 );
 }
 
+
+TEST_CASE ("WavAudioReaderImpl", "[readerwav]" )
+{
+	using arcsdec::details::wave::WavAudioHandler;
+	using arcsdec::details::wave::WavAudioReaderImpl;
+
+	auto r = WavAudioReaderImpl { std::make_unique<WavAudioHandler>() };
+
+	auto counter = Mock_SampleCounter{};
+	r.attach_processor(counter);
+
+	SECTION ("Processes the entire file")
+	{
+		r.process_file("test01.wav");
+
+		CHECK ( counter.samples  == 1025 );
+		CHECK ( counter.declared == 1025 );
+	}
+
+	SECTION ("Processes a range of samples")
+	{
+		r.process_range("test01.wav", 100, 200);
+
+		CHECK ( counter.samples  == 200 );
+		CHECK ( counter.declared == 200 );
+	}
+
+	SECTION ("Truncates a range to the end of the file")
+	{
+		r.process_range("test01.wav", 1000, 200);
+
+		CHECK ( counter.samples  == 25 );
+		CHECK ( counter.declared == 25 );
+	}
+
+	SECTION ("Reads the entire file block by block")
+	{
+		r.open("test01.wav");
+
+		CHECK ( r.input_size().samples() == 1025 );
+
+		auto total = std::size_t { 0 };
+
+		for (auto b { r.next_block() }; !b.empty(); b = r.next_block())
+		{
+			total += b.size();
+		}
+
+		r.close();
+
+		CHECK ( total == 1025 );
+	}
+}
@@ -89,6 +89,11 @@ TEST_CASE ("DescriptorWavpack", "[readerwvpk]" )
 	{
 		CHECK ( d.formats() == std::set<Format>{ Format::WV } );
 	}
+
+	SECTION ("Creates a reader")
+	{
+		CHECK ( d.create_reader() != nullptr );
+	}
 }
 
 
@@ -129,6 +134,14 @@ TEST_CASE ("FileReaderSelection", "[filereaderselection]")
 
 		CHECK ( "wavpack" == reader->id() );
 	}
+
+	SECTION ( "Default ToC settings select wavpackcue for WV/Wavpack" )
+	{
+		auto reader = FileReaderRegistry::default_toc_selection()->get(
+				Format::WV, Codec::WAVPACK, *default_readers );
+
+		CHECK ( "wavpackcue" == reader->id() );
+	}
 }
 
 
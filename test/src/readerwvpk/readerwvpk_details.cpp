@@ -56,6 +56,30 @@ TEST_CASE ("WavpackAudioReaderImpl", "[readerwvpk]" )
 		r.process_file("test01.wv");
 		// TODO What the mock sees in its callbacks has to be tested
 	}
+
+	SECTION ("Processes a range of samples")
+	{
+		auto r { WavpackAudioReaderImpl{} };
+		auto counter = Mock_SampleCounter{};
+		r.attach_processor(counter);
+
+		r.process_range("test01.wv", 100, 200);
+
+		CHECK ( counter.samples  == 200 );
+		CHECK ( counter.declared == 200 );
+	}
+
+	SECTION ("Truncates a range to the end of the file")
+	{
+		auto r { WavpackAudioReaderImpl{} };
+		auto counter = Mock_SampleCounter{};
+		r.attach_processor(counter);
+
+		r.process_range("test01.wv", 1000, 200);
+
+		CHECK ( counter.samples  == 25 );
+		CHECK ( counter.declared == 25 );
+	}
 }
 
 
@@ -135,3 +159,21 @@ TEST_CASE ("WavpackValidatingHandler", "[readerwvpk]" )
 	}
 }
 
+
+TEST_CASE ("WavpackCuesheetParserImpl", "[readerwvpk]" )
+{
+	using arcsdec::details::wavpack::WavpackCuesheetParserImpl;
+	using arcsdec::MetadataParseException;
+
+	WavpackCuesheetParserImpl p;
+
+	SECTION ("Returns correct descriptor")
+	{
+		CHECK ( p.descriptor()->id() == "wavpackcue" );
+	}
+
+	SECTION ("Throws on a file without embedded Cuesheet")
+	{
+		CHECK_THROWS_AS ( p.parse("test01.wv"), MetadataParseException );
+	}
+}
@@ -10,6 +10,11 @@
 #include "selection.hpp"                // TO BE TESTED
 #endif
 
+#ifndef __LIBARCSDEC_AUDIOREADER_HPP__
+#include "audioreader.hpp"              // for ReaderStatistics
+#endif
+
+#include <sstream>        // for stringstream
 #include <type_traits>    // for is_copy_constructible,...
 
 
@@ -32,6 +37,321 @@ TEST_CASE ( "FileReaderSelector", "[filereaderselector]")
 }
 
 
+TEST_CASE ( "DefaultPreference", "[defaultpreference]")
+{
+	using arcsdec::Codec;
+	using arcsdec::DefaultPreference;
+	using arcsdec::DescriptorPreference;
+	using arcsdec::Format;
+
+	const auto wavpcm { arcsdec::FileReaderRegistry::reader("wavpcm") };
+	REQUIRE ( wavpcm );
+
+	const auto p = DefaultPreference {};
+
+	SECTION ( "Accepted format and codec have a preference" )
+	{
+		const auto pref { p.preference(Format::WAV, Codec::PCM_S16LE,
+				*wavpcm) };
+
+		CHECK ( DescriptorPreference::MIN_PREFERENCE < pref );
+		CHECK ( pref <= DescriptorPreference::MAX_PREFERENCE );
+	}
+
+	SECTION ( "Accepted format with unknown codec has a preference" )
+	{
+		CHECK ( DescriptorPreference::MIN_PREFERENCE <
+				p.preference(Format::WAV, Codec::UNKNOWN, *wavpcm) );
+	}
+
+	SECTION ( "Unaccepted codec has no preference" )
+	{
+		CHECK ( DescriptorPreference::MIN_PREFERENCE ==
+				p.preference(Format::WAV, Codec::FLAC, *wavpcm) );
+	}
+
+	SECTION ( "Unaccepted format has no preference" )
+	{
+		CHECK ( DescriptorPreference::MIN_PREFERENCE ==
+				p.preference(Format::FLAC, Codec::UNKNOWN, *wavpcm) );
+	}
+
+	SECTION ( "MetadataParser has no preference for audio" )
+	{
+		const auto cuesheet {
+			arcsdec::FileReaderRegistry::reader("cuesheet") };
+		REQUIRE ( cuesheet );
+
+		CHECK ( DescriptorPreference::MIN_PREFERENCE ==
+				p.preference(Format::CUE, Codec::NONE, *cuesheet) );
+	}
+}
+
+
+TEST_CASE ( "FormatPreference", "[formatpreference]")
+{
+	using arcsdec::Codec;
+	using arcsdec::DescriptorPreference;
+	using arcsdec::FormatPreference;
+	using arcsdec::Format;
+
+	const auto wavpcm { arcsdec::FileReaderRegistry::reader("wavpcm") };
+	REQUIRE ( wavpcm );
+
+	const auto cuesheet { arcsdec::FileReaderRegistry::reader("cuesheet") };
+	REQUIRE ( cuesheet );
+
+	const auto p = FormatPreference {};
+
+	SECTION ( "Accepted metadata format has a preference" )
+	{
+		CHECK ( DescriptorPreference::MIN_PREFERENCE <
+				p.preference(Format::CUE, Codec::NONE, *cuesheet) );
+	}
+
+	SECTION ( "AudioReader accepting the format has a preference" )
+	{
+		CHECK ( DescriptorPreference::MIN_PREFERENCE <
+				p.preference(Format::WAV, Codec::PCM_S16LE, *wavpcm) );
+	}
+}
+
+
+TEST_CASE ( "TocPreference", "[tocpreference]")
+{
+	using arcsdec::Codec;
+	using arcsdec::DescriptorPreference;
+	using arcsdec::TocPreference;
+	using arcsdec::Format;
+
+	const auto wavpcm { arcsdec::FileReaderRegistry::reader("wavpcm") };
+	REQUIRE ( wavpcm );
+
+	const auto cuesheet { arcsdec::FileReaderRegistry::reader("cuesheet") };
+	REQUIRE ( cuesheet );
+
+	const auto p = TocPreference {};
+
+	SECTION ( "Accepted metadata format has a preference" )
+	{
+		CHECK ( DescriptorPreference::MIN_PREFERENCE <
+				p.preference(Format::CUE, Codec::NONE, *cuesheet) );
+	}
+
+	SECTION ( "AudioReader has no preference" )
+	{
+		CHECK ( DescriptorPreference::MIN_PREFERENCE ==
+				p.preference(Format::WAV, Codec::PCM_S16LE, *wavpcm) );
+	}
+}
+
+
+TEST_CASE ( "ReaderThroughput", "[readerthroughput]")
+{
+	using arcsdec::Codec;
+	using arcsdec::Format;
+	using arcsdec::ReaderThroughput;
+
+	auto t = ReaderThroughput {};
+
+	t.record("fast", Format::WAV, Codec::PCM_S16LE, 4000, 1.0);
+	t.record("slow", Format::WAV, Codec::PCM_S16LE, 1000, 1.0);
+	t.record("slow", Format::WAV, Codec::PCM_S16LE, 1000, 1.0);
+
+	SECTION ( "Measurements are accumulated" )
+	{
+		CHECK ( 2 == t.size() );
+		CHECK ( 4000.0 == t.samples_per_second("fast", Format::WAV,
+					Codec::PCM_S16LE) );
+		CHECK ( 1000.0 == t.samples_per_second("slow", Format::WAV,
+					Codec::PCM_S16LE) );
+	}
+
+	SECTION ( "Unmeasured reader has no throughput" )
+	{
+		CHECK ( 0.0 == t.samples_per_second("fast", Format::FLAC,
+					Codec::FLAC) );
+		CHECK ( 0.0 == t.best(Format::FLAC, Codec::FLAC) );
+	}
+
+	SECTION ( "Best throughput is determined" )
+	{
+		CHECK ( 4000.0 == t.best(Format::WAV, Codec::PCM_S16LE) );
+	}
+
+	SECTION ( "Invalid measurements are ignored" )
+	{
+		t.record("other", Format::WAV, Codec::PCM_S16LE, 0, 1.0);
+		t.record("other", Format::WAV, Codec::PCM_S16LE, 1000, 0.0);
+
+		CHECK ( 2 == t.size() );
+	}
+
+	SECTION ( "Measurements can be saved and loaded" )
+	{
+		std::stringstream stream;
+		t.save(stream);
+
+		auto loaded = ReaderThroughput {};
+		loaded.load(stream);
+
+		CHECK ( 2 == loaded.size() );
+		CHECK ( 4000.0 == loaded.samples_per_second("fast", Format::WAV,
+					Codec::PCM_S16LE) );
+		CHECK ( 1000.0 == loaded.samples_per_second("slow", Format::WAV,
+					Codec::PCM_S16LE) );
+	}
+
+	SECTION ( "Unparseable lines are skipped on loading" )
+	{
+		std::stringstream stream { "foo\nfast WAV nocodec 100 1\n" };
+
+		auto loaded = ReaderThroughput {};
+		loaded.load(stream);
+
+		CHECK ( 0 == loaded.size() );
+	}
+
+	SECTION ( "Measurements can be cleared" )
+	{
+		t.clear();
+
+		CHECK ( 0 == t.size() );
+	}
+
+	SECTION ( "All formats and codecs can be loaded" )
+	{
+		std::stringstream stream {
+			"r unknown unknown 100 1\nr AIFF none 100 1\n" };
+
+		auto loaded = ReaderThroughput {};
+		loaded.load(stream);
+
+		CHECK ( 2 == loaded.size() );
+		CHECK ( 100.0 == loaded.samples_per_second("r", Format::AIFF,
+					Codec::NONE) );
+	}
+
+	SECTION ( "Statistics of a run are recorded" )
+	{
+		auto statistics = arcsdec::ReaderStatistics {};
+		statistics.reader_id          = "fast";
+		statistics.samples            = 4000;
+		statistics.open_seconds       = 0.25;
+		statistics.decode_seconds     = 0.75;
+		statistics.processing_seconds = 5.0;
+
+		t.record(statistics, Format::WAV, Codec::PCM_S16LE);
+
+		CHECK ( 4000.0 == t.samples_per_second("fast", Format::WAV,
+					Codec::PCM_S16LE) );
+	}
+
+	SECTION ( "Revision changes iff the fastest reader changes" )
+	{
+		const auto r0 { t.revision() };
+
+		t.record("slow", Format::WAV, Codec::PCM_S16LE, 1000, 1.0);
+
+		CHECK ( r0 == t.revision() );
+
+		t.record("slow", Format::WAV, Codec::PCM_S16LE, 100000, 1.0);
+		const auto r1 { t.revision() };
+
+		CHECK ( r0 != r1 );
+
+		t.record("fast", Format::FLAC, Codec::FLAC, 1000, 1.0);
+		const auto r2 { t.revision() };
+
+		CHECK ( r1 != r2 );
+
+		t.clear();
+
+		CHECK ( r2 != t.revision() );
+	}
+}
+
+
+TEST_CASE ( "ThroughputPreference", "[throughputpreference]")
+{
+	using arcsdec::Codec;
+	using arcsdec::DefaultPreference;
+	using arcsdec::DescriptorPreference;
+	using arcsdec::Format;
+	using arcsdec::ReaderThroughput;
+	using arcsdec::ThroughputPreference;
+
+	const auto wavpcm { arcsdec::FileReaderRegistry::reader("wavpcm") };
+	REQUIRE ( wavpcm );
+
+	auto t = ReaderThroughput {};
+	const auto p = ThroughputPreference { &t };
+
+	SECTION ( "Default instance uses the registered measurements" )
+	{
+		CHECK ( arcsdec::FileReaderRegistry::throughput() ==
+				ThroughputPreference{}.throughput() );
+	}
+
+	SECTION ( "Unmeasured reader has a lower preference than by default" )
+	{
+		const auto pref { p.preference(Format::WAV, Codec::PCM_S16LE,
+				*wavpcm) };
+
+		CHECK ( DescriptorPreference::MIN_PREFERENCE < pref );
+		CHECK ( pref < DefaultPreference{}.preference(Format::WAV,
+					Codec::PCM_S16LE, *wavpcm) );
+	}
+
+	SECTION ( "Fastest measured reader has maximal preference" )
+	{
+		t.record(wavpcm->id(), Format::WAV, Codec::PCM_S16LE, 4000, 1.0);
+
+		CHECK ( DescriptorPreference::MAX_PREFERENCE ==
+				p.preference(Format::WAV, Codec::PCM_S16LE, *wavpcm) );
+	}
+
+	SECTION ( "Slower measured reader has lower preference" )
+	{
+		t.record(wavpcm->id(), Format::WAV, Codec::PCM_S16LE, 1000, 1.0);
+		t.record("other",      Format::WAV, Codec::PCM_S16LE, 4000, 1.0);
+
+		const auto pref { p.preference(Format::WAV, Codec::PCM_S16LE,
+				*wavpcm) };
+
+		CHECK ( pref < DescriptorPreference::MAX_PREFERENCE );
+		CHECK ( p.preference(Format::WAV, Codec::UNKNOWN, *wavpcm) < pref );
+	}
+
+	SECTION ( "Unaccepted format has no preference" )
+	{
+		t.record(wavpcm->id(), Format::FLAC, Codec::FLAC, 4000, 1.0);
+
+		CHECK ( DescriptorPreference::MIN_PREFERENCE ==
+				p.preference(Format::FLAC, Codec::FLAC, *wavpcm) );
+	}
+
+	SECTION ( "Selection has the revision of the measurements" )
+	{
+		using arcsdec::DefaultSelector;
+		using arcsdec::FileReaderPreferenceSelection;
+
+		auto selection =
+			FileReaderPreferenceSelection<ThroughputPreference,
+				DefaultSelector> {};
+		selection.set_preference(p);
+
+		const auto r0 { selection.revision() };
+
+		t.record(wavpcm->id(), Format::WAV, Codec::PCM_S16LE, 4000, 1.0);
+
+		CHECK ( t.revision() == selection.revision() );
+		CHECK ( r0 != selection.revision() );
+		CHECK ( 0 == DefaultPreference{}.revision() );
+	}
+}
+
+
 TEST_CASE ( "FileReaderRegistry", "[filereaderregistry]")
 {
 	using arcsdec::FileReaderRegistry;
@@ -89,3 +409,256 @@ TEST_CASE ( "FileReaderRegistry", "[filereaderregistry]")
 	}
 }
 
+
+
+TEST_CASE ( "SelectionCache", "[selectioncache]")
+{
+	using arcsdec::FileReaderRegistry;
+	using arcsdec::details::SelectionCache;
+
+	const auto selection { FileReaderRegistry::default_audio_selection() };
+	const auto formats   { FileReaderRegistry::formats() };
+	const auto readers   { FileReaderRegistry::readers() };
+
+	SelectionCache cache;
+
+	SECTION ( "Copy constructor and assignment operator are not available" )
+	{
+		CHECK ( not std::is_copy_constructible<SelectionCache>::value );
+		CHECK ( not std::is_copy_assignable<SelectionCache>::value );
+	}
+
+	SECTION ( "Selection for same file type is decided only once" )
+	{
+		const auto d1 { cache.descriptor("test01.wav", *selection, *formats,
+				*readers) };
+
+		REQUIRE ( d1 );
+		CHECK ( 1 == cache.size() );
+
+		const auto d2 { cache.descriptor("test01.wav", *selection, *formats,
+				*readers) };
+
+		CHECK ( d1 == d2 );
+		CHECK ( 1 == cache.size() );
+	}
+
+	SECTION ( "Cached selection is equivalent to select_descriptor()" )
+	{
+		const auto d { cache.descriptor("test01.wav", *selection, *formats,
+				*readers) };
+
+		const auto expected { arcsdec::details::select_descriptor("test01.wav",
+				*selection, *formats, *readers) };
+
+		REQUIRE ( d );
+		REQUIRE ( expected );
+		CHECK ( d->id() == expected->id() );
+	}
+
+	SECTION ( "clear() forgets all decisions" )
+	{
+		cache.descriptor("test01.wav", *selection, *formats, *readers);
+		REQUIRE ( 1 == cache.size() );
+
+		cache.clear();
+
+		CHECK ( 0 == cache.size() );
+	}
+
+	SECTION ( "Changed configuration forgets all decisions" )
+	{
+		using arcsdec::details::SelectionConfiguration;
+		using arcsdec::details::next_configuration_id;
+
+		const auto first  = SelectionConfiguration {
+			next_configuration_id(), next_configuration_id(), 0 };
+		const auto second = SelectionConfiguration {
+			next_configuration_id(), std::get<1>(first), 0 };
+
+		CHECK ( cache.configure(first) );
+
+		cache.descriptor("test01.wav", *selection, *formats, *readers);
+		REQUIRE ( 1 == cache.size() );
+
+		CHECK ( not cache.configure(first) );
+		CHECK ( 1 == cache.size() );
+
+		CHECK ( cache.configure(second) );
+		CHECK ( 0 == cache.size() );
+	}
+
+	SECTION ( "Configuration identifiers are never reused" )
+	{
+		const auto id1 { arcsdec::details::next_configuration_id() };
+		const auto id2 { arcsdec::details::next_configuration_id() };
+
+		CHECK ( id1 > 0 );
+		CHECK ( id2 > id1 );
+	}
+}
+
+
+TEST_CASE ( "ReaderPool", "[readerpool]")
+{
+	using arcsdec::FileReader;
+	using arcsdec::details::ReaderPool;
+
+	const auto wavpcm { arcsdec::FileReaderRegistry::reader("wavpcm") };
+	REQUIRE ( wavpcm );
+
+	auto pool = ReaderPool<FileReader> {};
+
+	SECTION ( "Empty pool provides no reader" )
+	{
+		CHECK ( 0 == pool.size() );
+		CHECK ( nullptr == pool.take(wavpcm->id()) );
+	}
+
+	SECTION ( "Reader is provided for its descriptor id" )
+	{
+		auto reader { wavpcm->create_reader() };
+		REQUIRE ( reader );
+
+		const auto address { reader.get() };
+		pool.put(std::move(reader));
+
+		CHECK ( 1 == pool.size() );
+		CHECK ( nullptr == pool.take("foo") );
+		CHECK ( address == pool.take(wavpcm->id()).get() );
+		CHECK ( 0 == pool.size() );
+	}
+
+	SECTION ( "Number of idle readers is limited" )
+	{
+		constexpr auto max_idle { ReaderPool<FileReader>::MAX_IDLE };
+
+		for (auto i = std::size_t { 0 }; i < max_idle + 2; ++i)
+		{
+			pool.put(wavpcm->create_reader());
+		}
+
+		CHECK ( max_idle == pool.size() );
+	}
+
+	SECTION ( "Idle readers can be cleared" )
+	{
+		pool.put(wavpcm->create_reader());
+		pool.clear();
+
+		CHECK ( 0 == pool.size() );
+	}
+
+	SECTION ( "Reader is reset when put into the pool" )
+	{
+		using arcsdec::AudioReader;
+		using arcsdec::BLOCKSIZE;
+
+		auto reader { wavpcm->create_reader() };
+		auto audio  { dynamic_cast<AudioReader*>(reader.get()) };
+		REQUIRE ( audio );
+
+		audio->set_samples_per_read(BLOCKSIZE::DEFAULT + 1024);
+		pool.put(std::move(reader));
+
+		const auto taken { pool.take(wavpcm->id()) };
+		REQUIRE ( taken );
+
+		CHECK ( BLOCKSIZE::DEFAULT ==
+				dynamic_cast<AudioReader&>(*taken).samples_per_read() );
+	}
+
+	SECTION ( "Reader that cannot be reset is discarded" )
+	{
+		class Unresettable final : public FileReader
+		{
+			std::unique_ptr<arcsdec::FileReaderDescriptor> do_descriptor()
+				const final
+			{
+				return arcsdec::FileReaderRegistry::reader("wavpcm")->clone();
+			}
+		};
+
+		pool.put(std::make_unique<Unresettable>());
+
+		CHECK ( 0 == pool.size() );
+	}
+}
+
+
+TEST_CASE ( "FormatTable", "[formattable]")
+{
+	using arcsdec::Bytes;
+	using arcsdec::Codec;
+	using arcsdec::Format;
+	using arcsdec::FormatList;
+	using arcsdec::FormatMatcher;
+	using arcsdec::details::FormatTable;
+
+	FormatList formats;
+
+	formats.push_back(std::make_unique<FormatMatcher<Format::CUE>>(
+		arcsdec::SuffixSet { "cue" }, std::set<Codec> { Codec::NONE }));
+
+	formats.push_back(std::make_unique<FormatMatcher<Format::FLAC>>(
+		arcsdec::SuffixSet { "flac" },
+		Bytes { 0, { 0x66, 0x4C, 0x61, 0x43 } },
+		std::set<Codec> { Codec::FLAC }));
+
+	formats.push_back(std::make_unique<FormatMatcher<Format::M4A>>(
+		arcsdec::SuffixSet { "m4a" },
+		Bytes { 4, { 0x66, 0x74, Bytes::any, 0x70 } },
+		std::set<Codec> { Codec::ALAC }));
+
+	const auto table = FormatTable { formats };
+
+	const auto flac = Bytes { 0, { 0x66, 0x4C, 0x61, 0x43, 0x00, 0x00 } };
+	const auto m4a  = Bytes { 0, { 0x00, 0x00, 0x00, 0x20,
+		0x66, 0x74, 0x12, 0x70, 0x4D } };
+
+	SECTION ( "Table contains all matchers" )
+	{
+		CHECK ( 3 == table.size() );
+	}
+
+	SECTION ( "Matchers without reference bytes accept any bytes" )
+	{
+		CHECK ( 0x1 == (table.candidates(flac) & 0x1) );
+		CHECK ( 0x1 == (table.candidates(m4a)  & 0x1) );
+	}
+
+	SECTION ( "Reference bytes are matched" )
+	{
+		CHECK ( 0x3 == table.candidates(flac) );
+	}
+
+	SECTION ( "Reference bytes with offset and wildcard are matched" )
+	{
+		CHECK ( 0x5 == table.candidates(m4a) );
+	}
+
+	SECTION ( "Wildcards in the input accept any reference byte" )
+	{
+		const auto partial = Bytes { 0, { 0x66, Bytes::any, 0x61, 0x43 } };
+
+		CHECK ( 0x7 == table.candidates(partial) );
+		CHECK ( partial.is_wildcard(1) );
+		CHECK ( not partial.is_wildcard(0) );
+	}
+
+	SECTION ( "Bytes and filename are matched" )
+	{
+		CHECK ( formats[1].get() == table.match(flac, "foo.flac") );
+		CHECK ( formats[2].get() == table.match(m4a,  "foo.m4a") );
+		CHECK ( formats[0].get() == table.match(m4a,  "foo.cue") );
+		CHECK ( nullptr == table.match(flac, "foo.m4a") );
+	}
+
+	SECTION ( "Registered formats are compiled" )
+	{
+		using arcsdec::FileReaderRegistry;
+
+		CHECK ( FileReaderRegistry::formats()->size() ==
+				FileReaderRegistry::format_table()->size() );
+	}
+}